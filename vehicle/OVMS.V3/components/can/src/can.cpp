@@ -51,6 +51,15 @@ static const char *TAG = "can";
 #include "metrics_standard.h"
 #include "vehicle_poller.h"
 
+#define CAN_CYCLIC_EARLY_US   200     // send cyclic messages due within this time
+
+// TX queue entry:
+typedef struct
+  {
+  CAN_frame_t frame;
+  int64_t     time;                   // esp_timer time of queueing
+  } CAN_txentry_t;
+
 #if defined(CONFIG_OVMS_COMP_ESP32CAN) || \
     defined(CONFIG_OVMS_COMP_MCP2515) || \
     defined(CONFIG_OVMS_COMP_EXTERNAL_SWCAN)
@@ -340,7 +349,7 @@ void can_testtx(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, c
   for (uint32_t k=0;k<count;k++)
     {
     frame.data.u8[0] = (uint8_t)k;
-    sbus->Write(&frame, pdMS_TO_TICKS(500));
+    sbus->WritePriority(&frame, CAN_TXPRIO_BULK, pdMS_TO_TICKS(500));
     if (delayms != 0) vTaskDelay(pdMS_TO_TICKS(delayms));
     }
   }
@@ -367,7 +376,7 @@ void can_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, c
   writer->printf("Rx pkt:    %20" PRId32 "\n",sbus->m_status.packets_rx);
   writer->printf("Rx ovrflw: %20d\n",sbus->m_status.rxbuf_overflow);
   writer->printf("Tx pkt:    %20" PRId32 "\n",sbus->m_status.packets_tx);
-  writer->printf("Tx queue:  %20" PRId32 "\n",uxQueueMessagesWaiting(sbus->m_txqueue));
+  writer->printf("Tx queue:  %20" PRId32 "\n",sbus->TxQueueCount());
   writer->printf("Tx delays: %20" PRId32 "\n",sbus->m_status.txbuf_delay);
   writer->printf("Tx ovrflw: %20d\n",sbus->m_status.txbuf_overflow);
   writer->printf("Tx fails:  %20" PRId32 "\n",sbus->m_status.tx_fails);
@@ -388,6 +397,103 @@ void can_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, c
     writer->printf("Wdg Timer: %20" PRId32 " sec(s)\n",monotonictime-sbus->m_watchdog_timer);
     }
   writer->printf("Err Resets:%20d\n",sbus->m_status.error_resets);
+
+  writer->printf("\nTx class    queued  ovrflw  noslot  waiting  lat avg/max [ms]\n");
+  for (int k = 0; k < CAN_TXPRIO_COUNT; k++)
+    {
+    CAN_txstats_t& st = sbus->m_txstats[k];
+    writer->printf("%-9s %8" PRIu32 " %7" PRIu32 " %7" PRIu32 " %8d  %.2f / %.2f\n",
+      GetCanTxPrioName((CAN_txprio_t)k), st.queued, st.overflow, st.noslot,
+      uxQueueMessagesWaiting(sbus->m_txqueues[k]),
+      (st.lat_count > 0) ? (float)st.lat_sum / st.lat_count / 1000 : 0.0f,
+      (float)st.lat_max / 1000);
+    }
+  }
+
+void can_cyclic_list(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  const char* bus = cmd->GetParent()->GetParent()->GetName();
+  canbus* sbus = (canbus*)MyPcpApp.FindDeviceByName(bus);
+  if (sbus == NULL)
+    {
+    writer->puts("Error: Cannot find named CAN bus");
+    return;
+    }
+
+  cancyclic* cyclic = sbus->GetCyclic();
+  int cnt = 0;
+  for (int k = 0; cyclic && k < CAN_MAXCYCLIC; k++)
+    {
+    std::string info = cyclic->GetInfo(k);
+    if (info.empty()) continue;
+    writer->printf("#%d: %s\n", k, info.c_str());
+    cnt++;
+    }
+  if (cnt == 0)
+    writer->puts("No cyclic messages");
+  }
+
+void can_cyclic_add(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  const char* bus = cmd->GetParent()->GetParent()->GetName();
+  canbus* sbus = (canbus*)MyPcpApp.FindDeviceByName(bus);
+  if (sbus == NULL)
+    {
+    writer->puts("Error: Cannot find named CAN bus");
+    return;
+    }
+
+  CAN_frame_t frame = {};
+  frame.origin = sbus;
+  char* ep;
+  uint32_t uv = strtoul(argv[0], &ep, 16);
+  if (*ep != '\0' || uv > 0x1fffffff)
+    {
+    writer->printf("Error: Invalid CAN ID \"%s\"\n", argv[0]);
+    return;
+    }
+  frame.MsgID = uv;
+  frame.FIR.B.FF = (uv > 0x7ff) ? CAN_frame_ext : CAN_frame_std;
+  int period = atoi(argv[1]);
+  int phase = atoi(argv[2]);
+  if (period <= 0 || phase < 0)
+    {
+    writer->puts("Error: Invalid period/phase");
+    return;
+    }
+  frame.FIR.B.DLC = argc-3;
+  for (int k=0; k<(argc-3); k++)
+    {
+    uv = strtoul(argv[k+3], &ep, 16);
+    if (*ep != '\0' || uv > 0xff)
+      {
+      writer->printf("Error: Invalid CAN octet \"%s\"\n", argv[k+3]);
+      return;
+      }
+    frame.data.u8[k] = uv;
+    }
+
+  int handle = sbus->AddCyclic(&frame, period, phase);
+  if (handle < 0)
+    writer->printf("Error: Cyclic message table full (max %d)\n", CAN_MAXCYCLIC);
+  else
+    writer->printf("Cyclic message #%d added\n", handle);
+  }
+
+void can_cyclic_remove(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  const char* bus = cmd->GetParent()->GetParent()->GetName();
+  canbus* sbus = (canbus*)MyPcpApp.FindDeviceByName(bus);
+  if (sbus == NULL)
+    {
+    writer->puts("Error: Cannot find named CAN bus");
+    return;
+    }
+
+  if (sbus->RemoveCyclic(atoi(argv[0])))
+    writer->puts("Cyclic message removed");
+  else
+    writer->puts("Error: Cannot find specified cyclic message");
   }
 
 void can_explain_flags(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
@@ -708,6 +814,18 @@ const char* GetCanLogTypeName(CAN_log_type_t type)
   return CAN_log_type_names[type];
   }
 
+static const char* const CAN_txprio_names[] = {
+  "control",
+  "poller",
+  "cyclic",
+  "bulk"
+  };
+
+const char* GetCanTxPrioName(CAN_txprio_t prio)
+  {
+  return (prio < CAN_TXPRIO_COUNT) ? CAN_txprio_names[prio] : "-";
+  }
+
 void can::LogFrame(canbus* bus, CAN_log_type_t type, const CAN_frame_t* frame)
   {
   OvmsRecMutexLock lock(&m_loggermap_mutex);
@@ -756,7 +874,7 @@ void canbus::LogStatus(CAN_log_type_t type)
       m_status.error_flags, m_status.errors_rx, m_status.errors_tx,
       m_status.invalid_rx, m_status.rxbuf_overflow, m_status.txbuf_overflow,
       m_status.txbuf_delay, m_status.tx_fails, m_status.watchdog_resets,
-      m_status.error_resets, uxQueueMessagesWaiting(m_txqueue));
+      m_status.error_resets, TxQueueCount());
     }
   if (MyCan.HasLogger())
     MyCan.LogStatus(this, type, &m_status);
@@ -1100,6 +1218,12 @@ can::can()
     cmd_cantesttx->RegisterCommand("standard","Transmit test standard CAN frames",can_testtx,"<id> <count> <delayms>", 3, 3);
     cmd_cantesttx->RegisterCommand("extended","Transmit test extended CAN frames",can_testtx,"<id> <count> <delayms>", 3, 3);
     cmd_canx->RegisterCommand("status","Show CAN status",can_status);
+    OvmsCommand* cmd_cancyclic = cmd_canx->RegisterCommand("cyclic","CAN cyclic messages");
+    cmd_cancyclic->RegisterCommand("list","List cyclic messages",can_cyclic_list);
+    cmd_cancyclic->RegisterCommand("add","Add cyclic message",can_cyclic_add,
+      "<id> <period_ms> <phase_ms> [<data...>]\n"
+      "IDs above 7ff are sent as extended frames", 3, 11);
+    cmd_cancyclic->RegisterCommand("remove","Remove cyclic message",can_cyclic_remove,"<nr>", 1, 1);
     cmd_canx->RegisterCommand("clear","Clear CAN status",can_clearstatus);
     cmd_canx->RegisterCommand("explain","Explain CAN error flags", can_explain_flags, "[<errorflags>]\n"
       "Produce a human readable decoding of the current or given error flags for the bus, if available.\n"
@@ -1185,6 +1309,21 @@ void can::NotifyListeners(const CAN_frame_t* frame, bool tx)
     }
   }
 
+/**
+ * GetListenerSpace: get the minimum free space of all listener queues
+ *  (i.e. for frame producers that need to pace themselves to the consumers)
+ */
+uint32_t can::GetListenerSpace()
+  {
+  uint32_t space = UINT32_MAX;
+  for (CanListenerMap_t::iterator it = m_listeners.begin(); it != m_listeners.end(); ++it)
+    {
+    uint32_t s = uxQueueSpacesAvailable(it->first);
+    if (s < space) space = s;
+    }
+  return space;
+  }
+
 /**
  * RegisterCallback: register a synchronous CAN frame processor
  * 
@@ -1274,7 +1413,12 @@ canbus::canbus(const char* name)
   : pcp(name)
   {
   m_busnumber = name[strlen(name)-1] - '1';
-  m_txqueue = xQueueCreate(CONFIG_OVMS_HW_CAN_TX_QUEUE_SIZE, sizeof(CAN_frame_t));
+  for (int k = 0; k < CAN_TXPRIO_COUNT; k++)
+    m_txqueues[k] = xQueueCreate(CONFIG_OVMS_HW_CAN_TX_QUEUE_SIZE, sizeof(CAN_txentry_t));
+  m_txprio_lock = portMUX_INITIALIZER_UNLOCKED;
+  memset(m_txprio, 0, sizeof(m_txprio));
+  m_cyclic = NULL;
+  m_overlay = NULL;
   m_mode = CAN_MODE_OFF;
   m_speed = CAN_SPEED_1000KBPS;
   m_dbcfile = NULL;
@@ -1288,7 +1432,13 @@ canbus::canbus(const char* name)
 
 canbus::~canbus()
   {
-  vQueueDelete(m_txqueue);
+  if (m_cyclic)
+    {
+    delete m_cyclic;
+    m_cyclic = NULL;
+    }
+  for (int k = 0; k < CAN_TXPRIO_COUNT; k++)
+    vQueueDelete(m_txqueues[k]);
   }
 
 esp_err_t canbus::Start(CAN_mode_t mode, CAN_speed_t speed)
@@ -1336,6 +1486,7 @@ esp_err_t canbus::WriteReg( uint8_t reg, uint8_t value )
 void canbus::ClearStatus()
   {
   memset(&m_status, 0, sizeof(m_status));
+  memset(&m_txstats, 0, sizeof(m_txstats));
   m_status_chksum = 0;
   m_watchdog_timer = monotonictime;
   }
@@ -1427,9 +1578,22 @@ void canbus::TxCallback(CAN_frame_t* p_frame, bool success)
  *    - returns ESP_OK, ESP_QUEUED or ESP_FAIL
  *      … ESP_OK = frame delivered to CAN transceiver (not necessarily sent!)
  *      … ESP_FAIL = TX queue is full (TX overflow)
- *    - actual TX implementation in driver override
+ *    - with an overlay attached, the overlay takes the frame instead of the driver
+ *    - actual TX implementation in driver override of DriverWrite()
  */
 esp_err_t canbus::Write(const CAN_frame_t* p_frame, TickType_t maxqueuewait /*=0*/)
+  {
+  canbus* overlay = m_overlay;
+  if (overlay)
+    return overlay->Write(p_frame, maxqueuewait);
+  return DriverWrite(p_frame, maxqueuewait);
+  }
+
+/**
+ * canbus::DriverWrite -- driver TX implementation
+ *    - drivers call the base implementation on success for the TX callback
+ */
+esp_err_t canbus::DriverWrite(const CAN_frame_t* p_frame, TickType_t maxqueuewait /*=0*/)
   {
   m_tx_frame = *p_frame; // save a local copy of this frame to be used later in txcallback
   m_tx_frame.origin = this;
@@ -1442,20 +1606,151 @@ esp_err_t canbus::Write(const CAN_frame_t* p_frame, TickType_t maxqueuewait /*=0
  */
 esp_err_t canbus::QueueWrite(const CAN_frame_t* p_frame, TickType_t maxqueuewait /*=0*/)
   {
-  if (xQueueSend(m_txqueue, p_frame, maxqueuewait) == pdTRUE)
+  CAN_txprio_t prio = GetTxPriority();
+  CAN_txentry_t entry;
+  entry.frame = *p_frame;
+  entry.time = esp_timer_get_time();
+  if (xQueueSend(m_txqueues[prio], &entry, maxqueuewait) == pdTRUE)
     {
     m_status.txbuf_delay++;
+    m_txstats[prio].queued++;
     LogFrame(CAN_LogFrame_TX_Queue, p_frame);
     return ESP_QUEUED;
     }
   else
     {
     m_status.txbuf_overflow++;
+    m_txstats[prio].overflow++;
     LogFrame(CAN_LogFrame_TX_Fail, p_frame);
     return ESP_FAIL;
     }
   }
 
+/**
+ * canbus::TxQueuePop -- get the next frame to send from the TX queues
+ *    - internal method, called by driver when a TX buffer becomes available
+ *    - serves the highest priority class first
+ */
+bool canbus::TxQueuePop(CAN_frame_t* p_frame)
+  {
+  CAN_txentry_t entry;
+  for (int k = 0; k < CAN_TXPRIO_COUNT; k++)
+    {
+    if (xQueueReceive(m_txqueues[k], &entry, 0) == pdTRUE)
+      {
+      *p_frame = entry.frame;
+      CAN_txstats_t& st = m_txstats[k];
+      uint32_t lat = esp_timer_get_time() - entry.time;
+      st.lat_count++;
+      st.lat_sum += lat;
+      if (lat > st.lat_max) st.lat_max = lat;
+      return true;
+      }
+    }
+  return false;
+  }
+
+uint32_t canbus::TxQueueCount()
+  {
+  uint32_t cnt = 0;
+  for (int k = 0; k < CAN_TXPRIO_COUNT; k++)
+    cnt += uxQueueMessagesWaiting(m_txqueues[k]);
+  return cnt;
+  }
+
+void canbus::TxQueueReset()
+  {
+  for (int k = 0; k < CAN_TXPRIO_COUNT; k++)
+    xQueueReset(m_txqueues[k]);
+  }
+
+/**
+ * canbus::WritePriority -- TX API for a priority class
+ *    - as Write(), queued frames are sent before those of lower classes
+ *    - the class is passed to QueueWrite() per calling task, so concurrent
+ *      writers never wait for each other here
+ *    - with an overlay attached, the overlay takes the frame instead of the driver
+ */
+esp_err_t canbus::WritePriority(const CAN_frame_t* p_frame, CAN_txprio_t prio, TickType_t maxqueuewait /*=0*/)
+  {
+  canbus* overlay = m_overlay;
+  if (overlay)
+    return overlay->Write(p_frame, maxqueuewait);
+
+  if (prio == CAN_TXPRIO_CONTROL || prio >= CAN_TXPRIO_COUNT)
+    return Write(p_frame, maxqueuewait);
+
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  int slot = -1;
+  portENTER_CRITICAL(&m_txprio_lock);
+  for (int k = 0; k < CAN_TXPRIO_SLOTS; k++)
+    {
+    if (m_txprio[k].task == NULL)
+      {
+      m_txprio[k].task = task;
+      m_txprio[k].prio = prio;
+      slot = k;
+      break;
+      }
+    }
+  portEXIT_CRITICAL(&m_txprio_lock);
+  if (slot < 0)
+    {
+    // All slots taken by concurrent writers: a queued frame falls back to CONTROL
+    m_txstats[prio].noslot++;
+    }
+
+  esp_err_t res = Write(p_frame, maxqueuewait);
+
+  if (slot >= 0)
+    {
+    portENTER_CRITICAL(&m_txprio_lock);
+    m_txprio[slot].task = NULL;
+    portEXIT_CRITICAL(&m_txprio_lock);
+    }
+  return res;
+  }
+
+CAN_txprio_t canbus::GetTxPriority()
+  {
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  CAN_txprio_t prio = CAN_TXPRIO_CONTROL;
+  portENTER_CRITICAL(&m_txprio_lock);
+  for (int k = 0; k < CAN_TXPRIO_SLOTS; k++)
+    {
+    if (m_txprio[k].task == task)
+      {
+      prio = m_txprio[k].prio;
+      break;
+      }
+    }
+  portEXIT_CRITICAL(&m_txprio_lock);
+  return prio;
+  }
+
+/**
+ * canbus::AddCyclic -- register a cyclic message
+ *    - p_frame: ID, format, DLC and initial payload
+ *    - phase_ms: offset of the first transmission
+ *    - callback: optional payload update hook, called before each send
+ *    - returns the handle (>= 0) or -1 if the table is full
+ */
+int canbus::AddCyclic(const CAN_frame_t* p_frame, uint32_t period_ms, uint32_t phase_ms /*=0*/, CanCyclicCallback callback /*=NULL*/)
+  {
+  if (!m_cyclic) m_cyclic = new cancyclic(this);
+  return m_cyclic->Add(p_frame, period_ms, phase_ms, callback);
+  }
+
+bool canbus::UpdateCyclic(int handle, const uint8_t* data, uint8_t length)
+  {
+  return m_cyclic ? m_cyclic->Update(handle, data, length) : false;
+  }
+
+bool canbus::RemoveCyclic(int handle)
+  {
+  return m_cyclic ? m_cyclic->Remove(handle) : false;
+  }
+
 /**
  * canbus::WriteExtended -- application TX utility
  */
@@ -1475,7 +1770,7 @@ esp_err_t canbus::WriteExtended(uint32_t id, uint8_t length, uint8_t *data, Tick
   frame.FIR.B.FF = CAN_frame_ext;
   frame.MsgID = id;
   memcpy(frame.data.u8, data, length);
-  return this->Write(&frame, maxqueuewait);
+  return WritePriority(&frame, CAN_TXPRIO_CONTROL, maxqueuewait);
   }
 
 /**
@@ -1497,7 +1792,7 @@ esp_err_t canbus::WriteStandard(uint16_t id, uint8_t length, uint8_t *data, Tick
   frame.FIR.B.FF = CAN_frame_std;
   frame.MsgID = id;
   memcpy(frame.data.u8, data, length);
-  return this->Write(&frame, maxqueuewait);
+  return WritePriority(&frame, CAN_TXPRIO_CONTROL, maxqueuewait);
   }
 
 /**
@@ -1506,9 +1801,230 @@ esp_err_t canbus::WriteStandard(uint16_t id, uint8_t length, uint8_t *data, Tick
  *      … ESP_OK = frame delivered to CAN transceiver (not necessarily sent!)
  *      … ESP_FAIL = TX queue is full (TX overflow)
  */
-esp_err_t CAN_frame_t::Write(canbus* bus /*=NULL*/, TickType_t maxqueuewait /*=0*/)
+esp_err_t CAN_frame_t::Write(canbus* bus /*=NULL*/, TickType_t maxqueuewait /*=0*/, CAN_txprio_t prio /*=CAN_TXPRIO_CONTROL*/)
   {
   if (!bus)
     bus = origin;
-  return bus ? bus->Write(this, maxqueuewait) : ESP_FAIL;
+  return bus ? bus->WritePriority(this, prio, maxqueuewait) : ESP_FAIL;
+  }
+
+////////////////////////////////////////////////////////////////////////
+// cancyclic - cyclic messages of a CAN bus
+////////////////////////////////////////////////////////////////////////
+
+cancyclic::cancyclic(canbus* bus)
+  {
+  m_bus = bus;
+  m_lock = portMUX_INITIALIZER_UNLOCKED;
+  for (int k = 0; k < CAN_MAXCYCLIC; k++) m_entries[k] = NULL;
+  m_running = -1;
+  m_runner = NULL;
+  m_runs = 0;
+  m_generation = 0;
+
+  esp_timer_create_args_t args = {};
+  args.callback = TimerCallback;
+  args.arg = this;
+  args.name = "can cyclic";
+  if (esp_timer_create(&args, &m_timer) != ESP_OK)
+    {
+    ESP_LOGE(TAG, "%s: cannot create cyclic message timer", bus->GetName());
+    m_timer = NULL;
+    }
+  }
+
+cancyclic::~cancyclic()
+  {
+    {
+    OvmsMutexLock lock(&m_mutex);
+    if (m_timer)
+      {
+      esp_timer_stop(m_timer);
+      esp_timer_delete(m_timer);
+      m_timer = NULL;
+      }
+    }
+  // Wait for a Run() in progress (sending or waiting for the mutex), it
+  //  stops at the next entry now the timer is gone:
+  while (m_runs > 0 && xTaskGetCurrentTaskHandle() != m_runner)
+    vTaskDelay(1);
+  OvmsMutexLock lock(&m_mutex);
+  for (int k = 0; k < CAN_MAXCYCLIC; k++)
+    {
+    if (m_entries[k]) delete m_entries[k];
+    m_entries[k] = NULL;
+    }
+  }
+
+int cancyclic::Add(const CAN_frame_t* p_frame, uint32_t period_ms, uint32_t phase_ms, CanCyclicCallback callback)
+  {
+  if (period_ms == 0 || m_timer == NULL) return -1;
+  OvmsMutexLock lock(&m_mutex);
+  for (int k = 0; k < CAN_MAXCYCLIC; k++)
+    {
+    if (m_entries[k] == NULL)
+      {
+      entry_t* e = new entry_t();
+      e->frame = *p_frame;
+      e->frame.origin = m_bus;
+      e->frame.callback = NULL;
+      e->callback = callback;
+      e->period = (int64_t)period_ms * 1000;
+      e->due = esp_timer_get_time() + (int64_t)phase_ms * 1000;
+      e->sent = e->failed = e->missed = e->jitter_max = 0;
+      e->jitter_sum = 0;
+      e->generation = ++m_generation;
+      m_entries[k] = e;
+      Schedule();
+      return k;
+      }
+    }
+  return -1;
+  }
+
+bool cancyclic::Update(int handle, const uint8_t* data, uint8_t length)
+  {
+  if (handle < 0 || handle >= CAN_MAXCYCLIC || length > 8) return false;
+  bool found = false;
+  portENTER_CRITICAL(&m_lock);
+  entry_t* e = m_entries[handle];
+  if (e)
+    {
+    memcpy(e->frame.data.u8, data, length);
+    e->frame.FIR.B.DLC = length;
+    found = true;
+    }
+  portEXIT_CRITICAL(&m_lock);
+  return found;
+  }
+
+bool cancyclic::Remove(int handle)
+  {
+  if (handle < 0 || handle >= CAN_MAXCYCLIC) return false;
+    {
+    OvmsMutexLock lock(&m_mutex);
+    entry_t* e = m_entries[handle];
+    if (e == NULL) return false;
+    portENTER_CRITICAL(&m_lock);
+    m_entries[handle] = NULL;
+    portEXIT_CRITICAL(&m_lock);
+    delete e;
+    Schedule();
+    }
+  // Wait for a send in progress, the callback may refer to the caller:
+  while (m_running == handle && xTaskGetCurrentTaskHandle() != m_runner)
+    vTaskDelay(1);
+  return true;
+  }
+
+std::string cancyclic::GetInfo(int handle)
+  {
+  if (handle < 0 || handle >= CAN_MAXCYCLIC) return std::string("");
+  OvmsMutexLock lock(&m_mutex);
+  entry_t* e = m_entries[handle];
+  if (e == NULL) return std::string("");
+
+  std::ostringstream buf;
+  buf << std::hex << std::uppercase << e->frame.MsgID << std::dec
+    << " every " << (e->period / 1000) << " ms"
+    << " Sent:" << e->sent
+    << " Failed:" << e->failed
+    << " Missed:" << e->missed;
+  if (e->sent > 0)
+    buf << " Jitter:" << std::fixed << std::setprecision(2)
+      << ((float)e->jitter_sum / e->sent / 1000) << "/" << ((float)e->jitter_max / 1000) << "ms";
+  return buf.str();
+  }
+
+void cancyclic::TimerCallback(void* arg)
+  {
+  cancyclic* me = (cancyclic*)arg;
+  portENTER_CRITICAL(&me->m_lock);
+  me->m_runs++;
+  me->m_runner = xTaskGetCurrentTaskHandle();
+  portEXIT_CRITICAL(&me->m_lock);
+  me->Run();
+  portENTER_CRITICAL(&me->m_lock);
+  me->m_runs--;
+  portEXIT_CRITICAL(&me->m_lock);
+  }
+
+/**
+ * Run: send all due messages (esp_timer task), then re-arm the timer
+ */
+void cancyclic::Run()
+  {
+  // Send the due frames one at a time, without holding the mutex while
+  //  calling the payload hook and the driver (Remove() waits for a send in progress):
+  int64_t now = esp_timer_get_time();
+  CAN_frame_t frame;
+  CanCyclicCallback callback;
+
+  for (int k = 0; k < CAN_MAXCYCLIC; k++)
+    {
+    uint32_t generation;
+    uint32_t jitter;
+      {
+      OvmsMutexLock lock(&m_mutex);
+      if (m_timer == NULL) return; // shutting down
+      entry_t* e = m_entries[k];
+      if (e == NULL || e->due > now + CAN_CYCLIC_EARLY_US) continue;
+      generation = e->generation;
+
+      jitter = (now > e->due) ? now - e->due : 0;
+      portENTER_CRITICAL(&m_lock);
+      frame = e->frame;
+      portEXIT_CRITICAL(&m_lock);
+      callback = e->callback;
+      m_running = k;
+
+      // Keep the phase, skip periods missed:
+      e->due += e->period;
+      if (e->due <= now)
+        {
+        int64_t skip = (now - e->due) / e->period + 1;
+        e->missed += skip;
+        e->due += skip * e->period;
+        }
+      }
+
+    if (callback) callback(&frame);
+    bool failed = (m_bus->WritePriority(&frame, CAN_TXPRIO_CYCLIC, 0) == ESP_FAIL);
+
+    OvmsMutexLock lock(&m_mutex);
+    m_running = -1;
+    entry_t* e = m_entries[k];
+    if (e == NULL || e->generation != generation) continue; // removed (& replaced) meanwhile
+    if (failed)
+      e->failed++;
+    else
+      {
+      e->sent++;
+      e->jitter_sum += jitter;
+      if (jitter > e->jitter_max) e->jitter_max = jitter;
+      }
+    }
+
+  OvmsMutexLock lock(&m_mutex);
+  Schedule();
+  }
+
+/**
+ * Schedule: arm the timer for the next due message (mutex held)
+ */
+void cancyclic::Schedule()
+  {
+  if (m_timer == NULL) return;
+  int64_t next = INT64_MAX;
+  for (int k = 0; k < CAN_MAXCYCLIC; k++)
+    {
+    if (m_entries[k] && m_entries[k]->due < next)
+      next = m_entries[k]->due;
+    }
+  esp_timer_stop(m_timer);
+  if (next != INT64_MAX)
+    {
+    int64_t wait = next - esp_timer_get_time();
+    esp_timer_start_once(m_timer, (wait > 50) ? wait : 50);
+    }
   }
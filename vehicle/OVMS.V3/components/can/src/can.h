@@ -44,6 +44,7 @@
 #include <list>
 #include "pcp.h"
 #include <esp_err.h>
+#include "esp_timer.h"
 #include "ovms_events.h"
 
 ////////////////////////////////////////////////////////////////////////
@@ -117,6 +118,21 @@ typedef union
   } CAN_FIR_t;
 
 
+// CAN TX priority classes (highest first), each with a TX queue of its own:
+typedef enum
+  {
+  CAN_TXPRIO_CONTROL = 0,               // application & control frames (Write() default)
+  CAN_TXPRIO_POLLER,                    // poller / diagnostic requests
+  CAN_TXPRIO_CYCLIC,                    // registered cyclic messages
+  CAN_TXPRIO_BULK,                      // bulk transfers (log transmit mode, test frames)
+  CAN_TXPRIO_COUNT
+  } CAN_txprio_t;
+
+extern const char* GetCanTxPrioName(CAN_txprio_t prio);
+
+// Max concurrent WritePriority() calls tracked per bus (see canbus::m_txprio):
+#define CAN_TXPRIO_SLOTS 4
+
 typedef struct CAN_frame_t CAN_frame_t;
 typedef std::function<void(const CAN_frame_t*, bool)> CanFrameCallback;
 
@@ -136,7 +152,8 @@ struct CAN_frame_t
     uint64_t  u64;                      // Payload u64 access (Att: little endian!)
     } data;
 
-  esp_err_t Write(canbus* bus=NULL, TickType_t maxqueuewait=0);  // bus: NULL=origin
+  esp_err_t Write(canbus* bus=NULL, TickType_t maxqueuewait=0,   // bus: NULL=origin
+                  CAN_txprio_t prio=CAN_TXPRIO_CONTROL);
   };
 
 // CAN status
@@ -170,6 +187,17 @@ typedef enum
 
 extern const char* GetCanErrorStateName(CAN_errorstate_t error_state);
 
+// CAN TX class statistics
+typedef struct
+  {
+  uint32_t queued;                  // frames routed through the TX queue
+  uint32_t overflow;                // TX queue overflows
+  uint32_t noslot;                  // WritePriority() without a free slot (queued as CONTROL)
+  uint32_t lat_count;               // frames sent from the queue
+  uint32_t lat_max;                 // queue latency [us]
+  uint64_t lat_sum;
+  } CAN_txstats_t;
+
 ////////////////////////////////////////////////////////////////////////
 // CAN messages queue
 // This queue is between the CAN bus controller MyCAN and tasks that
@@ -288,6 +316,10 @@ extern const char* GetCanLogTypeName(CAN_log_type_t type);
 class canlog;
 class canplay;
 class dbcfile;
+class cancyclic;
+
+// Cyclic message payload update hook, called before each transmission:
+typedef std::function<void(CAN_frame_t*)> CanCyclicCallback;
 
 class canbus : public pcp, public InternalRamAllocated
   {
@@ -311,15 +343,36 @@ class canbus : public pcp, public InternalRamAllocated
     dbcfile* GetDBC();
 
   public:
-    virtual esp_err_t Write(const CAN_frame_t* p_frame, TickType_t maxqueuewait=0);
+    esp_err_t Write(const CAN_frame_t* p_frame, TickType_t maxqueuewait=0);
     virtual esp_err_t WriteExtended(uint32_t id, uint8_t length, uint8_t *data, TickType_t maxqueuewait=0);
     virtual esp_err_t WriteStandard(uint16_t id, uint8_t length, uint8_t *data, TickType_t maxqueuewait=0);
     virtual bool AsynchronousInterruptHandler(CAN_frame_t* frame, uint32_t* framesReceived);
     virtual void TxCallback(CAN_frame_t* frame, bool success);
 
+  public:
+    // Prioritized TX (see CAN_txprio_t):
+    esp_err_t WritePriority(const CAN_frame_t* p_frame, CAN_txprio_t prio, TickType_t maxqueuewait=0);
+    uint32_t TxQueueCount();
+    bool TxQueuePop(CAN_frame_t* p_frame);
+    void TxQueueReset();
+
+  public:
+    // Cyclic messages (sent at CAN_TXPRIO_CYCLIC):
+    int AddCyclic(const CAN_frame_t* p_frame, uint32_t period_ms, uint32_t phase_ms=0, CanCyclicCallback callback=NULL);
+    bool UpdateCyclic(int handle, const uint8_t* data, uint8_t length);
+    bool RemoveCyclic(int handle);
+    cancyclic* GetCyclic() { return m_cyclic; }
+
+  public:
+    // Virtual bus overlay (e.g. ECU simulator), takes all TX:
+    void SetOverlay(canbus* overlay) { m_overlay = overlay; }
+    canbus* GetOverlay() { return m_overlay; }
+
   protected:
+    virtual esp_err_t DriverWrite(const CAN_frame_t* p_frame, TickType_t maxqueuewait=0);
     virtual esp_err_t QueueWrite(const CAN_frame_t* p_frame, TickType_t maxqueuewait=0);
     virtual void BusTicker10(std::string event, void* data);
+    CAN_txprio_t GetTxPriority();
 
   public:
     void LogFrame(CAN_log_type_t type, const CAN_frame_t* p_frame);
@@ -338,11 +391,74 @@ class canbus : public pcp, public InternalRamAllocated
     uint32_t m_status_chksum;
     uint32_t m_watchdog_timer;
     uint32_t m_state;             // state bitset
-    QueueHandle_t m_txqueue;
+    QueueHandle_t m_txqueues[CAN_TXPRIO_COUNT];
+    CAN_txstats_t m_txstats[CAN_TXPRIO_COUNT];
     int m_busnumber;
 
   protected:
     dbcfile *m_dbcfile;
+    cancyclic *m_cyclic;
+    canbus *m_overlay;
+    portMUX_TYPE m_txprio_lock;
+    struct
+      {
+      TaskHandle_t task;
+      CAN_txprio_t prio;
+      } m_txprio[CAN_TXPRIO_SLOTS]; // priority of Write() calls in progress
+  };
+
+/**
+ * cancyclic: cyclic messages of a bus, sent by an esp_timer at their due
+ *  time (period & phase). Frame payloads are shared buffers, updated by
+ *  canbus::UpdateCyclic() or by a callback invoked before each send.
+ *  Late sends are counted as jitter, skipped periods as missed.
+ */
+#define CAN_MAXCYCLIC 16
+
+class cancyclic : public InternalRamAllocated
+  {
+  public:
+    typedef struct
+      {
+      CAN_frame_t       frame;
+      CanCyclicCallback callback;
+      int64_t           period;     // [us]
+      int64_t           due;        // esp_timer time of next send
+      uint32_t          sent;
+      uint32_t          failed;
+      uint32_t          missed;
+      uint32_t          jitter_max; // [us]
+      uint64_t          jitter_sum;
+      uint32_t          generation; // identifies the entry of a handle
+      } entry_t;
+
+  public:
+    cancyclic(canbus* bus);
+    ~cancyclic();
+
+  public:
+    int Add(const CAN_frame_t* p_frame, uint32_t period_ms, uint32_t phase_ms, CanCyclicCallback callback);
+    bool Update(int handle, const uint8_t* data, uint8_t length);
+    bool Remove(int handle);
+    std::string GetInfo(int handle);
+
+  protected:
+    static void TimerCallback(void* arg);
+    void Run();
+    void Schedule();
+
+  public:
+    canbus*           m_bus;
+    entry_t*          m_entries[CAN_MAXCYCLIC];
+
+  protected:
+    OvmsMutex         m_mutex;      // entry list & timer
+    portMUX_TYPE      m_lock;       // payload access
+    esp_timer_handle_t m_timer;
+    volatile int      m_running;    // handle being sent by Run(), -1 = none
+    TaskHandle_t      m_runner;     // timer task (running Run())
+    volatile int      m_runs;       // Run() calls in progress (incl. waiting for the mutex)
+    uint32_t          m_generation; // last entry generation assigned
   };
 
 #define CAN_M_STATE_TX_BUF_OCCUPIED   BIT(0) // transmit buffer is in use
@@ -388,6 +504,7 @@ class can : public InternalRamAllocated
     void RegisterListener(QueueHandle_t queue, bool txfeedback=false);
     void DeregisterListener(QueueHandle_t queue);
     void NotifyListeners(const CAN_frame_t* frame, bool tx);
+    uint32_t GetListenerSpace();
 
   public:
     void RegisterCallback(const char* caller, CanFrameCallback callback, bool txfeedback=false);
@@ -0,0 +1,477 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Module:        CAN bus bridge
+;    Date:          18th October 2026
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011        Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+#include "ovms_log.h"
+static const char *TAG = "canbridge";
+
+#include <string.h>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include "can.h"
+#include "canbridge.h"
+#include "ovms_command.h"
+#include "ovms_peripherals.h"
+#include "esp_timer.h"
+
+canbridge MyCanBridge __attribute__ ((init_priority (4580)));
+
+////////////////////////////////////////////////////////////////////////
+// Command Processing
+////////////////////////////////////////////////////////////////////////
+
+static bool can_bridge_parse_ids(const char* arg, uint32_t& id_from, uint32_t& id_to)
+  {
+  char* ep;
+  id_from = strtoul(arg, &ep, 16);
+  if (ep == arg) return false;
+  if (*ep == '-')
+    {
+    const char* p = ep+1;
+    id_to = (*p) ? strtoul(p, &ep, 16) : UINT32_MAX;
+    }
+  else
+    id_to = id_from;
+  return (*ep == '\0' && id_from <= id_to);
+  }
+
+static bool can_bridge_parse_mask(const char* arg, uint8_t* mask)
+  {
+  size_t len = strlen(arg);
+  if (len == 0 || len > 16 || (len & 1)) return false;
+  for (size_t k = 0; k < len; k += 2)
+    {
+    char hex[3] = { arg[k], arg[k+1], 0 };
+    char* ep;
+    mask[k/2] = strtoul(hex, &ep, 16);
+    if (*ep != '\0') return false;
+    }
+  return true;
+  }
+
+static canbus* can_bridge_bus(OvmsWriter* writer, const char* name)
+  {
+  canbus* bus = (canbus*)MyPcpApp.FindDeviceByName(name);
+  if (bus == NULL)
+    writer->printf("Error: Cannot find CAN bus \"%s\"\n", name);
+  return bus;
+  }
+
+void can_bridge_add(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  canbridge::rule_t rule;
+  memset(&rule, 0, sizeof(rule));
+  rule.deny = (strcmp(cmd->GetName(), "deny") == 0);
+  rule.id_from = 0;
+  rule.id_to = UINT32_MAX;
+  memset(rule.and_mask, 0xff, sizeof(rule.and_mask));
+
+  int arg = 0;
+  if ((rule.from = can_bridge_bus(writer, argv[arg++])) == NULL) return;
+  if (!rule.deny)
+    {
+    if ((rule.to = can_bridge_bus(writer, argv[arg++])) == NULL) return;
+    if (rule.to == rule.from)
+      {
+      writer->puts("Error: Source and destination bus must differ");
+      return;
+      }
+    }
+
+  for (; arg < argc; arg++)
+    {
+    const char* a = argv[arg];
+    if (!rule.deny && strncmp(a, "remap=", 6) == 0)
+      {
+      char* ep;
+      rule.remap = true;
+      rule.remap_id = strtoul(a+6, &ep, 16);
+      if (*ep != '\0' || rule.remap_id > 0x1fffffff)
+        {
+        writer->printf("Error: Invalid remap ID \"%s\"\n", a+6);
+        return;
+        }
+      }
+    else if (!rule.deny && strncmp(a, "and=", 4) == 0)
+      {
+      rule.mask = true;
+      if (!can_bridge_parse_mask(a+4, rule.and_mask))
+        {
+        writer->printf("Error: Invalid mask \"%s\" (1-8 hex bytes)\n", a+4);
+        return;
+        }
+      }
+    else if (!rule.deny && strncmp(a, "or=", 3) == 0)
+      {
+      rule.mask = true;
+      if (!can_bridge_parse_mask(a+3, rule.or_mask))
+        {
+        writer->printf("Error: Invalid mask \"%s\" (1-8 hex bytes)\n", a+3);
+        return;
+        }
+      }
+    else if (!can_bridge_parse_ids(a, rule.id_from, rule.id_to))
+      {
+      writer->printf("Error: Invalid argument \"%s\"\n", a);
+      return;
+      }
+    }
+
+  int nr = MyCanBridge.AddRule(rule);
+  if (nr == -2)
+    {
+    writer->puts("Error: Remapped ID range exceeds 1fffffff, limit the ID range of the rule");
+    return;
+    }
+  else if (nr < 0)
+    {
+    writer->printf("Error: Rule table full (max %d rules)\n", CANBRIDGE_MAXRULES);
+    return;
+    }
+  writer->printf("Rule #%d: %s\n", nr+1, MyCanBridge.GetRule(nr).c_str());
+  if (!MyCanBridge.IsRunning())
+    writer->puts("Note: bridge is stopped, use 'can bridge start' to forward frames");
+  }
+
+void can_bridge_remove(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (MyCanBridge.RemoveRule(atoi(argv[0])-1))
+    writer->puts("Rule removed");
+  else
+    writer->puts("Error: Cannot find specified rule");
+  }
+
+void can_bridge_clear(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  MyCanBridge.ClearRules();
+  writer->puts("All rules removed");
+  }
+
+void can_bridge_start(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  MyCanBridge.Start();
+  writer->printf("CAN bridge started (%d rules)\n", MyCanBridge.GetRuleCount());
+  }
+
+void can_bridge_stop(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  MyCanBridge.Stop();
+  writer->puts("CAN bridge stopped");
+  }
+
+void can_bridge_reset(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  MyCanBridge.ResetStats();
+  writer->puts("CAN bridge statistics reset");
+  }
+
+void can_bridge_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  uint32_t frames = MyCanBridge.m_framecount;
+  writer->printf("CAN bridge %s, %d rules, %" PRIu32 " frames checked",
+    MyCanBridge.IsRunning() ? "running" : "stopped", MyCanBridge.GetRuleCount(), frames);
+  if (frames > 0)
+    writer->printf(", callback avg %.1f max %" PRIu32 " us",
+      (float)MyCanBridge.m_cbtime_sum / frames, MyCanBridge.m_cbtime_max);
+  writer->puts("");
+  for (int k = 0; k < MyCanBridge.GetRuleCount(); k++)
+    {
+    writer->printf("#%d: %s\n    %s\n", k+1, MyCanBridge.GetRule(k).c_str(), MyCanBridge.GetStats(k).c_str());
+    }
+  }
+
+////////////////////////////////////////////////////////////////////////
+// CAN bridge class
+////////////////////////////////////////////////////////////////////////
+
+canbridge::canbridge()
+  {
+  ESP_LOGI(TAG, "Initialising CAN bridge (4580)");
+
+  m_lock = portMUX_INITIALIZER_UNLOCKED;
+  m_rulecount = 0;
+  m_generation = 0;
+  m_running = false;
+  memset(m_indexcount, 0, sizeof(m_indexcount));
+  ResetStats();
+
+  OvmsCommand* cmd_can = MyCommandApp.FindCommand("can");
+  if (cmd_can == NULL)
+    {
+    ESP_LOGE(TAG,"Cannot find CAN command - aborting bridge command registration");
+    return;
+    }
+
+  OvmsCommand* cmd_bridge = cmd_can->RegisterCommand("bridge", "CAN bus bridge");
+  cmd_bridge->RegisterCommand("allow", "Add forwarding rule", can_bridge_add,
+    "<from> <to> [<id>[-<id>]] [remap=<id>] [and=<hex>] [or=<hex>]\n"
+    "<from>, <to>: bus names, i.e. can1 can3\n"
+    "remap=<id>: new ID for the first ID of the range (offset is kept)\n"
+    "and=<hex>, or=<hex>: payload byte masks, data = (data & and) | or\n"
+    "Example: can bridge allow can1 can3 100-1ff remap=500 and=ff00",
+    2, 6);
+  cmd_bridge->RegisterCommand("deny", "Add blocking rule", can_bridge_add,
+    "<from> [<id>[-<id>]]", 1, 2);
+  cmd_bridge->RegisterCommand("remove", "Remove rule", can_bridge_remove, "<nr>", 1, 1);
+  cmd_bridge->RegisterCommand("clear", "Remove all rules", can_bridge_clear);
+  cmd_bridge->RegisterCommand("start", "Start forwarding", can_bridge_start);
+  cmd_bridge->RegisterCommand("stop", "Stop forwarding", can_bridge_stop);
+  cmd_bridge->RegisterCommand("status", "Show rules and statistics", can_bridge_status);
+  cmd_bridge->RegisterCommand("reset", "Reset statistics", can_bridge_reset);
+  }
+
+canbridge::~canbridge()
+  {
+  Stop();
+  }
+
+void canbridge::Start()
+  {
+  if (m_running) return;
+  m_running = true;
+  using std::placeholders::_1;
+  using std::placeholders::_2;
+  MyCan.RegisterCallbackFront(TAG, std::bind(&canbridge::IncomingFrame, this, _1, _2));
+  }
+
+void canbridge::Stop()
+  {
+  if (!m_running) return;
+  MyCan.DeregisterCallback(TAG);
+  m_running = false;
+  }
+
+int canbridge::AddRule(const rule_t& rule)
+  {
+  if (rule.remap)
+    {
+    // The remapped range must fit into the 29 bit ID space (frames carry no higher IDs):
+    uint32_t id_to = MIN(rule.id_to, 0x1fffffff);
+    if (rule.id_from > id_to || rule.remap_id > 0x1fffffff - (id_to - rule.id_from))
+      return -2;
+    }
+  portENTER_CRITICAL(&m_lock);
+  int index = -1;
+  if (m_rulecount < CANBRIDGE_MAXRULES)
+    {
+    index = m_rulecount++;
+    m_rules[index] = rule;
+    Compile();
+    }
+  portEXIT_CRITICAL(&m_lock);
+  return index;
+  }
+
+bool canbridge::RemoveRule(int index)
+  {
+  bool found = false;
+  portENTER_CRITICAL(&m_lock);
+  if (index >= 0 && index < m_rulecount)
+    {
+    for (int k = index; k < m_rulecount-1; k++)
+      m_rules[k] = m_rules[k+1];
+    m_rulecount--;
+    Compile();
+    found = true;
+    }
+  portEXIT_CRITICAL(&m_lock);
+  return found;
+  }
+
+void canbridge::ClearRules()
+  {
+  portENTER_CRITICAL(&m_lock);
+  m_rulecount = 0;
+  Compile();
+  portEXIT_CRITICAL(&m_lock);
+  }
+
+void canbridge::ResetStats()
+  {
+  portENTER_CRITICAL(&m_lock);
+  for (int k = 0; k < m_rulecount; k++)
+    {
+    rule_t& r = m_rules[k];
+    r.matched = r.forwarded = r.queued = r.failed = r.lat_max = 0;
+    r.lat_sum = 0;
+    }
+  m_framecount = 0;
+  m_cbtime_max = 0;
+  m_cbtime_sum = 0;
+  portEXIT_CRITICAL(&m_lock);
+  }
+
+/**
+ * Compile: rebuild the per source bus rule index tables (lock held)
+ */
+void canbridge::Compile()
+  {
+  m_generation++;
+  memset(m_indexcount, 0, sizeof(m_indexcount));
+  for (int k = 0; k < m_rulecount; k++)
+    {
+    int bus = m_rules[k].from->m_busnumber;
+    if (bus >= 0 && bus < CAN_MAXBUSES)
+      m_index[bus][m_indexcount[bus]++] = k;
+    }
+  }
+
+/**
+ * IncomingFrame: CAN task RX callback
+ */
+void canbridge::IncomingFrame(const CAN_frame_t* frame, bool success)
+  {
+  int bus = frame->origin->m_busnumber;
+  if (bus < 0 || bus >= CAN_MAXBUSES || m_indexcount[bus] == 0)
+    return;
+
+  int64_t start = esp_timer_get_time();
+  CAN_frame_t out[CAN_MAXBUSES];
+  uint8_t outrule[CAN_MAXBUSES];
+  int outcount = 0;
+  uint32_t dstmask = 0;
+
+  // Scan the rules and prepare the frames to forward:
+  portENTER_CRITICAL(&m_lock);
+  for (int k = 0; k < m_indexcount[bus]; k++)
+    {
+    uint8_t nr = m_index[bus][k];
+    rule_t& r = m_rules[nr];
+    if (frame->MsgID < r.id_from || frame->MsgID > r.id_to)
+      continue;
+    r.matched++;
+    if (r.deny)
+      break;
+    uint32_t dst = 1 << r.to->m_busnumber;
+    if (dstmask & dst)
+      continue;
+    dstmask |= dst;
+
+    CAN_frame_t& f = out[outcount];
+    f = *frame;
+    f.origin = r.to;
+    f.callback = NULL;
+    if (r.remap)
+      {
+      f.MsgID = r.remap_id + (frame->MsgID - r.id_from);
+      if (f.MsgID > 0x7ff) f.FIR.B.FF = CAN_frame_ext;
+      }
+    if (r.mask)
+      {
+      for (int i = 0; i < 8; i++)
+        f.data.u8[i] = (f.data.u8[i] & r.and_mask[i]) | r.or_mask[i];
+      }
+    outrule[outcount++] = nr;
+    }
+  uint32_t generation = m_generation;
+  portEXIT_CRITICAL(&m_lock);
+
+  // Forward (never waiting for TX queue space):
+  esp_err_t res[CAN_MAXBUSES];
+  uint32_t lat[CAN_MAXBUSES];
+  for (int k = 0; k < outcount; k++)
+    {
+    res[k] = out[k].origin->Write(&out[k], 0);
+    lat[k] = esp_timer_get_time() - start;
+    }
+
+  uint32_t cbtime = esp_timer_get_time() - start;
+  portENTER_CRITICAL(&m_lock);
+  m_framecount++;
+  m_cbtime_sum += cbtime;
+  if (cbtime > m_cbtime_max) m_cbtime_max = cbtime;
+  if (generation == m_generation)
+    {
+    for (int k = 0; k < outcount; k++)
+      {
+      rule_t& r = m_rules[outrule[k]];
+      if (res[k] == ESP_FAIL)
+        r.failed++;
+      else
+        {
+        if (res[k] == ESP_QUEUED) r.queued++;
+        r.forwarded++;
+        r.lat_sum += lat[k];
+        if (lat[k] > r.lat_max) r.lat_max = lat[k];
+        }
+      }
+    }
+  portEXIT_CRITICAL(&m_lock);
+  }
+
+std::string canbridge::GetRule(int index)
+  {
+  if (index < 0 || index >= m_rulecount) return std::string("");
+  rule_t r = m_rules[index];
+  std::ostringstream buf;
+
+  buf << (r.deny ? "deny " : "allow ") << r.from->GetName();
+  if (!r.deny)
+    buf << " -> " << r.to->GetName();
+  buf << std::hex << std::uppercase;
+  if (r.id_from == 0 && r.id_to == UINT32_MAX)
+    buf << " all";
+  else if (r.id_from == r.id_to)
+    buf << " " << r.id_from;
+  else
+    buf << " " << r.id_from << "-" << r.id_to;
+  if (r.remap)
+    buf << " remap=" << r.remap_id;
+  if (r.mask)
+    {
+    buf << std::setfill('0');
+    buf << " and=";
+    for (int i = 0; i < 8; i++) buf << std::setw(2) << (int)r.and_mask[i];
+    buf << " or=";
+    for (int i = 0; i < 8; i++) buf << std::setw(2) << (int)r.or_mask[i];
+    }
+
+  return buf.str();
+  }
+
+std::string canbridge::GetStats(int index)
+  {
+  if (index < 0 || index >= m_rulecount) return std::string("");
+  portENTER_CRITICAL(&m_lock);
+  rule_t r = m_rules[index];
+  portEXIT_CRITICAL(&m_lock);
+  std::ostringstream buf;
+
+  buf << "Matched:" << r.matched;
+  if (!r.deny)
+    {
+    buf << " Forwarded:" << r.forwarded
+      << " Queued:" << r.queued
+      << " Failed:" << r.failed;
+    if (r.forwarded > 0)
+      buf << " Latency:" << std::fixed << std::setprecision(1)
+        << ((float) r.lat_sum / r.forwarded) << "/" << r.lat_max << "us";
+    }
+
+  return buf.str();
+  }
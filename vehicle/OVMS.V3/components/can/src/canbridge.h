@@ -0,0 +1,115 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Module:        CAN bus bridge
+;    Date:          18th October 2026
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011        Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+#ifndef __CANBRIDGE_H__
+#define __CANBRIDGE_H__
+
+#include "can.h"
+
+#define CANBRIDGE_MAXRULES    32
+
+/**
+ * canbridge: forwards received frames between the module's CAN buses.
+ *
+ * Forwarding is done synchronously in the CAN task, from a callback at the
+ * front of the RX callback list, so the added latency is bounded by the
+ * rule scan and the driver Write() (which never waits for queue space).
+ *
+ * Rules are matched in order. A matching deny rule ends the scan, each
+ * matching allow rule forwards one copy to its destination bus (first rule
+ * per destination wins). Frames without a matching rule are not forwarded.
+ * An allow rule may remap the ID (preserving the offset within its range)
+ * and modify the payload by byte masks: data = (data & and) | or.
+ *
+ * The rule set is compiled into fixed per source bus index tables, edits
+ * swap them under a spinlock, so the callback path needs no heap access.
+ */
+class canbridge : public InternalRamAllocated
+  {
+  public:
+    typedef struct
+      {
+      canbus*   from;
+      canbus*   to;                     // NULL for deny rules
+      uint32_t  id_from;
+      uint32_t  id_to;
+      bool      deny;
+      bool      remap;
+      uint32_t  remap_id;               // new ID for id_from
+      bool      mask;
+      uint8_t   and_mask[8];
+      uint8_t   or_mask[8];
+      // Statistics:
+      uint32_t  matched;
+      uint32_t  forwarded;
+      uint32_t  queued;                 // Write() returned ESP_QUEUED
+      uint32_t  failed;                 // Write() returned ESP_FAIL
+      uint32_t  lat_max;                // callback entry to Write() return [us]
+      uint64_t  lat_sum;
+      } rule_t;
+
+  public:
+    canbridge();
+    ~canbridge();
+
+  public:
+    int AddRule(const rule_t& rule);  // -1 = table full, -2 = remapped IDs exceed 29 bits
+    bool RemoveRule(int index);
+    void ClearRules();
+    void ResetStats();
+    int GetRuleCount()                { return m_rulecount; }
+    std::string GetRule(int index);
+    std::string GetStats(int index);
+
+  public:
+    void Start();
+    void Stop();
+    bool IsRunning()                  { return m_running; }
+
+  protected:
+    void Compile();
+    void IncomingFrame(const CAN_frame_t* frame, bool success);
+
+  protected:
+    portMUX_TYPE  m_lock;
+    rule_t        m_rules[CANBRIDGE_MAXRULES];
+    int           m_rulecount;
+    uint8_t       m_index[CAN_MAXBUSES][CANBRIDGE_MAXRULES];
+    uint8_t       m_indexcount[CAN_MAXBUSES];
+    uint32_t      m_generation;         // rule table version (stats update check)
+    bool          m_running;
+
+  public:
+    uint32_t      m_framecount;         // frames seen on bridged buses
+    uint32_t      m_cbtime_max;         // callback runtime [us]
+    uint64_t      m_cbtime_sum;
+  };
+
+extern canbridge MyCanBridge;
+
+#endif //#ifndef __CANBRIDGE_H__
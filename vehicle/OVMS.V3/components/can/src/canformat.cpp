@@ -27,6 +27,7 @@
 #include "ovms_log.h"
 static const char *TAG = "canformat";
 
+#include <sys/param.h>
 #include "canformat.h"
 
 canformat::canformat_serve_mode_t GetFormatModeType(std::string name)
@@ -100,11 +101,175 @@ std::string canformat::getheader(struct timeval *time)
   return std::string("");
   }
 
+bool canformat::IsBuffered()
+  {
+  return false;
+  }
+
+std::string canformat::flush(bool force, uint32_t* records, struct timeval* first)
+  {
+  if (records) *records = 0;
+  return std::string("");
+  }
+
 size_t canformat::put(CAN_log_message_t* message, uint8_t *buffer, size_t len, bool* hasmore, canlogconnection* clc)
   {
   return 0;
   }
 
+/**
+ * GetMaxLength: maximum length of a message encoded by encode()
+ *  0 = batch conversion not supported by the format, use get() & put()
+ */
+size_t canformat::GetMaxLength()
+  {
+  return 0;
+  }
+
+/**
+ * encode: convert a message into the buffer (of at least GetMaxLength() bytes)
+ *  Returns the length written, 0 if the message is not represented in the format.
+ */
+size_t canformat::encode(CAN_log_message_t* message, uint8_t* buffer, size_t size)
+  {
+  return 0;
+  }
+
+/**
+ * decode: convert the first record in the buffer into a message
+ *  Returns the length consumed, 0 if the record is incomplete. Records not
+ *  resulting in a message (headers, commands, invalid data) are consumed
+ *  leaving message->type at CAN_LogNone.
+ */
+size_t canformat::decode(CAN_log_message_t* message, const uint8_t* buffer, size_t len, canlogconnection* clc)
+  {
+  return 0;
+  }
+
+/**
+ * getbatch: convert up to count messages into the buffer
+ *  Stops when the remaining space is below GetMaxLength().
+ *  Returns the number of messages converted, *length is set to the output length.
+ */
+size_t canformat::getbatch(CAN_log_message_t* messages, size_t count, uint8_t* buffer, size_t size, size_t* length)
+  {
+  size_t maxlen = GetMaxLength();
+  size_t done = 0;
+  *length = 0;
+  if (maxlen == 0) return 0;
+
+  for (; done < count && size - *length >= maxlen; done++)
+    {
+    *length += encode(&messages[done], buffer + *length, size - *length);
+    }
+  return done;
+  }
+
+/**
+ * putbatch: convert up to count messages from the buffer
+ *  Records are parsed directly from the buffer, an incomplete record at the
+ *  end is staged and completed by the next call. Formats without batch
+ *  support fall back to put().
+ *  Returns the length consumed, *parsed is set to the number of messages.
+ */
+size_t canformat::putbatch(CAN_log_message_t* messages, size_t count, uint8_t* buffer, size_t len, size_t* parsed, canlogconnection* clc)
+  {
+  size_t consumed = 0;
+  *parsed = 0;
+
+  if (GetMaxLength() == 0)
+    {
+    while (*parsed < count)
+      {
+      CAN_log_message_t* message = &messages[*parsed];
+      memset(message, 0, sizeof(*message));
+      bool hasmore = false;
+      size_t used = put(message, buffer + consumed, len - consumed, &hasmore, clc);
+      consumed += used;
+      if (message->type != CAN_LogNone)
+        (*parsed)++;
+      else if (!hasmore && (used == 0 || consumed >= len))
+        break;
+      }
+    return consumed;
+    }
+
+  if (IsServeDiscarding()) return len;  // Quick return if discarding
+
+  uint8_t rec[CANFORMAT_BATCH_RECMAX];
+  while (*parsed < count)
+    {
+    CAN_log_message_t* message = &messages[*parsed];
+    memset(message, 0, sizeof(*message));
+    size_t used;
+
+    if (m_buf.UsedSpace() > 0)
+      {
+      // Complete the record staged by the previous call:
+      size_t staged = m_buf.Peek(MIN(m_buf.UsedSpace(), sizeof(rec)), rec);
+      size_t add = MIN(len - consumed, sizeof(rec) - staged);
+      memcpy(rec + staged, buffer + consumed, add);
+      used = decode(message, rec, staged + add, clc);
+      if (used == 0)
+        {
+        if (staged + add < sizeof(rec))
+          {
+          // Still incomplete, wait for more data:
+          consumed += Stuff(buffer + consumed, add);
+          break;
+          }
+        used = staged + add; // Discard oversized record
+        }
+      if (used >= staged)
+        {
+        m_buf.EmptyAll();
+        consumed += used - staged;
+        }
+      else
+        {
+        m_buf.Pop(used, rec);
+        }
+      }
+    else
+      {
+      if (consumed >= len) break;
+      used = decode(message, buffer + consumed, len - consumed, clc);
+      if (used == 0)
+        {
+        // Incomplete record at the end, stage it for the next call:
+        if (len - consumed < sizeof(rec))
+          Stuff(buffer + consumed, len - consumed);
+        consumed = len;
+        break;
+        }
+      consumed += used;
+      }
+
+    if (message->type != CAN_LogNone)
+      (*parsed)++;
+    }
+
+  return consumed;
+  }
+
+/**
+ * GetLine: copy the first line of the buffer into line (NUL terminated, truncated to size)
+ *  Returns the length consumed including the line end, 0 if there is no complete line.
+ */
+size_t canformat::GetLine(char* line, size_t size, const uint8_t* buffer, size_t len)
+  {
+  size_t eol;
+  for (eol = 0; eol < len && buffer[eol] != '\r' && buffer[eol] != '\n'; eol++) {}
+  if (eol == len) return 0;
+
+  size_t linelen = MIN(eol, size-1);
+  memcpy(line, buffer, linelen);
+  line[linelen] = 0;
+
+  if (buffer[eol] == '\r' && eol+1 < len && buffer[eol+1] == '\n') eol++;
+  return eol+1;
+  }
+
 size_t canformat::Serve(uint8_t *buffer, size_t len, canlogconnection* clc)
   {
   if ((m_servediscarding)||(m_servemode == Discard))
@@ -132,7 +297,7 @@ size_t canformat::Serve(uint8_t *buffer, size_t len, canlogconnection* clc)
       len = 0;
       }
 
-    if (msg.frame.origin != NULL)
+    if ((msg.frame.origin != NULL) && (msg.type < CAN_LogStatus_Error))
       {
       switch (m_servemode)
         {
@@ -140,7 +305,7 @@ size_t canformat::Serve(uint8_t *buffer, size_t len, canlogconnection* clc)
           MyCan.IncomingFrame(&msg.frame);
           break;
         case Transmit:
-          msg.frame.origin->Write(&msg.frame, pdMS_TO_TICKS(500));
+          msg.frame.origin->WritePriority(&msg.frame, CAN_TXPRIO_BULK, pdMS_TO_TICKS(500));
           break;
         default:
           break;
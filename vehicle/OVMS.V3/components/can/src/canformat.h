@@ -38,6 +38,7 @@
 using namespace std;
 
 #define CANFORMAT_SERVE_BUFFERSIZE 1024
+#define CANFORMAT_BATCH_RECMAX 256        // max input record size for batch parsing
 
 class canlogconnection;
 
@@ -57,9 +58,25 @@ class canformat
     virtual std::string get(CAN_log_message_t* message);
     virtual std::string getheader(struct timeval *time = NULL);
 
+  public: // Block formats buffering converted messages
+    virtual bool IsBuffered();
+    virtual std::string flush(bool force=false, uint32_t* records=NULL, struct timeval* first=NULL);
+
   public: // Conversion from specific format to OVMS CAN log messages
     virtual size_t put(CAN_log_message_t* message, uint8_t *buffer, size_t len, bool* hasmore, canlogconnection* clc=NULL);
 
+  public: // Batch conversion without intermediate allocations
+    // Formats supporting batch conversion return the maximum length of a
+    // single encoded message, and implement encode() & decode():
+    virtual size_t GetMaxLength();
+    virtual size_t encode(CAN_log_message_t* message, uint8_t* buffer, size_t size);
+    virtual size_t decode(CAN_log_message_t* message, const uint8_t* buffer, size_t len, canlogconnection* clc=NULL);
+    size_t getbatch(CAN_log_message_t* messages, size_t count, uint8_t* buffer, size_t size, size_t* length);
+    size_t putbatch(CAN_log_message_t* messages, size_t count, uint8_t* buffer, size_t len, size_t* parsed, canlogconnection* clc=NULL);
+
+  protected:
+    size_t GetLine(char* line, size_t size, const uint8_t* buffer, size_t len);
+
   private:
     const char* m_type;
 
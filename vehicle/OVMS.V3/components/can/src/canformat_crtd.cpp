@@ -57,6 +57,19 @@ canformat_crtd::~canformat_crtd()
 std::string canformat_crtd::get(CAN_log_message_t* message)
   {
   char buf[CANFORMAT_CRTD_MAXLEN];
+  size_t len = encode(message, (uint8_t*)buf, sizeof(buf));
+  return std::string(buf, len);
+  }
+
+size_t canformat_crtd::GetMaxLength()
+  {
+  return CANFORMAT_CRTD_MAXLEN;
+  }
+
+size_t canformat_crtd::encode(CAN_log_message_t* message, uint8_t* buffer, size_t size)
+  {
+  char *buf = (char*)buffer;
+  size_t bufsize = size - 1; // reserve space for the line end
   char *p;
 
   char busnumber;
@@ -69,7 +82,7 @@ std::string canformat_crtd::get(CAN_log_message_t* message)
     {
     case CAN_LogFrame_RX:
     case CAN_LogFrame_TX:
-      snprintf(buf,sizeof(buf),"%l" PRId32 ".%06ld %c%c%s %0*" PRIX32,
+      snprintf(buf,bufsize,"%l" PRId32 ".%06ld %c%c%s %0*" PRIX32,
         message->timestamp.tv_sec, message->timestamp.tv_usec,
         busnumber,
         (message->type == CAN_LogFrame_RX) ? 'R' : 'T',
@@ -87,7 +100,7 @@ std::string canformat_crtd::get(CAN_log_message_t* message)
 
     case CAN_LogFrame_TX_Queue:
     case CAN_LogFrame_TX_Fail:
-      snprintf(buf,sizeof(buf),"%l" PRId32 ".%06ld %cCER %s %c%s %0*" PRIX32,
+      snprintf(buf,bufsize,"%l" PRId32 ".%06ld %cCER %s %c%s %0*" PRIX32,
         message->timestamp.tv_sec, message->timestamp.tv_usec,
         busnumber,
         GetCanLogTypeName(message->type),
@@ -106,7 +119,7 @@ std::string canformat_crtd::get(CAN_log_message_t* message)
 
     case CAN_LogStatus_Error:
     case CAN_LogStatus_Statistics:
-      snprintf(buf,sizeof(buf),
+      snprintf(buf,bufsize,
         "%l" PRId32 ".%06ld %c%s %s intr=%" PRId32 " rxpkt=%" PRId32 " txpkt=%" PRId32 " errflags=%#" PRIx32 " rxerr=%d txerr=%d"
         " rxinval=%d rxovr=%d txovr=%d txdelay=%" PRId32 " txfail=%" PRId32 " wdgreset=%d errreset=%d txqueue=%" PRId32,
         message->timestamp.tv_sec, message->timestamp.tv_usec,
@@ -117,14 +130,14 @@ std::string canformat_crtd::get(CAN_log_message_t* message)
         message->status.errors_rx, message->status.errors_tx, message->status.invalid_rx,
         message->status.rxbuf_overflow, message->status.txbuf_overflow,
         message->status.txbuf_delay, message->status.tx_fails, message->status.watchdog_resets,
-        message->status.error_resets, uxQueueMessagesWaiting(message->origin->m_txqueue));
+        message->status.error_resets, message->origin->TxQueueCount());
       break;
 
     case CAN_LogInfo_Comment:
     case CAN_LogInfo_Config:
     case CAN_LogInfo_Event:
     case CAN_LogInfo_Metric:
-      snprintf(buf,sizeof(buf),"%l" PRId32 ".%06ld %c%s %s %s",
+      snprintf(buf,bufsize,"%l" PRId32 ".%06ld %c%s %s %s",
         message->timestamp.tv_sec, message->timestamp.tv_usec,
         busnumber,
         (message->type == CAN_LogInfo_Event) ? "CEV" : (message->type == CAN_LogInfo_Metric) ? "CMT" : "CXX",
@@ -133,12 +146,12 @@ std::string canformat_crtd::get(CAN_log_message_t* message)
       break;
 
     default:
-      buf[0] = 0;
-      break;
+      return 0;
     }
 
-  strcat(buf,"\n");
-  return std::string(buf);
+  size_t len = strlen(buf);
+  buf[len++] = '\n';
+  return len;
   }
 
 std::string canformat_crtd::getheader(struct timeval *time)
@@ -173,116 +186,162 @@ size_t canformat_crtd::put(CAN_log_message_t* message, uint8_t *buffer, size_t l
     {
     *hasmore = true;  // Call us again to see if we have more frames to process
     std::string line = m_buf.ReadLine();
-    const char *b = line.c_str();
+    ParseLine(message, line.c_str(), clc);
+    return consumed;
+    }
+  }
 
-    // We look for something like
-    // 1524311386.811100 1R11 100 01 02 03
-    if (!isdigit(b[0])) return consumed;    // Discard invalid line
-    for (;((*b != 0)&&(*b != ' '));b++) {}
-    if (*b == 0) return consumed;           // Discard invalid line
-    b++;
-    char bus = '1';
-    if (isdigit(*b))
-      {
-      bus = *b;
-      b++;
-      }
+size_t canformat_crtd::decode(CAN_log_message_t* message, const uint8_t* buffer, size_t len, canlogconnection* clc)
+  {
+  char line[CANFORMAT_CRTD_MAXLEN];
+  size_t used = GetLine(line, sizeof(line), buffer, len);
+  if (used > 0 && !ParseLine(message, line, clc))
+    memset(message, 0, sizeof(*message));
+  return used;
+  }
 
-    if ((b[0]=='R')&&(b[1]=='1')&&(b[2]=='1'))
-      {
-      // R11 incoming CAN frame
-      message->type = CAN_LogFrame_RX;
-      message->frame.FIR.B.FF = CAN_frame_std;
-      }
-    else if ((b[0]=='R')&&(b[1]=='2')&&(b[2]=='9'))
-      {
-      // R29 incoming CAN frame
-      message->type = CAN_LogFrame_RX;
-      message->frame.FIR.B.FF = CAN_frame_ext;
-      }
-    else if ((b[0]=='T')&&(b[1]=='1')&&(b[2]=='1'))
-      {
-      // T11 outgoing CAN frame
-      message->type = CAN_LogFrame_TX;
-      message->frame.FIR.B.FF = CAN_frame_std;
-      }
-    else if ((b[0]=='T')&&(b[1]=='2')&&(b[2]=='9'))
-      {
-      // T29 outgoingCAN frame
-      message->type = CAN_LogFrame_TX;
-      message->frame.FIR.B.FF = CAN_frame_ext;
-      }
-    else if ((b[0]=='C')&&(b[1]=='B')&&(b[2]=='C'))
-      {
-      // A command to configure a CAN bus
-      CAN_mode_t mode = (b[4]=='A')?CAN_MODE_ACTIVE:CAN_MODE_LISTEN;
-      CAN_speed_t speed;
-      switch (atoi(b+6))
-        {
-        case 33333:   speed = CAN_SPEED_33KBPS; break;
-        case 50000:   speed = CAN_SPEED_50KBPS; break;
-        case 83333:   speed = CAN_SPEED_83KBPS; break;
-        case 100000:  speed = CAN_SPEED_100KBPS; break;
-        case 125000:  speed = CAN_SPEED_125KBPS; break;
-        case 250000:  speed = CAN_SPEED_250KBPS; break;
-        case 500000:  speed = CAN_SPEED_500KBPS; break;
-        case 1000000: speed = CAN_SPEED_1000KBPS; break;
-        default:
-          return consumed;
-        }
-      if (clc) clc->ControlBusConfigure(MyCan.GetBus(bus - '1'), mode, speed);
-      return consumed;
-      }
-    else if ((b[0]=='C')&&(b[1]=='D')&&(b[2]=='P'))
-      {
-      // A command to pause the transmission of messages
-      if (clc) clc->PauseTransmission();
-      return consumed;
-      }
-    else if ((b[0]=='C')&&(b[1]=='D')&&(b[2]=='R'))
-      {
-      // A command to resume the transmission of messages
-      if (clc) clc->ResumeTransmission();
-      return consumed;
-      }
-    else if ((b[0]=='C')&&(b[1]=='F')&&(b[2]=='C'))
+bool canformat_crtd::ParseLine(CAN_log_message_t* message, const char* b, canlogconnection* clc)
+  {
+  // We look for something like
+  // 1524311386.811100 1R11 100 01 02 03
+  if (!isdigit(b[0])) return false;    // Discard invalid line
+  char *t;
+  message->timestamp.tv_sec = strtol(b,&t,10);
+  if (*t == '.')
+    {
+    // Scale fraction to microseconds:
+    long usec = 0;
+    int digits = 0;
+    for (t++; isdigit(*t); t++)
       {
-      // A command to clear all filters for this connection
-      if (clc) clc->ClearFilters();
-      return consumed;
+      if (digits++ < 6) usec = usec*10 + (*t - '0');
       }
-    else if ((b[0]=='C')&&(b[1]=='F')&&(b[2]=='A'))
+    for (; digits < 6; digits++) usec *= 10;
+    message->timestamp.tv_usec = usec;
+    }
+  for (;((*b != 0)&&(*b != ' '));b++) {}
+  if (*b == 0) return false;           // Discard invalid line
+  b++;
+  char bus = '1';
+  if (isdigit(*b))
+    {
+    bus = *b;
+    b++;
+    }
+
+  if ((b[0]=='R')&&(b[1]=='1')&&(b[2]=='1'))
+    {
+    // R11 incoming CAN frame
+    message->type = CAN_LogFrame_RX;
+    message->frame.FIR.B.FF = CAN_frame_std;
+    }
+  else if ((b[0]=='R')&&(b[1]=='2')&&(b[2]=='9'))
+    {
+    // R29 incoming CAN frame
+    message->type = CAN_LogFrame_RX;
+    message->frame.FIR.B.FF = CAN_frame_ext;
+    }
+  else if ((b[0]=='T')&&(b[1]=='1')&&(b[2]=='1'))
+    {
+    // T11 outgoing CAN frame
+    message->type = CAN_LogFrame_TX;
+    message->frame.FIR.B.FF = CAN_frame_std;
+    }
+  else if ((b[0]=='T')&&(b[1]=='2')&&(b[2]=='9'))
+    {
+    // T29 outgoingCAN frame
+    message->type = CAN_LogFrame_TX;
+    message->frame.FIR.B.FF = CAN_frame_ext;
+    }
+  else if ((b[0]=='C')&&(b[1]=='B')&&(b[2]=='C'))
+    {
+    // A command to configure a CAN bus
+    CAN_mode_t mode = (b[4]=='A')?CAN_MODE_ACTIVE:CAN_MODE_LISTEN;
+    CAN_speed_t speed;
+    switch (atoi(b+6))
       {
-      // A command to add a filter for this connection
-      std::string filter(b+4);
-      if (clc) clc->AddFilter(filter);
-      return consumed;
+      case 33333:   speed = CAN_SPEED_33KBPS; break;
+      case 50000:   speed = CAN_SPEED_50KBPS; break;
+      case 83333:   speed = CAN_SPEED_83KBPS; break;
+      case 100000:  speed = CAN_SPEED_100KBPS; break;
+      case 125000:  speed = CAN_SPEED_125KBPS; break;
+      case 250000:  speed = CAN_SPEED_250KBPS; break;
+      case 500000:  speed = CAN_SPEED_500KBPS; break;
+      case 1000000: speed = CAN_SPEED_1000KBPS; break;
+      default:
+        return false;
       }
+    if (clc) clc->ControlBusConfigure(MyCan.GetBus(bus - '1'), mode, speed);
+    return false;
+    }
+  else if ((b[0]=='C')&&(b[1]=='D')&&(b[2]=='P'))
+    {
+    // A command to pause the transmission of messages
+    if (clc) clc->PauseTransmission();
+    return false;
+    }
+  else if ((b[0]=='C')&&(b[1]=='D')&&(b[2]=='R'))
+    {
+    // A command to resume the transmission of messages
+    if (clc) clc->ResumeTransmission();
+    return false;
+    }
+  else if ((b[0]=='C')&&(b[1]=='F')&&(b[2]=='C'))
+    {
+    // A command to clear all filters for this connection
+    if (clc) clc->ClearFilters();
+    return false;
+    }
+  else if ((b[0]=='C')&&(b[1]=='F')&&(b[2]=='A'))
+    {
+    // A command to add a filter for this connection
+    std::string filter(b+4);
+    if (clc) clc->AddFilter(filter);
+    return false;
+    }
+  else if (((b[0]=='C')&&(b[1]=='X')&&(b[2]=='X')) ||
+           ((b[0]=='C')&&(b[1]=='E')&&(b[2]=='V')) ||
+           ((b[0]=='C')&&(b[1]=='M')&&(b[2]=='T')))
+    {
+    // Info message: <type> <typename> <text> (i.e. "CXX Comment dedup 100 5")
+    if (b[3] != ' ') return false; // Discard invalid line
+    if (b[1]=='E')
+      message->type = CAN_LogInfo_Event;
+    else if (b[1]=='M')
+      message->type = CAN_LogInfo_Metric;
+    else if (strncmp(b+4, "Info ", 5) == 0)
+      message->type = CAN_LogInfo_Config;
     else
-      return consumed;  // Discard invalid line
+      message->type = CAN_LogInfo_Comment;
+    const char* text = strchr(b+4, ' ');
+    m_text.assign((text != NULL) ? text+1 : b+4);
+    message->origin = MyCan.GetBus(bus - '1');
+    message->text = (char*) m_text.c_str();
+    return true;
+    }
+  else
+    return false;  // Discard invalid line
 
-    if (b[3] != ' ') return consumed; // Discard invalid line
-    b += 4;
+  if (b[3] != ' ') return false; // Discard invalid line
+  b += 4;
 
-    char *p;
+  char *p;
+  errno = 0;
+  message->frame.MsgID = (uint32_t)strtol(b,&p,16);
+  if ((message->frame.MsgID == 0)&&(errno != 0)) return false; // Discard invalid line
+  b = p;
+  for (int k=0;k<8;k++)
+    {
+    if (*b==0) break;
+    b++;
     errno = 0;
-    message->frame.MsgID = (uint32_t)strtol(b,&p,16);
-    if ((message->frame.MsgID == 0)&&(errno != 0)) return consumed; // Discard invalid line
+    long d = strtol(b,&p,16);
+    if ((d==0)&&(errno != 0)) break;
+    message->frame.data.u8[k] = (uint8_t)d;
+    message->frame.FIR.B.DLC++;
     b = p;
-    for (int k=0;k<8;k++)
-      {
-      if (*b==0) break;
-      b++;
-      errno = 0;
-      long d = strtol(b,&p,16);
-      if ((d==0)&&(errno != 0)) break;
-      message->frame.data.u8[k] = (uint8_t)d;
-      message->frame.FIR.B.DLC++;
-      b = p;
-      }
-
-    message->origin = MyCan.GetBus(bus - '1');
-
-    return consumed;
     }
+
+  message->origin = MyCan.GetBus(bus - '1');
+  return true;
   }
@@ -31,6 +31,7 @@ static const char *TAG = "canformat-gvret";
 #include "canlog.h"
 #include <errno.h>
 #include <endian.h>
+#include <sys/param.h>
 #include "pcp.h"
 
 ////////////////////////////////////////////////////////////////////////
@@ -90,26 +91,41 @@ canformat_gvret_ascii::canformat_gvret_ascii(const char* type)
 std::string canformat_gvret_ascii::get(CAN_log_message_t* message)
   {
   char buf[CANFORMAT_GVRET_MAXLEN];
+  size_t len = encode(message, (uint8_t*)buf, sizeof(buf));
+  return std::string(buf, len);
+  }
+
+size_t canformat_gvret_ascii::GetMaxLength()
+  {
+  return CANFORMAT_GVRET_MAXLEN;
+  }
+
+size_t canformat_gvret_ascii::encode(CAN_log_message_t* message, uint8_t* buffer, size_t size)
+  {
+  char *buf = (char*)buffer;
 
   if ((message->type != CAN_LogFrame_RX)&&
       (message->type != CAN_LogFrame_TX))
     {
-    return std::string("");
+    return 0;
     }
 
   char busnumber = (message->origin != NULL)?message->origin->m_busnumber + '0':'0';
 
-  sprintf(buf,"%" PRIu32 " - %" PRIx32 " %s %c %d",
+  char *p = buf + sprintf(buf,"%" PRIu32 " - %" PRIx32 " %s %c %d",
     (uint32_t)((message->timestamp.tv_sec * 1000000) + message->timestamp.tv_usec),
     message->frame.MsgID,
     (message->frame.FIR.B.FF == CAN_frame_std) ? "S" : "X",
     busnumber,
     message->frame.FIR.B.DLC);
-    for (int k=0; k<message->frame.FIR.B.DLC; k++)
-      sprintf(buf+strlen(buf)," %02x", message->frame.data.u8[k]);
+  for (int k=0; k<message->frame.FIR.B.DLC; k++)
+    {
+    *p++ = ' ';
+    p = HexByte(p,message->frame.data.u8[k]);
+    }
 
-  strcat(buf,"\n");
-  return std::string(buf);
+  *p++ = '\n';
+  return p - buf;
   }
 
 size_t canformat_gvret_ascii::put(CAN_log_message_t* message, uint8_t *buffer, size_t len, bool* hasmore, canlogconnection* clc)
@@ -125,59 +141,69 @@ size_t canformat_gvret_ascii::put(CAN_log_message_t* message, uint8_t *buffer, s
     }
   else
     {
+    *hasmore = true;  // Call us again to see if we have more frames to process
     std::string line = m_buf.ReadLine();
-    char *b = strdup(line.c_str());
-
-    // We look for something like
-    // 1000 - 100 S 0 4 01 02 03 04
-    // timestamp, message ID (hex), S or X, length, data bytes
-
-    message->type = CAN_LogFrame_RX;
+    ParseLine(message, line.c_str());
+    return consumed;
+    }
+  }
 
-    uint32_t timestamp = strtol(b,&b,10);
-    message->timestamp.tv_sec = timestamp % 1000000;
-    message->timestamp.tv_usec = timestamp / 1000000;
+size_t canformat_gvret_ascii::decode(CAN_log_message_t* message, const uint8_t* buffer, size_t len, canlogconnection* clc)
+  {
+  char line[CANFORMAT_GVRET_MAXLEN];
+  size_t used = GetLine(line, sizeof(line), buffer, len);
+  if (used > 0 && !ParseLine(message, line))
+    memset(message, 0, sizeof(*message));
+  return used;
+  }
 
-    b += 2; // Skip the '-'
+bool canformat_gvret_ascii::ParseLine(CAN_log_message_t* message, const char* line)
+  {
+  char *b;
 
-    message->frame.MsgID = strtol(b,&b,16);
-    if (b[1] == 'S')
-      {
-      message->frame.FIR.B.FF = CAN_frame_std;
-      }
-    else if (b[1] == 'X')
-      {
-      message->frame.FIR.B.FF = CAN_frame_ext;
-      }
-    else
-      {
-      // Bad frame type - discard
-      free(b);
-      return consumed;
-      }
+  // We look for something like
+  // 1000 - 100 S 0 4 01 02 03 04
+  // timestamp, message ID (hex), S or X, bus, length, data bytes
 
-    b += 2; // Skip the frame type
+  uint32_t timestamp = strtoul(line,&b,10);
+  if ((b == line)||(b[0] != ' ')||(b[1] != '-')) return false; // Discard invalid line
+  b += 2; // Skip the '-'
 
-    uint32_t busnumber = strtol(b,&b,10);
+  message->frame.MsgID = strtoul(b,&b,16);
+  if (b[1] == 'S')
+    {
+    message->frame.FIR.B.FF = CAN_frame_std;
+    }
+  else if (b[1] == 'X')
+    {
+    message->frame.FIR.B.FF = CAN_frame_ext;
+    }
+  else
+    {
+    return false; // Bad frame type - discard
+    }
 
-    message->frame.FIR.B.DLC = strtol(b,&b,10);
-    if (message->frame.FIR.B.DLC > 8)
-      {
-      // Bad frame length - discard
-      free(b);
-      return consumed;
-      }
+  b += 2; // Skip the frame type
 
-    for (size_t x=0;x<message->frame.FIR.B.DLC;x++)
-      {
-      message->frame.data.u8[x] = strtol(b,&b,16);
-      }
+  long busnumber = strtol(b,&b,10);
 
-    message->origin = MyCan.GetBus(busnumber-'0');
+  long dlc = strtol(b,&b,10);
+  if ((dlc < 0)||(dlc > 8))
+    {
+    return false; // Bad frame length - discard
+    }
+  message->frame.FIR.B.DLC = dlc;
 
-    free(b);
-    return consumed;
+  for (size_t x=0;x<message->frame.FIR.B.DLC;x++)
+    {
+    message->frame.data.u8[x] = strtol(b,&b,16);
     }
+
+  message->type = CAN_LogFrame_RX;
+  message->timestamp.tv_sec = timestamp / 1000000;
+  message->timestamp.tv_usec = timestamp % 1000000;
+  message->origin = MyCan.GetBus(busnumber);
+  return true;
   }
 
 ////////////////////////////////////////////////////////////////////////
@@ -190,6 +216,18 @@ canformat_gvret_binary::canformat_gvret_binary(const char* type)
   }
 
 std::string canformat_gvret_binary::get(CAN_log_message_t* message)
+  {
+  uint8_t buf[GVRET_FRAME_MAXLEN];
+  size_t len = encode(message, buf, sizeof(buf));
+  return std::string((const char*)buf, len);
+  }
+
+size_t canformat_gvret_binary::GetMaxLength()
+  {
+  return GVRET_FRAME_MAXLEN;
+  }
+
+size_t canformat_gvret_binary::encode(CAN_log_message_t* message, uint8_t* buffer, size_t size)
   {
   gvret_binary_frame_t frame;
   memset(&frame,0,sizeof(frame));
@@ -197,7 +235,7 @@ std::string canformat_gvret_binary::get(CAN_log_message_t* message)
   if ((message->type != CAN_LogFrame_RX)&&
       (message->type != CAN_LogFrame_TX))
     {
-    return std::string("");
+    return 0;
     }
 
   char busnumber = (message->origin != NULL)?message->origin->m_busnumber:0;
@@ -210,7 +248,8 @@ std::string canformat_gvret_binary::get(CAN_log_message_t* message)
   frame.lenbus = message->frame.FIR.B.DLC + (busnumber<<4);
   for (int k=0; k<message->frame.FIR.B.DLC; k++)
     frame.data[k] = message->frame.data.u8[k];
-  return std::string((const char*)&frame,12 + message->frame.FIR.B.DLC);
+  memcpy(buffer, &frame, 12 + message->frame.FIR.B.DLC);
+  return 12 + message->frame.FIR.B.DLC;
   }
 
 std::string canformat_gvret_binary::getheader(struct timeval *time)
@@ -231,160 +270,124 @@ size_t canformat_gvret_binary::put(CAN_log_message_t* message, uint8_t *buffer,
 
   size_t consumed = Stuff(buffer,len);  // Stuff m_buf with as much as possible
 
-  uint8_t firstbyte;
-  while ((m_buf.Peek(1,&firstbyte) == 1)&&(firstbyte != GVRET_START_BYTE))
+  gvret_commandmsg_t m;
+  size_t avail = m_buf.Peek(sizeof(m),(uint8_t*)&m);
+  size_t used = decode(message, (uint8_t*)&m, avail, clc);
+  if (used > 0)
     {
-    if (firstbyte == GVRET_SET_BINARY)
-      {
-      ESP_LOGV(TAG,"GVRET request to set binary mode");
-      }
-    m_buf.Pop(1,&firstbyte);
+    m_buf.Pop(used,(uint8_t*)&m);
+    *hasmore = true;  // Call us again to see if we have more frames to process
     }
 
-  if (m_buf.UsedSpace() >= 2)
+  return consumed;
+  }
+
+size_t canformat_gvret_binary::decode(CAN_log_message_t* message, const uint8_t* buffer, size_t len, canlogconnection* clc)
+  {
+  size_t skip = 0;
+  while ((skip < len)&&(buffer[skip] != GVRET_START_BYTE))
     {
-    gvret_replymsg_t r;
-    gvret_commandmsg_t m;
-    memset(&m,0,sizeof(m));
-    memset(&r,0,sizeof(r));
-    m_buf.Peek(2,(uint8_t*)&m);
-    r.startbyte = m.startbyte;
-    r.command = m.command;
-    switch (m.command)
+    if (buffer[skip] == GVRET_SET_BINARY)
       {
-      case BUILD_CAN_FRAME:
-        if (m_buf.UsedSpace() >= 8)
-          {
-          m_buf.Peek(8,(uint8_t*)&m);
-          if (m_buf.UsedSpace() >= 8 + m.body.build_can_frame.length)
-            {
-            m_buf.Pop(8 + m.body.build_can_frame.length,(uint8_t*)&m);
-            CAN_frame_t msg;
-            memset(&msg,0,sizeof(msg));
-            msg.origin = MyCan.GetBus(m.body.build_can_frame.bus);
-            if (m.body.build_can_frame.id & 0x8000000)
-              {
-              msg.MsgID = m.body.build_can_frame.id & 0x7fffffff;
-              msg.FIR.B.FF = CAN_frame_ext;
-              }
-            else
-              {
-              msg.MsgID = m.body.build_can_frame.id;
-              msg.FIR.B.FF = CAN_frame_std;
-              }
-            msg.FIR.B.DLC = m.body.build_can_frame.length;
-            memcpy(&msg.data, &m.body.build_can_frame.data, m.body.build_can_frame.length);
-
-            ESP_LOGD(TAG,"Rx BUILD_CAN_FRAME ID=%0" PRIx32,msg.MsgID);
-            *hasmore = true;  // Call us again to see if we have more frames to process
-            // We have a frame to be transmitted / simulated
-            switch (m_servemode)
-              {
-              case Transmit:
-                if (msg.origin) msg.origin->Write(&msg);
-                break;
-              case Simulate:
-                if (msg.origin) MyCan.IncomingFrame(&msg);
-                break;
-              default:
-                break;
-              }
-            }
-          }
-        break;
-      case TIME_SYNC:
-        ESP_LOGD(TAG,"Rx %02x TIME_SYNC",m.command);
-        m_buf.Pop(2,(uint8_t*)&m);
-        r.body.time_sync.microseconds = 0;
-        if (clc) clc->TransmitCallback((uint8_t*)&r,6);
-        *hasmore = true;  // Call us again to see if we have more frames to process
-        break;
-      case GET_DIG_INPUTS:
-        ESP_LOGD(TAG,"Rx %02x GET_DIG_INPUTS",m.command);
-        m_buf.Pop(2,(uint8_t*)&m);
-        if (clc) clc->TransmitCallback((uint8_t*)&r,4);
-        *hasmore = true;  // Call us again to see if we have more frames to process
-        break;
-      case GET_ANALOG_INPUTS:
-        ESP_LOGD(TAG,"Rx %02x GET_ANALOG_INPUTS",m.command);
-        m_buf.Pop(2,(uint8_t*)&m);
-        if (clc) clc->TransmitCallback((uint8_t*)&r,11);
-        *hasmore = true;  // Call us again to see if we have more frames to process
-        break;
-      case SET_DIG_OUTPUTS:
-        ESP_LOGD(TAG,"Rx %02x GET_DIG_OUTPUTS",m.command);
-        m_buf.Pop(2,(uint8_t*)&m);
-        *hasmore = true;  // Call us again to see if we have more frames to process
-        break;
-      case SETUP_CANBUS:
-        ESP_LOGD(TAG,"Rx %02x SETUP_CANBUS",m.command);
-        m_buf.Pop(2,(uint8_t*)&m);
-        *hasmore = true;  // Call us again to see if we have more frames to process
-        break;
-      case GET_CANBUS_PARAMS:
-        ESP_LOGD(TAG,"Rx %02x GET_CANBUS_PARAMS",m.command);
-        m_buf.Pop(2,(uint8_t*)&m);
-        PopulateBusList12(&r);
-        if (clc) clc->TransmitCallback((uint8_t*)&r,12);
-        *hasmore = true;  // Call us again to see if we have more frames to process
-        break;
-      case GET_DEVICE_INFO:
-        ESP_LOGD(TAG,"Rx %02x GET_DEVICE_INFO",m.command);
-        m_buf.Pop(2,(uint8_t*)&m);
-        r.body.get_device_info.build = 0;
-        r.body.get_device_info.eeprom = 0;
-        r.body.get_device_info.filetype = 0;
-        r.body.get_device_info.autolog = 0;
-        r.body.get_device_info.singlewire = 0;
-        if (clc) clc->TransmitCallback((uint8_t*)&r,8);
-        *hasmore = true;  // Call us again to see if we have more frames to process
-        break;
-      case SET_SINGLEWIRE_MODE:
-        ESP_LOGD(TAG,"Rx %02x SET_SINGLEWIRE_MODE",m.command);
-        m_buf.Pop(2,(uint8_t*)&m);
-        *hasmore = true;  // Call us again to see if we have more frames to process
-        break;
-      case KEEP_ALIVE:
-        // Don't log keepalive, as we get four of these a second
-        //ESP_LOGD(TAG,"Rx %02x KEEP_ALIVE",m.command);
-        m_buf.Pop(2,(uint8_t*)&m);
-        r.body.keep_alive.notdead1 = GVRET_NOTDEAD_1;
-        r.body.keep_alive.notdead2 = GVRET_NOTDEAD_2;
-        if (clc) clc->TransmitCallback((uint8_t*)&r,4);
-        *hasmore = true;  // Call us again to see if we have more frames to process
-        break;
-      case SET_SYSTEM_TYPE:
-        ESP_LOGD(TAG,"Rx %02x SET_SYSTEM_TYPE",m.command);
-        m_buf.Pop(2,(uint8_t*)&m);
-        *hasmore = true;  // Call us again to see if we have more frames to process
-        break;
-      case ECHO_CAN_FRAME:
-        ESP_LOGD(TAG,"Rx %02x ECHO_CAN_FRAME",m.command);
-        m_buf.Pop(2,(uint8_t*)&m);
-        *hasmore = true;  // Call us again to see if we have more frames to process
-        break;
-      case GET_NUM_BUSES:
-        ESP_LOGD(TAG,"Rx %02x GET_NUM_BUSES",m.command);
-        m_buf.Pop(2,(uint8_t*)&m);
-        r.body.get_num_buses.buses = 3;
-        if (clc) clc->TransmitCallback((uint8_t*)&r,3);
-        *hasmore = true;  // Call us again to see if we have more frames to process
-        break;
-      case GET_EXT_BUSES:
-        ESP_LOGD(TAG,"Rx %02x GET_EXT_BUSES",m.command);
-        m_buf.Pop(2,(uint8_t*)&m);
-        PopulateBusList3(&r);
-        if (clc) clc->TransmitCallback((uint8_t*)&r,17);
-        *hasmore = true;  // Call us again to see if we have more frames to process
-        break;
-      default:
-        ESP_LOGW(TAG,"Rx %02x command unrecognised - skipping",m.command);
-        m_buf.Pop(2,(uint8_t*)&m);
-        *hasmore = true;  // Call us again to see if we have more frames to process
+      ESP_LOGV(TAG,"GVRET request to set binary mode");
       }
+    skip++;
     }
+  if (skip > 0) return skip;
+  if (len < 2) return 0; // Incomplete
 
-  return consumed;
+  gvret_replymsg_t r;
+  gvret_commandmsg_t m;
+  memset(&m,0,sizeof(m));
+  memset(&r,0,sizeof(r));
+  memcpy(&m,buffer,MIN(len,sizeof(m)));
+  r.startbyte = m.startbyte;
+  r.command = m.command;
+  switch (m.command)
+    {
+    case BUILD_CAN_FRAME:
+      if (len < 8) return 0; // Incomplete
+      if (m.body.build_can_frame.length > 8) return 2; // Invalid length, skip command
+      if (len < 8 + m.body.build_can_frame.length) return 0; // Incomplete
+      message->type = CAN_LogFrame_RX;
+      message->origin = MyCan.GetBus(m.body.build_can_frame.bus);
+      if (m.body.build_can_frame.id & 0x80000000)
+        {
+        message->frame.MsgID = m.body.build_can_frame.id & 0x7fffffff;
+        message->frame.FIR.B.FF = CAN_frame_ext;
+        }
+      else
+        {
+        message->frame.MsgID = m.body.build_can_frame.id;
+        message->frame.FIR.B.FF = CAN_frame_std;
+        }
+      message->frame.FIR.B.DLC = m.body.build_can_frame.length;
+      memcpy(&message->frame.data, &m.body.build_can_frame.data, m.body.build_can_frame.length);
+      ESP_LOGD(TAG,"Rx BUILD_CAN_FRAME ID=%0" PRIx32,message->frame.MsgID);
+      return 8 + m.body.build_can_frame.length;
+    case TIME_SYNC:
+      ESP_LOGD(TAG,"Rx %02x TIME_SYNC",m.command);
+      r.body.time_sync.microseconds = 0;
+      if (clc) clc->TransmitCallback((uint8_t*)&r,6);
+      return 2;
+    case GET_DIG_INPUTS:
+      ESP_LOGD(TAG,"Rx %02x GET_DIG_INPUTS",m.command);
+      if (clc) clc->TransmitCallback((uint8_t*)&r,4);
+      return 2;
+    case GET_ANALOG_INPUTS:
+      ESP_LOGD(TAG,"Rx %02x GET_ANALOG_INPUTS",m.command);
+      if (clc) clc->TransmitCallback((uint8_t*)&r,11);
+      return 2;
+    case SET_DIG_OUTPUTS:
+      ESP_LOGD(TAG,"Rx %02x GET_DIG_OUTPUTS",m.command);
+      return 2;
+    case SETUP_CANBUS:
+      ESP_LOGD(TAG,"Rx %02x SETUP_CANBUS",m.command);
+      return 2;
+    case GET_CANBUS_PARAMS:
+      ESP_LOGD(TAG,"Rx %02x GET_CANBUS_PARAMS",m.command);
+      PopulateBusList12(&r);
+      if (clc) clc->TransmitCallback((uint8_t*)&r,12);
+      return 2;
+    case GET_DEVICE_INFO:
+      ESP_LOGD(TAG,"Rx %02x GET_DEVICE_INFO",m.command);
+      r.body.get_device_info.build = 0;
+      r.body.get_device_info.eeprom = 0;
+      r.body.get_device_info.filetype = 0;
+      r.body.get_device_info.autolog = 0;
+      r.body.get_device_info.singlewire = 0;
+      if (clc) clc->TransmitCallback((uint8_t*)&r,8);
+      return 2;
+    case SET_SINGLEWIRE_MODE:
+      ESP_LOGD(TAG,"Rx %02x SET_SINGLEWIRE_MODE",m.command);
+      return 2;
+    case KEEP_ALIVE:
+      // Don't log keepalive, as we get four of these a second
+      //ESP_LOGD(TAG,"Rx %02x KEEP_ALIVE",m.command);
+      r.body.keep_alive.notdead1 = GVRET_NOTDEAD_1;
+      r.body.keep_alive.notdead2 = GVRET_NOTDEAD_2;
+      if (clc) clc->TransmitCallback((uint8_t*)&r,4);
+      return 2;
+    case SET_SYSTEM_TYPE:
+      ESP_LOGD(TAG,"Rx %02x SET_SYSTEM_TYPE",m.command);
+      return 2;
+    case ECHO_CAN_FRAME:
+      ESP_LOGD(TAG,"Rx %02x ECHO_CAN_FRAME",m.command);
+      return 2;
+    case GET_NUM_BUSES:
+      ESP_LOGD(TAG,"Rx %02x GET_NUM_BUSES",m.command);
+      r.body.get_num_buses.buses = 3;
+      if (clc) clc->TransmitCallback((uint8_t*)&r,3);
+      return 2;
+    case GET_EXT_BUSES:
+      ESP_LOGD(TAG,"Rx %02x GET_EXT_BUSES",m.command);
+      PopulateBusList3(&r);
+      if (clc) clc->TransmitCallback((uint8_t*)&r,17);
+      return 2;
+    default:
+      ESP_LOGW(TAG,"Rx %02x command unrecognised - skipping",m.command);
+      return 2;
+    }
   }
 
 void canformat_gvret_binary::PopulateBusList12(gvret_replymsg_t* r)
@@ -29,7 +29,8 @@
 
 #include "canformat.h"
 
-#define CANFORMAT_GVRET_MAXLEN 48
+#define CANFORMAT_GVRET_MAXLEN 64
+#define GVRET_FRAME_MAXLEN 20          // binary frame: 12 byte header + data
 
 #define GVRET_SET_BINARY 0xe7
 #define GVRET_START_BYTE 0xf1
@@ -179,6 +180,14 @@ class canformat_gvret_ascii : public canformat_gvret
     canformat_gvret_ascii(const char* type);
     virtual std::string get(CAN_log_message_t* message);
     virtual size_t put(CAN_log_message_t* message, uint8_t *buffer, size_t len, bool* hasmore, canlogconnection* clc=NULL);
+
+  public:
+    virtual size_t GetMaxLength();
+    virtual size_t encode(CAN_log_message_t* message, uint8_t* buffer, size_t size);
+    virtual size_t decode(CAN_log_message_t* message, const uint8_t* buffer, size_t len, canlogconnection* clc=NULL);
+
+  protected:
+    bool ParseLine(CAN_log_message_t* message, const char* line);
   };
 
 class canformat_gvret_binary : public canformat_gvret
@@ -189,6 +198,11 @@ class canformat_gvret_binary : public canformat_gvret
     virtual std::string getheader(struct timeval *time);
     virtual size_t put(CAN_log_message_t* message, uint8_t *buffer, size_t len, bool* hasmore, canlogconnection* clc=NULL);
 
+  public:
+    virtual size_t GetMaxLength();
+    virtual size_t encode(CAN_log_message_t* message, uint8_t* buffer, size_t size);
+    virtual size_t decode(CAN_log_message_t* message, const uint8_t* buffer, size_t len, canlogconnection* clc=NULL);
+
   private:
     void PopulateBusList12(gvret_replymsg_t* r);
     void PopulateBusList3(gvret_replymsg_t* r);
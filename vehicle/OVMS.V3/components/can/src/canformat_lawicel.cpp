@@ -29,6 +29,7 @@ static const char *TAG = "canformat-lawicel";
 
 #include <errno.h>
 #include "pcp.h"
+#include "ovms_utils.h"
 #include "canformat_lawicel.h"
 
 ////////////////////////////////////////////////////////////////////////
@@ -63,28 +64,41 @@ canformat_lawicel::~canformat_lawicel()
 std::string canformat_lawicel::get(CAN_log_message_t* message)
   {
   char buf[CANFORMAT_LAWICEL_MAXLEN];
+  size_t len = encode(message, (uint8_t*)buf, sizeof(buf));
+  return std::string(buf, len);
+  }
+
+size_t canformat_lawicel::GetMaxLength()
+  {
+  return CANFORMAT_LAWICEL_MAXLEN;
+  }
+
+size_t canformat_lawicel::encode(CAN_log_message_t* message, uint8_t* buffer, size_t size)
+  {
+  char *buf = (char*)buffer;
+  char *p;
 
   if ((message->type != CAN_LogFrame_RX)&&
       (message->type != CAN_LogFrame_TX))
     {
-    return std::string("");
+    return 0;
     }
 
   if (message->frame.FIR.B.FF == CAN_frame_std)
     {
-    sprintf(buf,"t%03" PRIx32 "%01d",message->frame.MsgID, message->frame.FIR.B.DLC);
+    p = buf + sprintf(buf,"t%03" PRIx32 "%01d",message->frame.MsgID, message->frame.FIR.B.DLC);
     }
   else
     {
-    sprintf(buf,"T%08" PRIx32 "%01d",message->frame.MsgID, message->frame.FIR.B.DLC);
+    p = buf + sprintf(buf,"T%08" PRIx32 "%01d",message->frame.MsgID, message->frame.FIR.B.DLC);
     }
 
   for (int k=0; k<message->frame.FIR.B.DLC; k++)
-    sprintf(buf+strlen(buf),"%02x", message->frame.data.u8[k]);
-  sprintf(buf+strlen(buf),"%04lx", message->timestamp.tv_usec/1000);
+    p = HexByte(p,message->frame.data.u8[k]);
+  p += sprintf(p,"%04lx", message->timestamp.tv_usec/1000);
 
-  strcat(buf,"\n");
-  return std::string(buf);
+  *p++ = '\n';
+  return p - buf;
   }
 
 std::string canformat_lawicel::getheader(struct timeval *time)
@@ -107,57 +121,70 @@ size_t canformat_lawicel::put(CAN_log_message_t* message, uint8_t *buffer, size_
     {
     *hasmore = true;  // Call us again to see if we have more frames to process
     std::string line = m_buf.ReadLine();
-    const char *b = line.c_str();
-    char hex[9];
-
-    // We look for something like
-    // t100401020304000a
-    if (*b == 't')
-      {
-      // Standard frame
-      memcpy(hex,b+1,3);
-      hex[3] = 0;
-      message->type = CAN_LogFrame_RX;
-      message->frame.FIR.B.FF = CAN_frame_std;
-      message->frame.MsgID = strtol(hex,NULL,16);
-      b += 4;
-      }
-    else if (*b == 'T')
-      {
-      // Extended frame
-      memcpy(hex,b+1,8);
-      hex[8] = 0;
-      message->type = CAN_LogFrame_RX;
-      message->frame.FIR.B.FF = CAN_frame_ext;
-      message->frame.MsgID = strtol(hex,NULL,16);
-      b += 9;
-      }
-    else
-      {
-      // Unknown format - discard
-      return consumed; // Discard invalid line
-      }
-
-    message->frame.FIR.B.DLC = *b - '0';
-    if (message->frame.FIR.B.DLC > 8)
-      {
-      // Invalid length - discard
-      return consumed; // Discard invalid line
-      }
-
-    b++;
-    for (size_t x=0;x<message->frame.FIR.B.DLC;x++)
-      {
-      hex[0] = b[0];
-      hex[1] = b[2];
-      hex[2] = 0;
-      b += 2;
-      message->frame.data.u8[x] = (uint8_t)strtol(hex,NULL,16);
-      }
-
-    gettimeofday(&message->timestamp,NULL);
-    message->origin = MyCan.GetBus(0);
-
+    ParseLine(message, line.c_str());
     return consumed;
     }
   }
+
+size_t canformat_lawicel::decode(CAN_log_message_t* message, const uint8_t* buffer, size_t len, canlogconnection* clc)
+  {
+  char line[CANFORMAT_LAWICEL_MAXLEN];
+  size_t used = GetLine(line, sizeof(line), buffer, len);
+  if (used > 0 && !ParseLine(message, line))
+    memset(message, 0, sizeof(*message));
+  return used;
+  }
+
+bool canformat_lawicel::ParseLine(CAN_log_message_t* message, const char* b)
+  {
+  char hex[9];
+
+  // We look for something like
+  // t100401020304000a
+  if (*b == 't')
+    {
+    // Standard frame
+    memcpy(hex,b+1,3);
+    hex[3] = 0;
+    message->type = CAN_LogFrame_RX;
+    message->frame.FIR.B.FF = CAN_frame_std;
+    message->frame.MsgID = strtol(hex,NULL,16);
+    b += 4;
+    }
+  else if (*b == 'T')
+    {
+    // Extended frame
+    memcpy(hex,b+1,8);
+    hex[8] = 0;
+    message->type = CAN_LogFrame_RX;
+    message->frame.FIR.B.FF = CAN_frame_ext;
+    message->frame.MsgID = strtol(hex,NULL,16);
+    b += 9;
+    }
+  else
+    {
+    // Unknown format - discard
+    return false; // Discard invalid line
+    }
+
+  if ((*b < '0')||(*b > '8'))
+    {
+    // Invalid length - discard
+    return false; // Discard invalid line
+    }
+  message->frame.FIR.B.DLC = *b - '0';
+
+  b++;
+  for (size_t x=0;x<message->frame.FIR.B.DLC;x++)
+    {
+    hex[0] = b[0];
+    hex[1] = b[1];
+    hex[2] = 0;
+    b += 2;
+    message->frame.data.u8[x] = (uint8_t)strtol(hex,NULL,16);
+    }
+
+  gettimeofday(&message->timestamp,NULL);
+  message->origin = MyCan.GetBus(0);
+  return true;
+  }
@@ -41,6 +41,14 @@ class canformat_lawicel : public canformat
     virtual std::string get(CAN_log_message_t* message);
     virtual std::string getheader(struct timeval *time);
     virtual size_t put(CAN_log_message_t* message, uint8_t *buffer, size_t len, bool* hasmore, canlogconnection* clc=NULL);
+
+  public:
+    virtual size_t GetMaxLength();
+    virtual size_t encode(CAN_log_message_t* message, uint8_t* buffer, size_t size);
+    virtual size_t decode(CAN_log_message_t* message, const uint8_t* buffer, size_t len, canlogconnection* clc=NULL);
+
+  protected:
+    bool ParseLine(CAN_log_message_t* message, const char* line);
   };
 
 #endif // __CANFORMAT_LAWICEL_H__
@@ -0,0 +1,527 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Module:        CAN dump OVBL binary block format
+;    Date:          18th October 2026
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011        Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+#include "ovms_log.h"
+static const char *TAG = "canformat-ovbl";
+
+#include "canformat_ovbl.h"
+#include <errno.h>
+#include <endian.h>
+#include <sys/param.h>
+#include "ovms_malloc.h"
+#include "pcp.h"
+
+class OvmsCanFormatOVBLInit
+  {
+  public: OvmsCanFormatOVBLInit();
+} MyOvmsCanFormatOVBLInit  __attribute__ ((init_priority (4505)));
+
+OvmsCanFormatOVBLInit::OvmsCanFormatOVBLInit()
+  {
+  ESP_LOGI(TAG, "Registering CAN Format: OVBL (4505)");
+
+  MyCanFormatFactory.RegisterCanFormat<canformat_ovbl>("ovbl");
+#ifdef CONFIG_OVMS_SC_ZIP
+  MyCanFormatFactory.RegisterCanFormat<canformat_ovbl>("ovbl-z");
+#endif
+  }
+
+#ifdef CONFIG_OVMS_SC_ZIP
+// Raw deflate streams with a small window & memory footprint (~12K for deflate):
+#define OVBL_ZWINDOWBITS        10
+#define OVBL_ZMEMLEVEL          4
+
+static voidpf ovbl_zalloc(voidpf opaque, uInt items, uInt size)
+  {
+  return ExternalRamCalloc(items, size);
+  }
+
+static void ovbl_zfree(voidpf opaque, voidpf address)
+  {
+  free(address);
+  }
+#endif // CONFIG_OVMS_SC_ZIP
+
+static inline void ovbl_put_varint(std::string& buf, uint32_t v)
+  {
+  while (v >= 0x80)
+    {
+    buf.push_back((char)(v | 0x80));
+    v >>= 7;
+    }
+  buf.push_back((char)v);
+  }
+
+static inline bool ovbl_get_varint(const std::string& buf, size_t& pos, uint32_t& v)
+  {
+  v = 0;
+  for (int shift = 0; shift < 35 && pos < buf.size(); shift += 7)
+    {
+    uint8_t b = buf[pos++];
+    v |= (uint32_t)(b & 0x7f) << shift;
+    if (!(b & 0x80)) return true;
+    }
+  return false;
+  }
+
+canformat_ovbl::canformat_ovbl(const char* type)
+  : canformat(type)
+  {
+  m_deflate = (strcmp(type, "ovbl-z") == 0);
+  m_count = 0;
+  m_base.tv_sec = 0;
+  m_base.tv_usec = 0;
+  m_last_ts = 0;
+  m_last_id = 0;
+  m_outcount = 0;
+  m_outtime.tv_sec = 0;
+  m_outtime.tv_usec = 0;
+  m_block.reserve(OVBL_BLOCK_MAXRAW + 64);
+  m_rawpos = 0;
+  m_rawcount = 0;
+  m_in_ts = 0;
+  m_in_id = 0;
+
+#ifdef CONFIG_OVMS_SC_ZIP
+  memset(&m_zdef, 0, sizeof(m_zdef));
+  memset(&m_zinf, 0, sizeof(m_zinf));
+  m_zdef.zalloc = m_zinf.zalloc = ovbl_zalloc;
+  m_zdef.zfree = m_zinf.zfree = ovbl_zfree;
+  m_zdef_ok = false;
+  m_zinf_ok = false;
+  if (m_deflate)
+    {
+    m_zdef_ok = (deflateInit2(&m_zdef, Z_BEST_SPEED, Z_DEFLATED,
+      -OVBL_ZWINDOWBITS, OVBL_ZMEMLEVEL, Z_DEFAULT_STRATEGY) == Z_OK);
+    if (!m_zdef_ok)
+      ESP_LOGE(TAG, "deflate init failed, writing uncompressed blocks");
+    }
+#endif // CONFIG_OVMS_SC_ZIP
+  }
+
+canformat_ovbl::~canformat_ovbl()
+  {
+#ifdef CONFIG_OVMS_SC_ZIP
+  if (m_zdef_ok) deflateEnd(&m_zdef);
+  if (m_zinf_ok) inflateEnd(&m_zinf);
+#endif // CONFIG_OVMS_SC_ZIP
+  }
+
+std::string canformat_ovbl::getheader(struct timeval *time)
+  {
+  ovbl_header_t h;
+  struct timeval t;
+
+  if (time == NULL)
+    {
+    gettimeofday(&t,NULL);
+    time = &t;
+    }
+
+  memset(&h,0,sizeof(h));
+  memcpy(h.magic, "OVBL", 4);
+  h.version = OVBL_VERSION;
+  h.flags = m_deflate ? OVBL_HDR_FL_DEFLATE : 0;
+  h.ts_sec = htole32(time->tv_sec);
+  h.ts_usec = htole32(time->tv_usec);
+
+  return std::string((const char*)&h, sizeof(h));
+  }
+
+std::string canformat_ovbl::get(CAN_log_message_t* message)
+  {
+  uint64_t ts = (uint64_t)message->timestamp.tv_sec * 1000000 + message->timestamp.tv_usec;
+
+  // Deltas are unsigned, so a clock step back or a long gap starts a new block:
+  if (m_count > 0 && (ts < m_last_ts || ts - m_last_ts >= OVBL_BLOCK_MAXAGE))
+    CloseBlock();
+
+  if (m_count == 0)
+    {
+    m_base = message->timestamp;
+    m_last_ts = ts;
+    m_last_id = 0;
+    }
+
+  uint8_t bus = (message->origin != NULL) ? MIN(message->origin->m_busnumber, 6) : 7;
+  uint8_t tag = (message->type & 0x0f) | (bus << 4);
+
+  switch (message->type)
+    {
+    case CAN_LogFrame_RX:
+    case CAN_LogFrame_TX:
+    case CAN_LogFrame_TX_Queue:
+    case CAN_LogFrame_TX_Fail:
+      {
+      if (message->frame.FIR.B.RTR == CAN_RTR) tag |= 0x80;
+      m_block.push_back((char)tag);
+      ovbl_put_varint(m_block, ts - m_last_ts);
+      uint32_t id = (message->frame.MsgID << 1) | ((message->frame.FIR.B.FF == CAN_frame_ext) ? 1 : 0);
+      int32_t delta = (int32_t)(id - m_last_id);
+      ovbl_put_varint(m_block, ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));  // zigzag
+      m_last_id = id;
+      uint8_t dlc = MIN(message->frame.FIR.B.DLC, 8);
+      m_block.push_back((char)dlc);
+      m_block.append((const char*)message->frame.data.u8, dlc);
+      break;
+      }
+
+    case CAN_LogStatus_Error:
+    case CAN_LogStatus_Statistics:
+      {
+      const CAN_status_t& s = message->status;
+      m_block.push_back((char)tag);
+      ovbl_put_varint(m_block, ts - m_last_ts);
+      ovbl_put_varint(m_block, s.interrupts);
+      ovbl_put_varint(m_block, s.packets_rx);
+      ovbl_put_varint(m_block, s.packets_tx);
+      ovbl_put_varint(m_block, s.txbuf_delay);
+      ovbl_put_varint(m_block, s.rxbuf_overflow);
+      ovbl_put_varint(m_block, s.txbuf_overflow);
+      ovbl_put_varint(m_block, s.tx_fails);
+      ovbl_put_varint(m_block, s.error_flags);
+      ovbl_put_varint(m_block, s.errors_rx);
+      ovbl_put_varint(m_block, s.errors_tx);
+      ovbl_put_varint(m_block, s.invalid_rx);
+      ovbl_put_varint(m_block, s.watchdog_resets);
+      ovbl_put_varint(m_block, s.error_resets);
+      ovbl_put_varint(m_block, s.error_time);
+      break;
+      }
+
+    case CAN_LogInfo_Comment:
+    case CAN_LogInfo_Config:
+    case CAN_LogInfo_Event:
+    case CAN_LogInfo_Metric:
+      {
+      size_t len = (message->text != NULL) ? MIN(strlen(message->text), 2048) : 0;
+      m_block.push_back((char)tag);
+      ovbl_put_varint(m_block, ts - m_last_ts);
+      ovbl_put_varint(m_block, len);
+      m_block.append(message->text, len);
+      break;
+      }
+
+    default:
+      return std::string("");
+    }
+
+  m_last_ts = ts;
+  m_count++;
+
+  if (m_count >= OVBL_BLOCK_MAXCOUNT || m_block.size() >= OVBL_BLOCK_MAXRAW)
+    CloseBlock();
+
+  // Completed blocks are collected by flush()
+  return std::string("");
+  }
+
+void canformat_ovbl::CloseBlock()
+  {
+  if (m_count == 0) return;
+
+  ovbl_block_t blk;
+  blk.magic = OVBL_BLK_MAGIC;
+  blk.flags = 0;
+  blk.count = htole16(m_count);
+  blk.rawlen = htole16(m_block.size());
+  blk.len = blk.rawlen;
+  blk.ts_sec = htole32(m_base.tv_sec);
+  blk.ts_usec = htole32(m_base.tv_usec);
+
+  bool stored = false;
+#ifdef CONFIG_OVMS_SC_ZIP
+  if (m_zdef_ok)
+    {
+    size_t hpos = m_out.size();
+    size_t bound = deflateBound(&m_zdef, m_block.size());
+    m_out.resize(hpos + sizeof(blk) + bound);
+    deflateReset(&m_zdef);
+    m_zdef.next_in = (Bytef*) m_block.data();
+    m_zdef.avail_in = m_block.size();
+    m_zdef.next_out = (Bytef*) &m_out[hpos + sizeof(blk)];
+    m_zdef.avail_out = bound;
+    if (deflate(&m_zdef, Z_FINISH) == Z_STREAM_END && m_zdef.total_out < m_block.size())
+      {
+      blk.flags = OVBL_BLK_FL_DEFLATE;
+      blk.len = htole16(m_zdef.total_out);
+      memcpy(&m_out[hpos], &blk, sizeof(blk));
+      m_out.resize(hpos + sizeof(blk) + m_zdef.total_out);
+      stored = true;
+      }
+    else
+      {
+      // Incompressible, store raw:
+      m_out.resize(hpos);
+      }
+    }
+#endif // CONFIG_OVMS_SC_ZIP
+
+  if (!stored)
+    {
+    m_out.append((const char*)&blk, sizeof(blk));
+    m_out.append(m_block);
+    }
+
+  if (m_outcount == 0) m_outtime = m_base;
+  m_outcount += m_count;
+  m_block.clear();
+  m_count = 0;
+  }
+
+bool canformat_ovbl::IsBuffered()
+  {
+  return true;
+  }
+
+std::string canformat_ovbl::flush(bool force, uint32_t* records, struct timeval* first)
+  {
+  if (m_count > 0)
+    {
+    if (force)
+      {
+      CloseBlock();
+      }
+    else
+      {
+      struct timeval now;
+      gettimeofday(&now, NULL);
+      int64_t age = ((int64_t)now.tv_sec - m_base.tv_sec) * 1000000 + (now.tv_usec - m_base.tv_usec);
+      if (age >= OVBL_BLOCK_MAXAGE || age < 0)
+        CloseBlock();
+      }
+    }
+
+  std::string result;
+  result.swap(m_out);
+  if (records) *records = m_outcount;
+  if (first) *first = m_outtime;
+  m_outcount = 0;
+  return result;
+  }
+
+bool canformat_ovbl::OpenInputBlock()
+  {
+  while (!m_in.empty())
+    {
+    uint8_t first = m_in[0];
+
+    // File header:
+    if (first == 'O')
+      {
+      size_t n = MIN(m_in.size(), (size_t)4);
+      if (memcmp(m_in.data(), "OVBL", n) == 0)
+        {
+        if (m_in.size() < sizeof(ovbl_header_t)) return false; // need more data
+        m_in.erase(0, sizeof(ovbl_header_t));
+        continue;
+        }
+      }
+
+    // Resync to the next block marker:
+    if (first != OVBL_BLK_MAGIC)
+      {
+      size_t p = 1;
+      while (p < m_in.size() && (uint8_t)m_in[p] != OVBL_BLK_MAGIC && m_in[p] != 'O') p++;
+      m_in.erase(0, p);
+      continue;
+      }
+
+    if (m_in.size() < sizeof(ovbl_block_t)) return false; // need more data
+
+    ovbl_block_t blk;
+    memcpy(&blk, m_in.data(), sizeof(blk));
+    uint16_t count = le16toh(blk.count);
+    uint16_t rawlen = le16toh(blk.rawlen);
+    uint16_t len = le16toh(blk.len);
+    bool deflated = (blk.flags & OVBL_BLK_FL_DEFLATE);
+    size_t total = sizeof(blk) + len;
+
+    if (count == 0 || (blk.flags & ~OVBL_BLK_FL_DEFLATE) || (!deflated && len != rawlen)
+        || total > OVBL_INPUT_MAXLEN)
+      {
+      m_in.erase(0, 1); // not a valid block header
+      continue;
+      }
+
+    if (m_in.size() < total) return false; // need more data
+
+    bool ok = true;
+    if (!deflated)
+      {
+      m_raw.assign(m_in, sizeof(blk), len);
+      }
+    else
+      {
+#ifdef CONFIG_OVMS_SC_ZIP
+      if (!m_zinf_ok)
+        m_zinf_ok = (inflateInit2(&m_zinf, -MAX_WBITS) == Z_OK);
+      if (m_zinf_ok)
+        {
+        m_raw.resize(rawlen);
+        inflateReset(&m_zinf);
+        m_zinf.next_in = (Bytef*) &m_in[sizeof(blk)];
+        m_zinf.avail_in = len;
+        m_zinf.next_out = (Bytef*) &m_raw[0];
+        m_zinf.avail_out = rawlen;
+        ok = (inflate(&m_zinf, Z_FINISH) == Z_STREAM_END && m_zinf.total_out == rawlen);
+        }
+      else
+        {
+        ok = false;
+        }
+#else
+      ok = false;
+#endif // CONFIG_OVMS_SC_ZIP
+      if (!ok) ESP_LOGW(TAG, "Cannot inflate block, skipping %d records", count);
+      }
+
+    m_in.erase(0, total);
+    if (!ok) continue;
+
+    m_rawpos = 0;
+    m_rawcount = count;
+    m_in_ts = (uint64_t)le32toh(blk.ts_sec) * 1000000 + le32toh(blk.ts_usec);
+    m_in_id = 0;
+    return true;
+    }
+
+  return false;
+  }
+
+bool canformat_ovbl::DecodeRecord(CAN_log_message_t* message)
+  {
+  uint32_t v;
+
+  if (m_rawpos >= m_raw.size()) return false;
+
+  memset(message, 0, sizeof(*message));
+  uint8_t tag = m_raw[m_rawpos++];
+  if (!ovbl_get_varint(m_raw, m_rawpos, v)) return false;
+  m_in_ts += v;
+
+  uint8_t bus = (tag >> 4) & 0x07;
+  message->type = (CAN_log_type_t)(tag & 0x0f);
+  message->timestamp.tv_sec = m_in_ts / 1000000;
+  message->timestamp.tv_usec = m_in_ts % 1000000;
+  canbus* origin = (bus < 7) ? MyCan.GetBus(bus) : NULL;
+
+  switch (message->type)
+    {
+    case CAN_LogFrame_RX:
+    case CAN_LogFrame_TX:
+    case CAN_LogFrame_TX_Queue:
+    case CAN_LogFrame_TX_Fail:
+      {
+      if (!ovbl_get_varint(m_raw, m_rawpos, v)) return false;
+      m_in_id += (int32_t)((v >> 1) ^ -(int32_t)(v & 1));
+      if (m_rawpos >= m_raw.size()) return false;
+      uint8_t dlc = m_raw[m_rawpos++];
+      if (dlc > 8 || m_rawpos + dlc > m_raw.size()) return false;
+      message->frame.origin = origin;
+      message->frame.MsgID = m_in_id >> 1;
+      message->frame.FIR.B.FF = (m_in_id & 1) ? CAN_frame_ext : CAN_frame_std;
+      message->frame.FIR.B.RTR = (tag & 0x80) ? CAN_RTR : CAN_no_RTR;
+      message->frame.FIR.B.DLC = dlc;
+      memcpy(message->frame.data.u8, &m_raw[m_rawpos], dlc);
+      m_rawpos += dlc;
+      break;
+      }
+
+    case CAN_LogStatus_Error:
+    case CAN_LogStatus_Statistics:
+      {
+      uint32_t f[14];
+      for (int i = 0; i < 14; i++)
+        if (!ovbl_get_varint(m_raw, m_rawpos, f[i])) return false;
+      CAN_status_t& s = message->status;
+      message->origin = origin;
+      s.interrupts = f[0];
+      s.packets_rx = f[1];
+      s.packets_tx = f[2];
+      s.txbuf_delay = f[3];
+      s.rxbuf_overflow = f[4];
+      s.txbuf_overflow = f[5];
+      s.tx_fails = f[6];
+      s.error_flags = f[7];
+      s.errors_rx = f[8];
+      s.errors_tx = f[9];
+      s.invalid_rx = f[10];
+      s.watchdog_resets = f[11];
+      s.error_resets = f[12];
+      s.error_time = f[13];
+      break;
+      }
+
+    case CAN_LogInfo_Comment:
+    case CAN_LogInfo_Config:
+    case CAN_LogInfo_Event:
+    case CAN_LogInfo_Metric:
+      {
+      if (!ovbl_get_varint(m_raw, m_rawpos, v)) return false;
+      if (m_rawpos + v > m_raw.size()) return false;
+      m_text.assign(m_raw, m_rawpos, v);
+      m_rawpos += v;
+      message->origin = origin;
+      message->text = (char*) m_text.c_str();
+      break;
+      }
+
+    default:
+      return false;
+    }
+
+  m_rawcount--;
+  return true;
+  }
+
+size_t canformat_ovbl::put(CAN_log_message_t* message, uint8_t *buffer, size_t len, bool* hasmore, canlogconnection* clc)
+  {
+  if (IsServeDiscarding()) return len;  // Quick return if discarding
+
+  size_t consumed = 0;
+  if (len > 0 && m_in.size() < OVBL_INPUT_MAXLEN)
+    {
+    consumed = MIN(len, OVBL_INPUT_MAXLEN - m_in.size());
+    m_in.append((const char*)buffer, consumed);
+    }
+
+  // Deliver the next record, one per call:
+  while (m_rawcount > 0 || OpenInputBlock())
+    {
+    if (DecodeRecord(message))
+      {
+      *hasmore = true;  // Call us again to see if we have more records to process
+      break;
+      }
+    ESP_LOGW(TAG, "Corrupt block, skipping %d records", m_rawcount);
+    m_rawcount = 0;
+    }
+
+  return consumed;
+  }
@@ -0,0 +1,139 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Module:        CAN dump OVBL binary block format
+;    Date:          18th October 2026
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011        Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+#ifndef __CANFORMAT_OVBL_H__
+#define __CANFORMAT_OVBL_H__
+
+#include <sdkconfig.h>
+#include "canformat.h"
+#ifdef CONFIG_OVMS_SC_ZIP
+#include "zlib.h"
+#endif
+
+/**
+ * OVBL: compact binary block log format
+ *
+ * A log starts with an ovbl_header_t, followed by a sequence of blocks. Each
+ * block starts with an ovbl_block_t carrying the block base time, followed
+ * by the (optionally deflated) record payload. Blocks are self contained,
+ * so a reader can start at any block boundary.
+ *
+ * Record encoding (all numbers are unsigned LEB128 varints):
+ *  tag       1 byte: [7] RTR, [6:4] bus number (7 = none), [3:0] log type
+ *  tsdelta   microseconds since the previous record (or the block base time)
+ *  frames:   iddelta (zigzag delta of (MsgID << 1 | extended) to the
+ *            previous frame in the block), dlc, dlc payload bytes
+ *  status:   the CAN_status_t fields in declaration order
+ *  info:     text length, text bytes
+ *
+ * Type "ovbl" stores blocks uncompressed, "ovbl-z" deflates them (needs
+ * the zip component).
+ */
+
+#define OVBL_VERSION            1
+#define OVBL_HDR_FL_DEFLATE     0x01
+#define OVBL_BLK_MAGIC          0xB1
+#define OVBL_BLK_FL_DEFLATE     0x01
+
+#define OVBL_BLOCK_MAXCOUNT     256         // records per block
+#define OVBL_BLOCK_MAXRAW       4000        // raw payload bytes per block
+#define OVBL_BLOCK_MAXAGE       1000000     // flush age for partial blocks [us]
+#define OVBL_INPUT_MAXLEN       8192        // max buffered input (reader)
+
+typedef struct __attribute__ ((__packed__))
+  {
+  char magic[4];          /* "OVBL" */
+  uint8_t version;        /* format version */
+  uint8_t flags;          /* OVBL_HDR_FL_* */
+  uint16_t reserved;
+  uint32_t ts_sec;        /* log start time */
+  uint32_t ts_usec;
+  } ovbl_header_t;
+
+typedef struct __attribute__ ((__packed__))
+  {
+  uint8_t magic;          /* OVBL_BLK_MAGIC */
+  uint8_t flags;          /* OVBL_BLK_FL_* */
+  uint16_t count;         /* number of records */
+  uint16_t rawlen;        /* uncompressed payload length */
+  uint16_t len;           /* stored payload length */
+  uint32_t ts_sec;        /* block base time */
+  uint32_t ts_usec;
+  } ovbl_block_t;
+
+class canformat_ovbl : public canformat
+  {
+  public:
+    canformat_ovbl(const char* type);
+    virtual ~canformat_ovbl();
+
+  public:
+    virtual std::string get(CAN_log_message_t* message);
+    virtual std::string getheader(struct timeval *time);
+    virtual size_t put(CAN_log_message_t* message, uint8_t *buffer, size_t len, bool* hasmore, canlogconnection* clc=NULL);
+
+  public:
+    virtual bool IsBuffered();
+    virtual std::string flush(bool force=false, uint32_t* records=NULL, struct timeval* first=NULL);
+
+  protected:
+    void CloseBlock();
+    bool OpenInputBlock();
+    bool DecodeRecord(CAN_log_message_t* message);
+
+  protected:
+    bool                m_deflate;
+
+    // Writer state:
+    std::string         m_block;          // raw payload of the current block
+    uint16_t            m_count;
+    struct timeval      m_base;
+    uint64_t            m_last_ts;
+    uint32_t            m_last_id;
+    std::string         m_out;            // completed blocks
+    uint32_t            m_outcount;       // records in m_out
+    struct timeval      m_outtime;        // base time of the first block in m_out
+
+    // Reader state:
+    std::string         m_in;             // buffered input
+    std::string         m_raw;            // payload of the current input block
+    size_t              m_rawpos;
+    uint16_t            m_rawcount;
+    uint64_t            m_in_ts;
+    uint32_t            m_in_id;
+    std::string         m_text;           // text of the last info record
+
+#ifdef CONFIG_OVMS_SC_ZIP
+    z_stream            m_zdef;
+    z_stream            m_zinf;
+    bool                m_zdef_ok;
+    bool                m_zinf_ok;
+#endif
+  };
+
+#endif // __CANFORMAT_OVBL_H__
@@ -28,6 +28,7 @@
 static const char *TAG = "canformat-panda";
 
 #include <errno.h>
+#include <sys/param.h>
 #include "pcp.h"
 #include "canlog.h"
 #include "canformat_panda.h"
@@ -55,6 +56,18 @@ canformat_panda::~canformat_panda()
   }
 
 std::string canformat_panda::get(CAN_log_message_t* message)
+  {
+  uint8_t buf[CANFORMAT_PANDA_LEN];
+  size_t len = encode(message, buf, sizeof(buf));
+  return std::string((char*)buf, len);
+  }
+
+size_t canformat_panda::GetMaxLength()
+  {
+  return CANFORMAT_PANDA_LEN;
+  }
+
+size_t canformat_panda::encode(CAN_log_message_t* message, uint8_t* buffer, size_t size)
   {
   struct
     {
@@ -67,13 +80,18 @@ std::string canformat_panda::get(CAN_log_message_t* message)
     {
     case CAN_LogFrame_RX:
     case CAN_LogFrame_TX:
-      packet.w1 = (uint32_t)message->frame.MsgID <<21;
-      packet.w2 = (message->frame.FIR.B.DLC & 0x0f) | (message->origin->m_busnumber << 4);
+      if (message->frame.FIR.B.FF == CAN_frame_ext)
+        packet.w1 = ((uint32_t)message->frame.MsgID << 3) | CANFORMAT_PANDA_FL_EXT;
+      else
+        packet.w1 = (uint32_t)message->frame.MsgID <<21;
+      packet.w2 = (message->frame.FIR.B.DLC & 0x0f) |
+        (((message->origin != NULL) ? message->origin->m_busnumber : 0) << 4);
       memcpy(&packet.data, message->frame.data.u8, 8);
-      return std::string((char*)&packet,sizeof(packet));
+      memcpy(buffer, &packet, sizeof(packet));
+      return sizeof(packet);
 
     default:
-      return std::string("");
+      return 0;
     }
   }
 
@@ -86,3 +104,34 @@ size_t canformat_panda::put(CAN_log_message_t* message, uint8_t *buffer, size_t
   {
   return len; // Just ignore incoming data
   }
+
+size_t canformat_panda::decode(CAN_log_message_t* message, const uint8_t* buffer, size_t len, canlogconnection* clc)
+  {
+  struct
+    {
+    uint32_t w1;
+    uint32_t w2;
+    uint64_t data;
+    } packet;
+
+  if (len < sizeof(packet)) return 0; // Insufficient data so far
+  memcpy(&packet, buffer, sizeof(packet));
+
+  message->type = CAN_LogFrame_RX;
+  gettimeofday(&message->timestamp,NULL);
+  if (packet.w1 & CANFORMAT_PANDA_FL_EXT)
+    {
+    message->frame.FIR.B.FF = CAN_frame_ext;
+    message->frame.MsgID = packet.w1 >> 3;
+    }
+  else
+    {
+    message->frame.FIR.B.FF = CAN_frame_std;
+    message->frame.MsgID = packet.w1 >> 21;
+    }
+  message->frame.FIR.B.DLC = MIN(packet.w2 & 0x0f, 8);
+  memcpy(message->frame.data.u8, &packet.data, 8);
+  message->origin = MyCan.GetBus((packet.w2 >> 4) & 0x0f);
+
+  return sizeof(packet);
+  }
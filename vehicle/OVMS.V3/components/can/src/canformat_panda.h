@@ -29,6 +29,9 @@
 
 #include "canformat.h"
 
+#define CANFORMAT_PANDA_LEN 16
+#define CANFORMAT_PANDA_FL_EXT 0x00000004
+
 class canformat_panda : public canformat
   {
   public:
@@ -39,6 +42,11 @@ class canformat_panda : public canformat
     virtual std::string get(CAN_log_message_t* message);
     virtual std::string getheader(struct timeval *time);
     virtual size_t put(CAN_log_message_t* message, uint8_t *buffer, size_t len, bool* hasmore, canlogconnection* clc=NULL);
+
+  public:
+    virtual size_t GetMaxLength();
+    virtual size_t encode(CAN_log_message_t* message, uint8_t* buffer, size_t size);
+    virtual size_t decode(CAN_log_message_t* message, const uint8_t* buffer, size_t len, canlogconnection* clc=NULL);
   };
 
 #endif // __CANFORMAT_PANDA_H__
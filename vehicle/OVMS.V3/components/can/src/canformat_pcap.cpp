@@ -30,6 +30,7 @@ static const char *TAG = "canformat-pcap";
 #include "canformat_pcap.h"
 #include <errno.h>
 #include <endian.h>
+#include <sys/param.h>
 #include "pcp.h"
 
 class OvmsCanFormatPCAPInit
@@ -56,28 +57,40 @@ canformat_pcap::~canformat_pcap()
 std::string canformat_pcap::get(CAN_log_message_t* message)
   {
   pcaprec_can_t m;
+  size_t len = encode(message, (uint8_t*)&m, sizeof(m));
+  return std::string((const char*)&m, len);
+  }
+
+size_t canformat_pcap::GetMaxLength()
+  {
+  return sizeof(pcaprec_can_t);
+  }
+
+size_t canformat_pcap::encode(CAN_log_message_t* message, uint8_t* buffer, size_t size)
+  {
+  pcaprec_can_t* m = (pcaprec_can_t*)buffer;
 
   if (message->type != CAN_LogFrame_RX)
     {
-    return std::string("");
+    return 0;
     }
 
-  memset(&m,0,sizeof(m));
+  memset(m,0,sizeof(*m));
 
-  m.hdr.ts_sec = htobe32(message->timestamp.tv_sec);
-  m.hdr.ts_usec = htobe32(message->timestamp.tv_usec);
-  m.hdr.incl_len = htobe32(16);
-  m.hdr.orig_len = htobe32(16);
+  m->hdr.ts_sec = htobe32(message->timestamp.tv_sec);
+  m->hdr.ts_usec = htobe32(message->timestamp.tv_usec);
+  m->hdr.incl_len = htobe32(16);
+  m->hdr.orig_len = htobe32(16);
 
   uint32_t idfl = message->frame.MsgID;
   if (message->frame.FIR.B.FF == CAN_frame_ext) idfl |= CANFORMAT_PCAP_FL_EXT;
   if (message->frame.FIR.B.RTR == CAN_RTR) idfl |= CANFORMAT_PCAP_FL_RTR;
-  m.phdr.idflags = htobe32(idfl);
-  m.phdr.len = message->frame.FIR.B.DLC;
+  m->phdr.idflags = htobe32(idfl);
+  m->phdr.len = message->frame.FIR.B.DLC;
 
-  memcpy(m.data, message->frame.data.u8, message->frame.FIR.B.DLC);
+  memcpy(m->data, message->frame.data.u8, message->frame.FIR.B.DLC);
 
-  return std::string((const char*)&m, sizeof(m));
+  return sizeof(*m);
   }
 
 std::string canformat_pcap::getheader(struct timeval *time)
@@ -102,6 +115,25 @@ std::string canformat_pcap::getheader(struct timeval *time)
   }
 
 size_t canformat_pcap::put(CAN_log_message_t* message, uint8_t *buffer, size_t len, bool* hasmore, canlogconnection* clc)
+  {
+  if (m_buf.FreeSpace()==0) SetServeDiscarding(true); // Buffer full, so discard from now on
+  if (IsServeDiscarding()) return len;  // Quick return if discarding
+
+  size_t consumed = Stuff(buffer,len);  // Stuff m_buf with as much as possible
+
+  pcaprec_can_t m;
+  size_t avail = m_buf.Peek(sizeof(m),(uint8_t*)&m);
+  size_t used = decode(message, (uint8_t*)&m, avail, clc);
+  if (used > 0)
+    {
+    m_buf.Pop(MIN(used,avail),(uint8_t*)&m);
+    *hasmore = true;  // Call us again to see if we have more frames to process
+    }
+
+  return consumed;
+  }
+
+size_t canformat_pcap::decode(CAN_log_message_t* message, const uint8_t* buffer, size_t len, canlogconnection* clc)
   {
   union
     {
@@ -109,16 +141,10 @@ size_t canformat_pcap::put(CAN_log_message_t* message, uint8_t *buffer, size_t l
     pcaprec_can_t record;
     } m;
 
-  if (m_buf.FreeSpace()==0) SetServeDiscarding(true); // Buffer full, so discard from now on
-  if (IsServeDiscarding()) return len;  // Quick return if discarding
-
-  size_t consumed = Stuff(buffer,len);  // Stuff m_buf with as much as possible
-
-  if (m_buf.UsedSpace() < 24) return consumed; // Insufficient data so far
+  if (len < sizeof(pcap_hdr_t)) return 0; // Insufficient data so far
 
   // At this point, we have our 24 bytes...
-  *hasmore = true;  // Call us again to see if we have more frames to process
-  m_buf.Peek(24,(uint8_t*)&m);
+  memcpy(&m,buffer,sizeof(pcap_hdr_t));
   uint32_t magic = be32toh(m.header.magic_number);
   if (magic == 0xa1b2c3d4)
     {
@@ -127,9 +153,9 @@ size_t canformat_pcap::put(CAN_log_message_t* message, uint8_t *buffer, size_t l
       {
       ESP_LOGE(TAG,"PCAP header network != 0xe3: Discarding");
       SetServeDiscarding(true);
-      return consumed;
+      return len;
       }
-    m_buf.Pop(24,(uint8_t*)&m);
+    return sizeof(pcap_hdr_t);
     }
   else if ((magic == 0xd4c3b2a1)||
            (magic == 0xa1b23c4d)||
@@ -137,20 +163,22 @@ size_t canformat_pcap::put(CAN_log_message_t* message, uint8_t *buffer, size_t l
     {
     ESP_LOGE(TAG,"pcap format %08" PRIx32 " not supported: Discarding",magic);
     SetServeDiscarding(true);
-    return consumed;
+    return len;
     }
 
-  if (m_buf.UsedSpace() < sizeof(pcaprec_can_t)) return consumed; // Insufficient data so far
+  if (len < sizeof(pcaprec_can_t)) return 0; // Insufficient data so far
 
-  m_buf.Pop(sizeof(pcaprec_can_t), (uint8_t*)&m);
+  memcpy(&m.record,buffer,sizeof(pcaprec_can_t));
 
   uint32_t idf = be32toh(m.record.phdr.idflags);
-  if (idf & CANFORMAT_PCAP_FL_MSG)
+  if ((idf & CANFORMAT_PCAP_FL_MSG)||(m.record.phdr.len > 8))
     {
     // Just ignore it
-    return consumed;
+    return sizeof(pcaprec_can_t);
     }
   message->type = CAN_LogFrame_RX;
+  message->timestamp.tv_sec = be32toh(m.record.hdr.ts_sec);
+  message->timestamp.tv_usec = be32toh(m.record.hdr.ts_usec);
   message->frame.FIR.B.RTR = (idf & CANFORMAT_PCAP_FL_RTR)?CAN_RTR:CAN_no_RTR;
   message->frame.FIR.B.FF = (idf & CANFORMAT_PCAP_FL_EXT)?CAN_frame_ext:CAN_frame_std;
   message->frame.MsgID = idf & CANFORMAT_PCAP_FL_MASK;
@@ -158,5 +186,5 @@ size_t canformat_pcap::put(CAN_log_message_t* message, uint8_t *buffer, size_t l
   message->frame.FIR.B.DLC = m.record.phdr.len;
   memcpy(message->frame.data.u8, m.record.data, m.record.phdr.len);
 
-  return consumed;
+  return sizeof(pcaprec_can_t);
   }
@@ -56,9 +56,21 @@ canformat_raw::~canformat_raw()
 std::string canformat_raw::get(CAN_log_message_t* message)
   {
   CAN_log_message_t raw;
-  memcpy(&raw,message,sizeof(raw));
-  raw.origin = (canbus*)raw.origin->m_busnumber;
-  return std::string((const char*)&raw,sizeof(CAN_log_message_t));
+  size_t len = encode(message, (uint8_t*)&raw, sizeof(raw));
+  return std::string((const char*)&raw, len);
+  }
+
+size_t canformat_raw::GetMaxLength()
+  {
+  return sizeof(CAN_log_message_t);
+  }
+
+size_t canformat_raw::encode(CAN_log_message_t* message, uint8_t* buffer, size_t size)
+  {
+  CAN_log_message_t* raw = (CAN_log_message_t*)buffer;
+  memcpy(raw,message,sizeof(*raw));
+  raw->origin = (canbus*)((raw->origin != NULL) ? raw->origin->m_busnumber : 0);
+  return sizeof(*raw);
   }
 
 std::string canformat_raw::getheader(struct timeval *time)
@@ -80,3 +92,12 @@ size_t canformat_raw::put(CAN_log_message_t* message, uint8_t *buffer, size_t le
   message->origin = MyCan.GetBus((int)message->origin);
   return consumed;
   }
+
+size_t canformat_raw::decode(CAN_log_message_t* message, const uint8_t* buffer, size_t len, canlogconnection* clc)
+  {
+  if (len < sizeof(CAN_log_message_t)) return 0; // Insufficient data so far
+
+  memcpy(message, buffer, sizeof(CAN_log_message_t));
+  message->origin = MyCan.GetBus((int)message->origin);
+  return sizeof(CAN_log_message_t);
+  }
@@ -35,6 +35,8 @@ static const char *TAG = "canlog";
 #include <string>
 #include <sstream>
 #include <iomanip>
+#include "esp_timer.h"
+#include "ovms_malloc.h"
 #include "ovms_utils.h"
 #include "ovms_config.h"
 #include "ovms_command.h"
@@ -44,6 +46,11 @@ static const char *TAG = "canlog";
 
 static const char *CAN_PARAM = "can";
 
+canpool MyCanLogTextPool __attribute__ ((init_priority (4540)))
+  ("canlog text", CANLOG_TEXTPOOL_BLOCKSIZE, CANLOG_TEXTPOOL_COUNT);
+canpool MyCanLogStatusPool __attribute__ ((init_priority (4540)))
+  ("canlog status", sizeof(CAN_status_t), CANLOG_STATUSPOOL_COUNT);
+
 ////////////////////////////////////////////////////////////////////////
 // Command Processing
 ////////////////////////////////////////////////////////////////////////
@@ -164,6 +171,318 @@ void can_log_list(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc,
     }
   }
 
+// Benchmark helper: parse the sample rounds times, per message (put) or batched (putbatch)
+static int64_t can_log_benchmark_parse(canformat* formatter, const std::string& sample, int rounds,
+  CAN_log_message_t* msgs, size_t count, bool batch, uint32_t* parsed)
+  {
+  uint8_t* data = (uint8_t*)sample.data();
+  size_t len = sample.size();
+  *parsed = 0;
+
+  int64_t started = esp_timer_get_time();
+  for (int r = 0; r < rounds; r++)
+    {
+    size_t pos = 0;
+    if (batch)
+      {
+      while (pos < len)
+        {
+        size_t n;
+        size_t used = formatter->putbatch(msgs, count, data + pos, len - pos, &n);
+        pos += used;
+        *parsed += n;
+        if (used == 0 && n == 0) break;
+        }
+      }
+    else
+      {
+      bool hasmore = true;
+      while (pos < len || hasmore)
+        {
+        memset(msgs, 0, sizeof(CAN_log_message_t));
+        hasmore = false;
+        size_t used = formatter->put(msgs, data + pos, len - pos, &hasmore);
+        pos += used;
+        if (msgs->type != CAN_LogNone) (*parsed)++;
+        if (used == 0 && !hasmore) break;
+        }
+      }
+    }
+  return esp_timer_get_time() - started;
+  }
+
+void can_log_benchmark(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  int frames = 10000;
+  if (argc>0) frames = atoi(argv[0]);
+  if (frames <= 0)
+    {
+    writer->puts("Error: invalid frame count");
+    return;
+    }
+
+  canbus* bus = MyCan.GetBus(0);
+  if (bus == NULL)
+    {
+    writer->puts("Error: Cannot find can1");
+    return;
+    }
+
+  // Run synthetic frames through the logger pipeline (ring, batch formatting)
+  // for each format, excluding the connection output, and compare the
+  // per message and batch conversion APIs:
+  uint32_t batchsize = MAX(1, MyConfig.GetParamValueInt(CAN_PARAM, "log.batchsize",32));
+  canlog_ring ring(batchsize);
+  canlog_batch batch(batchsize);
+  CAN_log_record_t* recs = (CAN_log_record_t*) InternalRamMalloc(batchsize * sizeof(CAN_log_record_t));
+  CAN_log_message_t* msgs = (CAN_log_message_t*) ExternalRamMalloc(batchsize * sizeof(CAN_log_message_t));
+  if (recs == NULL || msgs == NULL || !ring.IsValid())
+    {
+    writer->puts("Error: out of memory");
+    if (recs) free(recs);
+    if (msgs) free(msgs);
+    return;
+    }
+
+  CAN_log_record_t rec;
+  memset(&rec, 0, sizeof(rec));
+  rec.type = CAN_LogFrame_RX;
+  rec.origin = bus;
+  rec.FIR.B.DLC = 8;
+  rec.FIR.B.FF = CAN_frame_std;
+
+  for (uint32_t i = 0; i < batchsize; i++)
+    {
+    gettimeofday(&rec.timestamp, NULL);
+    rec.MsgID = i % 2048;
+    uint64_t payload = i+1;
+    memcpy(rec.data.u8, &payload, 8);
+    canlog::Expand(rec, msgs[i]);
+    }
+  int rounds = MAX(1, frames / (int)batchsize);
+
+  writer->printf("Logging %d frames in batches of %" PRIu32 " on %s\n", frames, batchsize, bus->GetName());
+  writer->printf("%-10s %8s %8s %8s %8s %8s %8s\n", "Format", "pipeline", "get", "getbatch", "put", "putbatch", "bytes");
+
+  for (auto it = MyCanFormatFactory.m_fmap.begin(); it != MyCanFormatFactory.m_fmap.end(); ++it)
+    {
+    canformat* formatter = MyCanFormatFactory.NewFormat(it->first);
+    if (formatter == NULL) continue;
+
+    // Logger pipeline:
+    size_t bytes = 0;
+    int64_t started = esp_timer_get_time();
+    for (int k = 0; k < frames; )
+      {
+      uint32_t count = MIN(batchsize, (uint32_t)(frames - k));
+      for (uint32_t i = 0; i < count; i++, k++)
+        {
+        gettimeofday(&rec.timestamp, NULL);
+        rec.MsgID = k % 2048;
+        uint64_t payload = k+1;
+        memcpy(rec.data.u8, &payload, 8);
+        ring.Push(rec);
+        }
+      count = ring.Pop(recs, count);
+      batch.Clear();
+      canlog::Format(formatter, recs, count, batch);
+      bytes += batch.Length();
+      }
+    bytes += formatter->flush(true).size();
+    int64_t t_pipeline = esp_timer_get_time() - started;
+
+    // Per message conversion, collecting one batch as the parser sample:
+    std::string sample = formatter->getheader();
+    started = esp_timer_get_time();
+    for (int r = 0; r < rounds; r++)
+      {
+      for (uint32_t i = 0; i < batchsize; i++)
+        {
+        std::string result = formatter->get(&msgs[i]);
+        if (r == 0) sample.append(result);
+        }
+      }
+    sample.append(formatter->flush(true));
+    int64_t t_get = esp_timer_get_time() - started;
+
+    // Batch conversion:
+    int64_t t_getbatch = 0;
+    size_t maxlen = formatter->GetMaxLength();
+    uint8_t* buf = (maxlen) ? (uint8_t*) ExternalRamMalloc(batchsize * maxlen) : NULL;
+    if (buf)
+      {
+      started = esp_timer_get_time();
+      for (int r = 0; r < rounds; r++)
+        {
+        size_t length;
+        formatter->getbatch(msgs, batchsize, buf, batchsize * maxlen, &length);
+        }
+      t_getbatch = esp_timer_get_time() - started;
+      free(buf);
+      }
+    delete formatter;
+
+    // Parsing:
+    uint32_t n_put = 0, n_putbatch = 0;
+    int64_t t_put = 0, t_putbatch = 0;
+    CAN_log_message_t msg;
+    formatter = MyCanFormatFactory.NewFormat(it->first);
+    formatter->SetServeMode(canformat::Simulate);
+    t_put = can_log_benchmark_parse(formatter, sample, rounds, &msg, 1, false, &n_put);
+    delete formatter;
+    if (maxlen)
+      {
+      formatter = MyCanFormatFactory.NewFormat(it->first);
+      formatter->SetServeMode(canformat::Simulate);
+      t_putbatch = can_log_benchmark_parse(formatter, sample, rounds, msgs, batchsize, true, &n_putbatch);
+      delete formatter;
+      }
+
+    char s_getbatch[12] = "-", s_put[12] = "-", s_putbatch[12] = "-";
+    uint32_t n_get = rounds * batchsize;
+    if (buf) snprintf(s_getbatch, sizeof(s_getbatch), "%.2f", (float) t_getbatch / n_get);
+    if (n_put) snprintf(s_put, sizeof(s_put), "%.2f", (float) t_put / n_put);
+    if (n_putbatch) snprintf(s_putbatch, sizeof(s_putbatch), "%.2f", (float) t_putbatch / n_putbatch);
+    writer->printf("%-10s %8.2f %8.2f %8s %8s %8s %8.1f\n", it->first,
+      (float) t_pipeline / frames,
+      (float) t_get / n_get,
+      s_getbatch, s_put, s_putbatch,
+      (float) bytes / frames);
+    }
+
+  writer->puts("(times in us per frame, bytes per frame; '-' = not supported)");
+  free(recs);
+  free(msgs);
+  }
+
+// Self test helper: compare a decoded frame to the original, returns the mismatch or NULL
+static const char* can_log_selftest_compare(const CAN_log_message_t& a, const CAN_log_message_t& b)
+  {
+  if (b.type != CAN_LogFrame_RX) return "type";
+  if (b.origin != a.origin) return "bus";
+  if (b.frame.MsgID != a.frame.MsgID) return "id";
+  if (b.frame.FIR.B.FF != a.frame.FIR.B.FF) return "id format";
+  if (b.frame.FIR.B.DLC != a.frame.FIR.B.DLC) return "length";
+  if (memcmp(b.frame.data.u8, a.frame.data.u8, a.frame.FIR.B.DLC) != 0) return "data";
+  return NULL;
+  }
+
+void can_log_selftest(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  canbus* bus = MyCan.GetBus(0);
+  if (bus == NULL)
+    {
+    writer->puts("Error: Cannot find can1");
+    return;
+    }
+
+  // Test set: standard & extended IDs at the range limits, all lengths:
+  const size_t count = 36;
+  CAN_log_message_t* msgs = (CAN_log_message_t*) ExternalRamMalloc(2 * count * sizeof(CAN_log_message_t));
+  if (msgs == NULL)
+    {
+    writer->puts("Error: out of memory");
+    return;
+    }
+  CAN_log_message_t* parsed = msgs + count;
+  memset(msgs, 0, 2 * count * sizeof(CAN_log_message_t));
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  for (size_t i = 0; i < count; i++)
+    {
+    CAN_log_message_t& m = msgs[i];
+    bool ext = (i >= count / 2);
+    m.type = CAN_LogFrame_RX;
+    m.origin = bus;
+    m.timestamp = tv;
+    m.timestamp.tv_usec = (tv.tv_usec + i * 1000) % 1000000;
+    m.frame.origin = bus;
+    m.frame.FIR.B.FF = ext ? CAN_frame_ext : CAN_frame_std;
+    m.frame.FIR.B.DLC = i % 9;
+    if (i % 9 == 0)
+      m.frame.MsgID = ext ? 0x1fffffff : 0x7ff;
+    else if (i % 9 == 1)
+      m.frame.MsgID = 0;
+    else
+      m.frame.MsgID = ext ? (0x18daf100 + i) : (0x700 + i);
+    for (int k = 0; k < 8; k++)
+      m.frame.data.u8[k] = (k < m.frame.FIR.B.DLC) ? (uint8_t)(0x11 * k + i) : 0;
+    }
+
+  // Encode via get(), decode via put() and putbatch(), compare frame content
+  // (timestamps are not compared, as not all formats carry them):
+  writer->printf("Round trip of %d frames on %s:\n", (int)count, bus->GetName());
+  int failed = 0;
+  for (auto it = MyCanFormatFactory.m_fmap.begin(); it != MyCanFormatFactory.m_fmap.end(); ++it)
+    {
+    canformat* formatter = MyCanFormatFactory.NewFormat(it->first);
+    if (formatter == NULL) continue;
+    std::string data = formatter->getheader(&tv);
+    for (size_t i = 0; i < count; i++)
+      data.append(formatter->get(&msgs[i]));
+    data.append(formatter->flush(true));
+    bool batch = (formatter->GetMaxLength() != 0);
+    delete formatter;
+
+    std::string result;
+    for (int pass = 0; pass < (batch ? 2 : 1) && result.empty(); pass++)
+      {
+      formatter = MyCanFormatFactory.NewFormat(it->first);
+      formatter->SetServeMode(canformat::Simulate);
+      uint8_t* buf = (uint8_t*)data.data();
+      size_t len = data.size(), pos = 0, n = 0;
+      if (pass == 0)
+        {
+        bool hasmore = true;
+        while ((pos < len || hasmore) && n < count)
+          {
+          memset(&parsed[n], 0, sizeof(CAN_log_message_t));
+          hasmore = false;
+          size_t used = formatter->put(&parsed[n], buf + pos, len - pos, &hasmore);
+          pos += used;
+          if (parsed[n].type != CAN_LogNone) n++;
+          if (used == 0 && !hasmore) break;
+          }
+        }
+      else
+        {
+        while (pos < len && n < count)
+          {
+          size_t got;
+          size_t used = formatter->putbatch(parsed + n, count - n, buf + pos, len - pos, &got);
+          pos += used;
+          n += got;
+          if (used == 0 && got == 0) break;
+          }
+        }
+      delete formatter;
+
+      const char* api = (pass == 0) ? "put" : "putbatch";
+      if (n != count)
+        {
+        result = string_format("FAIL: %s decoded %d of %d frames", api, (int)n, (int)count);
+        break;
+        }
+      for (size_t i = 0; i < count; i++)
+        {
+        const char* diff = can_log_selftest_compare(msgs[i], parsed[i]);
+        if (diff)
+          {
+          result = string_format("FAIL: %s frame #%d (id %" PRIx32 " len %d): %s differs",
+            api, (int)i, msgs[i].frame.MsgID, msgs[i].frame.FIR.B.DLC, diff);
+          break;
+          }
+        }
+      }
+
+    if (!result.empty()) failed++;
+    writer->printf("%-10s %s\n", it->first, result.empty() ? "OK" : result.c_str());
+    }
+
+  writer->printf("%s\n", failed ? "Self test FAILED" : "Self test passed");
+  free(msgs);
+  }
+
 ////////////////////////////////////////////////////////////////////////
 // CAN Logging System initialisation
 ////////////////////////////////////////////////////////////////////////
@@ -188,6 +507,8 @@ OvmsCanLogInit::OvmsCanLogInit()
   cmd_canlog->RegisterCommand("stop", "Stop logging", can_log_stop,"[<id>]",0,1);
   cmd_canlog->RegisterCommand("status", "Logging status", can_log_status,"[<id>]",0,1);
   cmd_canlog->RegisterCommand("list", "Logging list", can_log_list);
+  cmd_canlog->RegisterCommand("benchmark", "Logging throughput per format", can_log_benchmark,"[<frames>]",0,1);
+  cmd_canlog->RegisterCommand("selftest", "Format encode/decode round trip check", can_log_selftest);
   cmd_canlog->RegisterCommand("start", "CAN logging start framework");
   }
 
@@ -208,6 +529,7 @@ canlogconnection::canlogconnection(canlog* logger, std::string format, canformat
   m_dropcount = 0;
   m_discardcount = 0;
   m_filtercount = 0;
+  m_maxwrite = 0;
   }
 
 canlogconnection::~canlogconnection()
@@ -224,39 +546,87 @@ canlogconnection::~canlogconnection()
     }
   }
 
-void canlogconnection::OutputMsg(CAN_log_message_t& msg, std::string &result)
+bool canlogconnection::IsFiltered(const CAN_log_record_t& rec)
   {
-  m_msgcount++;
+  if (m_filters == NULL) return true;
+  switch (rec.type)
+    {
+    case CAN_LogFrame_RX:
+    case CAN_LogFrame_TX:
+    case CAN_LogFrame_TX_Queue:
+    case CAN_LogFrame_TX_Fail:
+      {
+      CAN_frame_t frame;
+      frame.origin = rec.origin;
+      frame.MsgID = rec.MsgID;
+      return m_filters->IsFiltered(&frame);
+      }
+    default:
+      return m_filters->IsFiltered(rec.origin);
+    }
+  }
 
-  if ((m_filters != NULL) && (! m_filters->IsFiltered(&msg.frame)))
+void canlogconnection::OutputBatch(canlog_batch& batch)
+  {
+  // Coalesce runs of accepted entries into single writes:
+  const char* data = batch.Data();
+  size_t runstart = 0, runlen = 0;
+  uint32_t runcount = 0;
+
+  for (canlog_batch::entry_t& entry : batch.m_entries)
     {
-    m_filtercount++;
-    return;
+    if (entry.rec.type != CAN_LogNone) m_msgcount++;
+
+    if (!IsFiltered(entry.rec))
+      {
+      m_filtercount++;
+      if (runlen > 0) OutputData(data+runstart, runlen, runcount);
+      runlen = 0;
+      runcount = 0;
+      continue;
+      }
+
+    if (entry.length == 0)
+      continue;
+
+    if (runlen > 0 && m_maxwrite > 0 && runlen + entry.length > m_maxwrite)
+      {
+      OutputData(data+runstart, runlen, runcount);
+      runlen = 0;
+      runcount = 0;
+      }
+
+    if (runlen == 0) runstart = entry.offset;
+    runlen += entry.length;
+    runcount += entry.count;
     }
 
+  if (runlen > 0) OutputData(data+runstart, runlen, runcount);
+  }
+
+void canlogconnection::OutputData(const char* data, size_t len, uint32_t count)
+  {
 #ifdef CONFIG_OVMS_SC_GPL_MONGOOSE
   // The standard base implemention here is for mongoose network connections
-  if (m_nc != NULL)
+  if ((m_nc != NULL) && (m_nc->send_mbuf.len < 32768))
     {
-    if (result.length()>0)
-      {
-      if (m_nc->send_mbuf.len < 32768)
-        {
-        mg_send(m_nc, (const char*)result.c_str(), result.length());
-        }
-      else
-        {
-        m_dropcount++;
-        }
-      }
+    mg_send(m_nc, data, len);
     }
   else
 #endif // CONFIG_OVMS_SC_GPL_MONGOOSE
     {
-    m_dropcount++;
+    m_dropcount += count;
     }
   }
 
+/**
+ * OutputFlush: send data held back by the connection
+ *  force=false: only if due, force=true: all (i.e. on close)
+ */
+void canlogconnection::OutputFlush(bool force)
+  {
+  }
+
 void canlogconnection::TransmitCallback(uint8_t *buffer, size_t len)
   {
   ESP_LOGD(TAG,"TransmitCallback on %s (%d bytes)",m_peer.c_str(),len);
@@ -307,6 +677,13 @@ void canlogconnection::ClearFilters()
 
 void canlogconnection::AddFilter(std::string& filter)
   {
+  if (m_logger && m_logger->m_formatter && m_logger->m_formatter->IsBuffered())
+    {
+    // Block formats encode all records into shared blocks, a block can't
+    // be filtered per connection:
+    ESP_LOGW(TAG,"Remote CAN bus filter not supported by format %s: %s", m_logger->GetFormat(), filter.c_str());
+    return;
+    }
   ESP_LOGI(TAG,"Remote CAN bus add filter: %s", filter.c_str());
   if (!m_filters) m_filters = new canfilter();
   m_filters->AddFilter(filter.c_str());
@@ -333,6 +710,234 @@ std::string canlogconnection::GetStats()
   }
 
 
+////////////////////////////////////////////////////////////////////////
+// CAN Logger record ring & batch buffer
+////////////////////////////////////////////////////////////////////////
+
+canlog_ring::canlog_ring(uint32_t size)
+  {
+  uint32_t cap = 16;
+  while (cap < size) cap <<= 1;
+  m_buf = (CAN_log_record_t*) InternalRamMalloc(cap * sizeof(CAN_log_record_t));
+  while (m_buf == NULL && cap > 16)
+    {
+    // Fall back to a smaller ring:
+    cap >>= 1;
+    m_buf = (CAN_log_record_t*) InternalRamMalloc(cap * sizeof(CAN_log_record_t));
+    }
+  m_mask = (m_buf) ? cap - 1 : 0;
+  m_head.store(0);
+  m_tail.store(0);
+  m_peak = 0;
+  m_lock = portMUX_INITIALIZER_UNLOCKED;
+  }
+
+canlog_ring::~canlog_ring()
+  {
+  free(m_buf);
+  }
+
+/**
+ * Push: add a record to the ring
+ *  Returns the new fill level, or 0 if the ring is full.
+ */
+uint32_t canlog_ring::Push(const CAN_log_record_t& rec)
+  {
+  uint32_t fill = 0;
+  if (m_buf == NULL) return 0;
+  portENTER_CRITICAL(&m_lock);
+  uint32_t head = m_head.load(std::memory_order_relaxed);
+  uint32_t tail = m_tail.load(std::memory_order_acquire);
+  if (head - tail <= m_mask)
+    {
+    m_buf[head & m_mask] = rec;
+    m_head.store(head + 1, std::memory_order_release);
+    fill = head + 1 - tail;
+    if (fill > m_peak) m_peak = fill;
+    }
+  portEXIT_CRITICAL(&m_lock);
+  return fill;
+  }
+
+/**
+ * Pop: take up to max records from the ring (consumer only)
+ */
+uint32_t canlog_ring::Pop(CAN_log_record_t* recs, uint32_t max)
+  {
+  uint32_t tail = m_tail.load(std::memory_order_relaxed);
+  uint32_t head = m_head.load(std::memory_order_acquire);
+  uint32_t count = MIN(head - tail, max);
+  for (uint32_t i = 0; i < count; i++)
+    recs[i] = m_buf[(tail + i) & m_mask];
+  m_tail.store(tail + count, std::memory_order_release);
+  return count;
+  }
+
+canlog_batch::canlog_batch(uint32_t size)
+  {
+  m_entries.reserve(size);
+  m_data.reserve(size * 64);
+  m_reserved = 0;
+  }
+
+canlog_batch::~canlog_batch()
+  {
+  }
+
+void canlog_batch::Clear()
+  {
+  m_entries.clear();
+  m_data.clear();
+  }
+
+/**
+ * Reserve: get a write pointer for up to len bytes of entry data, to be
+ *  finalized by Commit() (with the actual length) before the next Add/Reserve
+ */
+uint8_t* canlog_batch::Reserve(size_t len)
+  {
+  m_reserved = m_data.size();
+  m_data.resize(m_reserved + len);
+  return (uint8_t*) &m_data[m_reserved];
+  }
+
+void canlog_batch::Commit(const CAN_log_record_t& rec, size_t len)
+  {
+  entry_t entry;
+  entry.rec = rec;
+  entry.offset = m_reserved;
+  entry.length = len;
+  entry.count = 1;
+  m_entries.push_back(entry);
+  m_data.resize(m_reserved + len);
+  }
+
+void canlog_batch::Add(const CAN_log_record_t& rec, const char* data, size_t len, uint32_t count)
+  {
+  entry_t entry;
+  entry.rec = rec;
+  entry.offset = m_data.size();
+  entry.length = len;
+  entry.count = count;
+  m_entries.push_back(entry);
+  if (len) m_data.append(data, len);
+  }
+
+canlog_dedup::canlog_dedup(uint32_t heartbeat_ms)
+  {
+  m_table = (entry_t*) ExternalRamMalloc(CANLOG_DEDUP_SLOTS * sizeof(entry_t));
+  if (m_table) memset(m_table, 0, CANLOG_DEDUP_SLOTS * sizeof(entry_t));
+  m_heartbeat = (int64_t) heartbeat_ms * 1000;
+  m_drained = 0;
+  m_suppressed = 0;
+  m_repeats = 0;
+  }
+
+canlog_dedup::~canlog_dedup()
+  {
+  if (m_table)
+    {
+    free(m_table);
+    m_table = NULL;
+    }
+  }
+
+uint32_t canlog_dedup::Slot(canbus* origin, uint32_t msgid)
+  {
+  uint32_t key = msgid ^ ((uint32_t)(uintptr_t)origin << 20);
+  return (key ^ (key >> 9) ^ (key >> 18)) % CANLOG_DEDUP_SLOTS;
+  }
+
+/**
+ * Repeats: create the comment record for the repeats suppressed by an entry
+ */
+void canlog_dedup::Repeats(entry_t& entry, CAN_log_record_t& rec)
+  {
+  char text[32];
+  snprintf(text, sizeof(text), CANLOG_DEDUP_PREFIX "%" PRIX32 " %" PRIu32, entry.MsgID, entry.count);
+  memset(&rec, 0, sizeof(rec));
+  rec.type = CAN_LogInfo_Comment;
+  rec.origin = entry.origin;
+  rec.timestamp = entry.lastseen;
+  rec.data.text = MyCanLogTextPool.Strdup(text);
+  entry.count = 0;
+  m_repeats++;
+  }
+
+/**
+ * Process: filter a set of records, out needs space for 2 x count records
+ *  Returns the number of output records.
+ */
+uint32_t canlog_dedup::Process(CAN_log_record_t* recs, uint32_t count, CAN_log_record_t* out)
+  {
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < count; i++)
+    {
+    CAN_log_record_t& rec = recs[i];
+    if (rec.type != CAN_LogFrame_RX || rec.origin == NULL || m_table == NULL)
+      {
+      out[n++] = rec;
+      continue;
+      }
+
+    entry_t& e = m_table[Slot(rec.origin, rec.MsgID)];
+    uint8_t dlc = MIN(rec.FIR.B.DLC, 8);
+    if (e.origin == rec.origin && e.MsgID == rec.MsgID && e.FIR.B.FF == rec.FIR.B.FF)
+      {
+      bool same = (e.FIR.B.DLC == rec.FIR.B.DLC && memcmp(e.u8, rec.data.u8, dlc) == 0);
+      int64_t age = ((int64_t)rec.timestamp.tv_sec - e.emitted.tv_sec) * 1000000
+                  + (rec.timestamp.tv_usec - e.emitted.tv_usec);
+      if (same && (m_heartbeat == 0 || age < m_heartbeat))
+        {
+        e.count++;
+        e.lastseen = rec.timestamp;
+        m_suppressed++;
+        continue;
+        }
+      }
+    // Log the repeats of the previous payload (or of an evicted ID) first:
+    if (e.origin != NULL && e.count > 0)
+      Repeats(e, out[n++]);
+
+    e.origin = rec.origin;
+    e.MsgID = rec.MsgID;
+    e.FIR = rec.FIR;
+    memcpy(e.u8, rec.data.u8, 8);
+    e.emitted = rec.timestamp;
+    e.count = 0;
+    out[n++] = rec;
+    }
+  return n;
+  }
+
+/**
+ * Drain: output the repeat comments pending for IDs not seen within the
+ *  heartbeat interval, or for all IDs if forced (flush/close)
+ *  Returns the number of output records, call again until 0.
+ */
+uint32_t canlog_dedup::Drain(CAN_log_record_t* out, uint32_t size, bool force)
+  {
+  if (m_table == NULL || (!force && m_heartbeat == 0)) return 0;
+  // Scan the table at most every half heartbeat:
+  int64_t now = esp_timer_get_time();
+  if (!force && now - m_drained < m_heartbeat / 2) return 0;
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < CANLOG_DEDUP_SLOTS && n < size; i++)
+    {
+    entry_t& e = m_table[i];
+    if (e.origin == NULL || e.count == 0) continue;
+    int64_t age = ((int64_t)tv.tv_sec - e.emitted.tv_sec) * 1000000
+                + (tv.tv_usec - e.emitted.tv_usec);
+    if (force || age >= m_heartbeat)
+      Repeats(e, out[n++]);
+    }
+  if (n < size) m_drained = now;
+  return n;
+  }
+
+
 ////////////////////////////////////////////////////////////////////////
 // CAN Logger class
 ////////////////////////////////////////////////////////////////////////
@@ -351,6 +956,8 @@ canlog::canlog(const char* type, std::string format, canformat::canformat_serve_
   m_msgcount = 0;
   m_dropcount = 0;
   m_filtercount = 0;
+  m_batchcount = 0;
+  m_batchmsgs = 0;
 
   using std::placeholders::_1;
   using std::placeholders::_2;
@@ -360,9 +967,41 @@ canlog::canlog(const char* type, std::string format, canformat::canformat_serve_
   MyMetrics.RegisterListener(IDTAG, "*", std::bind(&canlog::MetricListener, this, _1));
 
   int queuesize = MyConfig.GetParamValueInt(CAN_PARAM, "log.queuesize",100);
+  int batchsize = MyConfig.GetParamValueInt(CAN_PARAM, "log.batchsize",32);
+  int flushtime = MyConfig.GetParamValueInt(CAN_PARAM, "log.flushtime",20);
   LoadConfig();
-  m_queue = xQueueCreate(queuesize, sizeof(CAN_log_message_t));
-  xTaskCreatePinnedToCore(RxTask, "OVMS CanLog", 4096, (void*)this, 10, &m_task, CORE(1));
+  m_ring = new canlog_ring(MAX(queuesize, 16));
+  if (m_ring->IsValid() && m_ring->Size() < (uint32_t)queuesize)
+    ESP_LOGW(TAG, "Out of memory for log.queuesize=%d, queue reduced to %" PRIu32, queuesize, m_ring->Size());
+  m_batchsize = MAX(1, MIN(batchsize, (int)m_ring->Size()/2));
+  m_flushticks = MAX(1, pdMS_TO_TICKS(flushtime));
+  m_pending = (CAN_log_record_t*) InternalRamMalloc(m_batchsize * sizeof(CAN_log_record_t));
+  if (!m_ring->IsValid() || m_pending == NULL)
+    {
+    // Open() refuses to start without a queue:
+    ESP_LOGE(TAG, "Out of memory for the log queue (log.queuesize=%d)", queuesize);
+    delete m_ring;
+    m_ring = NULL;
+    }
+  m_batch = new canlog_batch(m_batchsize);
+  if (MyConfig.GetParamValueBool(CAN_PARAM, "log.dedup", false))
+    {
+    m_dedup = new canlog_dedup(MAX(0, MyConfig.GetParamValueInt(CAN_PARAM, "log.dedup.heartbeat", 1000)));
+    m_dedupout = (CAN_log_record_t*) InternalRamMalloc(2 * m_batchsize * sizeof(CAN_log_record_t));
+    }
+  else
+    {
+    m_dedup = NULL;
+    m_dedupout = NULL;
+    }
+  // Buffering formats need a periodic flush of partial blocks:
+  m_idleticks = (m_formatter && m_formatter->IsBuffered()) ? pdMS_TO_TICKS(1000) : portMAX_DELAY;
+  // Change-only mode needs a periodic check for runs past the heartbeat:
+  if (m_dedup && m_dedup->m_heartbeat > 0)
+    m_idleticks = MIN(m_idleticks, MAX(1, pdMS_TO_TICKS(m_dedup->m_heartbeat / 1000)));
+  m_task = NULL;
+  if (m_ring)
+    xTaskCreatePinnedToCore(RxTask, "OVMS CanLog", 4096, (void*)this, 10, &m_task, CORE(1));
   }
 
 canlog::~canlog()
@@ -378,27 +1017,39 @@ canlog::~canlog()
     vTaskDelete(t);
     }
 
-  if (m_queue)
+  if (m_ring)
     {
-    QueueHandle_t q = m_queue;
-    m_queue = NULL;
+    canlog_ring* ring = m_ring;
+    m_ring = NULL;
 
-    CAN_log_message_t msg;
-    while (xQueueReceive(q, &msg, 0) == pdTRUE)
-      {
-      switch (msg.type)
-        {
-        case CAN_LogInfo_Comment:
-        case CAN_LogInfo_Config:
-        case CAN_LogInfo_Event:
-        case CAN_LogInfo_Metric:
-          free(msg.text);
-          break;
-        default:
-          break;
-        }
-      }
-    vQueueDelete(q);
+    CAN_log_record_t rec;
+    while (ring->Pop(&rec, 1) > 0)
+      Release(rec);
+    delete ring;
+    }
+
+  if (m_batch)
+    {
+    delete m_batch;
+    m_batch = NULL;
+    }
+
+  if (m_pending)
+    {
+    free(m_pending);
+    m_pending = NULL;
+    }
+
+  if (m_dedup)
+    {
+    delete m_dedup;
+    m_dedup = NULL;
+    }
+
+  if (m_dedupout)
+    {
+    free(m_dedupout);
+    m_dedupout = NULL;
     }
 
   if (m_formatter)
@@ -417,25 +1068,40 @@ canlog::~canlog()
 void canlog::RxTask(void *context)
   {
   canlog* me = (canlog*) context;
-  CAN_log_message_t msg;
   while (1)
     {
-    if (xQueueReceive(me->m_queue, &msg, (portTickType)portMAX_DELAY) == pdTRUE)
+    // Sleep until records arrive, then give the batch some time to fill up:
+    if (me->m_ring->Count() == 0)
+      ulTaskNotifyTake(pdTRUE, me->m_idleticks);
+    if (me->m_ring->Count() < me->m_batchsize)
+      ulTaskNotifyTake(pdTRUE, me->m_flushticks);
+
+    // Note: the formatter and batch buffer are shared with Flush()
+    OvmsRecMutexLock lock(&me->m_cmmutex);
+    uint32_t count;
+    while ((count = me->m_ring->Pop(me->m_pending, me->m_batchsize)) > 0)
       {
-      switch (msg.type)
+      me->m_batch->Clear();
+      if (me->m_formatter && me->m_isopen)
         {
-        case CAN_LogInfo_Comment:
-        case CAN_LogInfo_Config:
-        case CAN_LogInfo_Event:
-        case CAN_LogInfo_Metric:
-          me->OutputMsg(msg);
-          free(msg.text);
-          break;
-        default:
-          me->OutputMsg(msg);
-          break;
+        CAN_log_record_t* recs = me->m_pending;
+        if (me->m_dedup && me->m_dedupout)
+          {
+          count = me->m_dedup->Process(recs, count, me->m_dedupout);
+          recs = me->m_dedupout;
+          }
+        me->Format(me->m_formatter, recs, count, *me->m_batch);
+        me->OutputBatch(*me->m_batch);
+        }
+      else
+        {
+        me->m_dropcount += count;
+        for (uint32_t i = 0; i < count; i++)
+          Release(me->m_pending[i]);
         }
       }
+    me->DrainDedup(false);
+    me->Flush(false);
     }
   }
 
@@ -514,37 +1180,172 @@ const char* canlog::GetFormat()
   return m_format.c_str();
   }
 
-void canlog::OutputMsg(CAN_log_message_t& msg)
+/**
+ * Expand: convert a compact ring record into a full log message for the formatters
+ */
+void canlog::Expand(const CAN_log_record_t& rec, CAN_log_message_t& msg)
   {
-  if (m_formatter == NULL)
+  memset(&msg, 0, sizeof(msg));
+  msg.type = (CAN_log_type_t) rec.type;
+  msg.timestamp = rec.timestamp;
+  switch (msg.type)
     {
-    m_dropcount++;
-    return;
+    case CAN_LogStatus_Error:
+    case CAN_LogStatus_Statistics:
+      msg.origin = rec.origin;
+      if (rec.data.status) memcpy(&msg.status, rec.data.status, sizeof(CAN_status_t));
+      break;
+    case CAN_LogInfo_Comment:
+    case CAN_LogInfo_Config:
+    case CAN_LogInfo_Event:
+    case CAN_LogInfo_Metric:
+      msg.origin = rec.origin;
+      msg.text = rec.data.text;
+      break;
+    default:
+      msg.frame.origin = rec.origin;
+      msg.frame.FIR = rec.FIR;
+      msg.frame.MsgID = rec.MsgID;
+      memcpy(msg.frame.data.u8, rec.data.u8, 8);
+      break;
     }
+  }
 
-  if (!m_isopen)
+/**
+ * Release: free the pool/heap payload of a ring record
+ */
+void canlog::Release(CAN_log_record_t& rec)
+  {
+  switch (rec.type)
     {
-    m_dropcount++;
-    return;
+    case CAN_LogStatus_Error:
+    case CAN_LogStatus_Statistics:
+      MyCanLogStatusPool.Release(rec.data.status);
+      rec.data.status = NULL;
+      break;
+    case CAN_LogInfo_Comment:
+    case CAN_LogInfo_Config:
+    case CAN_LogInfo_Event:
+    case CAN_LogInfo_Metric:
+      MyCanLogTextPool.Release(rec.data.text);
+      rec.data.text = NULL;
+      break;
+    default:
+      break;
+    }
+  }
+
+/**
+ * Format: format a set of records into the batch buffer, releasing their payloads
+ */
+void canlog::Format(canformat* formatter, CAN_log_record_t* recs, uint32_t count, canlog_batch& batch)
+  {
+  CAN_log_message_t msg;
+  size_t maxlen = formatter->GetMaxLength();
+  for (uint32_t i = 0; i < count; i++)
+    {
+    Expand(recs[i], msg);
+    if (maxlen)
+      {
+      // Encode in place:
+      size_t len = formatter->encode(&msg, batch.Reserve(maxlen), maxlen);
+      Release(recs[i]);
+      batch.Commit(recs[i], len);
+      }
+    else
+      {
+      std::string result = formatter->get(&msg);
+      Release(recs[i]);
+      batch.Add(recs[i], result.data(), result.size());
+      }
     }
 
-  std::string result = m_formatter->get(&msg);
-  if (result.length()>0)
+  if (formatter->IsBuffered())
     {
-    OvmsRecMutexLock lock(&m_cmmutex);
-    for (conn_map_t::iterator it=m_connmap.begin(); it!=m_connmap.end(); ++it)
+    // Collect completed blocks. The records have been accounted for
+    // by their (empty) entries, the block entry carries their count:
+    // The block entry is stamped with the time of its first record:
+    uint32_t records;
+    CAN_log_record_t rec;
+    memset(&rec, 0, sizeof(rec));
+    std::string blocks = formatter->flush(false, &records, &rec.timestamp);
+    if (blocks.size() > 0)
       {
-      if (it->second->m_ispaused)
-        {
-        it->second->m_msgcount++;
-        it->second->m_discardcount++;
-        }
-      else
+      batch.Add(rec, blocks.data(), blocks.size(), records);
+      }
+    }
+  }
+
+/**
+ * Flush: output data held back by a buffered (block) formatter
+ *  and by the connections (i.e. datagram packing)
+ */
+void canlog::Flush(bool force)
+  {
+  OvmsRecMutexLock lock(&m_cmmutex);
+  if (!m_isopen) return;
+
+  if (force) DrainDedup(true);
+
+  if (m_formatter && m_formatter->IsBuffered())
+    {
+    uint32_t records;
+    CAN_log_record_t rec;
+    memset(&rec, 0, sizeof(rec));
+    std::string blocks = m_formatter->flush(force, &records, &rec.timestamp);
+    if (blocks.size() > 0)
+      {
+      m_batch->Clear();
+      m_batch->Add(rec, blocks.data(), blocks.size(), records);
+      for (conn_map_t::iterator it=m_connmap.begin(); it!=m_connmap.end(); ++it)
         {
-        it->second->OutputMsg(msg, result);
+        if (!it->second->m_ispaused)
+          it->second->OutputBatch(*m_batch);
         }
       }
     }
+
+  for (conn_map_t::iterator it=m_connmap.begin(); it!=m_connmap.end(); ++it)
+    it->second->OutputFlush(force);
+  }
+
+/**
+ * DrainDedup: log the pending change-only repeat comments
+ *  (heartbeat expired, or all if forced)
+ */
+void canlog::DrainDedup(bool force)
+  {
+  OvmsRecMutexLock lock(&m_cmmutex);
+  if (!m_dedup || !m_dedupout || !m_formatter || !m_isopen) return;
+  uint32_t count;
+  while ((count = m_dedup->Drain(m_dedupout, 2 * m_batchsize, force)) > 0)
+    {
+    m_batch->Clear();
+    Format(m_formatter, m_dedupout, count, *m_batch);
+    OutputBatch(*m_batch);
+    }
+  }
+
+void canlog::OutputBatch(canlog_batch& batch)
+  {
+  uint32_t count = batch.Count();
+  if (count == 0) return;
+  m_batchcount++;
+  m_batchmsgs += count;
+
+  OvmsRecMutexLock lock(&m_cmmutex);
+  for (conn_map_t::iterator it=m_connmap.begin(); it!=m_connmap.end(); ++it)
+    {
+    if (it->second->m_ispaused)
+      {
+      it->second->m_msgcount += count;
+      it->second->m_discardcount += count;
+      }
+    else
+      {
+      it->second->OutputBatch(batch);
+      }
+    }
   }
 
 std::string canlog::GetInfo()
@@ -581,7 +1382,7 @@ std::string canlog::GetStats()
   std::ostringstream buf;
 
   float droprate = (m_msgcount > 0) ? ((float) m_dropcount/m_msgcount*100) : 0;
-  uint32_t waiting = uxQueueMessagesWaiting(m_queue);
+  uint32_t waiting = m_ring ? m_ring->Count() : 0;
 
   buf << "Messages:" << m_msgcount
     << " Dropped:" << m_dropcount
@@ -591,6 +1392,17 @@ std::string canlog::GetStats()
   if (waiting > 0)
     buf << " Queued:" << waiting;
 
+  if (m_ring)
+    buf << " Ring:" << m_ring->Peak() << "/" << m_ring->Size();
+
+  if (m_batchcount > 0)
+    buf << " Batches:" << m_batchcount
+      << " Avg:" << std::setprecision(1) << ((float) m_batchmsgs / m_batchcount);
+
+  if (m_dedup)
+    buf << " Unchanged:" << m_dedup->m_suppressed
+      << " Repeats:" << m_dedup->m_repeats;
+
   return buf.str();
   }
 
@@ -612,19 +1424,36 @@ void canlog::ClearFilter()
     }
   }
 
+void canlog::Enqueue(CAN_log_record_t& rec)
+  {
+  gettimeofday(&rec.timestamp,NULL);
+  m_msgcount++;
+  uint32_t fill = m_ring->Push(rec);
+  if (fill == 0)
+    {
+    m_dropcount++;
+    Release(rec);
+    }
+  else if ((fill == 1 || fill == m_batchsize) && m_task)
+    {
+    // Wake the writer on the first record and when a batch is complete:
+    xTaskNotifyGive(m_task);
+    }
+  }
+
 void canlog::LogFrame(canbus* bus, CAN_log_type_t type, const CAN_frame_t* frame)
   {
   if (!IsOpen() || !bus || !frame) return;
 
-  if (((m_filter == NULL)||(m_filter->IsFiltered(frame)))&&(m_queue))
+  if (((m_filter == NULL)||(m_filter->IsFiltered(frame)))&&(m_ring))
     {
-    CAN_log_message_t msg;
-    msg.type = type;
-    gettimeofday(&msg.timestamp,NULL);
-    memcpy(&msg.frame,frame,sizeof(CAN_frame_t));
-    msg.frame.origin = bus;
-    m_msgcount++;
-    if (xQueueSend(m_queue, &msg, 0) != pdTRUE) m_dropcount++;
+    CAN_log_record_t rec;
+    rec.type = type;
+    rec.origin = bus;
+    rec.FIR = frame->FIR;
+    rec.MsgID = frame->MsgID;
+    memcpy(rec.data.u8, frame->data.u8, 8);
+    Enqueue(rec);
     }
   else
     {
@@ -636,15 +1465,15 @@ void canlog::LogStatus(canbus* bus, CAN_log_type_t type, const CAN_status_t* sta
   {
   if (!IsOpen() || !bus) return;
 
-  if (((m_filter == NULL)||(m_filter->IsFiltered(bus)))&&(m_queue))
+  if (((m_filter == NULL)||(m_filter->IsFiltered(bus)))&&(m_ring))
     {
-    CAN_log_message_t msg;
-    msg.type = type;
-    gettimeofday(&msg.timestamp,NULL);
-    msg.origin = bus;
-    memcpy(&msg.status,status,sizeof(CAN_status_t));
-    m_msgcount++;
-    if (xQueueSend(m_queue, &msg, 0) != pdTRUE) m_dropcount++;
+    CAN_log_record_t rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.type = type;
+    rec.origin = bus;
+    rec.data.status = (CAN_status_t*) MyCanLogStatusPool.Alloc(sizeof(CAN_status_t));
+    if (rec.data.status) memcpy(rec.data.status, status, sizeof(CAN_status_t));
+    Enqueue(rec);
     }
   else
     {
@@ -656,19 +1485,14 @@ void canlog::LogInfo(canbus* bus, CAN_log_type_t type, const char* text)
   {
   if (!IsOpen() || !text) return;
 
-  if (((m_filter == NULL)||(m_filter->IsFiltered(bus)))&&(m_queue))
+  if (((m_filter == NULL)||(m_filter->IsFiltered(bus)))&&(m_ring))
     {
-    CAN_log_message_t msg;
-    msg.type = type;
-    gettimeofday(&msg.timestamp,NULL);
-    msg.origin = bus;
-    msg.text = strdup(text);
-    m_msgcount++;
-    if (xQueueSend(m_queue, &msg, 0) != pdTRUE)
-      {
-      m_dropcount++;
-      free(msg.text);
-      }
+    CAN_log_record_t rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.type = type;
+    rec.origin = bus;
+    rec.data.text = MyCanLogTextPool.Strdup(text);
+    Enqueue(rec);
     }
   else
     {
@@ -28,8 +28,11 @@
 #define __CANLOG_H__
 
 #include "freertos/semphr.h"
+#include <atomic>
+#include <vector>
 #include "can.h"
 #include "canformat.h"
+#include "canpool.h"
 #include <sdkconfig.h>
 #ifdef CONFIG_OVMS_SC_GPL_MONGOOSE
 #include "ovms_netmanager.h"
@@ -46,9 +49,12 @@
  *  to the type list & method Instantiate(). See canlog_trace & canlog_crtd
  *  for examples & reference.
  *
- * Log messages are sent to a canlog through a queue handled by a separate
- *  task for the logger, so logging doesn't affect CAN framework speed and
- *  a log can be written/streamed to a slow medium.
+ * Log messages are sent to a canlog through a ring of compact records
+ *  (CAN_log_record_t) handled by a separate task for the logger, so logging
+ *  doesn't affect CAN framework speed and a log can be written/streamed to
+ *  a slow medium. The logger task formats records in batches into a reusable
+ *  buffer (canlog_batch) and passes each batch to the connections, which
+ *  normally issue a single write per batch.
  *
  * Log entries can be frames, status or info messages (see CAN_LogEntry_t).
  * The timestamp of the original event is preserved.
@@ -58,6 +64,147 @@
  *  of files or may return false on Open() without a bus filter.
  */
 
+// Compact log record, as stored in the logger ring:
+//  frame payloads are held inline, status & info payloads are pool copies
+//  (see below) owned by the record until formatted or dropped.
+typedef struct
+  {
+  struct timeval timestamp;
+  canbus*     origin;
+  CAN_FIR_t   FIR;
+  uint32_t    MsgID;
+  union
+    {
+    uint8_t       u8[8];
+    CAN_status_t* status;
+    char*         text;
+    } data;
+  uint8_t     type;                     // CAN_log_type_t
+  } CAN_log_record_t;
+
+// Record payload pools, texts exceeding the block size fall back to the heap:
+#define CANLOG_TEXTPOOL_BLOCKSIZE   128
+#define CANLOG_TEXTPOOL_COUNT       32
+#define CANLOG_STATUSPOOL_COUNT     16
+
+extern canpool MyCanLogTextPool;
+extern canpool MyCanLogStatusPool;
+
+/**
+ * canlog_ring: fixed size (power of two) ring of log records with a single
+ *  consumer (the logger task). Producers (CAN task, TX callers, event &
+ *  metric listeners) are serialized by a short spinlock, the consumer side
+ *  is lock free.
+ */
+class canlog_ring
+  {
+  public:
+    canlog_ring(uint32_t size);
+    ~canlog_ring();
+
+  public:
+    uint32_t Push(const CAN_log_record_t& rec);
+    uint32_t Pop(CAN_log_record_t* recs, uint32_t max);
+
+  public:
+    uint32_t Count()
+      {
+      return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+      }
+    uint32_t Size()   { return m_mask + 1; }
+    bool IsValid()    { return m_buf != NULL; }
+    uint32_t Peak()   { return m_peak; }
+
+  protected:
+    CAN_log_record_t*     m_buf;
+    uint32_t              m_mask;
+    std::atomic<uint32_t> m_head;       // next write position (producers)
+    std::atomic<uint32_t> m_tail;       // next read position (consumer)
+    uint32_t              m_peak;
+    portMUX_TYPE          m_lock;
+  };
+
+/**
+ * canlog_batch: a batch of log records formatted into one contiguous
+ *  buffer. Entries reference their formatted output by offset & length,
+ *  so connections can apply their filters and coalesce runs of accepted
+ *  entries into single writes.
+ */
+class canlog_batch
+  {
+  public:
+    typedef struct
+      {
+      CAN_log_record_t  rec;
+      uint32_t          offset;
+      uint32_t          length;
+      uint32_t          count;          // records output by the entry (a log block carries many)
+      } entry_t;
+
+  public:
+    canlog_batch(uint32_t size);
+    ~canlog_batch();
+
+  public:
+    void Clear();
+    void Add(const CAN_log_record_t& rec, const char* data, size_t len, uint32_t count=1);
+    uint8_t* Reserve(size_t len);
+    void Commit(const CAN_log_record_t& rec, size_t len);
+    uint32_t Count()            { return m_entries.size(); }
+    const char* Data()          { return m_data.data(); }
+    size_t Length()             { return m_data.size(); }
+
+  public:
+    std::vector<entry_t>  m_entries;
+    std::string           m_data;
+    size_t                m_reserved;
+  };
+
+/**
+ * canlog_dedup: change-only logging. Keeps the last payload per (bus, ID)
+ *  in a hashed table and suppresses RX frames repeating it. A suppressed
+ *  run is recorded by a comment "dedup <id> <count>" on the bus, stamped
+ *  with the time of the last repeat, before the next frame logged for the
+ *  ID. With a heartbeat, an unchanged frame is logged again at least every
+ *  heartbeat interval. canplay expands the repeats on replay.
+ */
+#define CANLOG_DEDUP_SLOTS  512
+#define CANLOG_DEDUP_PREFIX "dedup "
+
+class canlog_dedup
+  {
+  public:
+    typedef struct
+      {
+      canbus*         origin;         // NULL = unused
+      uint32_t        MsgID;
+      CAN_FIR_t       FIR;
+      uint8_t         u8[8];
+      struct timeval  emitted;        // time of last logged frame
+      struct timeval  lastseen;       // time of last suppressed repeat
+      uint32_t        count;          // repeats suppressed since emitted
+      } entry_t;
+
+  public:
+    canlog_dedup(uint32_t heartbeat_ms);
+    ~canlog_dedup();
+
+  public:
+    uint32_t Process(CAN_log_record_t* recs, uint32_t count, CAN_log_record_t* out);
+    uint32_t Drain(CAN_log_record_t* out, uint32_t size, bool force);
+    static uint32_t Slot(canbus* origin, uint32_t msgid);
+
+  protected:
+    void Repeats(entry_t& entry, CAN_log_record_t& rec);
+
+  public:
+    entry_t*    m_table;
+    int64_t     m_heartbeat;          // [us], 0 = off
+    int64_t     m_drained;            // esp_timer time of last complete Drain()
+    uint32_t    m_suppressed;
+    uint32_t    m_repeats;            // repeat comments logged
+  };
+
 class canlog;
 class canlogconnection: public InternalRamAllocated
   {
@@ -66,7 +213,10 @@ class canlogconnection: public InternalRamAllocated
     virtual ~canlogconnection();
 
   public:
-    virtual void OutputMsg(CAN_log_message_t& msg, std::string &result);
+    virtual void OutputBatch(canlog_batch& batch);
+    virtual void OutputData(const char* data, size_t len, uint32_t count);
+    virtual void OutputFlush(bool force=false);
+    bool IsFiltered(const CAN_log_record_t& rec);
 
   public:
     virtual void TransmitCallback(uint8_t *buffer, size_t len);
@@ -95,6 +245,7 @@ class canlogconnection: public InternalRamAllocated
     uint32_t       m_dropcount;
     uint32_t       m_discardcount;
     uint32_t       m_filtercount;
+    size_t         m_maxwrite;          // max bytes per OutputData() call (0=unlimited)
   };
 
 class canlog : public InternalRamAllocated
@@ -119,7 +270,14 @@ class canlog : public InternalRamAllocated
     virtual void Close() = 0;
     virtual bool IsOpen();
     virtual std::string GetInfo();
-    virtual void OutputMsg(CAN_log_message_t& msg);
+    virtual void OutputBatch(canlog_batch& batch);
+
+  public:
+    static void Expand(const CAN_log_record_t& rec, CAN_log_message_t& msg);
+    static void Release(CAN_log_record_t& rec);
+    static void Format(canformat* formatter, CAN_log_record_t* recs, uint32_t count, canlog_batch& batch);
+    void Flush(bool force=false);
+    void DrainDedup(bool force=false);
 
   public:
     virtual void SetFilter(canfilter* filter);
@@ -147,13 +305,25 @@ class canlog : public InternalRamAllocated
     conn_map_t m_connmap;
     OvmsRecMutex m_cmmutex;
 
+  protected:
+    void Enqueue(CAN_log_record_t& rec);
+
   public:
     TaskHandle_t        m_task;
-    QueueHandle_t       m_queue;
+    canlog_ring*        m_ring;
+    CAN_log_record_t*   m_pending;          // records taken from the ring
+    canlog_batch*       m_batch;
+    canlog_dedup*       m_dedup;            // change-only mode (NULL = off)
+    CAN_log_record_t*   m_dedupout;         // dedup output (2 x batch size)
+    uint32_t            m_batchsize;
+    TickType_t          m_flushticks;
+    TickType_t          m_idleticks;        // flush interval while idle
     bool                m_isopen;
     uint32_t            m_msgcount;
     uint32_t            m_dropcount;
     uint32_t            m_filtercount;
+    uint32_t            m_batchcount;
+    uint32_t            m_batchmsgs;
 
   protected:
     virtual void UpdatedConfig(std::string event, void* data);
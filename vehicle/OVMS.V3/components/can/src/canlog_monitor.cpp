@@ -82,35 +82,40 @@ canlog_monitor_conn::~canlog_monitor_conn()
   {
   }
 
-void canlog_monitor_conn::OutputMsg(CAN_log_message_t& msg, std::string &result)
+void canlog_monitor_conn::OutputBatch(canlog_batch& batch)
   {
-  m_msgcount++;
-
-  if ((m_filters != NULL) && (! m_filters->IsFiltered(&msg.frame)))
+  for (canlog_batch::entry_t& entry : batch.m_entries)
     {
-    m_filtercount++;
-    return;
-    }
+    if (entry.rec.type != CAN_LogNone) m_msgcount++;
 
-  if (result.length()>0)
-    {
-    switch (msg.type)
+    if (!IsFiltered(entry.rec))
+      {
+      m_filtercount++;
+      continue;
+      }
+
+    if (entry.length == 0)
+      continue;
+
+    const char* result = batch.Data() + entry.offset;
+    int len = entry.length;
+    switch (entry.rec.type)
       {
       case CAN_LogFrame_RX:
       case CAN_LogFrame_TX:
       case CAN_LogFrame_TX_Queue:
       case CAN_LogFrame_TX_Fail:
-        ESP_LOGV(TAG,"%s",result.c_str());
+        ESP_LOGV(TAG,"%.*s",len,result);
         break;
       case CAN_LogStatus_Error:
-        ESP_LOGE(TAG,"%s",result.c_str());
+        ESP_LOGE(TAG,"%.*s",len,result);
         break;
       case CAN_LogStatus_Statistics:
       case CAN_LogInfo_Comment:
       case CAN_LogInfo_Config:
       case CAN_LogInfo_Event:
       case CAN_LogInfo_Metric:
-        ESP_LOGD(TAG,"%s",result.c_str());
+        ESP_LOGD(TAG,"%.*s",len,result);
         break;
       default:
         break;
@@ -130,6 +135,7 @@ canlog_monitor::~canlog_monitor()
 
 bool canlog_monitor::Open()
   {
+  if (!m_ring) return false; // no log queue
   ESP_LOGI(TAG, "Now logging CAN messages to monitor");
 
   OvmsRecMutexLock lock(&m_cmmutex);
@@ -150,6 +156,7 @@ void canlog_monitor::Close()
   ESP_LOGI(TAG, "Closed monitor log: %s", GetStats().c_str());
 
   OvmsRecMutexLock lock(&m_cmmutex);
+  Flush(true);
   for (conn_map_t::iterator it=m_connmap.begin(); it!=m_connmap.end(); ++it)
     {
     delete it->second;
@@ -38,7 +38,7 @@ class canlog_monitor_conn: public canlogconnection
     virtual ~canlog_monitor_conn();
 
   public:
-    virtual void OutputMsg(CAN_log_message_t& msg, std::string &result);
+    virtual void OutputBatch(canlog_batch& batch);
   };
 
 
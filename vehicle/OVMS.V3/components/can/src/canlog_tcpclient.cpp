@@ -150,6 +150,7 @@ canlog_tcpclient::~canlog_tcpclient()
 bool canlog_tcpclient::Open()
   {
   if (m_isopen) return true;
+  if (!m_ring) return false; // no log queue
 
   struct mg_mgr* mgr = MyNetManager.GetMongooseMgr();
   if (mgr != NULL)
@@ -191,6 +192,7 @@ void canlog_tcpclient::Close()
   if (m_isopen)
     {
     ESP_LOGI(TAG, "Closed TCP client log: %s", GetStats().c_str());
+    Flush(true);
     if (m_connmap.size() > 0)
       {
       OvmsRecMutexLock lock(&m_cmmutex);
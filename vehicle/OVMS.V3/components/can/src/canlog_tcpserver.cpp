@@ -35,9 +35,279 @@ static const char *TAG = "canlog-tcpserver";
 #include "canlog_tcpserver.h"
 #include "ovms_config.h"
 #include "ovms_peripherals.h"
+#include "ovms_malloc.h"
+#include "esp_timer.h"
+#include <sys/param.h>
+#include <sstream>
+#include <iomanip>
+
+#define TCP_QUEUESIZE 16384
+#define TCP_WINDOW 8192
+#define TCP_ENTRYMIN 16         // expected min bytes per message (entry ring size)
 
 canlog_tcpserver* MyCanLogTcpServer = NULL;
 
+static canlog_tcp_policy_t GetTcpPolicy(std::string policy)
+  {
+  if (policy == "oldest") return TCP_DropOldest;
+  if (policy == "thin") return TCP_Thin;
+  if (policy == "pause") return TCP_Pause;
+  return TCP_DropNewest;
+  }
+
+static const char* GetTcpPolicyName(canlog_tcp_policy_t policy)
+  {
+  switch (policy)
+    {
+    case TCP_DropOldest: return "oldest";
+    case TCP_Thin:       return "thin";
+    case TCP_Pause:      return "pause";
+    default:             return "newest";
+    }
+  }
+
+tcpcanlogconnection::tcpcanlogconnection(canlog* logger, std::string format, canformat::canformat_serve_mode_t mode)
+  : canlogconnection(logger, format, mode)
+  {
+  m_policy = GetTcpPolicy(MyConfig.GetParamValue("can", "log.tcp.policy", "newest"));
+  int queuesize = MyConfig.GetParamValueInt("can", "log.tcp.queue", TCP_QUEUESIZE);
+  int window = MyConfig.GetParamValueInt("can", "log.tcp.window", TCP_WINDOW);
+  int thinhz = MyConfig.GetParamValueInt("can", "log.tcp.thin", 10);
+  m_window = MAX(window, 512);
+  m_thinms = (thinhz > 0) ? 1000 / thinhz : 0;
+
+  m_datasize = MAX(queuesize, 2048);
+  m_data = (char*) ExternalRamMalloc(m_datasize);
+  m_entrysize = m_datasize / TCP_ENTRYMIN;
+  m_entries = (entry_t*) ExternalRamMalloc(m_entrysize * sizeof(entry_t));
+  m_datahead = m_datatail = m_dataused = m_datapeak = 0;
+  m_entryhead = m_entrytail = m_entrycount = 0;
+
+  memset(m_thin, 0, sizeof(m_thin));
+  m_stalled = false;
+
+  m_starttime = esp_timer_get_time();
+  m_sentbytes = 0;
+  m_sentmsgs = 0;
+  m_thincount = 0;
+  m_stallcount = 0;
+  m_lag_sum = 0;
+  m_lag_max = 0;
+  m_lag_count = 0;
+  }
+
+tcpcanlogconnection::~tcpcanlogconnection()
+  {
+  if (m_data)
+    {
+    free(m_data);
+    m_data = NULL;
+    }
+  if (m_entries)
+    {
+    free(m_entries);
+    m_entries = NULL;
+    }
+  }
+
+void tcpcanlogconnection::OutputBatch(canlog_batch& batch)
+  {
+  const char* data = batch.Data();
+  for (canlog_batch::entry_t& entry : batch.m_entries)
+    {
+    if (entry.rec.type != CAN_LogNone) m_msgcount++;
+
+    if (!IsFiltered(entry.rec))
+      {
+      m_filtercount++;
+      continue;
+      }
+    if (entry.length == 0)
+      continue;
+
+    Enqueue(entry.rec, data + entry.offset, entry.length, entry.count);
+    }
+
+  Drain();
+  }
+
+void tcpcanlogconnection::OutputFlush(bool force)
+  {
+  Drain();
+  }
+
+/**
+ * Thinned: check & update the per ID rate limit (hashed, collisions pass)
+ */
+bool tcpcanlogconnection::Thinned(const CAN_log_record_t& rec, uint32_t now)
+  {
+  switch (rec.type)
+    {
+    case CAN_LogFrame_RX:
+    case CAN_LogFrame_TX:
+      break;
+    default:
+      return false;
+    }
+
+  uint32_t key = rec.MsgID ^ ((uint32_t)(uintptr_t)rec.origin << 20);
+  uint32_t slot = (key ^ (key >> 8) ^ (key >> 16)) % TCP_THIN_SLOTS;
+  if (m_thin[slot].key == key && now - m_thin[slot].time < m_thinms)
+    return true;
+  m_thin[slot].key = key;
+  m_thin[slot].time = now;
+  return false;
+  }
+
+void tcpcanlogconnection::DropOldest()
+  {
+  entry_t& e = m_entries[m_entrytail];
+  m_datatail = (m_datatail + e.length) % m_datasize;
+  m_dataused -= e.length;
+  m_entrytail = (m_entrytail + 1) % m_entrysize;
+  m_entrycount--;
+  m_dropcount += e.count;
+  }
+
+/**
+ * Enqueue: add a formatted message to the queue, applying the overflow policy
+ *  Returns false if the message has been dropped.
+ */
+bool tcpcanlogconnection::Enqueue(const CAN_log_record_t& rec, const char* data, size_t len, uint32_t count)
+  {
+  if (m_data == NULL || m_entries == NULL || len > m_datasize)
+    {
+    m_dropcount += count;
+    return false;
+    }
+
+  uint32_t now = esp_timer_get_time() / 1000;
+
+  // Thinning only applies while the client is behind:
+  if (m_policy == TCP_Thin && m_entrycount > 0 && m_thinms > 0 && Thinned(rec, now))
+    {
+    m_thincount++;
+    return false;
+    }
+
+  if (m_stalled)
+    {
+    if (m_dataused > m_datasize / 2 || m_entrycount > m_entrysize / 2)
+      {
+      m_dropcount += count;
+      return false;
+      }
+    m_stalled = false;
+    }
+
+  while (m_dataused + len > m_datasize || m_entrycount == m_entrysize)
+    {
+    if (m_policy == TCP_DropOldest)
+      {
+      DropOldest();
+      }
+    else
+      {
+      if (m_policy == TCP_Pause)
+        {
+        m_stalled = true;
+        m_stallcount++;
+        }
+      m_dropcount += count;
+      return false;
+      }
+    }
+
+  size_t part = MIN(len, m_datasize - m_datahead);
+  memcpy(m_data + m_datahead, data, part);
+  if (part < len)
+    memcpy(m_data, data + part, len - part);
+  m_datahead = (m_datahead + len) % m_datasize;
+  m_dataused += len;
+  if (m_dataused > m_datapeak) m_datapeak = m_dataused;
+
+  entry_t& e = m_entries[m_entryhead];
+  e.time = now;
+  e.length = len;
+  e.count = count;
+  m_entryhead = (m_entryhead + 1) % m_entrysize;
+  m_entrycount++;
+  return true;
+  }
+
+/**
+ * Drain: move queued messages into the mongoose send buffer, up to the
+ *  send window. Called on new log data and from the mongoose task on
+ *  MG_EV_SEND / MG_EV_POLL, with the logger connection mutex held.
+ */
+void tcpcanlogconnection::Drain()
+  {
+  if (m_nc == NULL || m_entrycount == 0) return;
+
+  uint32_t now = esp_timer_get_time() / 1000;
+  while (m_entrycount > 0 && m_nc->send_mbuf.len < m_window)
+    {
+    // Collect as many messages as fit into the window; an oversized message
+    //  (i.e. a log block) is sent when the send buffer is empty:
+    size_t space = m_window - m_nc->send_mbuf.len;
+    size_t len = 0;
+    uint32_t count = 0, records = 0;
+    uint32_t index = m_entrytail;
+    while (count < m_entrycount)
+      {
+      entry_t& e = m_entries[index];
+      if (len + e.length > space && !(count == 0 && m_nc->send_mbuf.len == 0))
+        break;
+      len += e.length;
+      records += e.count;
+      uint32_t lag = now - e.time;
+      m_lag_sum += lag;
+      m_lag_count++;
+      if (lag > m_lag_max) m_lag_max = lag;
+      index = (index + 1) % m_entrysize;
+      count++;
+      }
+    if (count == 0) break;
+
+    size_t part = MIN(len, m_datasize - m_datatail);
+    mg_send(m_nc, m_data + m_datatail, part);
+    if (part < len)
+      mg_send(m_nc, m_data, len - part);
+
+    m_datatail = (m_datatail + len) % m_datasize;
+    m_dataused -= len;
+    m_entrytail = index;
+    m_entrycount -= count;
+    m_sentbytes += len;
+    m_sentmsgs += records;
+    }
+  }
+
+std::string tcpcanlogconnection::GetStats()
+  {
+  std::ostringstream buf;
+
+  float secs = (esp_timer_get_time() - m_starttime) / 1000000.0;
+  if (secs < 1) secs = 1;
+
+  buf << canlogconnection::GetStats()
+    << " Sent:" << m_sentmsgs
+    << std::fixed << std::setprecision(1)
+    << " Throughput:" << (m_sentmsgs / secs) << "msg/s "
+    << (m_sentbytes / secs / 1024) << "kB/s"
+    << " Lag:" << ((m_lag_count > 0) ? (float) m_lag_sum / m_lag_count : 0)
+    << "/" << m_lag_max << "ms"
+    << " Queue:" << m_dataused << "/" << m_datasize
+    << " Peak:" << m_datapeak
+    << " Policy:" << GetTcpPolicyName(m_policy);
+  if (m_policy == TCP_Thin)
+    buf << " Thinned:" << m_thincount;
+  else if (m_policy == TCP_Pause)
+    buf << " Stalls:" << m_stallcount;
+
+  return buf.str();
+  }
+
 void can_log_tcpserver_start(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
   {
   std::string format(cmd->GetName());
@@ -156,6 +426,7 @@ canlog_tcpserver::~canlog_tcpserver()
 bool canlog_tcpserver::Open()
   {
   if (m_isopen) return true;
+  if (!m_ring) return false; // no log queue
 
   ESP_LOGI(TAG, "Launching TCP server at %s",m_path.c_str());
   struct mg_mgr* mgr = MyNetManager.GetMongooseMgr();
@@ -192,6 +463,7 @@ void canlog_tcpserver::Close()
   {
   if (m_isopen)
     {
+    Flush(true);
     if (m_connmap.size() > 0)
       {
       OvmsRecMutexLock lock(&m_cmmutex);
@@ -214,6 +486,8 @@ std::string canlog_tcpserver::GetInfo()
   std::string result = canlog::GetInfo();
   result.append(" Path:");
   result.append(m_path);
+  result.append(" Policy:");
+  result.append(GetTcpPolicyName(GetTcpPolicy(MyConfig.GetParamValue("can", "log.tcp.policy", "newest"))));
   return result;
   }
 
@@ -229,7 +503,7 @@ void canlog_tcpserver::MongooseHandler(struct mg_connection *nc, int ev, void *p
       OvmsRecMutexLock lock(&m_cmmutex);
       mg_sock_addr_to_str(&nc->sa, addr, sizeof(addr), MG_SOCK_STRINGIFY_IP);
       ESP_LOGI(TAG, "Log service connection from %s",addr);
-      canlogconnection* clc = new canlogconnection(this, m_format, m_mode);
+      tcpcanlogconnection* clc = new tcpcanlogconnection(this, m_format, m_mode);
       clc->m_nc = nc;
       clc->m_peer = std::string(addr);
       m_connmap[nc] = clc;
@@ -256,6 +530,17 @@ void canlog_tcpserver::MongooseHandler(struct mg_connection *nc, int ev, void *p
       break;
       }
 
+    case MG_EV_POLL:
+    case MG_EV_SEND:
+      {
+      // Send window may have opened: move queued messages
+      OvmsRecMutexLock lock(&m_cmmutex);
+      auto k = m_connmap.find(nc);
+      if (k != m_connmap.end())
+        ((tcpcanlogconnection*)k->second)->Drain();
+      break;
+      }
+
     case MG_EV_RECV:
       {
       // Receive data on the network connection
@@ -266,7 +551,8 @@ void canlog_tcpserver::MongooseHandler(struct mg_connection *nc, int ev, void *p
         canlogconnection* clc = NULL;
         auto k = m_connmap.find(nc);
         if (k != m_connmap.end()) clc = k->second;
-        used = clc->m_formatter->Serve((uint8_t*)nc->recv_mbuf.buf, used, clc);
+        if (clc != NULL)
+          used = clc->m_formatter->Serve((uint8_t*)nc->recv_mbuf.buf, used, clc);
         }
       if (used > 0)
         {
@@ -35,6 +35,84 @@
 #include "ovms_netmanager.h"
 #include "ovms_mutex.h"
 
+// Overflow policies (config can log.tcp.policy):
+typedef enum
+  {
+  TCP_DropNewest = 0,         // "newest": discard incoming messages while the queue is full
+  TCP_DropOldest,             // "oldest": discard the oldest queued messages to make room
+  TCP_Thin,                   // "thin": limit frames per ID to N Hz while backlogged
+  TCP_Pause                   // "pause": stop queueing when full until drained to half
+  } canlog_tcp_policy_t;
+
+#define TCP_THIN_SLOTS 256
+
+/**
+ * tcpcanlogconnection: TCP client with a bounded queue of formatted
+ *  messages. The queue is moved into the mongoose send buffer only up to
+ *  the send window, on new log data and on MG_EV_SEND / MG_EV_POLL, so a
+ *  slow client cannot make mongoose buffer without limit. The overflow
+ *  policy decides which messages are lost when the client falls behind.
+ */
+class tcpcanlogconnection: public canlogconnection
+  {
+  public:
+    tcpcanlogconnection(canlog* logger, std::string format, canformat::canformat_serve_mode_t mode);
+    virtual ~tcpcanlogconnection();
+
+  public:
+    virtual void OutputBatch(canlog_batch& batch);
+    virtual void OutputFlush(bool force=false);
+    virtual std::string GetStats();
+
+  public:
+    void Drain();
+
+  protected:
+    typedef struct
+      {
+      uint32_t time;          // enqueue time [ms]
+      uint32_t length;
+      uint32_t count;         // records
+      } entry_t;
+
+    bool Enqueue(const CAN_log_record_t& rec, const char* data, size_t len, uint32_t count);
+    bool Thinned(const CAN_log_record_t& rec, uint32_t now);
+    void DropOldest();
+
+  protected:
+    canlog_tcp_policy_t m_policy;
+    size_t    m_window;         // max bytes in the mongoose send buffer
+    uint32_t  m_thinms;         // min interval per ID for TCP_Thin [ms]
+
+    char*     m_data;           // queue payload ring
+    size_t    m_datasize;
+    size_t    m_datahead;
+    size_t    m_datatail;
+    size_t    m_dataused;
+    size_t    m_datapeak;
+    entry_t*  m_entries;        // queue entry ring
+    uint32_t  m_entrysize;
+    uint32_t  m_entryhead;
+    uint32_t  m_entrytail;
+    uint32_t  m_entrycount;
+
+    struct
+      {
+      uint32_t key;
+      uint32_t time;
+      } m_thin[TCP_THIN_SLOTS];
+    bool      m_stalled;        // TCP_Pause: waiting for the queue to drain
+
+    int64_t   m_starttime;
+    uint64_t  m_sentbytes;
+    uint32_t  m_sentmsgs;
+    uint32_t  m_thincount;
+    uint32_t  m_stallcount;
+    uint64_t  m_lag_sum;
+    uint32_t  m_lag_max;
+    uint32_t  m_lag_count;      // lag samples (queue entries sent)
+  };
+
 class canlog_tcpserver : public canlog
   {
   public:
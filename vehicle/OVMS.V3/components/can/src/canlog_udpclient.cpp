@@ -33,6 +33,8 @@ static const char *TAG = "canlog-udpclient";
 #include "can.h"
 #include "canformat.h"
 #include "canlog_udpclient.h"
+#include "canlog_udpserver.h"
+#include <sys/param.h>
 #include "ovms_config.h"
 #include "ovms_peripherals.h"
 
@@ -120,6 +122,8 @@ canlog_udpclient::canlog_udpclient(std::string path, std::string format, canform
   MyCanLogUdpClient = this;
   m_isopen = false;
   m_path = path;
+  int flushtime = MyConfig.GetParamValueInt("can", "log.udp.flushtime", 50);
+  m_idleticks = MIN(m_idleticks, MAX(1, pdMS_TO_TICKS(flushtime)));
   }
 
 canlog_udpclient::~canlog_udpclient()
@@ -131,6 +135,7 @@ canlog_udpclient::~canlog_udpclient()
 bool canlog_udpclient::Open()
   {
   if (m_isopen) return true;
+  if (!m_ring) return false; // no log queue
 
   struct mg_mgr* mgr = MyNetManager.GetMongooseMgr();
   if (mgr != NULL)
@@ -147,9 +152,11 @@ bool canlog_udpclient::Open()
       mg_connection* nc;
       if ((nc = mg_connect_opt(mgr, dest.c_str(), tcMongooseHandler, opts)) != NULL)
         {
-        canlogconnection* clc = new canlogconnection(this, m_format, m_mode);
+        OvmsRecMutexLock lock(&m_cmmutex);
+        udpcanlogconnection* clc = new udpcanlogconnection(this, m_format, m_mode);
         clc->m_nc = nc;
         clc->m_peer = m_path;
+        SetSocket(clc, nc);
         m_connmap[nc] = clc;
         m_isopen = true;
         return true;
@@ -178,6 +185,7 @@ void canlog_udpclient::Close()
   if (m_isopen)
     {
     ESP_LOGI(TAG, "Closed UDP client log: %s", GetStats().c_str());
+    Flush(true);
     if (m_connmap.size() > 0)
       {
       OvmsRecMutexLock lock(&m_cmmutex);
@@ -201,10 +209,33 @@ std::string canlog_udpclient::GetInfo()
   return result;
   }
 
+/**
+ * SetSocket: take the socket & peer address from the mongoose connection
+ *  once it is connected (immediately for numeric hosts, else after DNS).
+ *  The logger task sends via sendto() on these copies, so it does not
+ *  access the mongoose connection, which may be closed concurrently.
+ */
+void canlog_udpclient::SetSocket(udpcanlogconnection* clc, struct mg_connection *nc)
+  {
+  if (nc->sock == INVALID_SOCKET) return;
+  clc->m_sock = nc->sock;
+  memcpy(&clc->m_sa, &nc->sa.sin, sizeof(nc->sa.sin));
+  }
+
 void canlog_udpclient::MongooseHandler(struct mg_connection *nc, int ev, void *p)
   {
   switch (ev)
     {
+    case MG_EV_CONNECT:
+      {
+      ESP_LOGV(TAG, "MongooseHandler(MG_EV_CONNECT)");
+      if (*(int*)p != 0) break;
+      OvmsRecMutexLock lock(&m_cmmutex);
+      auto k = m_connmap.find(nc);
+      if (k != m_connmap.end())
+        SetSocket((udpcanlogconnection*)k->second, nc);
+      break;
+      }
     case MG_EV_CLOSE:
       ESP_LOGV(TAG, "MongooseHandler(MG_EV_CLOSE)");
       if (m_isopen)
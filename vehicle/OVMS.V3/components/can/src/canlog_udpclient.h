@@ -32,6 +32,8 @@
 #include "ovms_netmanager.h"
 #include "ovms_mutex.h"
 
+class udpcanlogconnection;
+
 class canlog_udpclient : public canlog
   {
   public:
@@ -46,6 +48,9 @@ class canlog_udpclient : public canlog
   public:
     void MongooseHandler(struct mg_connection *nc, int ev, void *p);
 
+  protected:
+    void SetSocket(udpcanlogconnection* clc, struct mg_connection *nc);
+
   public:
     std::string         m_path;
   };
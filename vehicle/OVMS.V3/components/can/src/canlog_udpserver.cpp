@@ -36,37 +36,156 @@ static const char *TAG = "canlog-udpserver";
 #include "ovms_config.h"
 #include "ovms_events.h"
 #include "ovms_peripherals.h"
+#include "ovms_malloc.h"
+#include "esp_timer.h"
+#include <endian.h>
+#include <sys/param.h>
+#include <sstream>
+#include <iomanip>
 
 #define UDP_TIMEOUT 30
+#define UDP_MAXDATAGRAM 1400
+#define UDP_MAXPAYLOAD 8192
 
 canlog_udpserver* MyCanLogUdpServer = NULL;
 
 udpcanlogconnection::udpcanlogconnection(canlog* logger, std::string format, canformat::canformat_serve_mode_t mode)
   : canlogconnection(logger, format, mode)
   {
+  m_sock = -1;
+  memset(&m_sa, 0, sizeof(m_sa));
   m_timeout = monotonictime + UDP_TIMEOUT;
+
+  int mtu = MyConfig.GetParamValueInt("can", "log.udp.mtu", UDP_MAXDATAGRAM);
+  int flushtime = MyConfig.GetParamValueInt("can", "log.udp.flushtime", 50);
+  m_useseq = MyConfig.GetParamValueBool("can", "log.udp.seq", false);
+  m_packsize = MAX(64, MIN(mtu, UDP_MAXPAYLOAD)) - sizeof(canlog_udp_header_t);
+  m_pack = (char*) ExternalRamMalloc(sizeof(canlog_udp_header_t) + m_packsize);
+  m_packlen = 0;
+  m_packcount = 0;
+  m_packtime = 0;
+  m_flushtime = (int64_t) MAX(flushtime, 0) * 1000;
+  m_seq = 0;
+  m_dgramcount = 0;
+  m_dgrammsgs = 0;
+  m_dgramfail = 0;
   }
 
 udpcanlogconnection::~udpcanlogconnection()
   {
+  if (m_pack)
+    {
+    free(m_pack);
+    m_pack = NULL;
+    }
+  }
+
+void udpcanlogconnection::OutputBatch(canlog_batch& batch)
+  {
+  // Pack accepted entries into datagrams, splitting at message boundaries:
+  const char* data = batch.Data();
+  for (canlog_batch::entry_t& entry : batch.m_entries)
+    {
+    if (entry.rec.type != CAN_LogNone) m_msgcount++;
+
+    if (!IsFiltered(entry.rec))
+      {
+      m_filtercount++;
+      continue;
+      }
+    if (entry.length == 0)
+      continue;
+
+    if (m_packlen > 0 && (m_packlen + entry.length > m_packsize
+      || m_packcount + entry.count > CANLOG_UDP_MAXCOUNT))
+      SendPack();
+
+    if (m_pack == NULL || entry.length > m_packsize)
+      {
+      // Oversized entry (i.e. a log block), send in a datagram of its own:
+      std::string dgram(sizeof(canlog_udp_header_t), 0);
+      dgram.append(data + entry.offset, entry.length);
+      SendDatagram(&dgram[0], dgram.size(), entry.count);
+      continue;
+      }
+
+    if (m_packlen == 0) m_packtime = esp_timer_get_time();
+    memcpy(m_pack + sizeof(canlog_udp_header_t) + m_packlen, data + entry.offset, entry.length);
+    m_packlen += entry.length;
+    m_packcount += entry.count;
+    }
+
+  OutputFlush(false);
+  }
+
+void udpcanlogconnection::OutputFlush(bool force)
+  {
+  if (m_packlen > 0 && (force || esp_timer_get_time() - m_packtime >= m_flushtime))
+    SendPack();
   }
 
-void udpcanlogconnection::OutputMsg(CAN_log_message_t& msg, std::string &result)
+void udpcanlogconnection::SendPack()
   {
-  m_msgcount++;
+  SendDatagram(m_pack, sizeof(canlog_udp_header_t) + m_packlen, m_packcount);
+  m_packlen = 0;
+  m_packcount = 0;
+  }
 
-  if ((m_filters != NULL) && (! m_filters->IsFiltered(&msg.frame)))
+/**
+ * SendDatagram: send a datagram, dgram has space for the header at the start
+ */
+void udpcanlogconnection::SendDatagram(char* dgram, size_t len, uint32_t count)
+  {
+  if (m_useseq)
+    {
+    canlog_udp_header_t* hdr = (canlog_udp_header_t*) dgram;
+    hdr->magic[0] = 'O';
+    hdr->magic[1] = 'S';
+    hdr->count = htole16((uint16_t) MIN(count, CANLOG_UDP_MAXCOUNT)); // saturate, a log block is not split
+    hdr->seq = htole32(m_seq);
+    }
+  else
     {
-    m_filtercount++;
-    return;
+    dgram += sizeof(canlog_udp_header_t);
+    len -= sizeof(canlog_udp_header_t);
     }
+  m_seq++;
+
+  // Note: called by the logger task, so only use the socket & address copied
+  //  from mongoose under m_cmmutex, not m_nc (owned by the mongoose task)
+  int res;
+  if (m_sock >= 0)
+    res = sendto(m_sock, dgram, len, 0, &m_sa, sizeof(m_sa));
+  else
+    res = -1;
 
-  if (result.length()>0)
+  if (res < 0)
     {
-    sendto(m_sock, (const char*)result.c_str(), result.length(), 0, &m_sa, sizeof(m_sa));
+    m_dgramfail++;
+    m_dropcount += count;
+    }
+  else
+    {
+    m_dgramcount++;
+    m_dgrammsgs += count;
     }
   }
 
+std::string udpcanlogconnection::GetStats()
+  {
+  std::ostringstream buf;
+
+  buf << canlogconnection::GetStats()
+    << " Datagrams:" << m_dgramcount
+    << " Avg:" << std::fixed << std::setprecision(1)
+    << ((m_dgramcount > 0) ? (float) m_dgrammsgs / m_dgramcount : 0)
+    << " Failed:" << m_dgramfail;
+  if (m_useseq)
+    buf << " Seq:" << m_seq;
+
+  return buf.str();
+  }
+
 void udpcanlogconnection::Tickle()
   {
   m_timeout = monotonictime + UDP_TIMEOUT;
@@ -179,6 +298,8 @@ canlog_udpserver::canlog_udpserver(std::string path, std::string format, canform
     }
   m_isopen = false;
   m_mgconn = NULL;
+  int flushtime = MyConfig.GetParamValueInt("can", "log.udp.flushtime", 50);
+  m_idleticks = MIN(m_idleticks, MAX(1, pdMS_TO_TICKS(flushtime)));
 
   #undef bind  // Kludgy, but works
   using std::placeholders::_1;
@@ -196,6 +317,7 @@ canlog_udpserver::~canlog_udpserver()
 bool canlog_udpserver::Open()
   {
   if (m_isopen) return true;
+  if (!m_ring) return false; // no log queue
 
   ESP_LOGI(TAG, "Launching UDP server at %s",m_path.c_str());
   struct mg_mgr* mgr = MyNetManager.GetMongooseMgr();
@@ -233,6 +355,7 @@ void canlog_udpserver::Close()
   {
   if (m_isopen)
     {
+    Flush(true);
     if (m_connmap.size() > 0)
       {
       OvmsRecMutexLock lock(&m_cmmutex);
@@ -262,16 +385,20 @@ void canlog_udpserver::Ticker(std::string event, void* data)
   {
   OvmsRecMutexLock lock(&m_cmmutex);
 
-  for (conn_map_t::iterator it=m_connmap.begin(); it!=m_connmap.end(); ++it)
+  for (conn_map_t::iterator it=m_connmap.begin(); it!=m_connmap.end();)
     {
     udpcanlogconnection* clc = (udpcanlogconnection*)it->second;
     if (clc->m_timeout < monotonictime)
       {
       // This client has timed out
       ESP_LOGD(TAG,"Timed out connection from %s",clc->m_peer.c_str());
-      m_connmap.erase(it);
+      it = m_connmap.erase(it);
       delete clc;
       }
+    else
+      {
+      ++it;
+      }
     }
   }
 
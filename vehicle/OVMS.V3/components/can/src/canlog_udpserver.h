@@ -35,6 +35,23 @@
 #include "ovms_netmanager.h"
 #include "ovms_mutex.h"
 
+// Optional datagram header (config can log.udp.seq):
+typedef struct __attribute__ ((__packed__))
+  {
+  char     magic[2];          // "OS"
+  uint16_t count;             // number of log messages in the datagram, incl. those in log blocks (LE)
+  uint32_t seq;               // datagram sequence number per peer (LE)
+  } canlog_udp_header_t;
+
+#define CANLOG_UDP_MAXCOUNT 0xffff  // max header count, datagrams are packed up to this
+
+/**
+ * udpcanlogconnection: UDP peer, packing as many messages as fit into
+ *  one datagram. A partial datagram is sent after the flush deadline.
+ *  Used by the UDP server (sendto on the listening socket) and the
+ *  UDP client (sendto on the socket of the mongoose connection, set
+ *  by the client once connected).
+ */
 class udpcanlogconnection: public canlogconnection
   {
   public:
@@ -42,16 +59,35 @@ class udpcanlogconnection: public canlogconnection
     virtual ~udpcanlogconnection();
 
   public:
-    virtual void OutputMsg(CAN_log_message_t& msg, std::string &result);
+    virtual void OutputBatch(canlog_batch& batch);
+    virtual void OutputFlush(bool force=false);
+    virtual std::string GetStats();
+
+  protected:
+    void SendPack();
+    void SendDatagram(char* dgram, size_t len, uint32_t count);
 
   public:
     void Tickle();
 
   public:
-    sock_t m_sock;             // Our main listening UDP socket
-    struct sockaddr m_sa;      // Our remote client address
+    sock_t m_sock;             // Our main listening UDP socket (server)
+    struct sockaddr m_sa;      // Our remote client address (server)
     mg_connection m_fakenc;    // A fake nc, just as an index to us
     uint32_t m_timeout;        // Our timeout
+
+  protected:
+    char*    m_pack;           // datagram buffer (header + payload)
+    size_t   m_packsize;       // max payload size
+    size_t   m_packlen;        // current payload length
+    uint32_t m_packcount;      // messages in payload
+    int64_t  m_packtime;       // esp_timer time of first message
+    int64_t  m_flushtime;      // flush deadline [us], 0 = at end of batch
+    bool     m_useseq;         // prepend canlog_udp_header_t
+    uint32_t m_seq;
+    uint32_t m_dgramcount;
+    uint32_t m_dgrammsgs;
+    uint32_t m_dgramfail;
   };
 
 class canlog_udpserver : public canlog
@@ -34,6 +34,8 @@ static const char *TAG = "canlog-vfs";
 #include "ovms_config.h"
 #include "ovms_peripherals.h"
 #include "ovms_vfs.h"
+#include "esp_timer.h"
+#include <sys/param.h>
 
 void can_log_vfs_start(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
   {
@@ -57,6 +59,121 @@ void can_log_vfs_start(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int
     }
   }
 
+static bool can_log_parse_time(const char* arg, const struct timeval& start, struct timeval& result)
+  {
+  char* end;
+  double t = strtod(arg, &end);
+  if (end == arg || *end != 0) return false;
+  int64_t us = (int64_t)(t * 1000000);
+  if (t < 1000000000)
+    {
+    // relative to log start:
+    us += (int64_t)start.tv_sec * 1000000 + start.tv_usec;
+    }
+  result.tv_sec = us / 1000000;
+  result.tv_usec = us % 1000000;
+  return true;
+  }
+
+void can_log_vfs_extract(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  std::string format(cmd->GetName());
+  std::string outpath;
+  if (argc > 3)
+    {
+    outpath = argv[3];
+    }
+  else
+    {
+    outpath = argv[0];
+    size_t dot = outpath.find_last_of('.');
+    if (dot != std::string::npos && outpath.find('/', dot) == std::string::npos)
+      outpath.erase(dot);
+    outpath += "-extract." + format;
+    }
+
+  if (outpath == argv[0] || MyConfig.ProtectedPath(outpath))
+    {
+    writer->printf("Error: cannot write to '%s'\n", outpath.c_str());
+    return;
+    }
+
+  canlog_vfs_reader reader(argv[0]);
+  if (!reader.Open())
+    {
+    writer->printf("Error: %s\n", reader.m_error.c_str());
+    return;
+    }
+
+  struct timeval start, from, to;
+  if (!reader.GetStartTime(start))
+    {
+    writer->puts("Error: no messages found in log");
+    return;
+    }
+  if (!can_log_parse_time(argv[1], start, from) || !can_log_parse_time(argv[2], start, to))
+    {
+    writer->puts("Error: invalid time, use <seconds since log start> or <unix time>");
+    return;
+    }
+
+  canformat* out = MyCanFormatFactory.NewFormat(format.c_str());
+  if (out == NULL)
+    {
+    writer->printf("Error: unknown format '%s'\n", format.c_str());
+    return;
+    }
+  FILE* file = fopen(outpath.c_str(), "w");
+  if (file == NULL)
+    {
+    writer->printf("Error: cannot write to '%s'\n", outpath.c_str());
+    delete out;
+    return;
+    }
+
+  int64_t started = esp_timer_get_time();
+  std::string result = out->getheader(&from);
+  size_t size = result.size();
+  if (size > 0) fwrite(result.data(), size, 1, file);
+
+  uint32_t count = 0, skipped = 0;
+  CAN_log_message_t msg;
+  reader.Seek(from);
+  while (reader.Read(&msg))
+    {
+    if (timercmp(&msg.timestamp, &from, <))
+      {
+      skipped++;
+      continue;
+      }
+    if (timercmp(&msg.timestamp, &to, >))
+      break;
+    result = out->get(&msg);
+    if (result.size() > 0)
+      {
+      fwrite(result.data(), result.size(), 1, file);
+      size += result.size();
+      }
+    count++;
+    }
+  result = out->flush(true);
+  if (result.size() > 0)
+    {
+    fwrite(result.data(), result.size(), 1, file);
+    size += result.size();
+    }
+  fclose(file);
+  delete out;
+
+  int64_t elapsed = esp_timer_get_time() - started;
+  char bufsize[15];
+  format_file_size(bufsize, sizeof(bufsize), size);
+  writer->printf("Extracted %" PRIu32 " messages (%s) from %s log to '%s' in %.1f s\n"
+    "%s: %" PRIu32 " messages skipped before start time\n",
+    count, bufsize, reader.GetFormat(), outpath.c_str(), (float)elapsed / 1000000,
+    reader.HasIndex() ? "Index used" : "No index", skipped);
+  }
+
 class OvmsCanLogVFSInit
   {
   public: OvmsCanLogVFSInit();
@@ -84,6 +201,14 @@ OvmsCanLogVFSInit::OvmsCanLogVFSInit()
           "Example: 2:2a0-37f",
           1, 9, true, vfs_file_validate);
         }
+
+      OvmsCommand* extract = cmd_can_log->RegisterCommand("extract", "Extract time range from VFS log");
+      MyCanFormatFactory.RegisterCommandSet(extract, "Extract time range from VFS log into new format",
+        can_log_vfs_extract,
+        "<path> <from> <to> [<outpath>]\n"
+        "<from>, <to>: seconds since log start, or unix time (i.e. 1668992145.5)\n"
+        "Default <outpath>: <path without extension>-extract.<format>",
+        3, 4, true, vfs_file_validate);
       }
     }
   }
@@ -93,6 +218,10 @@ canlog_vfs_conn::canlog_vfs_conn(canlog* logger, std::string format, canformat::
   : canlogconnection(logger, format, mode), m_file_size(0)
   {
   m_file = NULL;
+  m_index = NULL;
+  m_index_interval = 0;
+  m_index_next = 0;
+  m_index_count = 0;
   }
 
 canlog_vfs_conn::~canlog_vfs_conn()
@@ -102,23 +231,73 @@ canlog_vfs_conn::~canlog_vfs_conn()
     fclose(m_file);
     m_file = NULL;
     }
+  if (m_index)
+    {
+    fclose(m_index);
+    m_index = NULL;
+    }
   }
 
-void canlog_vfs_conn::OutputMsg(CAN_log_message_t& msg, std::string &result)
+bool canlog_vfs_conn::OpenIndex(std::string path, const char* format, uint32_t interval)
   {
-  m_msgcount++;
-
-  if ((m_filters != NULL) && (! m_filters->IsFiltered(&msg.frame)))
+  m_index = fopen(path.c_str(), "w");
+  if (!m_index)
     {
-    m_filtercount++;
-    return;
+    ESP_LOGW(TAG, "Can't write index '%s', logging without index", path.c_str());
+    return false;
     }
 
-  if (result.length()>0)
+  canlog_index_header_t h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, "OVIX", 4);
+  h.version = CANLOG_INDEX_VERSION;
+  h.interval = interval;
+  strncpy(h.format, format, sizeof(h.format)-1);
+  fwrite(&h, sizeof(h), 1, m_index);
+
+  m_index_interval = interval;
+  m_index_next = 0;
+  m_index_count = 0;
+  return true;
+  }
+
+void canlog_vfs_conn::OutputBatch(canlog_batch& batch)
+  {
+  // Add a checkpoint at the first record due. The file offsets follow
+  // the entries passing the connection filters:
+  if (m_index)
     {
-    fwrite(result.c_str(),result.length(),1,m_file);
-    m_file_size += result.length();
+    size_t offset = m_file_size;
+    for (canlog_batch::entry_t& entry : batch.m_entries)
+      {
+      if (entry.length == 0 || !IsFiltered(entry.rec))
+        continue;
+      offset += entry.length;
+      if ((uint32_t)entry.rec.timestamp.tv_sec < m_index_next)
+        continue;
+      canlog_index_entry_t ie;
+      ie.ts_sec = entry.rec.timestamp.tv_sec;
+      ie.ts_usec = entry.rec.timestamp.tv_usec;
+      ie.offset = offset - entry.length;
+      if (fwrite(&ie, sizeof(ie), 1, m_index) == 1)
+        {
+        fflush(m_index);
+        m_index_count++;
+        }
+      m_index_next = ie.ts_sec + m_index_interval;
+      break;
+      }
     }
+
+  canlogconnection::OutputBatch(batch);
+  }
+
+void canlog_vfs_conn::OutputData(const char* data, size_t len, uint32_t count)
+  {
+  if (fwrite(data,len,1,m_file) == 1)
+    m_file_size += len;
+  else
+    m_dropcount += count;
   }
 
 
@@ -144,6 +323,7 @@ canlog_vfs::~canlog_vfs()
 
 bool canlog_vfs::Open()
   {
+  if (!m_ring) return false; // no log queue
   OvmsRecMutexLock lock(&m_cmmutex);
 
   if (m_isopen)
@@ -190,6 +370,10 @@ bool canlog_vfs::Open()
     clc->m_file_size += header.length();
     }
 
+  int interval = MyConfig.GetParamValueInt("can", "log.vfs.index", 10);
+  if (interval > 0)
+    clc->OpenIndex(m_path + ".idx", m_format.c_str(), interval);
+
   m_connmap[NULL] = clc;
   m_isopen = true;
 
@@ -200,10 +384,12 @@ void canlog_vfs::Close()
   {
   if (m_isopen)
     {
+    OvmsRecMutexLock lock(&m_cmmutex);
+    Flush(true);
+
     ESP_LOGI(TAG, "Closed vfs log '%s': %s",
       m_path.c_str(), GetStats().c_str());
 
-    OvmsRecMutexLock lock(&m_cmmutex);
     for (conn_map_t::iterator it=m_connmap.begin(); it!=m_connmap.end(); ++it)
       {
       delete it->second;
@@ -235,6 +421,11 @@ std::string canlog_vfs_conn::GetStats()
 
   std::string result = "Size:";
   result.append(bufsize);
+  if (m_index)
+    {
+    result.append(" Index:");
+    result.append(std::to_string(m_index_count));
+    }
   result.append(" ");
   result.append(canlogconnection::GetStats());
 
@@ -270,3 +461,184 @@ void canlog_vfs::MountListener(std::string event, void* data)
   else if (event == "sd.mounted" && startsWith(m_path, "/sd"))
     Open();
   }
+
+
+////////////////////////////////////////////////////////////////////////
+// CAN VFS log reader
+////////////////////////////////////////////////////////////////////////
+
+canlog_vfs_reader::canlog_vfs_reader(std::string path, std::string format)
+  {
+  m_path = path;
+  m_format = format;
+  m_file = NULL;
+  m_formatter = NULL;
+  m_buflen = 0;
+  m_bufpos = 0;
+  }
+
+canlog_vfs_reader::~canlog_vfs_reader()
+  {
+  Close();
+  }
+
+bool canlog_vfs_reader::LoadIndex()
+  {
+  m_index.clear();
+  FILE* f = fopen((m_path + ".idx").c_str(), "r");
+  if (!f) return false;
+
+  canlog_index_header_t h;
+  if (fread(&h, sizeof(h), 1, f) != 1 || memcmp(h.magic, "OVIX", 4) != 0
+      || h.version != CANLOG_INDEX_VERSION)
+    {
+    ESP_LOGW(TAG, "Ignoring invalid index for '%s'", m_path.c_str());
+    fclose(f);
+    return false;
+    }
+
+  h.format[sizeof(h.format)-1] = 0;
+  if (m_format.empty()) m_format = h.format;
+
+  canlog_index_entry_t ie;
+  while (fread(&ie, sizeof(ie), 1, f) == 1)
+    m_index.push_back(ie);
+  fclose(f);
+  return true;
+  }
+
+void canlog_vfs_reader::ResetFormatter()
+  {
+  if (m_formatter) delete m_formatter;
+  m_formatter = MyCanFormatFactory.NewFormat(m_format.c_str());
+  // Note: we only use put(), the serve mode just needs to be non-discarding
+  if (m_formatter) m_formatter->SetServeMode(canformat::Simulate);
+  m_buflen = 0;
+  m_bufpos = 0;
+  }
+
+bool canlog_vfs_reader::Open()
+  {
+  Close();
+
+  if (MyConfig.ProtectedPath(m_path))
+    {
+    m_error = "Path '" + m_path + "' is protected";
+    return false;
+    }
+
+  LoadIndex();
+
+  if (m_format.empty())
+    {
+    // No index, try the file extension:
+    size_t dot = m_path.find_last_of('.');
+    if (dot != std::string::npos)
+      m_format = m_path.substr(dot+1);
+    }
+
+  ResetFormatter();
+  if (!m_formatter)
+    {
+    m_error = "Unknown log format '" + m_format + "' (and no index)";
+    return false;
+    }
+
+  m_file = fopen(m_path.c_str(), "r");
+  if (!m_file)
+    {
+    m_error = "Can't read from '" + m_path + "'";
+    return false;
+    }
+
+  return true;
+  }
+
+void canlog_vfs_reader::Close()
+  {
+  if (m_file)
+    {
+    fclose(m_file);
+    m_file = NULL;
+    }
+  if (m_formatter)
+    {
+    delete m_formatter;
+    m_formatter = NULL;
+    }
+  }
+
+/**
+ * GetStartTime: get the time of the first checkpoint or message
+ */
+bool canlog_vfs_reader::GetStartTime(struct timeval& time)
+  {
+  if (!m_index.empty())
+    {
+    time.tv_sec = m_index[0].ts_sec;
+    time.tv_usec = m_index[0].ts_usec;
+    return true;
+    }
+
+  CAN_log_message_t msg;
+  struct timeval zero = { 0, 0 };
+  if (!Seek(zero) || !Read(&msg)) return false;
+  time = msg.timestamp;
+  return Seek(zero);
+  }
+
+/**
+ * Seek: position the reader at the last checkpoint at or before the time.
+ *  Without index, this rewinds to the log start.
+ */
+bool canlog_vfs_reader::Seek(const struct timeval& time)
+  {
+  if (!m_file) return false;
+
+  // Binary search for the last checkpoint <= time:
+  uint32_t offset = 0;
+  size_t lo = 0, hi = m_index.size();
+  while (lo < hi)
+    {
+    size_t mid = (lo + hi) / 2;
+    const canlog_index_entry_t& ie = m_index[mid];
+    if (ie.ts_sec < (uint32_t)time.tv_sec ||
+        (ie.ts_sec == (uint32_t)time.tv_sec && ie.ts_usec <= (uint32_t)time.tv_usec))
+      lo = mid + 1;
+    else
+      hi = mid;
+    }
+  if (lo > 0) offset = m_index[lo-1].offset;
+
+  if (fseek(m_file, offset, SEEK_SET) != 0) return false;
+  ResetFormatter();
+  return (m_formatter != NULL);
+  }
+
+/**
+ * Read: get the next message from the log
+ *  Returns false on end of file.
+ */
+bool canlog_vfs_reader::Read(CAN_log_message_t* msg)
+  {
+  if (!m_file || !m_formatter) return false;
+
+  while (1)
+    {
+    size_t parsed = 0;
+    size_t used = m_formatter->putbatch(msg, 1, m_buf + m_bufpos, m_buflen - m_bufpos, &parsed);
+    m_bufpos += used;
+
+    if (parsed > 0)
+      return true;
+    if (m_bufpos < m_buflen)
+      {
+      if (used == 0) return false; // formatter stalled
+      continue;
+      }
+
+    m_buflen = fread(m_buf, 1, sizeof(m_buf), m_file);
+    m_bufpos = 0;
+    if (m_buflen == 0) return false;
+    }
+  }
@@ -28,8 +28,36 @@
 #ifndef __CANLOG_VFS_H__
 #define __CANLOG_VFS_H__
 
+#include <vector>
 #include "canlog.h"
 
+/**
+ * VFS logs are accompanied by a sidecar index file (<path>.idx) holding
+ * (timestamp, file offset) checkpoints at fixed intervals (config
+ * "log.vfs.index" seconds, 0 = no index). Checkpoint offsets are record
+ * boundaries, and all records logged at or after a checkpoint time are
+ * stored at or after its offset, so a reader can seek to any time and
+ * parse from there.
+ */
+
+#define CANLOG_INDEX_VERSION 1
+
+typedef struct __attribute__ ((__packed__))
+  {
+  char magic[4];          /* "OVIX" */
+  uint8_t version;        /* CANLOG_INDEX_VERSION */
+  uint8_t reserved[3];
+  uint32_t interval;      /* checkpoint interval [s] */
+  char format[16];        /* log format name */
+  } canlog_index_header_t;
+
+typedef struct __attribute__ ((__packed__))
+  {
+  uint32_t ts_sec;        /* checkpoint time */
+  uint32_t ts_usec;
+  uint32_t offset;        /* log file offset */
+  } canlog_index_entry_t;
+
 
 class canlog_vfs_conn: public canlogconnection
   {
@@ -38,12 +66,20 @@ class canlog_vfs_conn: public canlogconnection
     virtual ~canlog_vfs_conn();
 
   public:
-    virtual void OutputMsg(CAN_log_message_t& msg, std::string &result);
+    virtual void OutputBatch(canlog_batch& batch);
+    virtual void OutputData(const char* data, size_t len, uint32_t count);
     virtual std::string GetStats();
 
+  public:
+    bool OpenIndex(std::string path, const char* format, uint32_t interval);
+
   public:
     FILE*               m_file;
     size_t              m_file_size;
+    FILE*               m_index;
+    uint32_t            m_index_interval;
+    uint32_t            m_index_next;
+    uint32_t            m_index_count;
   };
 
 
@@ -67,4 +103,43 @@ class canlog_vfs : public canlog
     std::string         m_path;
   };
 
+/**
+ * canlog_vfs_reader: sequential reader for VFS logs in any registered
+ *  format, seeking by time using the sidecar index (if available).
+ */
+class canlog_vfs_reader
+  {
+  public:
+    canlog_vfs_reader(std::string path, std::string format="");
+    ~canlog_vfs_reader();
+
+  public:
+    bool Open();
+    void Close();
+    bool Seek(const struct timeval& time);
+    bool Read(CAN_log_message_t* msg);
+
+  public:
+    const char* GetFormat()     { return m_format.c_str(); }
+    bool HasIndex()             { return !m_index.empty(); }
+    bool GetStartTime(struct timeval& time);
+
+  protected:
+    bool LoadIndex();
+    void ResetFormatter();
+
+  public:
+    std::string         m_path;
+    std::string         m_format;
+    std::string         m_error;
+
+  protected:
+    FILE*               m_file;
+    canformat*          m_formatter;
+    std::vector<canlog_index_entry_t> m_index;
+    uint8_t             m_buf[512];
+    size_t              m_buflen;
+    size_t              m_bufpos;
+  };
+
 #endif // __CANLOG_VFS_H__
@@ -40,6 +40,11 @@ static const char *TAG = "canplay";
 #include "ovms_events.h"
 #include "ovms_peripherals.h"
 #include "metrics_standard.h"
+#include "esp_timer.h"
+#include "ovms_malloc.h"
+
+#define PLAY_MAXSLEEP_US      50000   // re-check player state at least every 50 ms
+#define PLAY_MINSPACE         4       // as-fast-as-possible: min free listener queue slots
 
 ////////////////////////////////////////////////////////////////////////
 // Command Processing
@@ -124,6 +129,39 @@ void can_play_list(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc
     }
   }
 
+void can_play_expand(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (!MyCan.HasPlayer())
+    {
+    writer->puts("CAN playing inactive");
+    return;
+    }
+
+  bool expand = (strcmp(cmd->GetName(), "on") == 0);
+  if (argc==1)
+    {
+    canplay* cl = MyCan.GetPlayer(atoi(argv[0]));
+    if (cl)
+      {
+      cl->SetExpand(expand);
+      writer->printf("CAN playing active: %s\n", cl->GetInfo().c_str());
+      }
+    else
+      {
+      writer->puts("Error: Cannot find specified can player");
+      }
+    }
+  else
+    {
+    OvmsMutexLock lock(&MyCan.m_playermap_mutex);
+    for (can::canplay_map_t::iterator it=MyCan.m_playermap.begin(); it!=MyCan.m_playermap.end(); ++it)
+      {
+      it->second->SetExpand(expand);
+      writer->printf("CAN player #%" PRId32 ": %s\n", it->first, it->second->GetInfo().c_str());
+      }
+    }
+  }
+
 void can_play_speed(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
   {
   if (!MyCan.HasPlayer())
@@ -182,7 +220,12 @@ OvmsCanPlayInit::OvmsCanPlayInit()
 
   OvmsCommand* cmd_canplay = cmd_can->RegisterCommand("play", "CAN play framework");
   cmd_canplay->RegisterCommand("stop", "Stop playing", can_play_stop,"[<id>]",0,1);
-  cmd_canplay->RegisterCommand("speed", "Set playback speed", can_play_speed,"<speed> [<id>]",1,2);
+  cmd_canplay->RegisterCommand("speed", "Set playback speed", can_play_speed,
+    "<speed> [<id>]\n"
+    "<speed>: time scale factor, 0 = as fast as possible",1,2);
+  OvmsCommand* cmd_expand = cmd_canplay->RegisterCommand("expand", "Expand repeats of change-only logs");
+  cmd_expand->RegisterCommand("on", "Play suppressed repeats (default)", can_play_expand,"[<id>]",0,1);
+  cmd_expand->RegisterCommand("off", "Play logged frames only", can_play_expand,"[<id>]",0,1);
   cmd_canplay->RegisterCommand("status", "Playing status", can_play_status,"[<id>]",0,1);
   cmd_canplay->RegisterCommand("list", "Playing list", can_play_list);
   cmd_canplay->RegisterCommand("start", "CAN play start framework");
@@ -192,55 +235,278 @@ OvmsCanPlayInit::OvmsCanPlayInit()
 // CAN Play class
 ////////////////////////////////////////////////////////////////////////
 
-canplay::canplay(const char* type, std::string format, canformat::canformat_serve_mode_t mode)
+canplay::canplay(const char* type, std::string format)
   {
   m_type = type;
   m_format = format;
-  m_formatter = MyCanFormatFactory.NewFormat(format.c_str());
-  m_formatter->SetServeMode(mode);
   m_filter = NULL;
   m_speed = 1;
 
   m_msgcount = 0;
+  m_filtercount = 0;
+  m_skipcount = 0;
+  m_expand = MyConfig.GetParamValueBool("can", "play.expand", true);
+  m_expandcount = 0;
+  m_played = (canlog_dedup::entry_t*) ExternalRamMalloc(CANLOG_DEDUP_SLOTS * sizeof(canlog_dedup::entry_t));
+  if (m_played) memset(m_played, 0, CANLOG_DEDUP_SLOTS * sizeof(canlog_dedup::entry_t));
+  m_playing = false;
+  m_rebase = true;
+  m_starttime = m_endtime = m_basetime = 0;
+  m_firstts = m_lastts = 0;
+  m_lag_sum = m_lag_max = 0;
+  m_lag_count = 0;
+  m_stop = false;
+  m_stopped = xSemaphoreCreateBinary();
   xTaskCreatePinnedToCore(PlayTask, "OVMS CanPlay", 4096, (void*)this, 10, &m_task, CORE(1));
   }
 
 canplay::~canplay()
   {
-  if (m_task)
+  // Sub classes need to Stop() before closing their input, this is a fallback:
+  Stop();
+  vSemaphoreDelete(m_stopped);
+
+  if (m_filter)
     {
-    vTaskDelete(m_task);
-    m_task = NULL;
+    delete m_filter;
+    m_filter = NULL;
     }
 
-  if (m_formatter)
+  if (m_played)
     {
-    delete m_formatter;
-    m_formatter = NULL;
+    free(m_played);
+    m_played = NULL;
     }
+  }
 
-  if (m_filter)
+void canplay::PlayTask(void *context)
+  {
+  canplay* me = (canplay*) context;
+  CAN_log_message_t msg;
+
+  while (!me->m_stop)
     {
-    delete m_filter;
-    m_filter = NULL;
+    // Wait for Start() or Stop():
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    if (me->m_stop) break;
+
+    while (me->Active())
+      {
+        {
+        OvmsMutexLock lock(&me->m_mutex);
+        if (!me->Active() || !me->InputMsg(&msg)) break;
+        }
+      me->PlayMsg(msg);
+      }
+
+    me->PlayEnd();
     }
+
+  xSemaphoreGive(me->m_stopped);
+  vTaskDelete(NULL);
   }
 
-void canplay::PlayTask(void *context)
+/**
+ * Stop: terminate the player task and wait for it to exit
+ *  (to be called by sub class destructors before closing their input,
+ *  as the task uses the virtual IsOpen() / InputMsg())
+ */
+void canplay::Stop()
   {
-//  canplay* me = (canplay*) context;
+  if (!m_task) return;
+  m_stop = true;
+  xTaskNotifyGive(m_task);
+  xSemaphoreTake(m_stopped, portMAX_DELAY);
+  m_task = NULL;
+  }
 
-//  CAN_log_message_t msg;
-//  while (me->InputMsg(&msg))
-//    {
-//    vTaskDelay(pdMS_TO_TICKS(1000));
-//    }
+/**
+ * Active: player task shall continue (not stopping, input open)
+ */
+bool canplay::Active()
+  {
+  return !m_stop && IsOpen();
+  }
 
-//  me->Close();
-  while(1)
+/**
+ * InjectFrame: pass a frame to the CAN RX queue, like a driver does.
+ *  The CAN task then dispatches it in the regular RX context.
+ */
+bool canplay::InjectFrame(CAN_frame_t& frame)
+  {
+  CAN_queue_msg_t qmsg;
+  memset(&qmsg, 0, sizeof(qmsg));
+  qmsg.type = CAN_frame;
+  qmsg.body.frame = frame;
+  qmsg.body.frame.callback = NULL;
+  while (Active())
     {
-    vTaskDelay(pdMS_TO_TICKS(1000));
+    if (xQueueSend(MyCan.m_rxqueue, &qmsg, pdMS_TO_TICKS(10)) == pdTRUE)
+      return true;
     }
+  return false;
+  }
+
+/**
+ * Start: (re)start playing from the current input position
+ *  (to be called by sub classes after a successful Open())
+ */
+void canplay::Start()
+  {
+  m_msgcount = 0;
+  m_filtercount = 0;
+  m_skipcount = 0;
+  m_expandcount = 0;
+  if (m_played) memset(m_played, 0, CANLOG_DEDUP_SLOTS * sizeof(canlog_dedup::entry_t));
+  m_lag_sum = m_lag_max = 0;
+  m_lag_count = 0;
+  m_starttime = m_endtime = m_basetime = 0;
+  m_rebase = true;
+  m_playing = true;
+  xTaskNotifyGive(m_task);
+  }
+
+/**
+ * PlayMsg: play a log message
+ */
+void canplay::PlayMsg(CAN_log_message_t& msg)
+  {
+  if (m_expand && m_played && msg.type == CAN_LogInfo_Comment && msg.origin != NULL && msg.text != NULL
+    && strncmp(msg.text, CANLOG_DEDUP_PREFIX, strlen(CANLOG_DEDUP_PREFIX)) == 0)
+    {
+    PlayRepeats(msg);
+    return;
+    }
+  if (msg.type != CAN_LogFrame_RX || msg.frame.origin == NULL)
+    {
+    m_skipcount++;
+    return;
+    }
+  if (m_expand && m_played)
+    {
+    // Remember the frame as the template for following repeats:
+    canlog_dedup::entry_t& e = m_played[canlog_dedup::Slot(msg.frame.origin, msg.frame.MsgID)];
+    e.origin = msg.frame.origin;
+    e.MsgID = msg.frame.MsgID;
+    e.FIR = msg.frame.FIR;
+    memcpy(e.u8, msg.frame.data.u8, 8);
+    e.emitted = msg.timestamp;
+    }
+  PlayFrame(msg);
+  }
+
+/**
+ * PlayRepeats: expand a change-only log comment "dedup <id> <count>",
+ *  spreading the repeats evenly between the last frame and the comment time.
+ *  The comment is logged after the run, so repeats older than the last frame
+ *  played are injected immediately (timing accuracy = heartbeat interval).
+ */
+void canplay::PlayRepeats(CAN_log_message_t& msg)
+  {
+  char* p;
+  const char* b = msg.text + strlen(CANLOG_DEDUP_PREFIX);
+  uint32_t msgid = strtoul(b, &p, 16);
+  uint32_t count = strtoul(p, NULL, 10);
+
+  canlog_dedup::entry_t& e = m_played[canlog_dedup::Slot(msg.origin, msgid)];
+  if (e.origin != msg.origin || e.MsgID != msgid || count == 0)
+    {
+    // Template frame not seen (i.e. extract started within a run):
+    m_skipcount++;
+    return;
+    }
+
+  canbus* origin = msg.origin;
+  int64_t ts0 = (int64_t)e.emitted.tv_sec * 1000000 + e.emitted.tv_usec;
+  int64_t ts1 = (int64_t)msg.timestamp.tv_sec * 1000000 + msg.timestamp.tv_usec;
+  if (ts1 < ts0) ts1 = ts0;
+
+  CAN_log_message_t rep;
+  for (uint32_t i = 1; i <= count && Active(); i++)
+    {
+    memset(&rep, 0, sizeof(rep));
+    rep.type = CAN_LogFrame_RX;
+    rep.frame.origin = origin;
+    rep.frame.FIR = e.FIR;
+    rep.frame.MsgID = e.MsgID;
+    memcpy(rep.frame.data.u8, e.u8, 8);
+    int64_t ts = ts0 + (ts1 - ts0) * i / count;
+    rep.timestamp.tv_sec = ts / 1000000;
+    rep.timestamp.tv_usec = ts % 1000000;
+    PlayFrame(rep, true);
+    m_expandcount++;
+    }
+  e.emitted = msg.timestamp;
+  }
+
+/**
+ * PlayFrame: inject a received frame, reproducing the log timing
+ */
+void canplay::PlayFrame(CAN_log_message_t& msg, bool repeat)
+  {
+  if (m_filter && !m_filter->IsFiltered(&msg.frame))
+    {
+    m_filtercount++;
+    return;
+    }
+
+  int64_t ts = (int64_t)msg.timestamp.tv_sec * 1000000 + msg.timestamp.tv_usec;
+  int64_t now = esp_timer_get_time();
+  uint32_t speed = m_speed;
+
+  if (m_starttime == 0)
+    m_starttime = now;
+
+  if (speed == 0 || (repeat && ts <= m_lastts))
+    {
+    // As fast as possible, or an expanded repeat already due (the dedup
+    //  comment follows the run): only pace to the slowest frame consumer
+    while ((MyCan.GetListenerSpace() < PLAY_MINSPACE
+      || uxQueueSpacesAvailable(MyCan.m_rxqueue) < PLAY_MINSPACE) && Active())
+      vTaskDelay(1);
+    if (repeat)
+      {
+      if (InjectFrame(msg.frame)) m_msgcount++;
+      return;
+      }
+    m_rebase = true;
+    }
+  else
+    {
+    if (m_rebase || ts < m_lastts)
+      {
+      // (Re)start the timeline on first frame, speed change or time warp:
+      m_firstts = ts;
+      m_basetime = now;
+      m_rebase = false;
+      }
+    int64_t due = m_basetime + (ts - m_firstts) / speed;
+    int64_t wait = due - now;
+    while (wait >= portTICK_PERIOD_MS * 1000 && Active())
+      {
+      // Sleep in slices to react to Close(); waits below one tick are released early
+      vTaskDelay(pdMS_TO_TICKS(MIN(wait, PLAY_MAXSLEEP_US) / 1000));
+      now = esp_timer_get_time();
+      wait = due - now;
+      }
+    if (wait < 0)
+      {
+      m_lag_sum -= wait;
+      if (-wait > m_lag_max) m_lag_max = -wait;
+      }
+    m_lag_count++;
+    }
+  m_lastts = ts;
+
+  if (InjectFrame(msg.frame)) m_msgcount++;
+  }
+
+void canplay::PlayEnd()
+  {
+  if (!m_playing) return;
+  m_endtime = esp_timer_get_time();
+  m_playing = false;
+  ESP_LOGI(TAG, "Playback finished: %s", GetStats().c_str());
   }
 
 const char* canplay::GetType()
@@ -253,9 +519,15 @@ const char* canplay::GetFormat()
   return m_format.c_str();
   }
 
+void canplay::SetExpand(bool expand)
+  {
+  m_expand = expand;
+  }
+
 void canplay::SetSpeed(uint32_t speed)
   {
   m_speed = speed;
+  m_rebase = true;
   }
 
 bool canplay::InputMsg(CAN_log_message_t* msg)
@@ -268,12 +540,14 @@ std::string canplay::GetInfo()
   std::ostringstream buf;
 
   buf << "Type:" << m_type << " Format:" << m_format;
-  if (m_formatter)
-    {
-    buf << "(" << m_formatter->GetServeModeName() << ")";
-    }
 
-  buf << " Speed:" << m_speed << "x";
+  if (m_speed == 0)
+    buf << " Speed:AFAP";
+  else
+    buf << " Speed:" << m_speed << "x";
+
+  if (!m_expand)
+    buf << " Expand:off";
 
   if (m_filter)
     {
@@ -291,7 +565,25 @@ std::string canplay::GetStats()
   {
   std::ostringstream buf;
 
-  buf << "total messages: " << m_msgcount;
+  int64_t elapsed = (m_playing ? esp_timer_get_time() : m_endtime) - m_starttime;
+
+  buf << "total messages: " << m_msgcount
+      << " filtered: " << m_filtercount
+      << " skipped: " << m_skipcount;
+  if (m_expandcount)
+    buf << " expanded: " << m_expandcount;
+  if (m_starttime && elapsed > 0)
+    {
+    buf << " rate: " << std::fixed << std::setprecision(1)
+        << (double)m_msgcount * 1000000 / elapsed << " fps";
+    }
+  if (m_lag_count)
+    {
+    buf << " lag avg: " << (m_lag_sum / m_lag_count) / 1000.0
+        << " ms max: " << m_lag_max / 1000.0 << " ms";
+    }
+  if (m_starttime && !m_playing)
+    buf << " (finished)";
 
   return buf.str();
   }
@@ -30,14 +30,30 @@
 #include "freertos/semphr.h"
 #include "can.h"
 #include "canformat.h"
+#include "canlog.h"
+#include "ovms_mutex.h"
 
 /**
  * canplay is the general interface and base implementation for all can players.
+ *
+ * The player task reads messages via InputMsg() and injects the RX frames
+ * through the CAN RX queue (like a driver), reproducing the original inter-frame timing
+ * scaled by the speed factor. Speed 0 plays as fast as possible, paced only
+ * by the free space in the CAN listener queues, so a replay doubles as a
+ * throughput benchmark for vehicle decoders.
+ *
+ * Start() (re)starts playing after a successful Open(), sub classes need
+ * to lock m_mutex when closing their input, and need to Stop() the task in
+ * their destructor before releasing the input.
+ *
+ * Logs written in change-only mode (see canlog_dedup) are expanded: the
+ * repeats recorded by a "dedup" comment are played as copies of the last
+ * frame of the ID, evenly spaced up to the comment time.
  */
 class canplay : public InternalRamAllocated
   {
   public:
-    canplay(const char* type, std::string format, canformat::canformat_serve_mode_t mode=canformat::Simulate);
+    canplay(const char* type, std::string format);
     virtual ~canplay();
 
   public:
@@ -48,6 +64,7 @@ class canplay : public InternalRamAllocated
     const char* GetFormat();
     virtual std::string GetStats();
     void SetSpeed(uint32_t speed);
+    void SetExpand(bool expand);
 
   public:
     // Methods expected to be implemented by sub-classes
@@ -61,16 +78,45 @@ class canplay : public InternalRamAllocated
     virtual void SetFilter(canfilter* filter);
     virtual void ClearFilter();
 
+  public:
+    void Start();
+    void Stop();
+
+  protected:
+    bool Active();
+    bool InjectFrame(CAN_frame_t& frame);
+    void PlayMsg(CAN_log_message_t& msg);
+    void PlayFrame(CAN_log_message_t& msg, bool repeat=false);
+    void PlayRepeats(CAN_log_message_t& msg);
+    void PlayEnd();
+
   public:
     const char*         m_type;
     std::string         m_format;
     uint32_t            m_speed;
-    canformat*          m_formatter;
     canfilter*          m_filter;
 
   public:
     TaskHandle_t        m_task;
-    uint32_t            m_msgcount;
+    volatile bool       m_stop;             // task shall exit
+    SemaphoreHandle_t   m_stopped;          // task exit signal
+    OvmsMutex           m_mutex;            // input access
+    uint32_t            m_msgcount;         // frames injected
+    uint32_t            m_filtercount;
+    uint32_t            m_skipcount;        // non RX messages
+    bool                m_expand;           // expand change-only logs
+    uint32_t            m_expandcount;      // repeated frames played
+    canlog_dedup::entry_t* m_played;        // last frame per ID (for m_expand)
+    bool                m_playing;
+    bool                m_rebase;           // restart timeline at next frame
+    int64_t             m_starttime;        // esp_timer time of first frame
+    int64_t             m_endtime;
+    int64_t             m_basetime;         // esp_timer time of m_firstts
+    int64_t             m_firstts;          // log time of timeline base [us]
+    int64_t             m_lastts;
+    int64_t             m_lag_sum;          // timing error statistics [us]
+    int64_t             m_lag_max;
+    uint32_t            m_lag_count;
   };
 
 #endif // __CANPLAY_H__
@@ -46,6 +46,7 @@ void can_play_vfs_start(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int
       { MyCan.AddPlayer(player, argc-1, &argv[1]); }
     else
       { MyCan.AddPlayer(player); }
+    player->Start();
     writer->printf("CAN playing from VFS active: %s\n", player->GetInfo().c_str());
     }
   else
@@ -89,7 +90,7 @@ OvmsCanPlayVFSInit::OvmsCanPlayVFSInit()
 canplay_vfs::canplay_vfs(std::string path, std::string format)
   : canplay("vfs", format)
   {
-  m_file = NULL;
+  m_reader = NULL;
   m_path = path;
   using std::placeholders::_1;
   using std::placeholders::_2;
@@ -99,9 +100,10 @@ canplay_vfs::canplay_vfs(std::string path, std::string format)
 
 canplay_vfs::~canplay_vfs()
   {
+  Stop();
   MyEvents.DeregisterEvent(IDTAG);
 
-  if (m_file != NULL)
+  if (m_reader != NULL)
     {
     Close();
     }
@@ -109,11 +111,7 @@ canplay_vfs::~canplay_vfs()
 
 bool canplay_vfs::Open()
   {
-  if (m_file)
-    {
-    fclose(m_file);
-    m_file = NULL;
-    }
+  Close();
 
   if (MyConfig.ProtectedPath(m_path))
     {
@@ -129,13 +127,16 @@ bool canplay_vfs::Open()
     }
 #endif // #ifdef CONFIG_OVMS_COMP_SDCARD
 
-  m_file = fopen(m_path.c_str(), "r");
-  if (!m_file)
+  canlog_vfs_reader* reader = new canlog_vfs_reader(m_path, m_format);
+  if (!reader->Open())
     {
-    ESP_LOGE(TAG, "Error: Can't read from '%s'", m_path.c_str());
+    ESP_LOGE(TAG, "Error: %s", reader->m_error.c_str());
+    delete reader;
     return false;
     }
 
+  OvmsMutexLock lock(&m_mutex);
+  m_reader = reader;
   ESP_LOGI(TAG, "Now playing CAN messages from '%s'", m_path.c_str());
 
   return true;
@@ -143,10 +144,11 @@ bool canplay_vfs::Open()
 
 void canplay_vfs::Close()
   {
-  if (m_file)
+  OvmsMutexLock lock(&m_mutex);
+  if (m_reader)
     {
-    fclose(m_file);
-    m_file = NULL;
+    delete m_reader;
+    m_reader = NULL;
     ESP_LOGI(TAG, "Closed vfs playback '%s': %s",
       m_path.c_str(), GetStats().c_str());
     }
@@ -154,7 +156,7 @@ void canplay_vfs::Close()
 
 bool canplay_vfs::IsOpen()
   {
-  return (m_file != NULL);
+  return (m_reader != NULL);
   }
 
 std::string canplay_vfs::GetInfo()
@@ -170,13 +172,14 @@ void canplay_vfs::MountListener(std::string event, void* data)
   if (event == "sd.unmounting" && startsWith(m_path, "/sd"))
     Close();
   else if (event == "sd.mounted" && startsWith(m_path, "/sd"))
-    Open();
+    {
+    if (Open()) Start();
+    }
   }
 
 bool canplay_vfs::InputMsg(CAN_log_message_t* msg)
   {
-  if (m_file == NULL) return false;
-  if (m_formatter == NULL) return false;
+  if (m_reader == NULL) return false;
 
-  return false;
+  return m_reader->Read(msg);
   }
@@ -29,6 +29,7 @@
 #define __CANPLAY_VFS_H__
 
 #include "canplay.h"
+#include "canlog_vfs.h"
 
 class canplay_vfs : public canplay
   {
@@ -50,7 +51,7 @@ class canplay_vfs : public canplay
 
   public:
     std::string         m_path;
-    FILE*               m_file;
+    canlog_vfs_reader*  m_reader;
   };
 
 #endif // __CANPLAY_VFS_H__
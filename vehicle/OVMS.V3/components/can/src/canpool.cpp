@@ -0,0 +1,231 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Module:        CAN object pools
+;    Date:          18th October 2026
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011        Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+#include "ovms_log.h"
+static const char *TAG = "canpool";
+
+#include <stdlib.h>
+#include <string.h>
+#include "canpool.h"
+#include "ovms_command.h"
+
+static canpool* s_pools[CANPOOL_MAXPOOLS] = {};
+
+////////////////////////////////////////////////////////////////////////
+// Command Processing
+////////////////////////////////////////////////////////////////////////
+
+static void can_pool_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  writer->puts("Pool            Size Count InUse  Peak    Allocs  Fallback  Failed");
+  for (int k = 0; k < CANPOOL_MAXPOOLS; k++)
+    {
+    if (s_pools[k])
+      writer->puts(s_pools[k]->GetStats().c_str());
+    }
+  }
+
+static void can_pool_reset(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  for (int k = 0; k < CANPOOL_MAXPOOLS; k++)
+    {
+    if (s_pools[k])
+      s_pools[k]->ClearStats();
+    }
+  writer->puts("Pool statistics cleared");
+  }
+
+class OvmsCanPoolInit
+  {
+  public:
+    OvmsCanPoolInit();
+  } MyOvmsCanPoolInit  __attribute__ ((init_priority (4515)));
+
+OvmsCanPoolInit::OvmsCanPoolInit()
+  {
+  ESP_LOGI(TAG, "Initialising CAN object pools (4515)");
+
+  OvmsCommand* cmd_can = MyCommandApp.FindCommand("can");
+  if (cmd_can == NULL)
+    {
+    ESP_LOGE(TAG,"Cannot find CAN command - aborting pool command registration");
+    return;
+    }
+
+  OvmsCommand* cmd_pool = cmd_can->RegisterCommand("pool", "CAN object pools");
+  cmd_pool->RegisterCommand("status", "Show pool usage statistics", can_pool_status);
+  cmd_pool->RegisterCommand("reset", "Reset pool statistics", can_pool_reset);
+  }
+
+////////////////////////////////////////////////////////////////////////
+// canpool
+////////////////////////////////////////////////////////////////////////
+
+canpool::canpool(const char* name, size_t blocksize, uint32_t count)
+  {
+  m_name = name;
+  m_blocksize = (blocksize + 3) & ~3;
+  m_count = (count < CANPOOL_NIL) ? count : CANPOOL_NIL-1;
+  m_storage = (uint8_t*) InternalRamMalloc(m_blocksize * m_count);
+  m_next = (volatile uint16_t*) InternalRamMalloc(m_count * sizeof(uint16_t));
+  if (!m_storage || !m_next)
+    {
+    ESP_LOGE(TAG, "%s: cannot allocate %" PRIu32 " blocks of %u bytes", name, m_count, (unsigned)m_blocksize);
+    if (m_storage) free(m_storage);
+    if (m_next) free((void*)m_next);
+    m_storage = NULL;
+    m_next = NULL;
+    m_count = 0;
+    }
+  for (uint32_t k = 0; k < m_count; k++)
+    m_next[k] = (k+1 < m_count) ? k+1 : CANPOOL_NIL;
+  m_head = (m_count > 0) ? 0 : CANPOOL_NIL;
+  m_inuse = 0;
+  ClearStats();
+
+  for (int k = 0; k < CANPOOL_MAXPOOLS; k++)
+    {
+    if (s_pools[k] == NULL)
+      {
+      s_pools[k] = this;
+      break;
+      }
+    }
+  }
+
+canpool::~canpool()
+  {
+  for (int k = 0; k < CANPOOL_MAXPOOLS; k++)
+    {
+    if (s_pools[k] == this)
+      s_pools[k] = NULL;
+    }
+  if (m_storage) free(m_storage);
+  if (m_next) free((void*)m_next);
+  }
+
+canpool* canpool::GetPool(int index)
+  {
+  return (index >= 0 && index < CANPOOL_MAXPOOLS) ? s_pools[index] : NULL;
+  }
+
+/**
+ * Alloc: take a block from the free list
+ *  The tag in the upper half of the head word is incremented on every
+ *  pop, so a concurrent pop & push of the same block fails the CAS.
+ */
+void* canpool::Alloc()
+  {
+  uint32_t head = m_head.load(std::memory_order_acquire);
+  uint32_t index;
+  for (;;)
+    {
+    index = head & 0xffff;
+    if (index == CANPOOL_NIL)
+      return NULL;
+    uint32_t next = ((head + 0x10000) & 0xffff0000) | m_next[index];
+    if (m_head.compare_exchange_weak(head, next, std::memory_order_acq_rel, std::memory_order_acquire))
+      break;
+    }
+
+  uint32_t inuse = ++m_inuse;
+  uint32_t peak = m_peak.load(std::memory_order_relaxed);
+  while (inuse > peak && !m_peak.compare_exchange_weak(peak, inuse, std::memory_order_relaxed))
+    ;
+  m_allocs++;
+  return m_storage + index * m_blocksize;
+  }
+
+void canpool::Free(void* ptr)
+  {
+  if (!Owns(ptr)) return;
+  uint32_t index = ((uint8_t*)ptr - m_storage) / m_blocksize;
+  uint32_t head = m_head.load(std::memory_order_acquire);
+  do
+    {
+    m_next[index] = head & 0xffff;
+    } while (!m_head.compare_exchange_weak(head, (head & 0xffff0000) | index,
+                std::memory_order_acq_rel, std::memory_order_acquire));
+  m_inuse--;
+  }
+
+bool canpool::Owns(const void* ptr) const
+  {
+  return (m_storage != NULL
+    && (const uint8_t*)ptr >= m_storage
+    && (const uint8_t*)ptr < m_storage + m_count * m_blocksize);
+  }
+
+void* canpool::Alloc(size_t size)
+  {
+  void* ptr = (size <= m_blocksize) ? Alloc() : NULL;
+  if (ptr == NULL)
+    {
+    ptr = malloc(size);
+    if (ptr)
+      m_fallbacks++;
+    else
+      m_failed++;
+    }
+  return ptr;
+  }
+
+void canpool::Release(void* ptr)
+  {
+  if (ptr == NULL)
+    return;
+  else if (Owns(ptr))
+    Free(ptr);
+  else
+    free(ptr);
+  }
+
+char* canpool::Strdup(const char* text)
+  {
+  size_t len = strlen(text) + 1;
+  char* copy = (char*) Alloc(len);
+  if (copy) memcpy(copy, text, len);
+  return copy;
+  }
+
+std::string canpool::GetStats()
+  {
+  char buf[100];
+  snprintf(buf, sizeof(buf), "%-14.14s %5u %5" PRIu32 " %5" PRIu32 " %5" PRIu32 " %9" PRIu32 " %9" PRIu32 " %7" PRIu32,
+    m_name, (unsigned)m_blocksize, m_count, m_inuse.load(), m_peak.load(),
+    m_allocs.load(), m_fallbacks.load(), m_failed.load());
+  return std::string(buf);
+  }
+
+void canpool::ClearStats()
+  {
+  m_peak = m_inuse.load();
+  m_allocs = 0;
+  m_fallbacks = 0;
+  m_failed = 0;
+  }
@@ -0,0 +1,114 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Module:        CAN object pools
+;    Date:          18th October 2026
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011        Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+#ifndef __CANPOOL_H__
+#define __CANPOOL_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <string>
+#include "ovms.h"
+
+#define CANPOOL_MAXPOOLS      8
+#define CANPOOL_NIL           0xffff
+
+/**
+ * canpool: fixed size block pool in internal RAM for the CAN real time path.
+ *
+ * The free list is a lock free stack (index + ABA tag in one 32 bit word),
+ * so Alloc() & Free() never block and may be used from any task. Requests
+ * exceeding the block size or the pool capacity fall back to the heap and
+ * are counted, so the pool sizing can be checked with "can pool status".
+ * Release() returns a block to its origin (pool or heap).
+ */
+class canpool : public InternalRamAllocated
+  {
+  public:
+    canpool(const char* name, size_t blocksize, uint32_t count);
+    ~canpool();
+
+  public:
+    void* Alloc();                      // NULL if exhausted
+    void Free(void* ptr);
+    bool Owns(const void* ptr) const;
+
+  public:
+    void* Alloc(size_t size);           // with heap fallback
+    void Release(void* ptr);            // pool or heap
+    char* Strdup(const char* text);     // with heap fallback
+
+  public:
+    const char* GetName() const { return m_name; }
+    size_t GetBlockSize() const { return m_blocksize; }
+    uint32_t GetCount() const { return m_count; }
+    std::string GetStats();
+    void ClearStats();
+
+  public:
+    static canpool* GetPool(int index);
+
+  protected:
+    const char*           m_name;
+    size_t                m_blocksize;
+    uint32_t              m_count;
+    uint8_t*              m_storage;
+    volatile uint16_t*    m_next;       // free list links
+    std::atomic<uint32_t> m_head;       // tag << 16 | index
+
+  protected:
+    std::atomic<uint32_t> m_inuse;
+    std::atomic<uint32_t> m_peak;
+    std::atomic<uint32_t> m_allocs;
+    std::atomic<uint32_t> m_fallbacks;  // served by the heap
+    std::atomic<uint32_t> m_failed;     // heap fallback failed
+  };
+
+/**
+ * canpool_allocator: STL allocator adaptor, e.g. for std::allocate_shared()
+ */
+template <class T> class canpool_allocator
+  {
+  public:
+    typedef T value_type;
+
+  public:
+    canpool_allocator(canpool* pool) : m_pool(pool) {}
+    template <class U> canpool_allocator(const canpool_allocator<U>& other) : m_pool(other.m_pool) {}
+
+  public:
+    T* allocate(size_t n) { return (T*) m_pool->Alloc(n * sizeof(T)); }
+    void deallocate(T* ptr, size_t n) { m_pool->Release(ptr); }
+    template <class U> bool operator==(const canpool_allocator<U>& other) const { return m_pool == other.m_pool; }
+    template <class U> bool operator!=(const canpool_allocator<U>& other) const { return m_pool != other.m_pool; }
+
+  public:
+    canpool* m_pool;
+  };
+
+#endif //#ifndef __CANPOOL_H__
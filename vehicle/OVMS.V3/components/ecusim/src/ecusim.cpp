@@ -0,0 +1,390 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Module:        ECU simulator
+;    Date:          18th October 2026
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011        Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+#include "ovms_log.h"
+static const char *TAG = "ecusim";
+
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include "ecusim.h"
+#include "ovms_config.h"
+
+ecusimbus::ecusimbus(const char* name, canbus* target /*=NULL*/)
+  : canbus(name)
+  {
+  m_target = target ? target : this;
+  m_delivered = 0;
+  m_late_max = 0;
+  m_lastframe = 0;
+
+  esp_timer_create_args_t args = {};
+  args.callback = TimerCallback;
+  args.arg = this;
+  args.name = "ecusim";
+  if (esp_timer_create(&args, &m_timer) != ESP_OK)
+    {
+    ESP_LOGE(TAG, "%s: cannot create timer", name);
+    m_timer = NULL;
+    }
+  }
+
+ecusimbus::~ecusimbus()
+  {
+  Stop();
+  if (m_timer)
+    {
+    esp_timer_delete(m_timer);
+    m_timer = NULL;
+    }
+  }
+
+/**
+ * Start: attach to the target bus & reset the ECU states
+ */
+esp_err_t ecusimbus::Start(CAN_mode_t mode, CAN_speed_t speed)
+  {
+  if (m_timer == NULL)
+    return ESP_FAIL;
+  OvmsMutexLock lock(&m_mutex);
+  ClearStatus();
+  m_mode = mode;
+  m_speed = speed;
+  m_queue.clear();
+  m_lastframe = 0;
+  m_delivered = 0;
+  m_late_max = 0;
+  m_engine.Reset();
+  if (m_target != this)
+    m_target->SetOverlay(this);
+  ESP_LOGI(TAG, "%s: started on %s with %d ECUs", m_name, m_target->GetName(), (int)m_engine.m_ecus.size());
+  return ESP_OK;
+  }
+
+/**
+ * Stop: detach from the target bus, responses not yet received are discarded
+ */
+esp_err_t ecusimbus::Stop()
+  {
+  OvmsMutexLock lock(&m_mutex);
+  if (m_target != this && m_target->GetOverlay() == this)
+    m_target->SetOverlay(NULL);
+  if (m_timer)
+    esp_timer_stop(m_timer);
+  m_queue.clear();
+  m_mode = CAN_MODE_OFF;
+  return ESP_OK;
+  }
+
+/**
+ * BusTicker10: no inactivity watchdog
+ *  - there is no hardware to recover, a reset would discard the queued
+ *    responses & the ECU states and statistics
+ */
+void ecusimbus::BusTicker10(std::string event, void* data)
+  {
+  m_watchdog_timer = monotonictime;
+  }
+
+/**
+ * DriverWrite: pass a frame to the simulated ECUs
+ *  - the frame counts as sent immediately, the responses are queued
+ */
+esp_err_t ecusimbus::DriverWrite(const CAN_frame_t* p_frame, TickType_t maxqueuewait /*=0*/)
+  {
+  if (m_mode == CAN_MODE_OFF || m_target->m_mode != CAN_MODE_ACTIVE)
+    {
+    ESP_LOGW(TAG, "Cannot write %s when not in ACTIVE mode", m_target->GetName());
+    return ESP_FAIL;
+    }
+
+  CAN_frame_t frame = *p_frame;
+  frame.origin = m_target;
+
+  ecusim_frame_t request = {};
+  request.id = frame.MsgID;
+  request.ext = (frame.FIR.B.FF == CAN_frame_ext);
+  request.dlc = std::min<uint8_t>(frame.FIR.B.DLC, 8);
+  memcpy(request.data, frame.data.u8, request.dlc);
+
+    {
+    OvmsMutexLock lock(&m_mutex);
+    ecusim_outputs_t responses;
+    if (m_engine.Receive(request, esp_timer_get_time(), responses))
+      {
+      for (const ecusim_output_t& response : responses)
+        m_queue.emplace(response.due, response.frame);
+      Schedule();
+      }
+    }
+
+  // Application callbacks & logging, bypassing the TX queue handling of the target driver:
+  m_target->canbus::TxCallback(&frame, true);
+  return ESP_OK;
+  }
+
+/**
+ * Load: load an ECU script file (see EcuSimEngine::LoadLine())
+ */
+bool ecusimbus::Load(const std::string& path, std::string& error)
+  {
+  if (MyConfig.ProtectedPath(path))
+    {
+    error = "path is protected";
+    return false;
+    }
+  std::ifstream file(path, std::ios::in);
+  if (!file.is_open())
+    {
+    error = "cannot open file";
+    return false;
+    }
+  std::stringstream script;
+  script << file.rdbuf();
+
+  OvmsMutexLock lock(&m_mutex);
+  m_queue.clear();
+  m_path = path;
+  return m_engine.Load(script.str(), error);
+  }
+
+/**
+ * ResetEcus: reset ECU states, response sequences & statistics
+ */
+void ecusimbus::ResetEcus()
+  {
+  OvmsMutexLock lock(&m_mutex);
+  m_queue.clear();
+  m_engine.Reset();
+  m_delivered = 0;
+  m_late_max = 0;
+  }
+
+/**
+ * FrameTime: transmission time of a frame at the target bus speed [us]
+ */
+uint32_t ecusimbus::FrameTime()
+  {
+  return (uint64_t)ECUSIM_FRAMEBITS * 1000000 / MAP_CAN_SPEED(m_target->m_speed);
+  }
+
+void ecusimbus::Status(int verbosity, OvmsWriter* writer)
+  {
+  OvmsMutexLock lock(&m_mutex);
+  writer->printf("%s on %s: %s, script %s\n", m_name, m_target->GetName(),
+    (m_mode == CAN_MODE_OFF) ? "stopped" : "running", m_path.empty() ? "-" : m_path.c_str());
+  writer->printf("  frames received: %" PRIu32 ", max delay: %.1f ms, queued: %u\n",
+    m_delivered, (float)m_late_max / 1000, (unsigned)m_queue.size());
+  writer->printf("  %-10s %-6s %8s %8s %6s %6s %6s %6s %7s %7s %6s %6s\n",
+    "ECU", "Proto", "TxID", "RxID", "Req", "Resp", "NRC", "Unkn", "FrRx", "FrTx", "Drop", "Abort");
+  for (const EcuSimEngine::ecu_t& ecu : m_engine.m_ecus)
+    {
+    const char* proto =
+      (ecu.protocol == ISOTP_EXTADR) ? "extadr" :
+      (ecu.protocol == ISOTP_EXTFRAME) ? "ext" :
+      (ecu.protocol == VWTP_20) ? "vwtp" : "std";
+    writer->printf("  %-10.10s %-6s %8" PRIx32 " %8" PRIx32 " %6" PRIu32 " %6" PRIu32 " %6" PRIu32
+      " %6" PRIu32 " %7" PRIu32 " %7" PRIu32 " %6" PRIu32 " %6" PRIu32 "\n",
+      ecu.name.c_str(), proto, ecu.txid, ecu.rxid, ecu.requests, ecu.responses, ecu.errors,
+      ecu.unknown, ecu.frames_rx, ecu.frames_tx, ecu.dropped, ecu.aborted);
+    if (verbosity >= COMMAND_RESULT_NORMAL)
+      {
+      for (const EcuSimEngine::rule_t& rule : ecu.rules)
+        {
+        std::string prefix;
+        for (uint8_t byte : rule.prefix)
+          prefix += string_format("%02x", byte);
+        writer->printf("    %-16s hits: %" PRIu32 "\n", prefix.c_str(), rule.hits);
+        }
+      }
+    }
+  }
+
+void ecusimbus::TimerCallback(void* arg)
+  {
+  ((ecusimbus*)arg)->Run();
+  }
+
+/**
+ * Run: receive the response frames due (esp_timer task), then re-arm the timer
+ *  - frames are passed to the CAN task like frames received by a driver
+ */
+void ecusimbus::Run()
+  {
+  OvmsMutexLock lock(&m_mutex);
+  int64_t now = esp_timer_get_time();
+  uint32_t frametime = FrameTime();
+  CAN_queue_msg_t msg;
+
+  while (!m_queue.empty())
+    {
+    auto it = m_queue.begin();
+    int64_t slot = std::max(it->first, m_lastframe + frametime);
+    if (slot > now)
+      break;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.type = CAN_frame;
+    msg.body.frame.origin = m_target;
+    msg.body.frame.MsgID = it->second.id;
+    msg.body.frame.FIR.B.FF = it->second.ext ? CAN_frame_ext : CAN_frame_std;
+    msg.body.frame.FIR.B.DLC = it->second.dlc;
+    memcpy(msg.body.frame.data.u8, it->second.data, it->second.dlc);
+    if (xQueueSend(MyCan.m_rxqueue, &msg, 0) != pdTRUE)
+      m_target->m_status.rxbuf_overflow++;
+
+    m_delivered++;
+    if (now - it->first > m_late_max)
+      m_late_max = now - it->first;
+    m_lastframe = slot;
+    m_queue.erase(it);
+    }
+
+  Schedule();
+  }
+
+/**
+ * Schedule: arm the timer for the next frame (mutex held)
+ */
+void ecusimbus::Schedule()
+  {
+  if (m_timer == NULL)
+    return;
+  esp_timer_stop(m_timer);
+  if (m_queue.empty())
+    return;
+  int64_t next = std::max(m_queue.begin()->first, m_lastframe + FrameTime());
+  int64_t wait = next - esp_timer_get_time();
+  esp_timer_start_once(m_timer, (wait > 50) ? wait : 50);
+  }
+
+
+////////////////////////////////////////////////////////////////////////
+// Shell commands
+////////////////////////////////////////////////////////////////////////
+
+class EcuSimInit
+  {
+  public:
+    EcuSimInit();
+  public:
+    ecusimbus* m_sims[ECUSIM_MAXBUSES];
+  } MyEcuSimInit  __attribute__ ((init_priority (7050)));
+
+static void ecusim_start(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  static const char* names[ECUSIM_MAXBUSES] = { "ecusim1", "ecusim2", "ecusim3", "ecusim4" };
+  const char* busname = cmd->GetName();
+  int busno = busname[strlen(busname)-1] - '1';
+  canbus* bus = MyCan.GetBus(busno);
+  if (busno < 0 || busno >= ECUSIM_MAXBUSES || !bus)
+    {
+    writer->printf("ERROR: unknown CAN bus name '%s'\n", busname);
+    return;
+    }
+
+  ecusimbus*& sim = MyEcuSimInit.m_sims[busno];
+  if (!sim)
+    sim = new ecusimbus(names[busno], bus);
+  else
+    sim->Stop();
+
+  std::string error;
+  if (!sim->Load(argv[0], error))
+    {
+    writer->printf("ERROR: %s: %s\n", argv[0], error.c_str());
+    return;
+    }
+  if (sim->Start(CAN_MODE_ACTIVE, bus->m_speed) != ESP_OK)
+    {
+    writer->puts("ERROR: ECU simulator could not be started");
+    return;
+    }
+  writer->printf("ECU simulator started on %s with %d ECUs\n", busname, (int)sim->m_engine.m_ecus.size());
+  if (bus->m_mode != CAN_MODE_ACTIVE)
+    writer->printf("Note: %s needs to be started in active mode (by the vehicle module)\n", busname);
+  }
+
+static void ecusim_stop(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  int cnt = 0;
+  for (int k = 0; k < ECUSIM_MAXBUSES; k++)
+    {
+    ecusimbus* sim = MyEcuSimInit.m_sims[k];
+    if (sim && sim->m_mode != CAN_MODE_OFF)
+      {
+      sim->Stop();
+      cnt++;
+      }
+    }
+  writer->printf("%d ECU simulator(s) stopped\n", cnt);
+  }
+
+static void ecusim_reset(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  for (int k = 0; k < ECUSIM_MAXBUSES; k++)
+    {
+    if (MyEcuSimInit.m_sims[k])
+      MyEcuSimInit.m_sims[k]->ResetEcus();
+    }
+  writer->puts("ECU simulator states and statistics reset");
+  }
+
+static void ecusim_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  int cnt = 0;
+  for (int k = 0; k < ECUSIM_MAXBUSES; k++)
+    {
+    if (MyEcuSimInit.m_sims[k])
+      {
+      MyEcuSimInit.m_sims[k]->Status(verbosity, writer);
+      cnt++;
+      }
+    }
+  if (cnt == 0)
+    writer->puts("No ECU simulator started");
+  }
+
+EcuSimInit::EcuSimInit()
+  {
+  ESP_LOGI(TAG, "Initialising ECU simulator (7050)");
+
+  for (int k = 0; k < ECUSIM_MAXBUSES; k++)
+    m_sims[k] = NULL;
+
+  OvmsCommand* cmd_ecusim = MyCommandApp.RegisterCommand("ecusim","ECU simulator framework");
+  OvmsCommand* cmd_start = cmd_ecusim->RegisterCommand("start","Start the ECU simulator on a CAN bus");
+  cmd_start->RegisterCommand("can1","Start the ECU simulator on can1",ecusim_start,"<script>",1,1);
+  cmd_start->RegisterCommand("can2","Start the ECU simulator on can2",ecusim_start,"<script>",1,1);
+  cmd_start->RegisterCommand("can3","Start the ECU simulator on can3",ecusim_start,"<script>",1,1);
+  cmd_start->RegisterCommand("can4","Start the ECU simulator on can4",ecusim_start,"<script>",1,1);
+  cmd_ecusim->RegisterCommand("stop","Stop all ECU simulators",ecusim_stop);
+  cmd_ecusim->RegisterCommand("reset","Reset ECU states and statistics",ecusim_reset);
+  cmd_ecusim->RegisterCommand("status","Show ECU simulator statistics",ecusim_status);
+  }
@@ -0,0 +1,94 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Module:        ECU simulator
+;    Date:          18th October 2026
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011        Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+#ifndef __ECUSIM_H__
+#define __ECUSIM_H__
+
+#include <map>
+#include <string>
+#include "esp_timer.h"
+#include "can.h"
+#include "ovms_mutex.h"
+#include "ovms_command.h"
+#include "ecusim_engine.h"
+
+#define ECUSIM_MAXBUSES       4
+#define ECUSIM_FRAMEBITS      130     // bits of an 8 byte standard frame incl. stuffing
+
+/**
+ * ecusimbus: virtual CAN bus running an EcuSimEngine
+ *
+ *  Frames written to the bus go to the simulated ECUs, their responses are
+ *  received at their due time, spaced by the frame time at the bus speed.
+ *
+ *  Attached to a hardware bus as its overlay, the simulator takes all frames
+ *  written to that bus (canbus::Write() & WritePriority(), i.e. also the
+ *  poller, CAN_frame_t::Write(), WriteStandard() & WriteExtended()), and the
+ *  responses are received on that bus. So the poller and vehicle modules run
+ *  unchanged. Without a target, the simulator is a bus of its own.
+ */
+class ecusimbus : public canbus
+  {
+  public:
+    ecusimbus(const char* name, canbus* target=NULL);
+    ~ecusimbus();
+
+  public:
+    esp_err_t Start(CAN_mode_t mode, CAN_speed_t speed);
+    esp_err_t Stop();
+
+  protected:
+    esp_err_t DriverWrite(const CAN_frame_t* p_frame, TickType_t maxqueuewait=0);
+    void BusTicker10(std::string event, void* data);
+
+  public:
+    bool Load(const std::string& path, std::string& error);
+    void ResetEcus();
+    void Status(int verbosity, OvmsWriter* writer);
+    uint32_t FrameTime();
+
+  protected:
+    static void TimerCallback(void* arg);
+    void Run();
+    void Schedule();
+
+  public:
+    canbus*             m_target;       // bus the responses are received on
+    std::string         m_path;         // script file
+    EcuSimEngine        m_engine;
+    uint32_t            m_delivered;    // response frames received
+    uint32_t            m_late_max;     // max delivery delay after due time [us]
+
+  protected:
+    OvmsMutex           m_mutex;        // engine & queue
+    esp_timer_handle_t  m_timer;
+    std::multimap<int64_t, ecusim_frame_t> m_queue;
+    int64_t             m_lastframe;    // delivery time of the last frame
+  };
+
+#endif //#ifndef __ECUSIM_H__
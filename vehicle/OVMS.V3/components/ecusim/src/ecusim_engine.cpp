@@ -0,0 +1,778 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Module:        ECU simulator
+;    Date:          18th October 2026
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011        Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <sstream>
+#include "ecusim_engine.h"
+
+// Time units of VW-TP timing parameters [us]:
+static const uint32_t vwtp_timeunit[4] = { 100, 1000, 10000, 100000 };
+
+static uint32_t IsoTpDecodeSepTime(uint8_t stmin)
+  {
+  if (stmin <= 0x7f)
+    return stmin * 1000;
+  else if (stmin >= 0xf1 && stmin <= 0xf9)
+    return (stmin - 0xf0) * 100;
+  else
+    return 127000;
+  }
+
+static uint8_t IsoTpEncodeSepTime(uint32_t us)
+  {
+  if (us == 0)
+    return 0;
+  else if (us < 1000)
+    return 0xf0 + ((us < 100) ? 1 : us / 100);
+  else
+    return (us >= 127000) ? 127 : us / 1000;
+  }
+
+static uint32_t VwtpDecodeTime(uint8_t t)
+  {
+  return (t & 0x3f) * vwtp_timeunit[t >> 6];
+  }
+
+static uint8_t VwtpEncodeTime(uint32_t us)
+  {
+  for (int unit = 0; unit < 4; unit++)
+    {
+    if (us / vwtp_timeunit[unit] <= 0x3f)
+      return (unit << 6) | (us / vwtp_timeunit[unit]);
+    }
+  return 0xff;
+  }
+
+static bool ParseHex(const std::string& token, std::vector<uint8_t>& data)
+  {
+  if (token.size() % 2)
+    return false;
+  for (size_t i = 0; i < token.size(); i += 2)
+    {
+    if (!isxdigit(token[i]) || !isxdigit(token[i+1]))
+      return false;
+    data.push_back(strtoul(token.substr(i, 2).c_str(), NULL, 16));
+    }
+  return true;
+  }
+
+
+EcuSimEngine::EcuSimEngine()
+  {
+  SetSeed(1);
+  }
+
+/**
+ * Load: replace the ECU table by a script
+ *  - one statement per line, see LoadLine()
+ *  - on error, the table holds the ECUs defined up to the failing line
+ */
+bool EcuSimEngine::Load(const std::string& script, std::string& error)
+  {
+  Clear();
+  std::istringstream in(script);
+  std::string line;
+  int lineno = 0;
+  while (std::getline(in, line))
+    {
+    lineno++;
+    if (!LoadLine(line, error))
+      {
+      error = "line " + std::to_string(lineno) + ": " + error;
+      return false;
+      }
+    }
+  return true;
+  }
+
+/**
+ * LoadLine: process a script statement
+ *
+ *  ecu <name> <txid> <rxid> [std|extadr|ext|vwtp]
+ *  delay <ms> [<jitter_ms>]
+ *  flow <septime_us> [<blocksize>]
+ *  drop <percent>
+ *  pad <byte>|off
+ *  nrc <code>|off
+ *  req <prefix> [pending=<n>] [delay=<ms>] <response> [<response> …]
+ *  seed <n>
+ *
+ *  Settings and rules apply to the last ECU defined. Responses are served
+ *  in turn; a response is a hex string optionally followed by +<n> fill
+ *  bytes, "nrc:<code>" for a negative response or "none" for no response.
+ */
+bool EcuSimEngine::LoadLine(const std::string& line, std::string& error)
+  {
+  std::istringstream in(line.substr(0, line.find('#')));
+  std::vector<std::string> args;
+  std::string token;
+  while (in >> token)
+    args.push_back(token);
+  if (args.empty())
+    return true;
+
+  const std::string& cmd = args[0];
+  if (cmd == "seed" && args.size() == 2)
+    {
+    SetSeed(strtoul(args[1].c_str(), NULL, 10));
+    return true;
+    }
+  if (cmd == "ecu")
+    {
+    if (args.size() < 4 || args.size() > 5)
+      {
+      error = "usage: ecu <name> <txid> <rxid> [std|extadr|ext|vwtp]";
+      return false;
+      }
+    ecu_t ecu;
+    ecu.name = args[1];
+    ecu.txid = strtoul(args[2].c_str(), NULL, 16);
+    ecu.rxid = strtoul(args[3].c_str(), NULL, 16);
+    if (args.size() == 5)
+      {
+      if (args[4] == "std")
+        ecu.protocol = ISOTP_STD;
+      else if (args[4] == "extadr")
+        ecu.protocol = ISOTP_EXTADR;
+      else if (args[4] == "ext")
+        ecu.protocol = ISOTP_EXTFRAME;
+      else if (args[4] == "vwtp")
+        ecu.protocol = VWTP_20;
+      else
+        {
+        error = "unknown protocol '" + args[4] + "'";
+        return false;
+        }
+      }
+    m_ecus.push_back(ecu);
+    return true;
+    }
+
+  if (m_ecus.empty())
+    {
+    error = "'" + cmd + "' needs an ecu";
+    return false;
+    }
+  ecu_t& ecu = m_ecus.back();
+
+  if (cmd == "delay" && args.size() >= 2 && args.size() <= 3)
+    {
+    ecu.delay = strtod(args[1].c_str(), NULL) * 1000;
+    ecu.jitter = (args.size() == 3) ? strtod(args[2].c_str(), NULL) * 1000 : 0;
+    }
+  else if (cmd == "flow" && args.size() >= 2 && args.size() <= 3)
+    {
+    ecu.septime = strtoul(args[1].c_str(), NULL, 10);
+    ecu.bs = (args.size() == 3) ? strtoul(args[2].c_str(), NULL, 10) : 0;
+    }
+  else if (cmd == "drop" && args.size() == 2)
+    {
+    double percent = strtod(args[1].c_str(), NULL);
+    ecu.drop = (percent <= 0) ? 0 : (percent >= 100) ? 1000 : percent * 10;
+    }
+  else if (cmd == "pad" && args.size() == 2)
+    {
+    ecu.pad = (args[1] == "off") ? -1 : (int16_t)(strtoul(args[1].c_str(), NULL, 16) & 0xff);
+    }
+  else if (cmd == "nrc" && args.size() == 2)
+    {
+    ecu.nrc = (args[1] == "off") ? 0 : strtoul(args[1].c_str(), NULL, 16);
+    }
+  else if (cmd == "req" && args.size() >= 3)
+    {
+    rule_t rule = {};
+    rule.delay = -1;
+    if (!ParseHex(args[1], rule.prefix) || rule.prefix.empty())
+      {
+      error = "invalid request prefix '" + args[1] + "'";
+      return false;
+      }
+    for (size_t i = 2; i < args.size(); i++)
+      {
+      const std::string& arg = args[i];
+      response_t response = {};
+      if (arg.compare(0, 8, "pending=") == 0)
+        {
+        rule.pending = strtoul(arg.c_str()+8, NULL, 10);
+        continue;
+        }
+      else if (arg.compare(0, 6, "delay=") == 0)
+        {
+        rule.delay = strtod(arg.c_str()+6, NULL) * 1000;
+        continue;
+        }
+      else if (arg.compare(0, 4, "nrc:") == 0)
+        {
+        response.nrc = strtoul(arg.c_str()+4, NULL, 16);
+        }
+      else if (arg != "none")
+        {
+        size_t fill = arg.find('+');
+        int fillcnt = (fill != std::string::npos) ? atoi(arg.c_str()+fill+1) : 0;
+        if (!ParseHex(arg.substr(0, fill), response.data) || fillcnt < 0
+          || response.data.size() + fillcnt > 4095)
+          {
+          error = "invalid response '" + arg + "'";
+          return false;
+          }
+        for (int k = 0; k < fillcnt; k++)
+          response.data.push_back(k & 0xff);
+        }
+      rule.responses.push_back(response);
+      }
+    if (rule.responses.empty())
+      {
+      error = "no response for request '" + args[1] + "'";
+      return false;
+      }
+    ecu.rules.push_back(rule);
+    }
+  else
+    {
+    error = "invalid statement '" + cmd + "'";
+    return false;
+    }
+  return true;
+  }
+
+/**
+ * Clear: remove all ECUs
+ */
+void EcuSimEngine::Clear()
+  {
+  m_ecus.clear();
+  m_rand = m_seed;
+  }
+
+/**
+ * Reset: reset protocol states, response sequences & statistics
+ */
+void EcuSimEngine::Reset()
+  {
+  for (ecu_t& ecu : m_ecus)
+    {
+    ecu_t fresh;
+    fresh.name = ecu.name;
+    fresh.protocol = ecu.protocol;
+    fresh.txid = ecu.txid;
+    fresh.rxid = ecu.rxid;
+    fresh.delay = ecu.delay;
+    fresh.jitter = ecu.jitter;
+    fresh.septime = ecu.septime;
+    fresh.bs = ecu.bs;
+    fresh.pad = ecu.pad;
+    fresh.drop = ecu.drop;
+    fresh.nrc = ecu.nrc;
+    fresh.rules.swap(ecu.rules);
+    for (rule_t& rule : fresh.rules)
+      {
+      rule.next = 0;
+      rule.hits = 0;
+      }
+    ecu = std::move(fresh);
+    }
+  m_rand = m_seed;
+  }
+
+/**
+ * Receive: process a frame sent by the tester
+ *  - response frames are appended to out with their due time
+ *  - returns true if the frame was addressed to a simulated ECU
+ */
+bool EcuSimEngine::Receive(const ecusim_frame_t& frame, int64_t now, ecusim_outputs_t& out)
+  {
+  bool consumed = false;
+  for (ecu_t& ecu : m_ecus)
+    {
+    bool match = (ecu.protocol == VWTP_20)
+      ? VwtpReceive(ecu, frame, now, out)
+      : IsoTpReceive(ecu, frame, now, out);
+    if (match)
+      {
+      ecu.frames_rx++;
+      consumed = true;
+      }
+    }
+  return consumed;
+  }
+
+/**
+ * IsoTpReceive: ISO-TP request reception & response flow control
+ */
+bool EcuSimEngine::IsoTpReceive(ecu_t& ecu, const ecusim_frame_t& frame, int64_t now, ecusim_outputs_t& out)
+  {
+  uint8_t offset = 0;
+  if (ecu.protocol == ISOTP_EXTADR)
+    {
+    if (frame.ext || frame.id != (ecu.txid >> 8) || frame.dlc < 2 || frame.data[0] != (ecu.txid & 0xff))
+      return false;
+    offset = 1;
+    }
+  else if (frame.id != ecu.txid || frame.ext != (ecu.protocol == ISOTP_EXTFRAME) || frame.dlc < 1)
+    return false;
+
+  const uint8_t* fr_data = frame.data + offset;
+  uint8_t fr_len = frame.dlc - offset;
+  uint8_t fc[3];
+
+  switch (fr_data[0] >> 4)
+    {
+    case ISOTP_FT_SINGLE:
+      {
+      uint8_t len = fr_data[0] & 0x0f;
+      if (len == 0 || len >= fr_len)
+        break;
+      ecu.rxbuf.assign(fr_data + 1, fr_data + 1 + len);
+      Respond(ecu, now, out);
+      break;
+      }
+    case ISOTP_FT_FIRST:
+      {
+      if (fr_len < 8 - offset)
+        break;
+      ecu.rxlen = (fr_data[0] & 0x0f) << 8 | fr_data[1];
+      ecu.rxbuf.assign(fr_data + 2, fr_data + fr_len);
+      ecu.rxseq = 1;
+      ecu.rxblock = ecu.bs;
+      fc[0] = 0x30;
+      fc[1] = ecu.bs;
+      fc[2] = IsoTpEncodeSepTime(ecu.septime);
+      IsoTpEmit(ecu, fc, 3, now, out);
+      break;
+      }
+    case ISOTP_FT_CONSECUTIVE:
+      {
+      if (ecu.rxlen == 0)
+        break;
+      if ((fr_data[0] & 0x0f) != (ecu.rxseq & 0x0f))
+        {
+        ecu.aborted++;
+        ecu.rxlen = 0;
+        ecu.rxbuf.clear();
+        break;
+        }
+      ecu.rxseq++;
+      ecu.rxbuf.insert(ecu.rxbuf.end(), fr_data + 1, fr_data + fr_len);
+      if (ecu.rxbuf.size() >= ecu.rxlen)
+        {
+        ecu.rxbuf.resize(ecu.rxlen);
+        ecu.rxlen = 0;
+        Respond(ecu, now, out);
+        }
+      else if (ecu.bs && --ecu.rxblock == 0)
+        {
+        ecu.rxblock = ecu.bs;
+        fc[0] = 0x30;
+        fc[1] = ecu.bs;
+        fc[2] = IsoTpEncodeSepTime(ecu.septime);
+        IsoTpEmit(ecu, fc, 3, now, out);
+        }
+      break;
+      }
+    case ISOTP_FT_FLOWCTRL:
+      {
+      if (!ecu.txwait || fr_len < 3)
+        break;
+      switch (fr_data[0] & 0x0f)
+        {
+        case 0:   // clear to send
+          ecu.txwait = false;
+          IsoTpSendBlock(ecu, fr_data[1], IsoTpDecodeSepTime(fr_data[2]), now, out);
+          break;
+        case 1:   // wait
+          break;
+        default:  // overflow / abort
+          ecu.aborted++;
+          ecu.txwait = false;
+          ecu.txbuf.clear();
+          break;
+        }
+      break;
+      }
+    default:
+      break;
+    }
+  return true;
+  }
+
+/**
+ * IsoTpSend: send a response, multi frame responses wait for the flow control
+ */
+void EcuSimEngine::IsoTpSend(ecu_t& ecu, const std::vector<uint8_t>& payload, int64_t due, ecusim_outputs_t& out)
+  {
+  uint8_t fr_maxlen = (ecu.protocol == ISOTP_EXTADR) ? 7 : 8;
+  uint8_t fr[8];
+  if (payload.size() < fr_maxlen)
+    {
+    fr[0] = payload.size();
+    memcpy(fr + 1, payload.data(), payload.size());
+    IsoTpEmit(ecu, fr, payload.size() + 1, due, out);
+    return;
+    }
+  ecu.txbuf = payload;
+  ecu.txoffset = fr_maxlen - 2;
+  ecu.txseq = 1;
+  ecu.txwait = true;
+  fr[0] = 0x10 | (payload.size() >> 8);
+  fr[1] = payload.size() & 0xff;
+  memcpy(fr + 2, payload.data(), fr_maxlen - 2);
+  IsoTpEmit(ecu, fr, fr_maxlen, due, out);
+  }
+
+/**
+ * IsoTpSendBlock: send the consecutive frames allowed by a flow control
+ */
+void EcuSimEngine::IsoTpSendBlock(ecu_t& ecu, uint8_t blocksize, uint32_t septime, int64_t now, ecusim_outputs_t& out)
+  {
+  uint8_t fr_maxlen = (ecu.protocol == ISOTP_EXTADR) ? 7 : 8;
+  uint8_t fr[8];
+  int64_t due = now;
+  for (int k = 0; ecu.txoffset < ecu.txbuf.size(); k++)
+    {
+    if (blocksize && k == blocksize)
+      {
+      ecu.txwait = true;
+      return;
+      }
+    uint8_t len = std::min<size_t>(fr_maxlen - 1, ecu.txbuf.size() - ecu.txoffset);
+    fr[0] = 0x20 | (ecu.txseq++ & 0x0f);
+    memcpy(fr + 1, ecu.txbuf.data() + ecu.txoffset, len);
+    ecu.txoffset += len;
+    IsoTpEmit(ecu, fr, len + 1, due, out);
+    due = ecu.txtime + septime;
+    }
+  ecu.txbuf.clear();
+  }
+
+/**
+ * IsoTpEmit: address & pad an ISO-TP frame
+ */
+void EcuSimEngine::IsoTpEmit(ecu_t& ecu, const uint8_t* fr, uint8_t len, int64_t due, ecusim_outputs_t& out)
+  {
+  uint8_t data[8];
+  uint8_t dlc = 0;
+  uint32_t id = ecu.rxid;
+  if (ecu.protocol == ISOTP_EXTADR)
+    {
+    id = ecu.rxid >> 8;
+    data[dlc++] = ecu.rxid & 0xff;
+    }
+  memcpy(data + dlc, fr, len);
+  dlc += len;
+  if (ecu.pad >= 0)
+    {
+    while (dlc < 8)
+      data[dlc++] = ecu.pad;
+    }
+  Emit(ecu, id, data, dlc, due, out);
+  }
+
+/**
+ * VwtpReceive: VW-TP 2.0 channel management & request reception
+ */
+bool EcuSimEngine::VwtpReceive(ecu_t& ecu, const ecusim_frame_t& frame, int64_t now, ecusim_outputs_t& out)
+  {
+  if (frame.ext || frame.dlc < 1)
+    return false;
+  uint8_t fr[7];
+
+  // Channel setup request on the base ID:
+  if (frame.id == ecu.txid)
+    {
+    if (frame.dlc != 7 || frame.data[0] != (ecu.rxid & 0xff) || frame.data[1] != 0xC0)
+      return false;
+    ecu.vwtp_rxid = frame.data[5] << 8 | frame.data[4];
+    ecu.vwtp_txid = 0x740 + (ecu.rxid & 0x3f);
+    ecu.vwtp_open = true;
+    ecu.rxseq = ecu.txseq = 0;
+    ecu.rxlen = 0;
+    ecu.rxbuf.clear();
+    ecu.txbuf.clear();
+    ecu.txwait = false;
+    fr[0] = 0x00;
+    fr[1] = 0xD0;   // positive response
+    fr[2] = ecu.vwtp_rxid & 0xff;
+    fr[3] = ecu.vwtp_rxid >> 8;
+    fr[4] = ecu.vwtp_txid & 0xff;
+    fr[5] = ecu.vwtp_txid >> 8;
+    fr[6] = 0x01;
+    Emit(ecu, ecu.txid + (ecu.rxid & 0xff), fr, 7, now, out);
+    return true;
+    }
+
+  if (!ecu.vwtp_open || frame.id != ecu.vwtp_txid)
+    return false;
+
+  uint8_t opcode = frame.data[0];
+  if (opcode == 0xA0 || opcode == 0xA3)
+    {
+    // Channel parameters / keepalive:
+    if (opcode == 0xA0 && frame.dlc >= 5)
+      {
+      ecu.vwtp_bs = frame.data[1] ? frame.data[1] : 15;
+      ecu.vwtp_septime = VwtpDecodeTime(frame.data[4]);
+      }
+    fr[0] = 0xA1;
+    fr[1] = ecu.bs ? ecu.bs : 15;
+    fr[2] = 0x8A;   // ACK timeout 100 ms
+    fr[3] = 0xFF;
+    fr[4] = VwtpEncodeTime(ecu.septime);
+    fr[5] = 0xFF;
+    Emit(ecu, ecu.vwtp_rxid, fr, 6, now, out);
+    }
+  else if (opcode == 0xA8)
+    {
+    // Channel close:
+    fr[0] = 0xA8;
+    Emit(ecu, ecu.vwtp_rxid, fr, 1, now, out);
+    ecu.vwtp_open = false;
+    ecu.txbuf.clear();
+    ecu.txwait = false;
+    }
+  else if ((opcode & 0xf0) == 0xB0)
+    {
+    // ACK, continue:
+    if (ecu.txwait)
+      {
+      ecu.txwait = false;
+      VwtpSendBlock(ecu, now, out);
+      }
+    }
+  else if ((opcode & 0xf0) == 0x90)
+    {
+    // ACK, abort:
+    if (!ecu.txbuf.empty())
+      {
+      ecu.aborted++;
+      ecu.txbuf.clear();
+      ecu.txwait = false;
+      }
+    }
+  else if (opcode < 0x40)
+    {
+    // Data frame:
+    if ((opcode & 0xf0) == 0x30)
+      {
+      // transfer aborted by the tester:
+      if (!ecu.rxbuf.empty())
+        ecu.aborted++;
+      ecu.rxlen = 0;
+      ecu.rxbuf.clear();
+      ecu.rxseq = (opcode & 0x0f) + 1;
+      return true;
+      }
+    if ((opcode & 0x0f) != (ecu.rxseq & 0x0f))
+      {
+      // resync to the tester sequence, drop a partial request:
+      if (!ecu.rxbuf.empty())
+        ecu.aborted++;
+      ecu.rxlen = 0;
+      ecu.rxbuf.clear();
+      }
+    ecu.rxseq = (opcode & 0x0f) + 1;
+    if (ecu.rxlen == 0)
+      {
+      if (frame.dlc < 3)
+        return true;
+      ecu.rxlen = frame.data[1] << 8 | frame.data[2];
+      ecu.rxbuf.assign(frame.data + 3, frame.data + frame.dlc);
+      }
+    else
+      {
+      ecu.rxbuf.insert(ecu.rxbuf.end(), frame.data + 1, frame.data + frame.dlc);
+      }
+    if ((opcode & 0xf0) <= 0x10)
+      {
+      fr[0] = 0xB0 | (ecu.rxseq & 0x0f);
+      Emit(ecu, ecu.vwtp_rxid, fr, 1, now, out);
+      }
+    if ((opcode & 0xf0) == 0x10 || ecu.rxbuf.size() >= ecu.rxlen)
+      {
+      if (ecu.rxbuf.size() > ecu.rxlen)
+        ecu.rxbuf.resize(ecu.rxlen);
+      ecu.rxlen = 0;
+      Respond(ecu, now, out);
+      }
+    }
+  return true;
+  }
+
+/**
+ * VwtpSend: send a response message
+ */
+void EcuSimEngine::VwtpSend(ecu_t& ecu, const std::vector<uint8_t>& payload, int64_t due, ecusim_outputs_t& out)
+  {
+  ecu.txbuf.clear();
+  ecu.txbuf.push_back(payload.size() >> 8);
+  ecu.txbuf.push_back(payload.size() & 0xff);
+  ecu.txbuf.insert(ecu.txbuf.end(), payload.begin(), payload.end());
+  ecu.txoffset = 0;
+  ecu.txwait = false;
+  VwtpSendBlock(ecu, due, out);
+  }
+
+/**
+ * VwtpSendBlock: send the frames of a block, the last one requests an ACK
+ */
+void EcuSimEngine::VwtpSendBlock(ecu_t& ecu, int64_t due, ecusim_outputs_t& out)
+  {
+  uint8_t fr[8];
+  for (int k = 1; ecu.txoffset < ecu.txbuf.size(); k++)
+    {
+    uint8_t len = std::min<size_t>(7, ecu.txbuf.size() - ecu.txoffset);
+    memcpy(fr + 1, ecu.txbuf.data() + ecu.txoffset, len);
+    ecu.txoffset += len;
+    uint8_t opcode;
+    if (ecu.txoffset >= ecu.txbuf.size())
+      opcode = 0x10;    // last frame, waiting for ACK
+    else if (k < ecu.vwtp_bs)
+      opcode = 0x20;    // more frames following in this block
+    else
+      opcode = 0x00;    // block end, waiting for ACK
+    fr[0] = opcode | (ecu.txseq++ & 0x0f);
+    Emit(ecu, ecu.vwtp_rxid, fr, len + 1, due, out);
+    due = ecu.txtime + ecu.vwtp_septime;
+    if (opcode == 0x00)
+      {
+      ecu.txwait = true;
+      return;
+      }
+    }
+  ecu.txbuf.clear();
+  }
+
+/**
+ * Respond: look up the response to the request received & schedule it
+ */
+void EcuSimEngine::Respond(ecu_t& ecu, int64_t now, ecusim_outputs_t& out)
+  {
+  const std::vector<uint8_t>& request = ecu.rxbuf;
+  uint8_t sid = request.empty() ? 0 : request[0];
+  ecu.requests++;
+
+  // A new request cancels a response in progress:
+  ecu.txbuf.clear();
+  ecu.txwait = false;
+
+  rule_t* rule = NULL;
+  for (rule_t& r : ecu.rules)
+    {
+    if (r.prefix.size() <= request.size() && std::equal(r.prefix.begin(), r.prefix.end(), request.begin()))
+      {
+      rule = &r;
+      break;
+      }
+    }
+
+  int64_t delay = (rule && rule->delay >= 0) ? rule->delay : ecu.delay;
+  if (ecu.jitter)
+    delay += Random() % (ecu.jitter + 1);
+  int64_t due = now + delay;
+  std::vector<uint8_t> payload;
+
+  if (rule)
+    {
+    const response_t& response = rule->responses[rule->next];
+    rule->next = (rule->next + 1) % rule->responses.size();
+    rule->hits++;
+    for (int k = 0; k < rule->pending; k++)
+      {
+      Send(ecu, { 0x7f, sid, 0x78 }, due, out);
+      due += delay;
+      }
+    if (response.nrc)
+      payload = { 0x7f, sid, response.nrc };
+    else
+      payload = response.data;
+    }
+  else
+    {
+    ecu.unknown++;
+    if (sid == 0x3e && request.size() >= 2)
+      {
+      // TesterPresent, unless suppressed:
+      if (!(request[1] & 0x80))
+        payload = { 0x7e, request[1] };
+      }
+    else if (ecu.nrc)
+      payload = { 0x7f, sid, ecu.nrc };
+    }
+
+  ecu.rxbuf.clear();
+  if (payload.empty())
+    return;
+  if (payload[0] == 0x7f)
+    ecu.errors++;
+  ecu.responses++;
+  Send(ecu, payload, due, out);
+  }
+
+void EcuSimEngine::Send(ecu_t& ecu, const std::vector<uint8_t>& payload, int64_t due, ecusim_outputs_t& out)
+  {
+  if (ecu.protocol == VWTP_20)
+    VwtpSend(ecu, payload, due, out);
+  else
+    IsoTpSend(ecu, payload, due, out);
+  }
+
+/**
+ * Emit: put a frame on the bus (or drop it)
+ *  - the bus driving the engine serializes frames due at the same time
+ */
+void EcuSimEngine::Emit(ecu_t& ecu, uint32_t id, const uint8_t* data, uint8_t len, int64_t due, ecusim_outputs_t& out)
+  {
+  ecu.txtime = due;
+  if (ecu.drop && Random() % 1000 < ecu.drop)
+    {
+    ecu.dropped++;
+    return;
+    }
+  ecu.frames_tx++;
+
+  ecusim_output_t output = {};
+  output.due = due;
+  output.frame.id = id;
+  output.frame.ext = (ecu.protocol == ISOTP_EXTFRAME);
+  output.frame.dlc = len;
+  memcpy(output.frame.data, data, len);
+  out.push_back(output);
+  }
+
+/**
+ * Random: xorshift32, reproducible from the seed
+ */
+uint32_t EcuSimEngine::Random()
+  {
+  m_rand ^= m_rand << 13;
+  m_rand ^= m_rand >> 17;
+  m_rand ^= m_rand << 5;
+  return m_rand;
+  }
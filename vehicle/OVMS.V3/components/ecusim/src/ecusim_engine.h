@@ -0,0 +1,157 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Module:        ECU simulator
+;    Date:          18th October 2026
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011        Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+#ifndef __ECUSIM_ENGINE_H__
+#define __ECUSIM_ENGINE_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "vehicle_common.h"
+
+/**
+ * EcuSimEngine: scriptable ECU simulator core
+ *
+ *  Implements the ECU side of ISO-TP and VW-TP 2.0 for a table of simulated
+ *  ECUs. Frames sent by the tester go in, response frames come out tagged with
+ *  their due time. The engine has no OS, driver or framework dependencies, so
+ *  it can be driven by the ecusimbus virtual bus as well as by a host build.
+ */
+
+typedef struct
+  {
+  uint32_t  id;                     // CAN ID
+  bool      ext;                    // 29 bit ID
+  uint8_t   dlc;
+  uint8_t   data[8];
+  } ecusim_frame_t;
+
+typedef struct
+  {
+  int64_t         due;              // time to deliver the frame [us]
+  ecusim_frame_t  frame;
+  } ecusim_output_t;
+
+typedef std::vector<ecusim_output_t> ecusim_outputs_t;
+
+class EcuSimEngine
+  {
+  public:
+    typedef struct
+      {
+      std::vector<uint8_t> data;    // response payload (empty & no nrc = no response)
+      uint8_t   nrc;                // negative response code, 0 = positive response
+      } response_t;
+
+    typedef struct
+      {
+      std::vector<uint8_t> prefix;  // request prefix to match
+      std::vector<response_t> responses; // served in turn
+      uint16_t  pending;            // "response pending" NRCs before the response
+      int32_t   delay;              // response delay [us], -1 = ECU default
+      size_t    next;               // next response to serve
+      uint32_t  hits;
+      } rule_t;
+
+    struct ecu_t
+      {
+      std::string name;
+      uint8_t   protocol = ISOTP_STD;
+      uint32_t  txid = 0;           // request ID (VW-TP: base ID, e.g. 0x200)
+      uint32_t  rxid = 0;           // response ID (VW-TP: module ID)
+      uint32_t  delay = 0;          // response delay [us]
+      uint32_t  jitter = 0;         // max random delay added [us]
+      uint32_t  septime = 0;        // separation time requested from the tester [us]
+      uint8_t   bs = 0;             // block size requested from the tester (VW-TP: 0 = 15)
+      int16_t   pad = 0x55;         // padding byte, -1 = no padding
+      uint16_t  drop = 0;           // frames dropped [1/1000]
+      uint8_t   nrc = 0x31;         // NRC for unknown requests, 0 = no response
+      std::vector<rule_t> rules;
+
+      // Request reception:
+      std::vector<uint8_t> rxbuf;
+      uint16_t  rxlen = 0;          // announced request length
+      uint8_t   rxseq = 0;
+      uint8_t   rxblock = 0;        // frames left in the current block
+      // Response transmission:
+      std::vector<uint8_t> txbuf;
+      uint16_t  txoffset = 0;
+      uint8_t   txseq = 0;
+      int64_t   txtime = 0;         // due time of the last response frame
+      bool      txwait = false;     // waiting for flow control / ACK
+      // VW-TP channel:
+      bool      vwtp_open = false;
+      uint16_t  vwtp_txid = 0;      // channel ID tester → ECU
+      uint16_t  vwtp_rxid = 0;      // channel ID ECU → tester
+      uint8_t   vwtp_bs = 15;       // tester block size
+      uint32_t  vwtp_septime = 0;   // tester frame separation time [us]
+
+      // Statistics:
+      uint32_t  requests = 0;
+      uint32_t  responses = 0;
+      uint32_t  errors = 0;         // negative responses sent
+      uint32_t  unknown = 0;        // requests without matching rule
+      uint32_t  frames_rx = 0;
+      uint32_t  frames_tx = 0;
+      uint32_t  dropped = 0;
+      uint32_t  aborted = 0;        // transfers aborted by the tester or by sequence errors
+      };
+
+  public:
+    EcuSimEngine();
+
+  public:
+    bool Load(const std::string& script, std::string& error);
+    bool LoadLine(const std::string& line, std::string& error);
+    void Clear();
+    void Reset();
+    void SetSeed(uint32_t seed) { m_seed = m_rand = seed ? seed : 1; }
+
+  public:
+    bool Receive(const ecusim_frame_t& frame, int64_t now, ecusim_outputs_t& out);
+
+  protected:
+    bool IsoTpReceive(ecu_t& ecu, const ecusim_frame_t& frame, int64_t now, ecusim_outputs_t& out);
+    void IsoTpSend(ecu_t& ecu, const std::vector<uint8_t>& payload, int64_t due, ecusim_outputs_t& out);
+    void IsoTpSendBlock(ecu_t& ecu, uint8_t blocksize, uint32_t septime, int64_t now, ecusim_outputs_t& out);
+    void IsoTpEmit(ecu_t& ecu, const uint8_t* fr, uint8_t len, int64_t due, ecusim_outputs_t& out);
+    bool VwtpReceive(ecu_t& ecu, const ecusim_frame_t& frame, int64_t now, ecusim_outputs_t& out);
+    void VwtpSend(ecu_t& ecu, const std::vector<uint8_t>& payload, int64_t due, ecusim_outputs_t& out);
+    void VwtpSendBlock(ecu_t& ecu, int64_t due, ecusim_outputs_t& out);
+    void Respond(ecu_t& ecu, int64_t now, ecusim_outputs_t& out);
+    void Send(ecu_t& ecu, const std::vector<uint8_t>& payload, int64_t due, ecusim_outputs_t& out);
+    void Emit(ecu_t& ecu, uint32_t id, const uint8_t* data, uint8_t len, int64_t due, ecusim_outputs_t& out);
+    uint32_t Random();
+
+  public:
+    std::vector<ecu_t> m_ecus;
+    uint32_t          m_seed;
+    uint32_t          m_rand;
+  };
+
+#endif //#ifndef __ECUSIM_ENGINE_H__
@@ -572,7 +572,7 @@ esp_err_t esp32can::Stop()
   canbus::Stop();
 
   // Clear TX queue
-  xQueueReset(m_txqueue);
+  TxQueueReset();
 
   ESP32CAN_ENTER_CRITICAL();
 
@@ -763,9 +763,9 @@ esp_err_t esp32can::WriteFrame(const CAN_frame_t* p_frame)
 
 
 /**
- * Write: transmit or queue a frame for transmission (API)
+ * DriverWrite: transmit or queue a frame for transmission (called by canbus::Write())
  */
-esp_err_t esp32can::Write(const CAN_frame_t* p_frame, TickType_t maxqueuewait /*=0*/)
+esp_err_t esp32can::DriverWrite(const CAN_frame_t* p_frame, TickType_t maxqueuewait /*=0*/)
   {
   OvmsMutexLock lock(&m_write_mutex);
 
@@ -776,7 +776,7 @@ esp_err_t esp32can::Write(const CAN_frame_t* p_frame, TickType_t maxqueuewait /*
     }
 
   // if there are frames waiting in the TX queue, add the new one there as well:
-  if (uxQueueMessagesWaiting(m_txqueue))
+  if (TxQueueCount())
     {
     return QueueWrite(p_frame, maxqueuewait);
     }
@@ -788,7 +788,7 @@ esp_err_t esp32can::Write(const CAN_frame_t* p_frame, TickType_t maxqueuewait /*
     }
 
   // stats & logging:
-  canbus::Write(p_frame, maxqueuewait);
+  canbus::DriverWrite(p_frame, maxqueuewait);
 
   return ESP_OK;
   }
@@ -803,7 +803,7 @@ void esp32can::TxCallback(CAN_frame_t* p_frame, bool success)
     {
     OvmsMutexLock lock(&m_write_mutex);
     CAN_frame_t frame;
-    while (xQueueReceive(m_txqueue, (void*)&frame, 0) == pdTRUE)
+    while (TxQueuePop(&frame))
       {
       if (WriteFrame(&frame) == ESP_FAIL)
         {
@@ -817,7 +817,7 @@ void esp32can::TxCallback(CAN_frame_t* p_frame, bool success)
         }
       else
         {
-        canbus::Write(&frame, 0);
+        canbus::DriverWrite(&frame, 0);
         break;
         }
       }
@@ -104,8 +104,10 @@ class esp32can : public canbus
     esp_err_t InitController();
     esp_err_t SetAcceptanceFilter(const esp32can_filter_config_t& cfg);
 
+  protected:
+    esp_err_t DriverWrite(const CAN_frame_t* p_frame, TickType_t maxqueuewait=0);
+
   public:
-    esp_err_t Write(const CAN_frame_t* p_frame, TickType_t maxqueuewait=0);
     void TxCallback(CAN_frame_t* p_frame, bool success);
 
   protected:
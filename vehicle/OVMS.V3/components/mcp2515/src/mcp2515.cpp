@@ -510,9 +510,9 @@ esp_err_t mcp2515::WriteFrame(const CAN_frame_t* p_frame)
 
 
 /**
- * Write: transmit or queue a frame for transmission (API)
+ * DriverWrite: transmit or queue a frame for transmission (called by canbus::Write())
  */
-esp_err_t mcp2515::Write(const CAN_frame_t* p_frame, TickType_t maxqueuewait /*=0*/)
+esp_err_t mcp2515::DriverWrite(const CAN_frame_t* p_frame, TickType_t maxqueuewait /*=0*/)
   {
   OvmsMutexLock lock(&m_write_mutex);
 
@@ -523,7 +523,7 @@ esp_err_t mcp2515::Write(const CAN_frame_t* p_frame, TickType_t maxqueuewait /*=
     }
 
   // if there are frames waiting in the TX queue, add the new one there as well:
-  if (uxQueueMessagesWaiting(m_txqueue))
+  if (TxQueueCount())
     {
     return QueueWrite(p_frame, maxqueuewait);
     }
@@ -535,7 +535,7 @@ esp_err_t mcp2515::Write(const CAN_frame_t* p_frame, TickType_t maxqueuewait /*=
     }
 
   // OK, stats & logging:
-  canbus::Write(p_frame, maxqueuewait);
+  canbus::DriverWrite(p_frame, maxqueuewait);
 
   return ESP_OK;
   }
@@ -771,7 +771,7 @@ void mcp2515::TxCallback(CAN_frame_t* p_frame, bool success)
     {
     OvmsMutexLock lock(&m_write_mutex);
     CAN_frame_t frame;
-    while (xQueueReceive(m_txqueue, (void*)&frame, 0) == pdTRUE)
+    while (TxQueuePop(&frame))
       {
       if (WriteFrame(&frame) == ESP_FAIL)
         {
@@ -785,7 +785,7 @@ void mcp2515::TxCallback(CAN_frame_t* p_frame, bool success)
         }
       else
         {
-        canbus::Write(&frame, 0);
+        canbus::DriverWrite(&frame, 0);
         break;
         }
       }
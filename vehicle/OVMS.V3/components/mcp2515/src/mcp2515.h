@@ -83,8 +83,10 @@ class mcp2515 : public canbus
     esp_err_t ViewRegisters();
     esp_err_t SetAcceptanceFilter(const mcp2515_filter_config_t& cfg);
 
+  protected:
+    esp_err_t DriverWrite(const CAN_frame_t* p_frame, TickType_t maxqueuewait=0);
+
   public:
-    esp_err_t Write(const CAN_frame_t* p_frame, TickType_t maxqueuewait=0);
     bool AsynchronousInterruptHandler(CAN_frame_t* frame, uint32_t* framesReceived);
     void TxCallback(CAN_frame_t* p_frame, bool success);
 
@@ -33,6 +33,7 @@ static const char *TAG = "vehicle-poll";
 
 #include <stdio.h>
 #include <algorithm>
+#include <map>
 #include <ovms_command.h>
 #include <ovms_script.h>
 #include <ovms_metrics.h>
@@ -45,6 +46,7 @@ static const char *TAG = "vehicle-poll";
 #include <string_writer.h>
 #include "vehicle_poller.h"
 #include "can.h"
+#include "canpool.h"
 #include "ovms_boot.h"
 #include "dbc.h"
 
@@ -52,6 +54,18 @@ using namespace std::placeholders;
 
 OvmsPollers MyPollers __attribute__ ((init_priority (7000)));
 
+#define POLLER_JOBPOOL_COUNT  4
+canpool OvmsPoller::s_jobpool __attribute__ ((init_priority (6990)))
+  ("poll jobs", sizeof(OvmsPoller::BlockingOnceOffPoll) + 32, POLLER_JOBPOOL_COUNT);
+
+// Response reassembly buffers, larger responses (max 4095) fall back to the heap:
+#define POLLER_RXPOOL_SMALL   256
+#define POLLER_RXPOOL_LARGE   1024
+canpool OvmsPoller::s_rxpool_small __attribute__ ((init_priority (6990)))
+  ("poll rx 256", POLLER_RXPOOL_SMALL, 4);
+canpool OvmsPoller::s_rxpool_large __attribute__ ((init_priority (6990)))
+  ("poll rx 1k", POLLER_RXPOOL_LARGE, 2);
+
 // Runtime control for logging:
 #define IFTRACE(x) if (MyPollers.m_trace &  OvmsPollers::tracetype_t::trace_##x)
 
@@ -88,6 +102,44 @@ OvmsPoller::OvmsPoller(canbus* can, uint8_t can_number, OvmsPollers *parent,
   m_poll_repeat_count = 0;
   m_poll_sent_last = 0;
   m_poll_between_success = 0;
+  m_poll_interval_unit = 0;
+  m_poll_adaptive = 0;
+  m_poll_latency = {};
+  m_sched_timer = NULL;
+  m_poll_fc_adaptive = false;
+  m_poll_fc_rx = {};
+  m_poll_tx_txid = 0;
+  m_poll_tx_blockcnt = 0;
+  m_poll_tx_septime = 0;
+  m_poll_tx_due = 0;
+  m_poll_tx_paced = false;
+  m_poll_tx_aborts = 0;
+  m_tx_timer = NULL;
+  for (int i = 0; i < POLLER_MAXSLOTS; ++i)
+    m_slots[i].busy = false;
+  m_parked_cnt = 0;
+  m_slots_busy = 0;
+  m_poll_concurrency = 1;
+  m_slots_peak = 0;
+  m_slots_started = 0;
+  m_slots_parked = 0;
+  m_slots_timeouts = 0;
+  m_cache_hits = 0;
+  m_cache_coalesced = 0;
+  m_cache_misses = 0;
+  for (int i = 0; i < POLL_VWTP_MAXPOOL; ++i)
+    m_vwtp_pool[i] = {};
+  m_vwtp_pool_size = 0;
+  m_vwtp_pool_limit = 0;
+  m_vwtp_pool_tested = 0;
+  m_vwtp_setup_start = 0;
+  m_vwtp_setup_time = 0;
+  m_vwtp_setups = 0;
+  m_vwtp_switches = 0;
+  m_vwtp_reuses = 0;
+  m_vwtp_evictions = 0;
+  m_vwtp_lost = 0;
+  m_vwtp_refused = 0;
   }
 
 /** Handle incoming frame.
@@ -95,6 +147,15 @@ OvmsPoller::OvmsPoller(canbus* can, uint8_t can_number, OvmsPollers *parent,
  */
 bool OvmsPoller::Incoming(CAN_frame_t &frame, bool success)
   {
+  // Pipelined requests:
+  if (m_slots_busy && PollerSlotIncoming(frame))
+    return true;
+
+  // Pooled VWTP channels (frames of the active channel are handled below):
+  if (m_vwtp_pool_size
+      && !(m_poll_vwtp.state != VWTP_Closed && frame.origin == m_poll_vwtp.bus && frame.MsgID == m_poll_vwtp.rxid)
+      && PollerVWTPPoolReceive(frame))
+    return true;
 
   // No multiframe request is active.
   if (m_poll.type == VEHICLE_POLL_TYPE_NONE)
@@ -152,6 +213,16 @@ bool OvmsPoller::Incoming(CAN_frame_t &frame, bool success)
 
 OvmsPoller::~OvmsPoller()
   {
+  if (m_sched_timer)
+    {
+    esp_timer_stop(m_sched_timer);
+    esp_timer_delete(m_sched_timer);
+    }
+  if (m_tx_timer)
+    {
+    esp_timer_stop(m_tx_timer);
+    esp_timer_delete(m_tx_timer);
+    }
   }
 
 
@@ -197,6 +268,8 @@ void OvmsPoller::PollSetPidList(uint8_t defaultbus, const OvmsPoller::poll_pid_t
     if (!plist) // Don't add if not necessary.
       return;
     m_poll_series = std::shared_ptr<StandardPollSeries>(new StandardVehiclePollSeries(this, signal));
+    m_poll_series->PollSetIntervalUnit(m_poll_interval_unit);
+    m_poll_series->PollSetAdaptive(m_poll_adaptive);
     m_polls.SetEntry("!v.standard", m_poll_series);
     }
 
@@ -279,6 +352,446 @@ void OvmsPoller::PollSetTimeBetweenSuccess(uint16_t time_between_ms)
   m_poll_between_success = pdMS_TO_TICKS(time_between_ms);
   }
 
+/**
+ * PollSetIntervalUnit: switch the PollSetPidList() series to deadline scheduling
+ *  The poll list is compiled into a queue of due times, polltime values are
+ *  interpreted in units of unit_ms milliseconds, e.g. 100 = polltime 5 means
+ *  every 500 ms. Entries with equal intervals are spread over the interval.
+ *
+ *  @param unit_ms
+ *    Polltime unit in milliseconds, 0 = ticker scheduling (default)
+ */
+void OvmsPoller::PollSetIntervalUnit(uint16_t unit_ms)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  m_poll_interval_unit = unit_ms;
+  if (m_poll_series)
+    m_poll_series->PollSetIntervalUnit(unit_ms);
+  }
+
+void OvmsPoller::ScheduleStatus(OvmsWriter* writer, bool reset)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  m_polls.ScheduleStatus(writer, reset);
+  }
+
+/**
+ * PollSetAdaptive: adapt the PollSetPidList() poll rates to the value volatility
+ *  The poller tracks whether the responses of an entry change. After
+ *  POLL_ADAPT_STABLE unchanged responses, the interval of the entry is
+ *  doubled, up to max_factor times its polltime. A changed response returns
+ *  the entry to its polltime. All entries return to their polltime on a poll
+ *  state change and on the vehicle on/off and charge start/stop events.
+ *
+ *  @param max_factor
+ *    Max interval stretch factor, 0 = adaptive mode off (default)
+ */
+void OvmsPoller::PollSetAdaptive(uint8_t max_factor)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  m_poll_adaptive = max_factor;
+  if (m_poll_series)
+    m_poll_series->PollSetAdaptive(max_factor);
+  }
+
+/**
+ * PollSetFlowControlAdaptive: learn the ISO-TP flow control parameters per ECU
+ *  The flow control for multi frame responses starts with the separation time
+ *  set by PollSetResponseSeparationTime(). After POLL_FC_CLEAN responses
+ *  without loss, the separation time is lowered one level. A lost response
+ *  (sequence error or timeout) raises it two levels, and the level below
+ *  is only retried after POLL_FC_PROBE clean responses. Losses at the max
+ *  separation time add a block size of POLL_FC_BLOCKSIZE.
+ *
+ *  @param adaptive
+ *    true = learn per ECU, false = use the configured separation time (default)
+ */
+void OvmsPoller::PollSetFlowControlAdaptive(bool adaptive)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  m_poll_fc_adaptive = adaptive;
+  }
+
+/**
+ * PollSetChannelPool: keep VWTP channels to multiple modules open
+ *  When a poll addresses another module, the idle channel is kept open in a
+ *  pool instead of being closed, so polls alternating between modules don't
+ *  need a channel setup each time. Pooled channels are tested every second
+ *  and closed after the PollSetChannelKeepalive() timeout. If the gateway
+ *  refuses a channel, the pool size is reduced to what the gateway accepts.
+ *
+ *  @param channels
+ *    Channels kept open besides the active one (max POLL_VWTP_MAXPOOL),
+ *    0 = one channel at a time (default)
+ */
+void OvmsPoller::PollSetChannelPool(uint8_t channels)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  channels = LIMIT_MAX(channels, POLL_VWTP_MAXPOOL);
+  if (channels == m_vwtp_pool_size)
+    return;
+  PollerVWTPPoolCloseAll();
+  m_vwtp_pool_size = channels;
+  m_vwtp_pool_limit = channels;
+  }
+
+/**
+ * PollSetFairScheduling: weighted fair scheduling across the poll series
+ *  By default, the poll series (standard list, PollRequest() series,
+ *  once-off requests) are run one after the other in the order they were
+ *  added, so a once-off request waits for the full poll list run, or the
+ *  next primary tick if the run is through. With fair scheduling, the series
+ *  take turns (see PollSetSeriesWeight()), once-off requests get a turn
+ *  each round and are served next when waiting longer than the latency
+ *  target. A once-off request added after the run is through is sent
+ *  immediately.
+ *
+ *  @param latency_ms
+ *    Latency target for once-off (interactive) requests, 0 = off (default)
+ */
+void OvmsPoller::PollSetFairScheduling(uint16_t latency_ms)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  m_polls.SetFairLatency(latency_ms);
+  }
+
+/**
+ * PollSetSeriesWeight: set the fair scheduling weight of a poll series
+ *  @param name
+ *    Name of the series, e.g. "!v.standard" for the PollSetPidList() list
+ *  @param weight
+ *    Entries polled per turn (default 1)
+ *  @return
+ *    false if the series does not exist
+ */
+bool OvmsPoller::PollSetSeriesWeight(const std::string &name, uint8_t weight)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  return m_polls.SetWeight(name, weight);
+  }
+
+void OvmsPoller::FairStatus(OvmsWriter* writer)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  m_polls.FairStatus(writer);
+  }
+
+void OvmsPoller::FairReset()
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  m_polls.FairReset();
+  }
+
+void OvmsPoller::AdaptiveReset(bool stats)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  m_polls.AdaptiveReset(stats);
+  }
+
+void OvmsPoller::AdaptiveStatus(OvmsWriter* writer)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  m_polls.AdaptiveStatus(writer);
+  }
+
+/**
+ * PollSetConcurrency: pipeline ISO-TP requests to different ECUs
+ *  Requests for different ECUs (request/response ID pairs) are sent without
+ *  waiting for the previous response, up to max_requests at a time. Requests
+ *  to the same ECU are still sent one at a time. Multi frame responses are
+ *  collected and passed on complete, so the vehicle still gets the frames of
+ *  one response in sequence. Broadcasts, VW-TP, multi frame and blocking
+ *  requests are sent after all pipelined requests have finished.
+ *
+ *  @param max_requests
+ *    Max requests in flight per bus, 1 = no pipelining (default), max POLLER_MAXSLOTS
+ */
+void OvmsPoller::PollSetConcurrency(uint8_t max_requests)
+  {
+  if (max_requests < 1)
+    max_requests = 1;
+  else if (max_requests > POLLER_MAXSLOTS)
+    max_requests = POLLER_MAXSLOTS;
+  m_poll_concurrency = max_requests;
+  }
+
+/**
+ * PollerSlotEligible: can the request be pipelined?
+ *  Single frame ISO-TP requests to a specific ECU only.
+ */
+bool OvmsPoller::PollerSlotEligible(const poll_pid_t &entry) const
+  {
+  if (entry.protocol == VWTP_20 || entry.rxmoduleid == 0 || entry.txmoduleid == 0x7df)
+    return false;
+  uint16_t tp_len;
+  if (POLL_TYPE_HAS_16BIT_PID(entry.type))
+    tp_len = 3;
+  else if (POLL_TYPE_HAS_8BIT_PID(entry.type))
+    tp_len = 2;
+  else
+    tp_len = 1;
+  tp_len += POLL_ENTRY_XARGS(entry) ? entry.xargs.datalen : entry.args.datalen;
+  return tp_len <= ((entry.protocol == ISOTP_EXTADR) ? 6 : 7);
+  }
+
+/**
+ * PollerSlotFind: find the busy slot for an ECU
+ *  @return slot index or -1
+ */
+int OvmsPoller::PollerSlotFind(uint32_t txid, uint32_t rxid) const
+  {
+  for (int i = 0; i < POLLER_MAXSLOTS; ++i)
+    {
+    const poll_slot_t &slot = m_slots[i];
+    if (slot.busy && (slot.job.moduleid_sent == txid || slot.job.moduleid_low == rxid))
+      return i;
+    }
+  return -1;
+  }
+
+/**
+ * PollerSlotStart: send a pipelined request
+ */
+bool OvmsPoller::PollerSlotStart(const poll_pid_t &entry, const std::shared_ptr<PollSeriesEntry> &series)
+  {
+  if (!POLL_TYPE_IS_CACHEABLE(entry.type))
+    PollCacheInvalidate(entry.txmoduleid, entry.rxmoduleid);
+
+  poll_slot_t* slot = nullptr;
+  for (int i = 0; i < POLLER_MAXSLOTS && !slot; ++i)
+    {
+    if (!m_slots[i].busy)
+      slot = &m_slots[i];
+    }
+  if (!slot)
+    return false;
+
+  slot->job = m_poll;
+  slot->job.entry = entry;
+  PollerBatchKeep(slot->job.entry, slot->batch);
+  slot->job.protocol = entry.protocol;
+  slot->job.type = entry.type;
+  slot->job.pid = entry.pid;
+  slot->job.mlframe = 0;
+  slot->job.mloffset = 0;
+  slot->job.mlremain = 0;
+  slot->job.moduleid_rec = 0;
+  slot->job.raw_data = nullptr;
+  slot->job.raw_data_len = 0;
+  slot->series = series;
+  slot->fc.start = 0;
+
+  CAN_frame_t txframe;
+  uint16_t tx_datasent = PollerISOTPRequestFrame(slot->job, txframe);
+  MyPollers.LatencyStart(slot->job, slot->latency, tx_datasent);
+  slot->txmsgid = txframe.MsgID;
+  slot->deadline = esp_timer_get_time() + POLLER_SLOT_TIMEOUT * 1000;
+  slot->busy = true;
+  if (++m_slots_busy > m_slots_peak)
+    m_slots_peak = m_slots_busy;
+  m_slots_started++;
+
+  IFTRACE(Poller) ESP_LOGD(TAG, "[%" PRIu8 "]PollerSlotStart: send [type=%02" PRIX16 ", pid=%X] to %03" PRIx32 ", %" PRIu8 " in flight",
+    m_poll.bus_no, slot->job.type, slot->job.pid, slot->job.moduleid_sent, m_slots_busy);
+  m_poll_sent_last = monotonictime;
+  m_poll_sequence_cnt++;
+  m_poll.bus->WritePriority(&txframe, CAN_TXPRIO_POLLER);
+  return true;
+  }
+
+void OvmsPoller::PollerSlotRelease(poll_slot_t &slot)
+  {
+  if (!slot.busy)
+    return;
+  slot.busy = false;
+  slot.series = nullptr;
+  slot.frames.Release();
+  --m_slots_busy;
+  }
+
+/**
+ * PollerSlotExpire: drop pipelined requests without a response
+ */
+void OvmsPoller::PollerSlotExpire()
+  {
+  int64_t now = esp_timer_get_time();
+  for (int i = 0; i < POLLER_MAXSLOTS; ++i)
+    {
+    poll_slot_t &slot = m_slots[i];
+    if (slot.busy && now >= slot.deadline)
+      {
+      IFTRACE(Poller) ESP_LOGD(TAG, "[%" PRIu8 "]PollerSlotExpire: timeout [type=%02" PRIX16 ", pid=%X] from %03" PRIx32,
+        m_poll.bus_no, slot.job.type, slot.job.pid, slot.job.moduleid_low);
+      m_slots_timeouts++;
+      MyPollers.LatencyTimeout(slot.job, slot.latency);
+      if (slot.fc.start)
+        PollerISOTPFlowResult(slot.fc, true);
+      PollerSlotRelease(slot);
+      }
+    }
+  }
+
+/**
+ * PollerSlotRunParked: start parked requests for ECUs that are free now
+ *  @return true if there is room to fetch the next entry
+ */
+bool OvmsPoller::PollerSlotRunParked()
+  {
+  int i = 0;
+  while (i < m_parked_cnt && m_slots_busy < m_poll_concurrency)
+    {
+    poll_parked_t &park = m_parked[i];
+    if (park.legacy)
+      break;
+    bool ecu_free = PollerSlotFind(park.entry.txmoduleid, park.entry.rxmoduleid) < 0;
+    // keep the order of requests to the same ECU:
+    for (int k = 0; k < i && ecu_free; ++k)
+      {
+      if (m_parked[k].entry.txmoduleid == park.entry.txmoduleid)
+        ecu_free = false;
+      }
+    if (!ecu_free || !CanPoll())
+      {
+      ++i;
+      continue;
+      }
+    PollerSlotStart(park.entry, park.series);
+    PollerParkedRemove(i);
+    }
+  return m_slots_busy < m_poll_concurrency
+      && m_parked_cnt < POLLER_MAXSLOTS
+      && !(m_parked_cnt > 0 && m_parked[m_parked_cnt-1].legacy);
+  }
+
+/**
+ * PollerParkedRemove: remove a parked entry, keeping the order of the others
+ */
+void OvmsPoller::PollerParkedRemove(int index)
+  {
+  m_parked[index].series = nullptr;
+  for (int i = index; i+1 < m_parked_cnt; ++i)
+    {
+    m_parked[i] = m_parked[i+1];
+    if (m_parked[i].entry.xargs.tag == POLL_TXBATCH)
+      m_parked[i].entry.xargs.data = m_parked[i].batch;
+    }
+  m_parked[--m_parked_cnt].series = nullptr;
+  }
+
+void OvmsPoller::PollerSlotsClear()
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  for (int i = 0; i < POLLER_MAXSLOTS; ++i)
+    PollerSlotRelease(m_slots[i]);
+  for (int i = 0; i < m_parked_cnt; ++i)
+    m_parked[i].series = nullptr;
+  m_parked_cnt = 0;
+  }
+
+/**
+ * PollerSlotIncoming: pass a response frame to its pipelined request
+ *  @return true if the frame was handled
+ */
+bool OvmsPoller::PollerSlotIncoming(CAN_frame_t &frame)
+  {
+  if (frame.origin != m_poll.bus)
+    return false;
+  for (int i = 0; i < POLLER_MAXSLOTS; ++i)
+    {
+    poll_slot_t &slot = m_slots[i];
+    if (!slot.busy)
+      continue;
+    uint32_t msgid;
+    if (slot.job.protocol == ISOTP_EXTADR)
+      msgid = frame.MsgID << 8 | frame.data.u8[0];
+    else
+      msgid = frame.MsgID;
+    if (msgid != slot.job.moduleid_low)
+      continue;
+    slot.job.format = frame.FIR.B.FF;
+    return PollerISOTPSlotReceive(slot, &frame, msgid);
+    }
+  return false;
+  }
+
+/**
+ * PollerSlotOutgoing: TX callback for a pipelined request
+ *  @return true if the frame belongs to a pipelined request
+ */
+bool OvmsPoller::PollerSlotOutgoing(const CAN_frame_t &frame, bool success)
+  {
+  if (frame.origin != m_poll.bus)
+    return false;
+  for (int i = 0; i < POLLER_MAXSLOTS; ++i)
+    {
+    poll_slot_t &slot = m_slots[i];
+    if (!slot.busy || slot.txmsgid != frame.MsgID)
+      continue;
+    if (slot.job.protocol == ISOTP_EXTADR && frame.data.u8[0] != (slot.job.moduleid_sent & 0xff))
+      continue;
+    slot.job.moduleid_rec = 0; // Not yet received
+      {
+      OvmsRecMutexLock lock(&m_poll_mutex, pdMS_TO_TICKS(10));
+      if (lock.IsLocked() && m_polls.HasSeries(slot.series.get()))
+        {
+        if (!success)
+          slot.series->IncomingError(slot.job, POLLSINGLE_TXFAILURE);
+        slot.series->IncomingTxReply(slot.job, success);
+        }
+      }
+    if (!success)
+      PollerSlotRelease(slot);
+    return true;
+    }
+  return false;
+  }
+
+/**
+ * PollerScheduleWake: (re)arm the wakeup timer for the next due deadline entry
+ *  Not armed while a request is pending or throttled, the response / next
+ *  tick will look for due entries then.
+ */
+void OvmsPoller::PollerScheduleWake()
+  {
+  int64_t due;
+    {
+    OvmsRecMutexLock lock(&m_poll_mutex, pdMS_TO_TICKS(10));
+    if (!lock.IsLocked())
+      return;
+    due = m_polls.NextDueTime();
+    }
+  if (due == 0)
+    {
+    if (m_sched_timer)
+      esp_timer_stop(m_sched_timer);
+    return;
+    }
+  if (!m_sched_timer)
+    {
+    esp_timer_create_args_t args = {};
+    args.callback = SchedTimerCallback;
+    args.arg = this;
+    args.name = "poll sched";
+    if (esp_timer_create(&args, &m_sched_timer) != ESP_OK)
+      {
+      ESP_LOGE(TAG, "[%" PRIu8 "]Poller: cannot create schedule timer", m_poll.bus_no);
+      m_sched_timer = NULL;
+      return;
+      }
+    }
+  esp_timer_stop(m_sched_timer);
+  if (m_poll_wait > 0 || !CanPoll())
+    return;
+  int64_t wait = due - esp_timer_get_time();
+  esp_timer_start_once(m_sched_timer, (wait > 1000) ? wait : 1000);
+  }
+
+void OvmsPoller::SchedTimerCallback(void* arg)
+  {
+  OvmsPoller* poller = (OvmsPoller*) arg;
+  MyPollers.QueuePollerSend(OvmsPoller::poller_source_t::Scheduled, poller->m_poll.bus_no);
+  }
+
 void OvmsPoller::ResetThrottle()
   {
   // Main Timer reset throttling counter,
@@ -294,6 +807,7 @@ void OvmsPoller::ResetPollEntry(bool force)
     m_polls.RestartPoll(OvmsPoller::ResetMode::PollReset);
     m_poll.entry = {};
     m_poll_txmsgid = 0;
+    PollerSlotsClear();
     }
   }
 
@@ -306,6 +820,7 @@ bool OvmsPoller::HasPollList() const
 void OvmsPoller::ClearPollList()
   {
   OvmsRecMutexLock lock(&m_poll_mutex);
+  PollerSlotsClear();
   return m_polls.Clear();
   }
 
@@ -354,6 +869,14 @@ void OvmsPoller::PollRunFinished()
 void OvmsPoller::PollerSend(poller_source_t source)
   {
 
+  if (source == poller_source_t::TxPace)
+    {
+    // Consecutive frame due:
+    if (m_poll_tx_paced)
+      PollerISOTPTxBlock();
+    return;
+    }
+
   bool curIsBlocking;
   {
     OvmsRecMutexLock lock(&m_poll_mutex, pdMS_TO_TICKS(50));
@@ -363,6 +886,8 @@ void OvmsPoller::PollerSend(poller_source_t source)
       return; // Something is blocking .. don't bind things up.
       }
     curIsBlocking = m_polls.PollIsBlocking();
+    if (source == poller_source_t::Primary)
+      m_polls.CountStarved();
   }
   bool fromPrimaryTicker = false, fromPrimaryOrOnceOffTicker = false;
   switch (source)
@@ -390,6 +915,9 @@ void OvmsPoller::PollerSend(poller_source_t source)
       m_poll_ticked = true;
       }
     }
+  if (m_slots_busy)
+    PollerSlotExpire();
+
   if (fromPrimaryOrOnceOffTicker)
     {
     // Timer ticker call: check response timeout
@@ -423,6 +951,17 @@ void OvmsPoller::PollerSend(poller_source_t source)
       }
     }
  // Clear. If it got to here we are ready to send a new item.
+  if (m_poll.type != VEHICLE_POLL_TYPE_NONE)
+    {
+    // The response is incomplete (timeout / abort):
+    OvmsRecMutexLock lock(&m_poll_mutex, pdMS_TO_TICKS(10));
+    if (lock.IsLocked())
+      m_polls.IncomingAbandoned(m_poll);
+    }
+  MyPollers.LatencyTimeout(m_poll, m_poll_latency);
+  if (m_poll_fc_rx.start)
+    PollerISOTPFlowResult(m_poll_fc_rx, true);
+  m_poll_tx_paced = false;
   m_poll.type = VEHICLE_POLL_TYPE_NONE;
 
   if (m_poll.ticker == init_ticker)
@@ -444,6 +983,32 @@ void OvmsPoller::PollerSend(poller_source_t source)
     return;
     }
 
+  // Blocking requests (PollSingleRequest) are sent the plain way, wait for the slots to drain:
+  if (curIsBlocking && m_slots_busy)
+    {
+    IFTRACE(Poller) ESP_LOGV(TAG, "[%" PRIu8 "]PollerSend: Blocking request waiting for %" PRIu8 " slot(s)",
+      m_poll.bus_no, m_slots_busy);
+    return;
+    }
+
+  // Pipelined requests: start parked requests first
+  bool unparked = false;
+  if (m_parked_cnt > 0 || m_poll_concurrency > 1)
+    {
+    if (m_parked_cnt > 0 && m_parked[0].legacy)
+      {
+      // Non-pipelined request waiting for the slots to finish:
+      if (m_slots_busy)
+        return;
+      m_poll.entry = m_parked[0].entry;
+      PollerBatchKeep(m_poll.entry, m_poll_batch);
+      PollerParkedRemove(0);
+      unparked = true;
+      }
+    else if (!PollerSlotRunParked())
+      return;
+    }
+
   OvmsPoller::OvmsNextPollResult res;
   {
     OvmsRecMutexLock lock(&m_poll_mutex, pdMS_TO_TICKS(50));
@@ -452,7 +1017,10 @@ void OvmsPoller::PollerSend(poller_source_t source)
       IFTRACE(Poller) ESP_LOGD(TAG, "[%" PRIu8 "]PollerSend - Failed to lock for NextPollEntry", m_poll.bus_no);
       return; // Something is blocking .. don't bind things up.
       }
-    res = m_polls.NextPollEntry(m_poll.entry, m_poll.bus_no, m_poll.ticker, m_poll_state);
+    if (unparked)
+      res = OvmsNextPollResult::FoundEntry;
+    else
+      res = m_polls.NextPollEntry(m_poll.entry, m_poll.bus_no, m_poll.ticker, m_poll_state);
   }
   if (res == OvmsNextPollResult::ReachedEnd && m_polls.HasRepeat())
     {
@@ -477,6 +1045,13 @@ void OvmsPoller::PollerSend(poller_source_t source)
       res = m_polls.NextPollEntry(m_poll.entry, m_poll.bus_no, m_poll.ticker, m_poll_state);
       }
     }
+  if ((res == OvmsNextPollResult::StillAtEnd || res == OvmsNextPollResult::ReachedEnd) && !curIsBlocking)
+    {
+    // Run is through: continue with new once-off requests & due deadline scheduled entries
+    OvmsRecMutexLock lock(&m_poll_mutex, pdMS_TO_TICKS(50));
+    if (lock.IsLocked() && (m_polls.ResumeInteractive() || m_polls.ResumeDue(esp_timer_get_time())))
+      res = m_polls.NextPollEntry(m_poll.entry, m_poll.bus_no, m_poll.ticker, m_poll_state);
+    }
   switch (res)
     {
     case OvmsNextPollResult::Ignore:
@@ -507,12 +1082,49 @@ void OvmsPoller::PollerSend(poller_source_t source)
         ESP_LOGD(TAG, "[%" PRIu8 "]PollerSend(%s)[%" PRIu8 "]: entry at[type=%02X, pid=%X], ticker=%" PRIu32 ", wait=%u, cnt=%u/%u",
              m_poll.bus_no, PollerSource(source), m_poll_state, m_poll.entry.type, m_poll.entry.pid,
              m_poll.ticker, m_poll_wait, m_poll_sequence_cnt, m_poll_sequence_max);
+
+      if (m_poll_concurrency > 1 && !unparked && !curIsBlocking)
+        {
+        std::shared_ptr<PollSeriesEntry> series;
+          {
+          OvmsRecMutexLock lock(&m_poll_mutex);
+          series = m_polls.CurrentSeries();
+          }
+        bool eligible = PollerSlotEligible(m_poll.entry);
+        if (eligible || m_slots_busy || m_parked_cnt)
+          {
+          int busy = PollerSlotFind(m_poll.entry.txmoduleid, m_poll.entry.rxmoduleid);
+          if (eligible && busy < 0 && m_parked_cnt == 0 && m_slots_busy < m_poll_concurrency)
+            {
+            PollerSlotStart(m_poll.entry, series);
+            }
+          else
+            {
+            // ECU busy or request needs the plain path: park until possible
+            poll_parked_t &park = m_parked[m_parked_cnt++];
+            park.entry = m_poll.entry;
+            PollerBatchKeep(park.entry, park.batch);
+            park.series = series;
+            park.legacy = !eligible;
+            m_slots_parked++;
+            }
+          // Fetch the next entry while there is room:
+          if (eligible && m_slots_busy < m_poll_concurrency && m_parked_cnt < POLLER_MAXSLOTS && CanPoll())
+            Queue_PollerSend(poller_source_t::Successful);
+          break;
+          }
+        }
+
       // We need to poll this one...
+      PollerBatchKeep(m_poll.entry, m_poll_batch);
       m_poll.protocol = m_poll.entry.protocol;
       m_poll.type = m_poll.entry.type;
       m_poll.pid = m_poll.entry.pid;
 
       m_poll_sent_last = monotonictime;
+      // Requests from any series (list, PollRequest(), once off) may change data:
+      if (!POLL_TYPE_IS_CACHEABLE(m_poll.type))
+        PollCacheInvalidate(m_poll.entry.txmoduleid, m_poll.entry.rxmoduleid);
       // Dispatch transmission start to protocol handler:
       if (m_poll.protocol == VWTP_20)
         PollerVWTPStart(fromPrimaryOrOnceOffTicker);
@@ -527,6 +1139,9 @@ void OvmsPoller::PollerSend(poller_source_t source)
 
 void OvmsPoller::Outgoing(const CAN_frame_t &frame, bool success)
   {
+  // Pipelined requests:
+  if (m_slots_busy && PollerSlotOutgoing(frame, success))
+    return;
 
   // Check for a late callback:
   if (!m_poll_wait || !m_poll.entry.txmoduleid || frame.origin != m_poll.bus || frame.MsgID != m_poll_txmsgid)
@@ -568,6 +1183,11 @@ void OvmsPoller::Outgoing(const CAN_frame_t &frame, bool success)
  *  @param response     Response buffer (binary string) (multiple response frames assembled)
  *  @param timeout_ms   Timeout for poller/response in milliseconds
  *  @param protocol     Protocol variant: ISOTP_STD / ISOTP_EXTADR / ISOTP_EXTFRAME
+ *  @param max_age_ms   Accept a cached response up to this age (0 = always send the request)
+ *  
+ *  Read only requests (see POLL_TYPE_IS_CACHEABLE) are shared: a request identical to one
+ *  already in progress waits for that response instead of sending its own. Their
+ *  positive responses are kept in a small cache for the max_age_ms of later requests.
  *  
  *  @return             POLLSINGLE_OK         (0)   -- success, response is valid
  *                      POLLSINGLE_TIMEOUT    (-1)  -- timeout/poller unavailable
@@ -577,54 +1197,129 @@ void OvmsPoller::Outgoing(const CAN_frame_t &frame, bool success)
  */
 int OvmsPoller::PollSingleRequest(uint32_t txid, uint32_t rxid,
                                    std::string request, std::string& response,
-                                   int timeout_ms /*=3000*/, uint8_t protocol /*=ISOTP_STD*/)
+                                   int timeout_ms /*=3000*/, uint8_t protocol /*=ISOTP_STD*/,
+                                   int max_age_ms /*=0*/)
   {
   if (!Ready())
     return -1;
 
-  OvmsRecMutexLock slock(&m_poll_single_mutex, pdMS_TO_TICKS(timeout_ms));
-  if (!slock.IsLocked())
-    return -1;
-
-  // prepare single poll:
-  OvmsPoller::poll_pid_t poll =
-      { txid, rxid, 0, 0, { 1, 1, 1, 1 }, 0, protocol };
-
   assert(request.size() > 0);
-  poll.type = request[0];
-  poll.xargs.tag = POLL_TXDATA;
-
-  if (POLL_TYPE_HAS_16BIT_PID(poll.type))
-    {
-    assert(request.size() >= 3);
-    poll.xargs.pid = request[1] << 8 | request[2];
-    poll.xargs.datalen = LIMIT_MAX(request.size()-3, 4095);
-    poll.xargs.data = (const uint8_t*)request.data()+3;
-    }
-  else if (POLL_TYPE_HAS_8BIT_PID(poll.type))
+  if (!POLL_TYPE_IS_CACHEABLE((uint8_t)request[0]))
     {
-    assert(request.size() >= 2);
-    poll.xargs.pid = request.at(1);
-    poll.xargs.datalen = LIMIT_MAX(request.size()-2, 4095);
-    poll.xargs.data = (const uint8_t*)request.data()+2;
+    // The request may change data, drop the cached responses of the ECU(s):
+    PollCacheInvalidate(txid, rxid);
+    return PollSingleTransfer(txid, rxid, request, response, timeout_ms, protocol);
     }
-  else
+
+  std::shared_ptr<poll_inflight_t> inflight;
+  bool waiting = false;
     {
-    poll.xargs.pid = 0;
+    OvmsMutexLock lock(&m_cache_mutex);
+    if (max_age_ms > 0 && PollCacheFind(txid, rxid, protocol, request,
+        esp_timer_get_time() - (int64_t)max_age_ms * 1000, response))
+      {
+      ++m_cache_hits;
+      return POLLSINGLE_OK;
+      }
+    for (auto &req : m_inflight)
+      {
+      if (req->txid == txid && req->rxid == rxid && req->protocol == protocol && req->request == request)
+        {
+        inflight = req;
+        waiting = true;
+        break;
+        }
+      }
+    if (waiting)
+      ++m_cache_coalesced;
+    else
+      {
+      ++m_cache_misses;
+      inflight = std::make_shared<poll_inflight_t>();
+      inflight->txid = txid;
+      inflight->rxid = rxid;
+      inflight->protocol = protocol;
+      inflight->request = request;
+      inflight->result = POLLSINGLE_TIMEOUT;
+      m_inflight.push_back(inflight);
+      }
+    }
+
+  if (waiting)
+    {
+    // Identical request in progress, share its result:
+    IFTRACE(Poller) ESP_LOGV(TAG, "[%" PRIu8 "]Single Request joining identical request", m_poll.bus_no);
+    if (!inflight->rxdone.Take(pdMS_TO_TICKS(timeout_ms)))
+      return POLLSINGLE_TIMEOUT;
+    inflight->rxdone.Give();
+    if (inflight->result == POLLSINGLE_OK)
+      response = inflight->response;
+    return inflight->result;
+    }
+
+  int result = PollSingleTransfer(txid, rxid, request, response, timeout_ms, protocol);
+
+    {
+    OvmsMutexLock lock(&m_cache_mutex);
+    inflight->result = result;
+    if (result == POLLSINGLE_OK)
+      inflight->response = response;
+    m_inflight.erase(std::remove(m_inflight.begin(), m_inflight.end(), inflight), m_inflight.end());
+    }
+  inflight->rxdone.Give();
+  return result;
+  }
+
+/**
+ * PollSingleTransfer: send a single request & wait for the response (see PollSingleRequest)
+ */
+int OvmsPoller::PollSingleTransfer(uint32_t txid, uint32_t rxid, const std::string &request,
+                                   std::string& response, int timeout_ms, uint8_t protocol)
+  {
+  OvmsRecMutexLock slock(&m_poll_single_mutex, pdMS_TO_TICKS(timeout_ms));
+  if (!slock.IsLocked())
+    return -1;
+
+  // prepare single poll:
+  OvmsPoller::poll_pid_t poll =
+      { txid, rxid, 0, 0, { 1, 1, 1, 1 }, 0, protocol };
+
+  poll.type = request[0];
+  poll.xargs.tag = POLL_TXDATA;
+
+  if (POLL_TYPE_HAS_16BIT_PID(poll.type))
+    {
+    assert(request.size() >= 3);
+    poll.xargs.pid = request[1] << 8 | request[2];
+    poll.xargs.datalen = LIMIT_MAX(request.size()-3, 4095);
+    poll.xargs.data = (const uint8_t*)request.data()+3;
+    }
+  else if (POLL_TYPE_HAS_8BIT_PID(poll.type))
+    {
+    assert(request.size() >= 2);
+    poll.xargs.pid = request.at(1);
+    poll.xargs.datalen = LIMIT_MAX(request.size()-2, 4095);
+    poll.xargs.data = (const uint8_t*)request.data()+2;
+    }
+  else
+    {
+    poll.xargs.pid = 0;
     poll.xargs.datalen = LIMIT_MAX(request.size()-1, 4095);
     poll.xargs.data = (const uint8_t*)request.data()+1;
     }
 
   int rx_error;
   OvmsSemaphore     single_rxdone;   // … response done (ok/error)
-  std::shared_ptr<BlockingOnceOffPoll> poller( new BlockingOnceOffPoll(poll, &response, &rx_error, &single_rxdone));
+  std::shared_ptr<BlockingOnceOffPoll> poller = std::allocate_shared<BlockingOnceOffPoll>(
+    canpool_allocator<BlockingOnceOffPoll>(&s_jobpool), poll, &response, &rx_error, &single_rxdone);
 
   // acquire poller access:
     {
     OvmsRecMutexLock lock(&m_poll_mutex, pdMS_TO_TICKS(timeout_ms));
     if (!lock.IsLocked())
       return -1;
-    // start single poll:
+    // start single poll (the parent poller caches the response):
+    poller->SetParentPoller(this);
     m_polls.SetEntry("!v.single", poller, true);
     }
 
@@ -653,6 +1348,7 @@ int OvmsPoller::PollSingleRequest(uint32_t txid, uint32_t rxid,
  *  @param response     Response buffer (binary string) (multiple response frames assembled)
  *  @param timeout_ms   Timeout for poller/response in milliseconds
  *  @param protocol     Protocol variant: ISOTP_STD / ISOTP_EXTADR / ISOTP_EXTFRAME
+ *  @param max_age_ms   Accept a cached response up to this age (0 = always send the request)
  *  
  *  @return             POLLSINGLE_OK         ( 0)  -- success, response is valid
  *                      POLLSINGLE_TIMEOUT    (-1)  -- timeout/poller unavailable
@@ -662,7 +1358,8 @@ int OvmsPoller::PollSingleRequest(uint32_t txid, uint32_t rxid,
  */
 int OvmsPoller::PollSingleRequest( uint32_t txid, uint32_t rxid,
                                    uint8_t polltype, uint16_t pid, std::string& response,
-                                   int timeout_ms /*=3000*/, uint8_t protocol /*=ISOTP_STD*/)
+                                   int timeout_ms /*=3000*/, uint8_t protocol /*=ISOTP_STD*/,
+                                   int max_age_ms /*=0*/)
   {
   std::string request;
   request = (char) polltype;
@@ -675,7 +1372,143 @@ int OvmsPoller::PollSingleRequest( uint32_t txid, uint32_t rxid,
     {
     request += (char) (pid & 0xff);
     }
-  return PollSingleRequest(txid, rxid, request, response, timeout_ms, protocol);
+  return PollSingleRequest(txid, rxid, request, response, timeout_ms, protocol, max_age_ms);
+  }
+
+/**
+ * PollRequestData: get the request bytes (type + PID + payload) of a poll entry
+ */
+std::string OvmsPoller::PollRequestData(const poll_pid_t &entry)
+  {
+  std::string request;
+  request = (char) entry.type;
+  if (POLL_TYPE_HAS_16BIT_PID(entry.type))
+    {
+    request += (char) (entry.pid >> 8);
+    request += (char) (entry.pid & 0xff);
+    }
+  else if (POLL_TYPE_HAS_8BIT_PID(entry.type))
+    {
+    request += (char) (entry.pid & 0xff);
+    }
+  if (POLL_ENTRY_XARGS(entry))
+    request.append((const char*)entry.xargs.data, entry.xargs.datalen);
+  else
+    request.append((const char*)entry.args.data, LIMIT_MAX(entry.args.datalen, sizeof(entry.args.data)));
+  return request;
+  }
+
+/**
+ * PollCacheFind: look up a cached response received since the given time
+ *  Call with m_cache_mutex held.
+ */
+bool OvmsPoller::PollCacheFind(uint32_t txid, uint32_t rxid, uint8_t protocol, const std::string &request,
+                               int64_t since, std::string &response, CAN_frame_format_t *format /*=nullptr*/)
+  {
+  for (auto &entry : m_cache)
+    {
+    if (entry.txid == txid && entry.rxid == rxid && entry.protocol == protocol && entry.request == request)
+      {
+      if (entry.time < since)
+        return false;
+      response = entry.response;
+      if (format)
+        *format = entry.format;
+      return true;
+      }
+    }
+  return false;
+  }
+
+/**
+ * PollCacheStore: remember a positive response to a once-off request
+ *  Replaces the previous response to the request or the oldest entry.
+ */
+void OvmsPoller::PollCacheStore(const poll_pid_t &entry, CAN_frame_format_t format, const std::string &response)
+  {
+  if (!POLL_TYPE_IS_CACHEABLE(entry.type) || response.size() > POLL_CACHE_MAXDATA)
+    return;
+  std::string request = PollRequestData(entry);
+  OvmsMutexLock lock(&m_cache_mutex);
+  poll_cache_t *slot = nullptr, *oldest = nullptr;
+  for (auto &it : m_cache)
+    {
+    if (it.txid == entry.txmoduleid && it.rxid == entry.rxmoduleid && it.protocol == entry.protocol && it.request == request)
+      {
+      slot = &it;
+      break;
+      }
+    if (!oldest || it.time < oldest->time)
+      oldest = &it;
+    }
+  if (!slot)
+    {
+    if (m_cache.size() < POLL_CACHE_SIZE)
+      {
+      m_cache.emplace_back();
+      slot = &m_cache.back();
+      }
+    else
+      slot = oldest;
+    }
+  slot->txid = entry.txmoduleid;
+  slot->rxid = entry.rxmoduleid;
+  slot->protocol = entry.protocol;
+  slot->format = format;
+  slot->time = esp_timer_get_time();
+  slot->request = request;
+  slot->response = response;
+  }
+
+/**
+ * PollCacheStatus: output the cached responses & statistics
+ */
+void OvmsPoller::PollCacheStatus(OvmsWriter* writer)
+  {
+  OvmsMutexLock lock(&m_cache_mutex);
+  writer->printf("  Hits: %" PRIu32 "  Coalesced: %" PRIu32 "  Misses: %" PRIu32 "  In progress: %u\n",
+    m_cache_hits, m_cache_coalesced, m_cache_misses, (unsigned)m_inflight.size());
+  if (m_cache.empty())
+    return;
+  int64_t now = esp_timer_get_time();
+  writer->puts("  TxID     RxID     Age [s]  Bytes  Request");
+  for (auto &entry : m_cache)
+    {
+    writer->printf("  %-8" PRIx32 " %-8" PRIx32 " %7.1f %6u  %s\n",
+      entry.txid, entry.rxid, (now - entry.time) / 1000000.0f, (unsigned)entry.response.size(),
+      hexencode(entry.request).c_str());
+    }
+  }
+
+/**
+ * PollCacheInvalidate: drop the cached responses a (non read only) request may change
+ *  Broadcast requests (no response ID, or a functional request ID) address all ECUs,
+ *  so drop the whole cache of the bus.
+ */
+void OvmsPoller::PollCacheInvalidate(uint32_t txid, uint32_t rxid)
+  {
+  OvmsMutexLock lock(&m_cache_mutex);
+  if (rxid == 0 || txid == 0x7df || txid == 0x18db33f1)
+    m_cache.clear();
+  else
+    m_cache.erase(std::remove_if(m_cache.begin(), m_cache.end(),
+      [txid](const poll_cache_t &entry) { return entry.txid == txid; }),
+      m_cache.end());
+  }
+
+/**
+ * PollCacheClear: drop the cached responses (and reset the statistics)
+ */
+void OvmsPoller::PollCacheClear(bool stats)
+  {
+  OvmsMutexLock lock(&m_cache_mutex);
+  m_cache.clear();
+  if (stats)
+    {
+    m_cache_hits = 0;
+    m_cache_coalesced = 0;
+    m_cache_misses = 0;
+    }
   }
 
 void OvmsPoller::Queue_PollerSend(OvmsPoller::poller_source_t source)
@@ -729,6 +1562,9 @@ bool OvmsPoller::PollRequest(const std::string &name, const std::shared_ptr<Poll
   series->SetParentPoller(this);
   series->ResetList(OvmsPoller::ResetMode::PollReset);
   m_polls.SetEntry(name, series);
+  // Fair scheduling: don't let a once-off request wait for the next run
+  if (series->Interactive() && m_polls.ResumeInteractive())
+    MyPollers.QueuePollerSend(poller_source_t::Scheduled, m_poll.bus_no);
   return true;
   }
 
@@ -791,6 +1627,8 @@ const char *OvmsPoller::PollerSource(OvmsPoller::poller_source_t src)
     case poller_source_t::Secondary: return "SEC";
     case poller_source_t::Successful: return "SRX";
     case poller_source_t::OnceOff: return "ONE";
+    case poller_source_t::Scheduled: return "SCH";
+    case poller_source_t::TxPace: return "TXP";
     }
     return "XXX";
   }
@@ -806,6 +1644,13 @@ const char *OvmsPoller::PollerCommand(OvmsPollCommand src, bool brief)
     case OvmsPollCommand::SuccessSep:  return brief ? "SucSp" : "SuccSep";
     case OvmsPollCommand::Shutdown:    return brief ? "Shtdn" : "Shutdown";
     case OvmsPollCommand::ResetTimer:  return brief ? "RstTm" : "ResetTimer";
+    case OvmsPollCommand::IntervalUnit: return brief ? "IntUn" : "IntervalUnit";
+    case OvmsPollCommand::Concurrency: return brief ? "Concr" : "Concurrency";
+    case OvmsPollCommand::Adaptive:    return brief ? "Adapt" : "Adaptive";
+    case OvmsPollCommand::AdaptiveReset: return brief ? "AdRst" : "AdaptiveReset";
+    case OvmsPollCommand::FlowControl: return brief ? "FlCtl" : "FlowControl";
+    case OvmsPollCommand::ChannelPool: return brief ? "ChPol" : "ChannelPool";
+    case OvmsPollCommand::FairSchedule: return brief ? "FairS" : "FairSchedule";
     }
   return "??";
   }
@@ -816,6 +1661,12 @@ OvmsPollers::OvmsPollers()
     m_poll_fc_septime(25),
     m_poll_ch_keepalive(60),
     m_poll_between_success(0),
+    m_poll_interval_unit(0),
+    m_poll_concurrency(1),
+    m_poll_adaptive(0),
+    m_poll_fc_adaptive(false),
+    m_poll_ch_pool(0),
+    m_poll_fair_latency(0),
     m_poll_last(0),
     m_pollqueue(nullptr), m_polltask(nullptr),
     m_timer_poller(nullptr),
@@ -836,14 +1687,17 @@ OvmsPollers::OvmsPollers()
     m_pollers[idx] = nullptr;
     m_canbusses[idx].can = nullptr;
     m_canbusses[idx].auto_poweroff = BusPoweroff::None;
+    m_latency_metrics[idx] = {};
     }
 
   m_overflow_count[0] = 0;
   m_overflow_count[1] = 0;
+  PipelineReset();
 
   m_poll_txcallback = std::bind(&OvmsPollers::PollerTxCallback, this, _1, _2);
 
   MyEvents.RegisterEvent(TAG, "ticker.1", std::bind(&OvmsPollers::Ticker1, this, _1, _2));
+  MyEvents.RegisterEvent(TAG, "ticker.10", std::bind(&OvmsPollers::Ticker10, this, _1, _2));
   MyCan.RegisterCallback(TAG, std::bind(&OvmsPollers::PollerRxCallback, this, _1, _2));
   MyEvents.RegisterEvent(TAG,"system.shuttingdown",std::bind(&OvmsPollers::EventSystemShuttingDown, this, _1, _2));
   MyEvents.RegisterEvent(TAG, "config.changed", std::bind(&OvmsPollers::ConfigChanged, this, _1, _2));
@@ -869,6 +1723,53 @@ OvmsPollers::OvmsPollers()
   cmd_times->RegisterCommand("off","Turn off Poll-Time Tracing",poller_times);
   cmd_times->RegisterCommand("status","Show timing status",poller_times);
   cmd_times->RegisterCommand("reset","Reset Poll-Time Tracing",poller_times);
+  OvmsCommand* cmd_pipeline = cmd_poller->RegisterCommand("pipeline","CAN RX frame pipeline",poller_pipeline);
+  cmd_pipeline->RegisterCommand("status","Show frame pipeline statistics",poller_pipeline);
+  cmd_pipeline->RegisterCommand("reset","Reset frame pipeline statistics",poller_pipeline);
+  OvmsCommand* cmd_schedule = cmd_poller->RegisterCommand("schedule","Deadline poll schedule",poller_schedule);
+  cmd_schedule->RegisterCommand("status","Show requested vs. achieved poll intervals",poller_schedule);
+  cmd_schedule->RegisterCommand("reset","Reset poll schedule statistics",poller_schedule);
+  OvmsCommand* cmd_batch = cmd_poller->RegisterCommand("batch","ReadDataByIdentifier batching",poller_batch);
+  cmd_batch->RegisterCommand("status","Show batching capabilities and statistics",poller_batch);
+  cmd_batch->RegisterCommand("reset","Reset statistics and re-enable disabled ECUs",poller_batch);
+  OvmsCommand* cmd_latency = cmd_poller->RegisterCommand("latency","Poll response latency statistics",poller_latency);
+  cmd_latency->RegisterCommand("on","Turn on latency statistics",poller_latency);
+  cmd_latency->RegisterCommand("off","Turn off latency statistics",poller_latency);
+  cmd_latency->RegisterCommand("status","Show latency statistics",poller_latency,"[-j]\n-j = output in JSON format",0,1);
+  cmd_latency->RegisterCommand("reset","Reset latency statistics",poller_latency);
+  OvmsCommand* cmd_adaptive = cmd_poller->RegisterCommand("adaptive","Adaptive poll rates",poller_adaptive);
+  cmd_adaptive->RegisterCommand("status","Show effective poll intervals",poller_adaptive);
+  cmd_adaptive->RegisterCommand("reset","Return to base poll rates, reset statistics",poller_adaptive);
+  OvmsCommand* cmd_isotp = cmd_poller->RegisterCommand("isotp","ISO-TP flow control",poller_isotp);
+  cmd_isotp->RegisterCommand("status","Show flow control parameters and throughput per ECU",poller_isotp);
+  cmd_isotp->RegisterCommand("reset","Reset learned flow control parameters and statistics",poller_isotp);
+  cmd_isotp->RegisterCommand("bench","Measure response throughput of an ECU",poller_isotp_bench,
+    "[-e|-E] [-n<count>] [-t<timeout_ms>] <bus> <txid> <rxid> <request>\n"
+    "Sends the request <count> times (default 10) on CAN bus <bus> (1-4),"
+    " reports the response bytes per second.\n"
+    "Give <txid> and <rxid> as hexadecimal CAN IDs,"
+    " add -e to use ISO-TP extended addressing or -E to use extended frames.\n"
+    "<request> is the hex string of the request type + arguments,"
+    " e.g. '22f190' or '2300100000ff' (read memory).\n"
+    "Default timeout is 3000 ms.",
+    4, 7);
+  OvmsCommand* cmd_vwtp = cmd_poller->RegisterCommand("vwtp","VW-TP 2.0 channel pool",poller_vwtp);
+  cmd_vwtp->RegisterCommand("status","Show open channels and channel statistics",poller_vwtp);
+  cmd_vwtp->RegisterCommand("reset","Reset statistics and the pool size limit",poller_vwtp);
+  OvmsCommand* cmd_cache = cmd_poller->RegisterCommand("cache","Once-off response cache",poller_cache);
+  cmd_cache->RegisterCommand("status","Show cached responses and statistics",poller_cache);
+  cmd_cache->RegisterCommand("clear","Drop cached responses, reset statistics",poller_cache);
+  cmd_cache->RegisterCommand("test","Check a repeated request is served from the cache",poller_cache_test,
+    "[-e|-E] [-t<timeout_ms>] <bus> <txid> <rxid> <request>\n"
+    "Sends the (read only) request on CAN bus <bus> (1-4), then repeats it with a max age"
+    " and checks the response is taken from the cache without sending a frame.\n"
+    "Give <txid> and <rxid> as hexadecimal CAN IDs,"
+    " add -e to use ISO-TP extended addressing or -E to use extended frames.\n"
+    "Default timeout is 3000 ms.",
+    4, 6);
+  OvmsCommand* cmd_series = cmd_poller->RegisterCommand("series","Poll series scheduling",poller_series);
+  cmd_series->RegisterCommand("status","Show served entries, starvation and once-off wait times",poller_series);
+  cmd_series->RegisterCommand("reset","Reset scheduling statistics",poller_series);
 
 #ifdef CONFIG_OVMS_SC_JAVASCRIPT_DUKTAPE
   DuktapeObjectRegistration* dto = new DuktapeObjectRegistration("OvmsPoller");
@@ -1065,6 +1966,12 @@ void OvmsPollers::Ticker1(std::string event, void* data)
   PollerResetThrottle();
   }
 
+void OvmsPollers::Ticker10(std::string event, void* data)
+  {
+  if (IsTracingLatency())
+    LatencyMetrics();
+  }
+
 void OvmsPollers::EventSystemShuttingDown(std::string event, void* data)
   {
   if (m_shut_down)
@@ -1100,19 +2007,27 @@ void OvmsPollers::VehicleOn(std::string event, void* data)
   {
   IFTRACE(Times)
     MyPollers.PollerTimesReset();
+  if (m_poll_adaptive)
+    Queue_Command(OvmsPoller::OvmsPollCommand::AdaptiveReset, 0);
   }
 void OvmsPollers::VehicleChargeStart(std::string event, void* data)
   {
   IFTRACE(Times)
     MyPollers.PollerTimesReset();
+  if (m_poll_adaptive)
+    Queue_Command(OvmsPoller::OvmsPollCommand::AdaptiveReset, 0);
   }
 void OvmsPollers::VehicleOff(std::string event, void* data)
   {
   NotifyPollerTrace();
+  if (m_poll_adaptive)
+    Queue_Command(OvmsPoller::OvmsPollCommand::AdaptiveReset, 0);
   }
 void OvmsPollers::VehicleChargeStop(std::string event, void* data)
   {
   NotifyPollerTrace();
+  if (m_poll_adaptive)
+    Queue_Command(OvmsPoller::OvmsPollCommand::AdaptiveReset, 0);
   }
 
 void OvmsPollers::NotifyPollerTrace()
@@ -1150,6 +2065,10 @@ void OvmsPollers::LoadPollerTimerConfig()
     MyPollers.m_trace |= trace_Times;
   else
     MyPollers.m_trace &= ~trace_Times;
+  if (MyConfig.GetParamValueBool("log", "poller.latency", false))
+    MyPollers.m_trace |= trace_Latency;
+  else
+    MyPollers.m_trace &= ~trace_Latency;
   }
 
 /**
@@ -1460,22 +2379,33 @@ void OvmsPollers::PollerTask()
       {
       case OvmsPoller::OvmsPollEntryType::FrameRx:
         {
+        // RX pipeline: all stages work on the queue entry, the vehicle stage
+        // comes last, as it may modify the frame.
+        CAN_frame_t &frame = entry.entry_FrameRxTx.frame;
         bool processed = false;
-        canbus* bus = entry.entry_FrameRxTx.frame.origin;
-        auto poller = GetPoller(entry.entry_FrameRxTx.frame.origin);
-        IFTRACE(Poller) ESP_LOGV(TAG, "Pollers: FrameRx(bus=%d)", GetBusNo(entry.entry_FrameRxTx.frame.origin));
+        canbus* bus = frame.origin;
+        int64_t t0 = esp_timer_get_time(), t1;
+        auto poller = GetPoller(bus);
+        IFTRACE(Poller) ESP_LOGV(TAG, "Pollers: FrameRx(bus=%d)", GetBusNo(bus));
         if (poller)
-          processed = poller->Incoming(entry.entry_FrameRxTx.frame, entry.entry_FrameRxTx.success);
-        PollerFrameRx(entry.entry_FrameRxTx.frame);
+          processed = poller->Incoming(frame, entry.entry_FrameRxTx.success);
+        t1 = esp_timer_get_time();
+        AddPipelineTime(pipe_Poller, t1 - t0);
 
+        PollerFrameRx(frame);
         if (!processed) // Not processed by poller.
           {
           dbcfile* dbc = bus->GetDBC();
           if (dbc != nullptr)
-            {
-            CAN_frame_t &frame = entry.entry_FrameRxTx.frame;
             dbc->DecodeSignal(frame.FIR.B.FF, frame.MsgID, frame.data.u8, 8);
-            }
+          }
+        t0 = esp_timer_get_time();
+        AddPipelineTime(pipe_Listeners, t0 - t1);
+
+        if (m_framestage)
+          {
+          m_framestage(&frame);
+          AddPipelineTime(pipe_Vehicle, esp_timer_get_time() - t0);
           }
         }
         break;
@@ -1509,7 +2439,10 @@ void OvmsPollers::PollerTask()
             if (poller)
               {
               if ((entry.entry_Poll.poll_ticker == 0) || (poller->m_poll.ticker == entry.entry_Poll.poll_ticker))
+                {
                 poller->PollerSend(entry.entry_Poll.source);
+                poller->PollerScheduleWake();
+                }
               }
             }
           else
@@ -1522,7 +2455,10 @@ void OvmsPollers::PollerTask()
                 poller = m_pollers[i];
                 }
               if (poller)
+                {
                 poller->PollerSend(entry.entry_Poll.source);
+                poller->PollerScheduleWake();
+                }
               }
             }
           }
@@ -1615,6 +2551,89 @@ void OvmsPollers::PollerTask()
                 }
               }
             break;
+          case OvmsPoller::OvmsPollCommand::IntervalUnit:
+            if (entry.entry_Command.parameter != m_poll_interval_unit)
+              {
+              m_poll_interval_unit = entry.entry_Command.parameter;
+              OvmsRecMutexLock lock(&m_poller_mutex);
+              for (int i = 0 ; i < VEHICLE_MAXBUSSES; ++i)
+                {
+                if (m_pollers[i])
+                  m_pollers[i]->PollSetIntervalUnit(m_poll_interval_unit);
+                }
+              }
+            break;
+          case OvmsPoller::OvmsPollCommand::Concurrency:
+            if (entry.entry_Command.parameter != m_poll_concurrency)
+              {
+              m_poll_concurrency = entry.entry_Command.parameter;
+              OvmsRecMutexLock lock(&m_poller_mutex);
+              for (int i = 0 ; i < VEHICLE_MAXBUSSES; ++i)
+                {
+                if (m_pollers[i])
+                  m_pollers[i]->PollSetConcurrency(m_poll_concurrency);
+                }
+              }
+            break;
+          case OvmsPoller::OvmsPollCommand::Adaptive:
+            if (entry.entry_Command.parameter != m_poll_adaptive)
+              {
+              m_poll_adaptive = entry.entry_Command.parameter;
+              OvmsRecMutexLock lock(&m_poller_mutex);
+              for (int i = 0 ; i < VEHICLE_MAXBUSSES; ++i)
+                {
+                if (m_pollers[i])
+                  m_pollers[i]->PollSetAdaptive(m_poll_adaptive);
+                }
+              }
+            break;
+          case OvmsPoller::OvmsPollCommand::AdaptiveReset:
+            if (m_poll_adaptive)
+              {
+              OvmsRecMutexLock lock(&m_poller_mutex);
+              for (int i = 0 ; i < VEHICLE_MAXBUSSES; ++i)
+                {
+                if (m_pollers[i])
+                  m_pollers[i]->AdaptiveReset(false);
+                }
+              }
+            break;
+          case OvmsPoller::OvmsPollCommand::FlowControl:
+            if ((bool)entry.entry_Command.parameter != m_poll_fc_adaptive)
+              {
+              m_poll_fc_adaptive = entry.entry_Command.parameter;
+              OvmsRecMutexLock lock(&m_poller_mutex);
+              for (int i = 0 ; i < VEHICLE_MAXBUSSES; ++i)
+                {
+                if (m_pollers[i])
+                  m_pollers[i]->PollSetFlowControlAdaptive(m_poll_fc_adaptive);
+                }
+              }
+            break;
+          case OvmsPoller::OvmsPollCommand::ChannelPool:
+            if (entry.entry_Command.parameter != m_poll_ch_pool)
+              {
+              m_poll_ch_pool = entry.entry_Command.parameter;
+              OvmsRecMutexLock lock(&m_poller_mutex);
+              for (int i = 0 ; i < VEHICLE_MAXBUSSES; ++i)
+                {
+                if (m_pollers[i])
+                  m_pollers[i]->PollSetChannelPool(m_poll_ch_pool);
+                }
+              }
+            break;
+          case OvmsPoller::OvmsPollCommand::FairSchedule:
+            if (entry.entry_Command.parameter != m_poll_fair_latency)
+              {
+              m_poll_fair_latency = entry.entry_Command.parameter;
+              OvmsRecMutexLock lock(&m_poller_mutex);
+              for (int i = 0 ; i < VEHICLE_MAXBUSSES; ++i)
+                {
+                if (m_pollers[i])
+                  m_pollers[i]->PollSetFairScheduling(m_poll_fair_latency);
+                }
+              }
+            break;
           case OvmsPoller::OvmsPollCommand::ResetTimer:
             break;//triggered above
           }
@@ -1695,6 +2714,12 @@ OvmsPoller *OvmsPollers::GetPoller(canbus *can, bool force)
     newpoller->m_poll_sequence_max = m_poll_sequence_max;
     newpoller->m_poll_fc_septime = m_poll_fc_septime;
     newpoller->m_poll_ch_keepalive = m_poll_ch_keepalive;
+    newpoller->m_poll_interval_unit = m_poll_interval_unit;
+    newpoller->m_poll_concurrency = m_poll_concurrency;
+    newpoller->m_poll_adaptive = m_poll_adaptive;
+    newpoller->m_poll_fc_adaptive = m_poll_fc_adaptive;
+    newpoller->PollSetChannelPool(m_poll_ch_pool);
+    newpoller->PollSetFairScheduling(m_poll_fair_latency);
     m_pollers[gap] = newpoller;
     }
 
@@ -1835,6 +2860,20 @@ void OvmsPollers::PollRemove(canbus* defbus, const std::string &name)
     }
   }
 
+void OvmsPollers::PollSetSeriesWeight(canbus* defbus, const std::string &name, uint8_t weight)
+  {
+  OvmsRecMutexLock lock(&m_poller_mutex);
+  bool found = false;
+  for (int i = 0 ; i < VEHICLE_MAXBUSSES ; ++i)
+    {
+    auto poller = m_pollers[i];
+    if (poller && (defbus == nullptr || poller->HasBus(defbus)))
+      found |= poller->PollSetSeriesWeight(name, weight);
+    }
+  if (!found)
+    ESP_LOGW(TAG, "Pollers: No poll series '%s' to set the weight", name.c_str());
+  }
+
 bool OvmsPollers::HasPollList(canbus* bus)
   {
   if (bus)
@@ -1961,6 +3000,13 @@ void OvmsPollers::PollerStatus(int verbosity, OvmsWriter* writer)
       writer->puts("None");
     else
       writer->printf("%" PRIu32 "s (ticks)\n", (curmon - last));
+    if (poller->m_poll_concurrency > 1)
+      {
+      writer->printf("  Pipelined: max %" PRIu8 ", in flight %" PRIu8 " (peak %" PRIu8 "), parked %" PRIu8 "\n",
+        poller->m_poll_concurrency, poller->m_slots_busy, poller->m_slots_peak, poller->m_parked_cnt);
+      writer->printf("  Pipelined: %" PRIu32 " sent, %" PRIu32 " parked, %" PRIu32 " timeouts\n",
+        poller->m_slots_started, poller->m_slots_parked, poller->m_slots_timeouts);
+      }
     }
   if (!found_list)
     {
@@ -1988,78 +3034,909 @@ void OvmsPollers::PollerStatus(int verbosity, OvmsWriter* writer)
     writer->puts("OBD polling is Resumed");
   }
 
-void OvmsPollers::SetUserPauseStatus(bool paused, int verbosity, OvmsWriter* writer)
+/**
+ * AddPipelineTime: account the processing time of a pipeline stage for one frame
+ *  Each stage is only updated by one task (poller task, or the vehicle task
+ *  in separate mode), so no locking is needed.
+ */
+void OvmsPollers::AddPipelineTime(pipeline_stage_t stage, uint32_t time_us)
   {
-  if (paused)
-    {
-    PausePolling(true);
-    writer->puts("Vehicle OBD Polling Pause Requested");
-    }
-  else
-    {
-    ResumePolling(true);
-    writer->puts("Vehicle OBD Polling Resume Requested");
-    }
+  pipeline_stats_t &st = m_pipeline[stage];
+  st.frames++;
+  st.time_sum += time_us;
+  if (time_us > st.time_max)
+    st.time_max = time_us;
   }
 
-void OvmsPollers::vehicle_poller_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+void OvmsPollers::PipelineReset()
   {
-  MyPollers.PollerStatus(verbosity, writer);
+  memset(m_pipeline, 0, sizeof(m_pipeline));
   }
-void OvmsPollers::vehicle_pause_on(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
-  {
-  MyPollers.SetUserPauseStatus(true, verbosity, writer);
+
+/**
+ * PipelineStatus: output frame pipeline statistics
+ *  The capacity is the inverse of the average processing time per frame
+ *  of the busiest task, excluding the queue transfers.
+ */
+void OvmsPollers::PipelineStatus(OvmsWriter* writer)
+  {
+  static const char* const names[pipe_Count] = { "poller", "listeners", "vehicle" };
+  bool unified = HasFrameStage();
+  writer->printf("Frame pipeline: %s\n", unified
+    ? "unified (vehicle stage in poller task)"
+    : "separate (vehicle task with own queue)");
+  writer->puts("Stage          Frames   Avg[us]   Max[us]");
+  float avg[pipe_Count];
+  for (int k = 0; k < pipe_Count; ++k)
+    {
+    pipeline_stats_t &st = m_pipeline[k];
+    avg[k] = st.frames ? (float)st.time_sum / st.frames : 0;
+    writer->printf("%-10s %10" PRIu32 " %9.1f %9" PRIu32 "\n", names[k], st.frames, avg[k], st.time_max);
+    }
+  writer->printf("RX queue overflows: %" PRIu32 "\n", m_overflow_count[0]);
+
+  float polltask = avg[pipe_Poller] + avg[pipe_Listeners];
+  float vehtask = 0;
+  if (unified)
+    polltask += avg[pipe_Vehicle];
+  else
+    vehtask = avg[pipe_Vehicle];
+  float busiest = (polltask > vehtask) ? polltask : vehtask;
+  if (busiest > 0)
+    writer->printf("Capacity: %.0f frames/s\n", 1000000.0f / busiest);
   }
 
-void OvmsPollers::vehicle_pause_off(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+void OvmsPollers::poller_pipeline(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
   {
-  MyPollers.SetUserPauseStatus(false, verbosity, writer);
+  if (strcmp(cmd->GetName(), "reset") == 0)
+    {
+    MyPollers.PipelineReset();
+    writer->puts("Frame pipeline statistics reset");
+    }
+  else
+    MyPollers.PipelineStatus(writer);
   }
 
-void OvmsPollers::vehicle_poller_trace(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+void OvmsPollers::poller_schedule(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
   {
-  if (strcmp(cmd->GetName(), "on") == 0)
-    MyPollers.m_trace |= trace_Poller;
-  else if (strcmp(cmd->GetName(), "txrx") == 0)
-    MyPollers.m_trace |= trace_TXRX;
-  else if (strcmp(cmd->GetName(), "all") == 0)
-    MyPollers.m_trace |= trace_All;
-  else if (strcmp(cmd->GetName(), "off") == 0)
-    MyPollers.m_trace &= ~trace_All;
-  //"status" falls through here.
-
-  writer->printf("Vehicle OBD poller tracing: %s%s%s\n",
-      (MyPollers.m_trace & trace_Poller) ? "+poll" : "",
-      (MyPollers.m_trace & trace_TXRX) ? "+txrx" : "",
-      (MyPollers.m_trace & trace_All) ? "" : "off");
+  bool reset = (strcmp(cmd->GetName(), "reset") == 0);
+  OvmsRecMutexLock lock(&MyPollers.m_poller_mutex);
+  for (int i = 0 ; i < VEHICLE_MAXBUSSES; ++i)
+    {
+    OvmsPoller* poller = MyPollers.m_pollers[i];
+    if (!poller)
+      continue;
+    if (!reset)
+      writer->printf("CAN%" PRIu8 ":\n", poller->m_poll.bus_no);
+    poller->ScheduleStatus(writer, reset);
+    }
+  if (reset)
+    writer->puts("Poll schedule statistics reset");
   }
 
-void OvmsPollers::poller_times(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+void OvmsPollers::poller_latency(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
   {
   if (strcmp(cmd->GetName(), "on") == 0)
     {
-    MyConfig.SetParamValueBool("log", "poller.timers", true);
-    writer->puts("Poller timing is now on");
+    MyConfig.SetParamValueBool("log", "poller.latency", true);
+    writer->puts("Poller latency statistics are now on");
     }
   else if (strcmp(cmd->GetName(), "off") == 0)
     {
-    MyConfig.SetParamValueBool("log", "poller.timers", false);
-    writer->puts("Poller timing is now off");
-    // Turn off the 'last' value.
-    MyPollers.Queue_Command(OvmsPoller::OvmsPollCommand::ResetTimer, 3);
-    }
-  else if (strcmp(cmd->GetName(), "status") == 0)
-    {
-    writer->printf("Poller timing is: %s\n",
-      (MyPollers.m_trace & trace_Times) ? "on" : "off");
-    MyPollers.PollerTimesTrace(writer);
+    MyConfig.SetParamValueBool("log", "poller.latency", false);
+    writer->puts("Poller latency statistics are now off");
     }
   else if (strcmp(cmd->GetName(), "reset") == 0)
     {
-    MyPollers.PollerTimesReset();
-    writer->puts("Poller times Reset");
-    writer->printf("Poller timing is: %s\n",
-      (MyPollers.m_trace & trace_Times) ? "on" : "off");
+    MyPollers.LatencyReset();
+    writer->puts("Poller latency statistics reset");
+    }
+  else
+    {
+    bool json = false;
+    if (argc > 0)
+      {
+      if (strcmp(argv[0], "-j") != 0)
+        {
+        cmd->PutUsage(writer);
+        return;
+        }
+      json = true;
+      }
+    if (!json)
+      writer->printf("Poller latency statistics are: %s\n", MyPollers.IsTracingLatency() ? "on" : "off");
+    MyPollers.LatencyStatus(writer, json);
+    }
+  }
+
+void OvmsPollers::poller_adaptive(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  bool reset = (strcmp(cmd->GetName(), "reset") == 0);
+  if (!reset && !MyPollers.m_poll_adaptive)
+    writer->puts("Adaptive poll rates are off");
+  OvmsRecMutexLock lock(&MyPollers.m_poller_mutex);
+  for (int i = 0 ; i < VEHICLE_MAXBUSSES; ++i)
+    {
+    OvmsPoller* poller = MyPollers.m_pollers[i];
+    if (!poller)
+      continue;
+    if (reset)
+      {
+      poller->AdaptiveReset(true);
+      continue;
+      }
+    writer->printf("CAN%" PRIu8 ":\n", poller->m_poll.bus_no);
+    poller->AdaptiveStatus(writer);
+    }
+  if (reset)
+    writer->puts("Adaptive poll rates reset");
+  }
+
+void OvmsPollers::poller_isotp(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  bool reset = (strcmp(cmd->GetName(), "reset") == 0);
+  if (!reset)
+    writer->printf("Adaptive flow control is %s\n", MyPollers.m_poll_fc_adaptive ? "on" : "off");
+  OvmsRecMutexLock lock(&MyPollers.m_poller_mutex);
+  for (int i = 0 ; i < VEHICLE_MAXBUSSES; ++i)
+    {
+    OvmsPoller* poller = MyPollers.m_pollers[i];
+    if (!poller)
+      continue;
+    if (reset)
+      {
+      poller->FlowControlReset();
+      continue;
+      }
+    writer->printf("CAN%" PRIu8 ":\n", poller->m_poll.bus_no);
+    poller->FlowControlStatus(writer);
+    }
+  if (reset)
+    writer->puts("ISO-TP flow control reset");
+  }
+
+void OvmsPollers::poller_vwtp(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  bool reset = (strcmp(cmd->GetName(), "reset") == 0);
+  if (!reset)
+    writer->printf("Channel pool size: %" PRIu8 "\n", MyPollers.m_poll_ch_pool);
+  OvmsRecMutexLock lock(&MyPollers.m_poller_mutex);
+  for (int i = 0 ; i < VEHICLE_MAXBUSSES; ++i)
+    {
+    OvmsPoller* poller = MyPollers.m_pollers[i];
+    if (!poller)
+      continue;
+    if (reset)
+      {
+      poller->ChannelPoolReset();
+      continue;
+      }
+    writer->printf("CAN%" PRIu8 ":\n", poller->m_poll.bus_no);
+    poller->ChannelPoolStatus(writer);
+    }
+  if (reset)
+    writer->puts("VW-TP channel statistics reset");
+  }
+
+void OvmsPollers::poller_cache(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  bool clear = (strcmp(cmd->GetName(), "clear") == 0);
+  OvmsRecMutexLock lock(&MyPollers.m_poller_mutex);
+  for (int i = 0 ; i < VEHICLE_MAXBUSSES; ++i)
+    {
+    OvmsPoller* poller = MyPollers.m_pollers[i];
+    if (!poller)
+      continue;
+    if (clear)
+      {
+      poller->PollCacheClear(true);
+      continue;
+      }
+    writer->printf("CAN%" PRIu8 ":\n", poller->m_poll.bus_no);
+    poller->PollCacheStatus(writer);
+    }
+  if (clear)
+    writer->puts("Response cache cleared");
+  }
+
+void OvmsPollers::poller_cache_test(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  uint8_t protocol = ISOTP_STD;
+  int timeout_ms = 3000;
+  int busno = 0;
+  uint32_t txid = 0, rxid = 0;
+  std::string request;
+
+  // parse args: [-e|-E] [-t<timeout_ms>] bus txid rxid request
+  int argpos = 0;
+  for (int i = 0; i < argc; i++)
+    {
+    if (argv[i][0] == '-')
+      {
+      switch (argv[i][1])
+        {
+        case 'e':
+          protocol = ISOTP_EXTADR;
+          break;
+        case 'E':
+          protocol = ISOTP_EXTFRAME;
+          break;
+        case 't':
+          timeout_ms = atoi(argv[i]+2);
+          break;
+        default:
+          writer->printf("ERROR: unknown option '%s'\n", argv[i]);
+          return;
+        }
+      }
+    else
+      {
+      switch (++argpos)
+        {
+        case 1:
+          busno = atoi(argv[i]);
+          break;
+        case 2:
+          txid = strtol(argv[i], NULL, 16);
+          break;
+        case 3:
+          rxid = strtol(argv[i], NULL, 16);
+          break;
+        case 4:
+          request = hexdecode(argv[i]);
+          break;
+        default:
+          writer->puts("ERROR: too many args");
+          return;
+        }
+      }
+    }
+  if (argpos < 4 || request.empty() || rxid == 0)
+    {
+    writer->puts("ERROR: too few args, need: bus txid rxid request");
+    return;
+    }
+  if (!POLL_TYPE_IS_CACHEABLE((uint8_t)request[0]))
+    {
+    writer->puts("ERROR: request type is not cacheable (use a read only request)");
+    return;
+    }
+  if (timeout_ms <= 0)
+    {
+    writer->puts("ERROR: invalid timeout (must be > 0)");
+    return;
+    }
+  canbus* bus = MyPollers.GetBus(busno);
+  OvmsPoller* poller = bus ? MyPollers.GetPoller(bus, true) : nullptr;
+  if (!poller)
+    {
+    writer->printf("ERROR: CAN bus %d not available\n", busno);
+    return;
+    }
+
+  // First request: always sent, the response is cached:
+  const int max_age_ms = 60000;
+  std::string response1, response2;
+  poller->PollCacheInvalidate(txid, rxid);
+  int res = poller->PollSingleRequest(txid, rxid, request, response1, timeout_ms, protocol, max_age_ms);
+  if (res != POLLSINGLE_OK)
+    {
+    const char* errname = OvmsPoller::PollResultCodeName(res);
+    writer->printf("FAIL: no response to the first request: %d%s%s\n",
+      res, errname ? " " : "", errname ? errname : "");
+    writer->puts("Self test FAILED");
+    return;
+    }
+
+  // Second request: must be served from the cache, no frame sent:
+  uint32_t hits = poller->m_cache_hits;
+  uint32_t packets_tx = bus->m_status.packets_tx;
+  res = poller->PollSingleRequest(txid, rxid, request, response2, timeout_ms, protocol, max_age_ms);
+  std::string result;
+  if (res != POLLSINGLE_OK)
+    result = string_format("FAIL: second request result %d", res);
+  else if (bus->m_status.packets_tx != packets_tx)
+    result = string_format("FAIL: second request sent %" PRIu32 " frame(s)", bus->m_status.packets_tx - packets_tx);
+  else if (poller->m_cache_hits != hits + 1)
+    result = "FAIL: second request not counted as a cache hit";
+  else if (response2 != response1)
+    result = "FAIL: cached response differs";
+
+  writer->printf("%" PRIx32 "[%" PRIx32 "] %s: %u bytes, %s\n",
+    txid, rxid, hexencode(request).c_str(), (unsigned)response1.size(), result.empty() ? "OK" : result.c_str());
+  writer->printf("%s\n", result.empty() ? "Self test passed" : "Self test FAILED");
+  }
+
+void OvmsPollers::poller_series(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  bool reset = (strcmp(cmd->GetName(), "reset") == 0);
+  if (!reset)
+    {
+    if (MyPollers.m_poll_fair_latency)
+      writer->printf("Fair scheduling: on, latency target %" PRIu16 " ms\n", MyPollers.m_poll_fair_latency);
+    else
+      writer->puts("Fair scheduling: off");
+    }
+  OvmsRecMutexLock lock(&MyPollers.m_poller_mutex);
+  for (int i = 0 ; i < VEHICLE_MAXBUSSES; ++i)
+    {
+    OvmsPoller* poller = MyPollers.m_pollers[i];
+    if (!poller)
+      continue;
+    if (reset)
+      {
+      poller->FairReset();
+      continue;
+      }
+    writer->printf("CAN%" PRIu8 ":\n", poller->m_poll.bus_no);
+    poller->FairStatus(writer);
+    }
+  if (reset)
+    writer->puts("Poll series statistics reset");
+  }
+
+void OvmsPollers::poller_isotp_bench(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  uint8_t protocol = ISOTP_STD;
+  int count = 10, timeout_ms = 3000;
+  int busno = 0;
+  uint32_t txid = 0, rxid = 0;
+  std::string request;
+
+  // parse args: [-e|-E] [-n<count>] [-t<timeout_ms>] bus txid rxid request
+  int argpos = 0;
+  for (int i = 0; i < argc; i++)
+    {
+    if (argv[i][0] == '-')
+      {
+      switch (argv[i][1])
+        {
+        case 'e':
+          protocol = ISOTP_EXTADR;
+          break;
+        case 'E':
+          protocol = ISOTP_EXTFRAME;
+          break;
+        case 'n':
+          count = atoi(argv[i]+2);
+          break;
+        case 't':
+          timeout_ms = atoi(argv[i]+2);
+          break;
+        default:
+          writer->printf("ERROR: unknown option '%s'\n", argv[i]);
+          return;
+        }
+      }
+    else
+      {
+      switch (++argpos)
+        {
+        case 1:
+          busno = atoi(argv[i]);
+          break;
+        case 2:
+          txid = strtol(argv[i], NULL, 16);
+          break;
+        case 3:
+          rxid = strtol(argv[i], NULL, 16);
+          break;
+        case 4:
+          request = hexdecode(argv[i]);
+          break;
+        default:
+          writer->puts("ERROR: too many args");
+          return;
+        }
+      }
+    }
+  if (argpos < 4 || request.empty())
+    {
+    writer->puts("ERROR: too few args, need: bus txid rxid request");
+    return;
+    }
+  if (count <= 0 || timeout_ms <= 0)
+    {
+    writer->puts("ERROR: invalid count or timeout (must be > 0)");
+    return;
+    }
+  canbus* bus = MyPollers.GetBus(busno);
+  OvmsPoller* poller = bus ? MyPollers.GetPoller(bus, true) : nullptr;
+  if (!poller)
+    {
+    writer->printf("ERROR: CAN bus %d not available\n", busno);
+    return;
+    }
+
+  // run requests:
+  int responses = 0, err = 0;
+  uint64_t bytes = 0, time_sum = 0;
+  uint32_t time_min = UINT32_MAX, time_max = 0;
+  for (int i = 0; i < count; i++)
+    {
+    std::string response;
+    int64_t start = esp_timer_get_time();
+    int res = poller->PollSingleRequest(txid, rxid, request, response, timeout_ms, protocol);
+    uint32_t time = esp_timer_get_time() - start;
+    if (res != POLLSINGLE_OK)
+      {
+      err = res;
+      continue;
+      }
+    responses++;
+    bytes += response.size();
+    time_sum += time;
+    if (time < time_min) time_min = time;
+    if (time > time_max) time_max = time;
+    }
+
+  writer->printf("%" PRIx32 "[%" PRIx32 "] %s: %d of %d requests answered\n",
+    txid, rxid, hexencode(request).c_str(), responses, count);
+  if (err)
+    {
+    const char* errname = OvmsPoller::PollResultCodeName(err);
+    writer->printf("Last error: %d%s%s\n", err, errname ? " " : "", errname ? errname : "");
+    }
+  if (responses)
+    {
+    writer->printf("Response: %" PRIu64 " bytes avg, %.1f / %.1f / %.1f ms min/avg/max\n",
+      bytes / responses, time_min / 1000.0f, time_sum / responses / 1000.0f, time_max / 1000.0f);
+    writer->printf("Throughput: %.0f bytes/s\n", time_sum ? bytes * 1000000.0f / time_sum : 0.0f);
+    }
+  }
+
+void OvmsPollers::poller_batch(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (strcmp(cmd->GetName(), "reset") == 0)
+    {
+    MyPollers.BatchReset();
+    writer->puts("Batching statistics reset");
+    }
+  else
+    MyPollers.BatchStatus(writer);
+  }
+
+/**
+ * PollSetBatch: allow batched ReadDataByIdentifier requests for an ECU
+ *  Requests for up to max_dids DIDs due at the same time are combined. The
+ *  response is split into the single DID responses by the response data
+ *  lengths given for the DIDs (terminated by POLL_DID_LENGTH_END). The lengths
+ *  array must stay valid. max_dids < 2 removes the ECU.
+ */
+void OvmsPollers::PollSetBatch(uint32_t txid, uint32_t rxid, uint8_t max_dids, const OvmsPoller::poll_did_length_t* lengths)
+  {
+  OvmsMutexLock lock(&m_batch_mutex);
+  auto it = std::find_if(m_batch.begin(), m_batch.end(), [txid, rxid](const OvmsPoller::poll_batch_t &batch)
+    {
+    return batch.txid == txid && batch.rxid == rxid;
+    });
+  if (max_dids < 2 || !lengths)
+    {
+    if (it != m_batch.end())
+      m_batch.erase(it);
+    return;
+    }
+  if (it == m_batch.end())
+    it = m_batch.insert(m_batch.end(), OvmsPoller::poll_batch_t());
+  *it = {};
+  it->txid = txid;
+  it->rxid = rxid;
+  it->max_dids = LIMIT_MAX(max_dids, POLL_BATCH_MAXDIDS);
+  it->lengths = lengths;
+  }
+
+bool OvmsPollers::GetBatch(uint32_t txid, uint32_t rxid, OvmsPoller::poll_batch_t &batch) const
+  {
+  OvmsMutexLock lock(&m_batch_mutex);
+  for (auto &entry : m_batch)
+    {
+    if (entry.txid == txid && entry.rxid == rxid)
+      {
+      batch = entry;
+      return true;
+      }
+    }
+  return false;
+  }
+
+/**
+ * BatchResult: count a batched request, a failed one disables batching for the ECU
+ */
+void OvmsPollers::BatchResult(uint32_t txid, uint32_t rxid, uint8_t dids, bool failed)
+  {
+  OvmsMutexLock lock(&m_batch_mutex);
+  for (auto &entry : m_batch)
+    {
+    if (entry.txid != txid || entry.rxid != rxid)
+      continue;
+    entry.requests++;
+    entry.dids += dids;
+    if (failed)
+      {
+      entry.failures++;
+      if (!entry.disabled)
+        ESP_LOGW(TAG, "Batched requests to %03" PRIx32 " failed, disabling batching for this ECU", txid);
+      entry.disabled = true;
+      }
+    break;
+    }
+  }
+
+/**
+ * BatchLength: get the response data length for a DID
+ *  @return length or -1 if unknown
+ */
+int OvmsPollers::BatchLength(const OvmsPoller::poll_batch_t &batch, uint16_t did)
+  {
+  for (const OvmsPoller::poll_did_length_t* dl = batch.lengths; dl && dl->did != 0; ++dl)
+    {
+    if (dl->did == did)
+      return dl->length;
+    }
+  return -1;
+  }
+
+void OvmsPollers::BatchStatus(OvmsWriter* writer)
+  {
+  OvmsMutexLock lock(&m_batch_mutex);
+  if (m_batch.empty())
+    {
+    writer->puts("No ECUs with batched requests");
+    return;
+    }
+  writer->puts("TxID  RxID  Max  State     Requests    DIDs  Failed");
+  for (auto &entry : m_batch)
+    {
+    writer->printf("%4" PRIx32 "  %4" PRIx32 " %4" PRIu8 "  %-8s %9" PRIu32 " %7" PRIu32 " %7" PRIu32 "\n",
+      entry.txid, entry.rxid, entry.max_dids, entry.disabled ? "disabled" : "active",
+      entry.requests, entry.dids, entry.failures);
+    }
+  }
+
+void OvmsPollers::BatchReset()
+  {
+  OvmsMutexLock lock(&m_batch_mutex);
+  for (auto &entry : m_batch)
+    {
+    entry.disabled = false;
+    entry.requests = 0;
+    entry.dids = 0;
+    entry.failures = 0;
+    }
+  }
+
+// Latency histogram bucket upper bounds [us], the last bucket is open:
+const uint32_t OvmsPollers::latency_bounds[POLL_LATENCY_BUCKETS-1] =
+  {
+  1000, 2000, 3000, 5000, 7000, 10000, 15000, 20000, 30000, 50000, 70000,
+  100000, 150000, 200000, 300000, 500000, 700000, 1000000, 1500000, 2000000,
+  3000000, 5000000
+  };
+
+uint64_t OvmsPollers::LatencyKey(const OvmsPoller::poll_job_t &job)
+  {
+  return (uint64_t)job.bus_no << 56 | (uint64_t)(job.moduleid_sent & 0x1fffffff) << 24
+    | (uint64_t)(job.type & 0xff) << 16 | job.pid;
+  }
+
+uint8_t OvmsPollers::LatencyBucket(uint32_t time_us)
+  {
+  return std::upper_bound(latency_bounds, latency_bounds + POLL_LATENCY_BUCKETS-1, time_us - 1) - latency_bounds;
+  }
+
+/**
+ * LatencyPercentile: estimate a percentile [us] from a latency histogram
+ *  by linear interpolation within the bucket, the open bucket ends at max_us.
+ */
+float OvmsPollers::LatencyPercentile(const uint32_t* hist, uint32_t max_us, float p)
+  {
+  uint32_t total = 0;
+  for (int i = 0; i < POLL_LATENCY_BUCKETS; ++i)
+    total += hist[i];
+  if (total == 0)
+    return 0;
+  float target = p * total;
+  uint32_t count = 0;
+  for (int i = 0; i < POLL_LATENCY_BUCKETS; ++i)
+    {
+    if (hist[i] == 0 || count + hist[i] < target)
+      {
+      count += hist[i];
+      continue;
+      }
+    float lower = (i > 0) ? latency_bounds[i-1] : 0;
+    float upper = (i < POLL_LATENCY_BUCKETS-1) ? latency_bounds[i] : max_us;
+    if (upper > max_us)
+      upper = max_us;
+    if (upper < lower)
+      upper = lower;
+    return lower + (upper - lower) * (target - count) / hist[i];
+    }
+  return max_us;
+  }
+
+OvmsPollers::latency_stat_t &OvmsPollers::LatencyStat(const OvmsPoller::poll_job_t &job)
+  {
+  auto it = m_latency.find(LatencyKey(job));
+  if (it == m_latency.end())
+    it = m_latency.insert(std::make_pair(LatencyKey(job), latency_stat_t())).first;
+  return it->second;
+  }
+
+/**
+ * LatencyStart: a request has been sent, start tracking its response times
+ *  (if enabled). The poll_latency_t lat belongs to the request.
+ */
+void OvmsPollers::LatencyStart(const OvmsPoller::poll_job_t &job, OvmsPoller::poll_latency_t &lat, uint16_t bytes)
+  {
+  lat.sent = 0;
+  if (!IsTracingLatency())
+    return;
+  lat.sent = esp_timer_get_time();
+  lat.first = false;
+  OvmsMutexLock lock(&m_latency_mutex);
+  latency_stat_t &stat = LatencyStat(job);
+  stat.requests++;
+  stat.bytes_tx += bytes;
+  }
+
+/**
+ * LatencyFirst: the first response frame (or response pending info) has been received
+ */
+void OvmsPollers::LatencyFirst(const OvmsPoller::poll_job_t &job, OvmsPoller::poll_latency_t &lat)
+  {
+  if (!lat.sent || lat.first)
+    return;
+  lat.first = true;
+  uint32_t time = esp_timer_get_time() - lat.sent;
+  OvmsMutexLock lock(&m_latency_mutex);
+  latency_stat_t &stat = LatencyStat(job);
+  stat.first[LatencyBucket(time)]++;
+  if (time > stat.max_first)
+    stat.max_first = time;
+  }
+
+/**
+ * LatencyDone: the response is complete
+ */
+void OvmsPollers::LatencyDone(const OvmsPoller::poll_job_t &job, OvmsPoller::poll_latency_t &lat, uint16_t bytes)
+  {
+  if (!lat.sent)
+    return;
+  LatencyFirst(job, lat);
+  uint32_t time = esp_timer_get_time() - lat.sent;
+  lat.sent = 0;
+  OvmsMutexLock lock(&m_latency_mutex);
+  latency_stat_t &stat = LatencyStat(job);
+  stat.responses++;
+  stat.bytes_rx += bytes;
+  stat.done[LatencyBucket(time)]++;
+  if (time > stat.max_done)
+    stat.max_done = time;
+  }
+
+/**
+ * LatencyError: a negative response has been received
+ */
+void OvmsPollers::LatencyError(const OvmsPoller::poll_job_t &job, OvmsPoller::poll_latency_t &lat, uint8_t code)
+  {
+  if (!lat.sent)
+    return;
+  LatencyFirst(job, lat);
+  lat.sent = 0;
+  OvmsMutexLock lock(&m_latency_mutex);
+  latency_stat_t &stat = LatencyStat(job);
+  stat.errors++;
+  stat.nrc_last = code;
+  }
+
+/**
+ * LatencyTimeout: the request has not been (completely) answered
+ */
+void OvmsPollers::LatencyTimeout(const OvmsPoller::poll_job_t &job, OvmsPoller::poll_latency_t &lat)
+  {
+  if (!lat.sent)
+    return;
+  lat.sent = 0;
+  OvmsMutexLock lock(&m_latency_mutex);
+  LatencyStat(job).timeouts++;
+  }
+
+void OvmsPollers::LatencyReset()
+  {
+  OvmsMutexLock lock(&m_latency_mutex);
+  m_latency.clear();
+  }
+
+void OvmsPollers::LatencyStatus(OvmsWriter* writer, bool json)
+  {
+  std::map<uint64_t, latency_stat_t> copy;
+    {
+    OvmsMutexLock lock(&m_latency_mutex);
+    copy = m_latency;
+    }
+
+  if (json)
+    writer->puts("[");
+  else if (copy.empty())
+    {
+    writer->puts("No latency statistics");
+    return;
+    }
+  else
+    {
+    writer->puts("Bus TxID  Type  PID    Req  Resp   Err NRC   T/O   First p50/p95/p99 [ms]    Done p50/p95/p99 [ms]   Max[ms]   TX/RX [bytes]");
+    }
+
+  size_t n = 0;
+  for (auto &it : copy)
+    {
+    const latency_stat_t &stat = it.second;
+    uint8_t bus = it.first >> 56;
+    uint32_t txid = (it.first >> 24) & 0x1fffffff;
+    uint8_t type = (it.first >> 16) & 0xff;
+    uint16_t pid = it.first & 0xffff;
+    float first[3], done[3];
+    const float pct[3] = { 0.50f, 0.95f, 0.99f };
+    for (int k = 0; k < 3; ++k)
+      {
+      first[k] = LatencyPercentile(stat.first, stat.max_first, pct[k]) / 1000;
+      done[k] = LatencyPercentile(stat.done, stat.max_done, pct[k]) / 1000;
+      }
+    if (json)
+      {
+      writer->printf(
+        "%s{\"bus\":%" PRIu8 ",\"txid\":%" PRIu32 ",\"type\":%" PRIu8 ",\"pid\":%" PRIu16
+        ",\"requests\":%" PRIu32 ",\"responses\":%" PRIu32 ",\"errors\":%" PRIu32 ",\"nrc_last\":%" PRIu8
+        ",\"timeouts\":%" PRIu32 ",\"bytes_tx\":%" PRIu32 ",\"bytes_rx\":%" PRIu32
+        ",\"first_ms\":[%.1f,%.1f,%.1f],\"done_ms\":[%.1f,%.1f,%.1f],\"done_max_ms\":%.1f}\n",
+        (n++ > 0) ? "," : "", bus, txid, type, pid,
+        stat.requests, stat.responses, stat.errors, stat.nrc_last,
+        stat.timeouts, stat.bytes_tx, stat.bytes_rx,
+        first[0], first[1], first[2], done[0], done[1], done[2], stat.max_done / 1000.0f);
+      }
+    else
+      {
+      writer->printf("%3" PRIu8 " %4" PRIx32 "  %02" PRIx8 "  %04" PRIx16 " %6" PRIu32 " %5" PRIu32 " %5" PRIu32 "  %02" PRIx8 " %5" PRIu32
+        "  %6.1f %6.1f %6.1f    %6.1f %6.1f %6.1f  %8.1f %7" PRIu32 "/%" PRIu32 "\n",
+        bus, txid, type, pid, stat.requests, stat.responses, stat.errors, stat.nrc_last, stat.timeouts,
+        first[0], first[1], first[2], done[0], done[1], done[2], stat.max_done / 1000.0f,
+        stat.bytes_tx, stat.bytes_rx);
+      }
+    }
+  if (json)
+    writer->puts("]");
+  }
+
+/**
+ * LatencyMetrics: update the per bus latency metrics
+ *  m.poller.canN.lat.p50/p95/p99 (complete responses), .timeouts & .errors
+ */
+void OvmsPollers::LatencyMetrics()
+  {
+  uint32_t hist[VEHICLE_MAXBUSSES][POLL_LATENCY_BUCKETS] = {};
+  uint32_t max[VEHICLE_MAXBUSSES] = {};
+  uint32_t timeouts[VEHICLE_MAXBUSSES] = {};
+  uint32_t errors[VEHICLE_MAXBUSSES] = {};
+  bool used[VEHICLE_MAXBUSSES] = {};
+    {
+    OvmsMutexLock lock(&m_latency_mutex);
+    for (auto &it : m_latency)
+      {
+      uint8_t bus = it.first >> 56;
+      if (bus < 1 || bus > VEHICLE_MAXBUSSES)
+        continue;
+      --bus;
+      const latency_stat_t &stat = it.second;
+      used[bus] = true;
+      for (int i = 0; i < POLL_LATENCY_BUCKETS; ++i)
+        hist[bus][i] += stat.done[i];
+      if (stat.max_done > max[bus])
+        max[bus] = stat.max_done;
+      timeouts[bus] += stat.timeouts;
+      errors[bus] += stat.errors;
+      }
+    }
+
+  for (int bus = 0; bus < VEHICLE_MAXBUSSES; ++bus)
+    {
+    if (!used[bus])
+      continue;
+    latency_metrics_t &lm = m_latency_metrics[bus];
+    if (!lm.p50)
+      {
+      char name[40];
+      snprintf(name, sizeof(name), "m.poller.can%d.lat.p50", bus+1);
+      lm.p50 = new OvmsMetricFloat(strdup(name), SM_STALE_MID, Seconds);
+      snprintf(name, sizeof(name), "m.poller.can%d.lat.p95", bus+1);
+      lm.p95 = new OvmsMetricFloat(strdup(name), SM_STALE_MID, Seconds);
+      snprintf(name, sizeof(name), "m.poller.can%d.lat.p99", bus+1);
+      lm.p99 = new OvmsMetricFloat(strdup(name), SM_STALE_MID, Seconds);
+      snprintf(name, sizeof(name), "m.poller.can%d.timeouts", bus+1);
+      lm.timeouts = new OvmsMetricInt(strdup(name), SM_STALE_MID);
+      snprintf(name, sizeof(name), "m.poller.can%d.errors", bus+1);
+      lm.errors = new OvmsMetricInt(strdup(name), SM_STALE_MID);
+      }
+    lm.p50->SetValue(LatencyPercentile(hist[bus], max[bus], 0.50f) / 1000000);
+    lm.p95->SetValue(LatencyPercentile(hist[bus], max[bus], 0.95f) / 1000000);
+    lm.p99->SetValue(LatencyPercentile(hist[bus], max[bus], 0.99f) / 1000000);
+    lm.timeouts->SetValue(timeouts[bus]);
+    lm.errors->SetValue(errors[bus]);
+    }
+  }
+
+void OvmsPollers::SetUserPauseStatus(bool paused, int verbosity, OvmsWriter* writer)
+  {
+  if (paused)
+    {
+    PausePolling(true);
+    writer->puts("Vehicle OBD Polling Pause Requested");
+    }
+  else
+    {
+    ResumePolling(true);
+    writer->puts("Vehicle OBD Polling Resume Requested");
+    }
+  }
+
+void OvmsPollers::vehicle_poller_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  MyPollers.PollerStatus(verbosity, writer);
+  }
+void OvmsPollers::vehicle_pause_on(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  MyPollers.SetUserPauseStatus(true, verbosity, writer);
+  }
+
+void OvmsPollers::vehicle_pause_off(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  MyPollers.SetUserPauseStatus(false, verbosity, writer);
+  }
+
+void OvmsPollers::vehicle_poller_trace(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (strcmp(cmd->GetName(), "on") == 0)
+    MyPollers.m_trace |= trace_Poller;
+  else if (strcmp(cmd->GetName(), "txrx") == 0)
+    MyPollers.m_trace |= trace_TXRX;
+  else if (strcmp(cmd->GetName(), "all") == 0)
+    MyPollers.m_trace |= trace_All;
+  else if (strcmp(cmd->GetName(), "off") == 0)
+    MyPollers.m_trace &= ~trace_All;
+  //"status" falls through here.
+
+  writer->printf("Vehicle OBD poller tracing: %s%s%s\n",
+      (MyPollers.m_trace & trace_Poller) ? "+poll" : "",
+      (MyPollers.m_trace & trace_TXRX) ? "+txrx" : "",
+      (MyPollers.m_trace & trace_All) ? "" : "off");
+  }
+
+void OvmsPollers::poller_times(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (strcmp(cmd->GetName(), "on") == 0)
+    {
+    MyConfig.SetParamValueBool("log", "poller.timers", true);
+    writer->puts("Poller timing is now on");
+    }
+  else if (strcmp(cmd->GetName(), "off") == 0)
+    {
+    MyConfig.SetParamValueBool("log", "poller.timers", false);
+    writer->puts("Poller timing is now off");
+    // Turn off the 'last' value.
+    MyPollers.Queue_Command(OvmsPoller::OvmsPollCommand::ResetTimer, 3);
+    }
+  else if (strcmp(cmd->GetName(), "status") == 0)
+    {
+    writer->printf("Poller timing is: %s\n",
+      (MyPollers.m_trace & trace_Times) ? "on" : "off");
+    MyPollers.PollerTimesTrace(writer);
+    }
+  else if (strcmp(cmd->GetName(), "reset") == 0)
+    {
+    MyPollers.PollerTimesReset();
+    writer->puts("Poller times Reset");
+    writer->printf("Poller timing is: %s\n",
+      (MyPollers.m_trace & trace_Times) ? "on" : "off");
     }
   }
 #ifdef CONFIG_OVMS_SC_JAVASCRIPT_DUKTAPE
@@ -2343,7 +4220,10 @@ static const char *PollResStr( OvmsPoller::OvmsNextPollResult res)
 // List of Poll Series
 
 OvmsPoller::PollSeriesList::PollSeriesList()
-  : m_first(nullptr), m_last(nullptr), m_iter(nullptr)
+  : m_first(nullptr), m_last(nullptr), m_iter(nullptr), m_resumed(false),
+    m_fair_latency(0), m_turn(nullptr), m_turn_interactive(false), m_turn_left(0),
+    m_preempted(false), m_interactive_only(false),
+    m_int_served(0), m_int_late(0), m_int_wait_sum(0), m_int_wait_max(0)
   {
   }
 
@@ -2365,6 +4245,9 @@ void OvmsPoller::PollSeriesList::SetEntry(const std::string &name, std::shared_p
       if (it->series != nullptr)
         it->series->Removing();
       it->series = series;
+      it->interactive = series != nullptr && series->Interactive();
+      it->queued = it->interactive ? esp_timer_get_time() : 0;
+      it->run_done = false;
       if (activate && it == m_first)
         m_iter = it;
       ESP_LOGD(TAG, "Poll List: Replaced Entry %s (%s)%s", it->name.c_str(), name.c_str(), activate ? " (active)" : "");
@@ -2375,6 +4258,13 @@ void OvmsPoller::PollSeriesList::SetEntry(const std::string &name, std::shared_p
   newval->name = name;
   newval->series = series;
   newval->is_blocking = blocking;
+  newval->interactive = series != nullptr && series->Interactive();
+  newval->weight = 1;
+  newval->run_started = false;
+  newval->run_done = false;
+  newval->queued = newval->interactive ? esp_timer_get_time() : 0;
+  newval->served = 0;
+  newval->starved = 0;
   newval->next = nullptr;
   newval->prev = nullptr;
 
@@ -2411,6 +4301,14 @@ void OvmsPoller::PollSeriesList::Remove( poll_series_t *iter)
 
   if (m_iter == iter)
     m_iter = iternext;
+  if (m_turn == iter)
+    {
+    // Continue the round after the removed series
+    m_turn = iterprev;
+    m_turn_left = 0;
+    if (m_turn == nullptr)
+      m_turn_interactive = true;
+    }
   if (m_first == iter)
     m_first = iternext;
   if (m_last == iter)
@@ -2445,6 +4343,8 @@ void OvmsPoller::PollSeriesList::InsertBefore( poll_series_t *iter, poll_series_
     {
     iter->next = before;
     iter->prev = before->prev;
+    if (before->prev)
+      before->prev->next = iter;
     before->prev = iter;
 
     if (before == m_first)
@@ -2482,8 +4382,16 @@ void OvmsPoller::PollSeriesList::Clear()
 void OvmsPoller::PollSeriesList::RestartPoll(OvmsPoller::ResetMode mode)
   {
   m_iter = m_first;
+  m_resumed = false;
+  m_turn = nullptr;
+  m_turn_interactive = false;
+  m_turn_left = 0;
+  m_preempted = false;
+  m_interactive_only = false;
   for ( auto iter = m_first; iter != nullptr; iter = iter->next)
     {
+    iter->run_started = false;
+    iter->run_done = false;
     if (iter->series != nullptr)
       iter->series->ResetList(mode);
     }
@@ -2518,6 +4426,13 @@ void OvmsPoller::PollSeriesList::IncomingError(const OvmsPoller::poll_job_t& job
     }
   }
 
+/// Pass on an abandoned response
+void OvmsPoller::PollSeriesList::IncomingAbandoned(const OvmsPoller::poll_job_t& job)
+  {
+  if ((m_iter != nullptr) && (m_iter->series != nullptr))
+    m_iter->series->IncomingAbandoned(job);
+  }
+
 /// Send on an imcoming TX reply
 void OvmsPoller::PollSeriesList::IncomingTxReply(const OvmsPoller::poll_job_t& job, bool success)
   {
@@ -2545,6 +4460,8 @@ OvmsPoller::OvmsNextPollResult OvmsPoller::PollSeriesList::NextPollEntry(poll_pi
     IFTRACE(Poller) ESP_LOGV(TAG, "PollSeriesList::NextPollEntry - Not Started");
     return OvmsPoller::OvmsNextPollResult::StillAtEnd;
     }
+  if (m_fair_latency && !m_resumed)
+    return NextFairEntry(entry, mybus, pollticker, pollstate);
 
   OvmsPoller::OvmsNextPollResult res = OvmsPoller::OvmsNextPollResult::StillAtEnd;
   while (true)
@@ -2566,15 +4483,30 @@ OvmsPoller::OvmsNextPollResult OvmsPoller::PollSeriesList::NextPollEntry(poll_pi
 
     IFTRACE(Poller) ESP_LOGV(TAG, "PollSeriesList::NextPollEntry[%s]: %s", m_iter->name.c_str(), PollResStr(res));
 
+    if (m_resumed && res != OvmsPoller::OvmsNextPollResult::FoundEntry && res != OvmsPoller::OvmsNextPollResult::Ignore)
+      {
+      // Resumed for a deadline series: stop when it has nothing more due
+      m_resumed = false;
+      m_iter = nullptr;
+      return OvmsPoller::OvmsNextPollResult::StillAtEnd;
+      }
+
     switch (res)
       {
+      case OvmsPoller::OvmsNextPollResult::FoundEntry:
+        {
+        Served(m_iter, esp_timer_get_time());
+        return res;
+        }
       case OvmsPoller::OvmsNextPollResult::NotReady:
         {
+        m_iter->run_done = true;
         m_iter = m_iter->next;
         break;
         }
       case OvmsPoller::OvmsNextPollResult::StillAtEnd:
         {
+        m_iter->run_done = true;
         if (m_iter->is_blocking)
           {
           m_iter = nullptr;
@@ -2590,6 +4522,7 @@ OvmsPoller::OvmsNextPollResult OvmsPoller::PollSeriesList::NextPollEntry(poll_pi
           {
           case OvmsPoller::SeriesStatus::Next:
             {
+            m_iter->run_done = true;
             if (m_iter->is_blocking)
               {
               m_iter = nullptr;
@@ -2616,6 +4549,7 @@ OvmsPoller::OvmsNextPollResult OvmsPoller::PollSeriesList::NextPollEntry(poll_pi
             }
           default:
             // Shouldn't happen.
+            m_iter->run_done = true;
             if (m_iter->is_blocking)
               {
               m_iter = nullptr;
@@ -2631,26 +4565,336 @@ OvmsPoller::OvmsNextPollResult OvmsPoller::PollSeriesList::NextPollEntry(poll_pi
     }
   }
 
-bool OvmsPoller::PollSeriesList::HasPollList() const
+void OvmsPoller::PollSeriesList::Served( poll_series_t *iter, int64_t now)
+  {
+  ++iter->served;
+  iter->run_started = true;
+  if (iter->queued)
+    {
+    // First entry of an interactive series: account the queue wait
+    uint32_t wait = now - iter->queued;
+    iter->queued = 0;
+    ++m_int_served;
+    m_int_wait_sum += wait;
+    if (wait > m_int_wait_max)
+      m_int_wait_max = wait;
+    if (m_fair_latency && wait > m_fair_latency)
+      ++m_int_late;
+    }
+  }
+
+/**
+ * FairSelect: weighted round robin across the series
+ *  Blocking series stay exclusive. Interactive series waiting longer than
+ *  the latency target are served next, alternating with the turns so a
+ *  burst of them can't starve the other series either. Otherwise each
+ *  round gives one turn of POLL_FAIR_INTERACTIVE entries to the interactive
+ *  series (in order of arrival), then one turn of 'weight' entries to each
+ *  other series in list order.
+ *
+ *  @param turn
+ *    Set if the selection is charged to the current turn
+ */
+OvmsPoller::poll_series_t *OvmsPoller::PollSeriesList::FairSelect(int64_t now, bool &turn)
+  {
+  turn = false;
+  poll_series_t *pending = nullptr, *late = nullptr;
+  for (auto it = m_first; it != nullptr; it = it->next)
+    {
+    if (it->series == nullptr || it->run_done)
+      continue;
+    if (it->is_blocking)
+      return it;
+    if (it->interactive)
+      {
+      if (!pending)
+        pending = it;
+      if (!late && it->queued && now - it->queued >= m_fair_latency)
+        late = it;
+      }
+    }
+
+  if (m_interactive_only)
+    return pending;
+
+  if (late && !m_preempted)
+    {
+    m_preempted = true;
+    return late;
+    }
+  m_preempted = false;
+
+  turn = true;
+  if (m_turn_left > 0)
+    {
+    if (m_turn == nullptr && m_turn_interactive)
+      {
+      if (pending)
+        return pending;
+      }
+    else if (m_turn != nullptr && m_turn->series != nullptr && !m_turn->run_done)
+      return m_turn;
+    }
+
+  for (int round = 0; round < 2; ++round)
+    {
+    if (m_turn == nullptr && !m_turn_interactive)
+      {
+      // Start of a round: interactive turn
+      m_turn_interactive = true;
+      m_turn_left = 0;
+      if (pending)
+        {
+        m_turn_left = POLL_FAIR_INTERACTIVE;
+        return pending;
+        }
+      }
+    for (auto it = (m_turn != nullptr) ? m_turn->next : m_first; it != nullptr; it = it->next)
+      {
+      if (it->series == nullptr || it->run_done || it->is_blocking || it->interactive)
+        continue;
+      m_turn = it;
+      m_turn_interactive = false;
+      m_turn_left = it->weight;
+      return it;
+      }
+    m_turn = nullptr;
+    m_turn_interactive = false;
+    }
+  return nullptr;
+  }
+
+OvmsPoller::OvmsNextPollResult OvmsPoller::PollSeriesList::NextFairEntry(poll_pid_t &entry, uint8_t mybus, uint32_t pollticker, uint8_t pollstate)
+  {
+  int64_t now = esp_timer_get_time();
+  while (true)
+    {
+    bool turn;
+    m_iter = FairSelect(now, turn);
+    if (m_iter == nullptr)
+      {
+      IFTRACE(Poller) ESP_LOGV(TAG, "PollSeriesList::NextFairEntry - Run finished");
+      if (m_interactive_only)
+        {
+        m_interactive_only = false;
+        return OvmsPoller::OvmsNextPollResult::StillAtEnd;
+        }
+      return OvmsPoller::OvmsNextPollResult::ReachedEnd;
+      }
+
+    OvmsPoller::OvmsNextPollResult res = m_iter->series->NextPollEntry(entry, mybus, pollticker, pollstate);
+
+    IFTRACE(Poller) ESP_LOGV(TAG, "PollSeriesList::NextFairEntry[%s]: %s", m_iter->name.c_str(), PollResStr(res));
+
+    switch (res)
+      {
+      case OvmsPoller::OvmsNextPollResult::FoundEntry:
+        if (turn && m_turn_left > 0)
+          --m_turn_left;
+        Served(m_iter, now);
+        return res;
+      case OvmsPoller::OvmsNextPollResult::NotReady:
+      case OvmsPoller::OvmsNextPollResult::StillAtEnd:
+        // Blocking series waiting for a retry don't hold up the others:
+        m_iter->run_done = true;
+        break;
+      case OvmsPoller::OvmsNextPollResult::ReachedEnd:
+        switch (m_iter->series->FinishRun())
+          {
+          case OvmsPoller::SeriesStatus::RemoveNext:
+          case OvmsPoller::SeriesStatus::RemoveRestart:
+            IFTRACE(Poller) ESP_LOGD(TAG, "Poll Auto-Removing '%s'", m_iter->name.c_str());
+            Remove(m_iter);
+            break;
+          default:
+            m_iter->run_done = true;
+          }
+        break;
+      default:
+        return res;
+      }
+    }
+  }
+
+bool OvmsPoller::PollSeriesList::HasSeries(const PollSeriesEntry* series) const
+  {
+  if (series == nullptr)
+    return false;
+  for (auto it = m_first; it != nullptr; it = it->next)
+    {
+    if (it->series.get() == series)
+      return true;
+    }
+  return false;
+  }
+
+bool OvmsPoller::PollSeriesList::HasPollList() const
+  {
+  for (auto it = m_first; it != nullptr; it = it->next)
+    {
+    if (it->series != nullptr && it->series->HasPollList())
+      return true;
+    }
+  return false;
+  }
+
+bool OvmsPoller::PollSeriesList::HasRepeat() const
+  {
+  for (auto it = m_first; it != nullptr; it = it->next)
+    {
+    if (it->series != nullptr && it->series->HasRepeat())
+      return true;
+    }
+  return false;
+  }
+
+int64_t OvmsPoller::PollSeriesList::NextDueTime() const
+  {
+  int64_t next = 0;
+  for (auto it = m_first; it != nullptr; it = it->next)
+    {
+    if (it->series == nullptr)
+      continue;
+    int64_t due = it->series->NextDueTime();
+    if (due != 0 && (next == 0 || due < next))
+      next = due;
+    }
+  return next;
+  }
+
+bool OvmsPoller::PollSeriesList::ResumeDue(int64_t now)
+  {
+  if (m_iter != nullptr)
+    return false;
+  for (auto it = m_first; it != nullptr; it = it->next)
+    {
+    if (it->series == nullptr || !it->series->Ready())
+      continue;
+    int64_t due = it->series->NextDueTime();
+    if (due != 0 && due <= now)
+      {
+      IFTRACE(Poller) ESP_LOGV(TAG, "PollSeriesList::ResumeDue[%s]", it->name.c_str());
+      m_iter = it;
+      m_resumed = true;
+      return true;
+      }
+    }
+  return false;
+  }
+
+void OvmsPoller::PollSeriesList::ScheduleStatus(OvmsWriter* writer, bool reset)
   {
   for (auto it = m_first; it != nullptr; it = it->next)
     {
-    if (it->series != nullptr && it->series->HasPollList())
+    if (it->series != nullptr)
+      it->series->ScheduleStatus(writer, it->name, reset);
+    }
+  }
+
+void OvmsPoller::PollSeriesList::AdaptiveReset(bool stats)
+  {
+  for (auto it = m_first; it != nullptr; it = it->next)
+    {
+    if (it->series != nullptr)
+      it->series->AdaptiveReset(stats);
+    }
+  }
+
+void OvmsPoller::PollSeriesList::AdaptiveStatus(OvmsWriter* writer)
+  {
+  for (auto it = m_first; it != nullptr; it = it->next)
+    {
+    if (it->series != nullptr)
+      it->series->AdaptiveStatus(writer, it->name);
+    }
+  }
+
+void OvmsPoller::PollSeriesList::SetFairLatency(uint16_t latency_ms)
+  {
+  m_fair_latency = (int64_t)latency_ms * 1000;
+  m_turn = nullptr;
+  m_turn_interactive = false;
+  m_turn_left = 0;
+  m_preempted = false;
+  m_interactive_only = false;
+  }
+
+bool OvmsPoller::PollSeriesList::SetWeight(const std::string &name, uint8_t weight)
+  {
+  for (auto it = m_first; it != nullptr; it = it->next)
+    {
+    if (it->name == name)
+      {
+      it->weight = LIMIT_MIN(weight, 1);
       return true;
+      }
     }
   return false;
   }
 
-bool OvmsPoller::PollSeriesList::HasRepeat() const
+bool OvmsPoller::PollSeriesList::ResumeInteractive()
   {
+  if (!m_fair_latency || m_iter != nullptr)
+    return false;
   for (auto it = m_first; it != nullptr; it = it->next)
     {
-    if (it->series != nullptr && it->series->HasRepeat())
+    if (it->series != nullptr && it->interactive && !it->run_done)
+      {
+      IFTRACE(Poller) ESP_LOGV(TAG, "PollSeriesList::ResumeInteractive[%s]", it->name.c_str());
+      m_iter = it;
+      m_interactive_only = true;
       return true;
+      }
     }
   return false;
   }
 
+void OvmsPoller::PollSeriesList::CountStarved()
+  {
+  for (auto it = m_first; it != nullptr; it = it->next)
+    {
+    if (it->series != nullptr && !it->interactive && !it->run_started && !it->run_done
+        && it->series->HasPollList())
+      ++it->starved;
+    }
+  }
+
+void OvmsPoller::PollSeriesList::FairStatus(OvmsWriter* writer)
+  {
+  int pending = 0;
+  writer->printf("  %-24s %6s %10s %8s\n", "Series", "Weight", "Served", "Starved");
+  for (auto it = m_first; it != nullptr; it = it->next)
+    {
+    if (it->interactive)
+      {
+      if (it->queued)
+        ++pending;
+      continue;
+      }
+    writer->printf("  %-24s %6" PRIu8 " %10" PRIu32 " %8" PRIu32 "%s\n",
+      it->name.c_str(), it->weight, it->served, it->starved, it->is_blocking ? " (blocking)" : "");
+    }
+  writer->printf("  Interactive: %" PRIu32 " served, %d pending, wait avg %" PRIu32 " ms, max %" PRIu32 " ms",
+    m_int_served, pending, m_int_served ? (uint32_t)(m_int_wait_sum / m_int_served / 1000) : 0,
+    m_int_wait_max / 1000);
+  if (m_fair_latency)
+    writer->printf(", %" PRIu32 " over target", m_int_late);
+  writer->puts("");
+  }
+
+void OvmsPoller::PollSeriesList::FairReset()
+  {
+  for (auto it = m_first; it != nullptr; it = it->next)
+    {
+    it->served = 0;
+    it->starved = 0;
+    }
+  m_int_served = 0;
+  m_int_late = 0;
+  m_int_wait_sum = 0;
+  m_int_wait_max = 0;
+  }
+
 // Poll Series base
 /// Send on an imcoming TX reply
 void OvmsPoller::PollSeriesEntry::IncomingTxReply(const OvmsPoller::poll_job_t& job, bool success)
@@ -2658,15 +4902,44 @@ void OvmsPoller::PollSeriesEntry::IncomingTxReply(const OvmsPoller::poll_job_t&
   // ignore
   }
 
+/// The poller gave up on the response
+void OvmsPoller::PollSeriesEntry::IncomingAbandoned(const OvmsPoller::poll_job_t& job)
+  {
+  // ignore
+  }
+
 bool OvmsPoller::PollSeriesEntry::Ready() const
   {
   return true;
   }
+
+bool OvmsPoller::PollSeriesEntry::Interactive() const
+  {
+  return false;
+  }
+
+int64_t OvmsPoller::PollSeriesEntry::NextDueTime() const
+  {
+  return 0;
+  }
+
+void OvmsPoller::PollSeriesEntry::ScheduleStatus(OvmsWriter* writer, const std::string &name, bool reset)
+  {
+  }
+void OvmsPoller::PollSeriesEntry::AdaptiveReset(bool stats)
+  {
+  }
+void OvmsPoller::PollSeriesEntry::AdaptiveStatus(OvmsWriter* writer, const std::string &name)
+  {
+  }
 // Standard Poll Series - Replaces the original functionality
 
 // Standard Poll Series class
 OvmsPoller::StandardPollSeries::StandardPollSeries(OvmsPoller *poller, uint16_t stateoffset  )
-  : m_poller(poller), m_state_offset(stateoffset),  m_defaultbus(0), m_poll_plist(nullptr), m_poll_plcur(nullptr)
+  : m_poller(poller), m_state_offset(stateoffset),  m_defaultbus(0), m_poll_plist(nullptr), m_poll_plcur(nullptr),
+    m_interval_unit(0), m_sched_valid(false), m_sched_bus(0), m_sched_state(0),
+    m_batch(), m_batch_cnt(0), m_batch_open(false),
+    m_adapt_max(0), m_adapt_state(0), m_adapt_last(0), m_adapt_hash(0)
   {
   }
 void OvmsPoller::StandardPollSeries::SetParentPoller(OvmsPoller *poller)
@@ -2681,6 +4954,344 @@ void OvmsPoller::StandardPollSeries::PollSetPidList(uint8_t defaultbus, const po
   m_poll_plcur = nullptr;
   m_poll_plist = plist;
   m_defaultbus = defaultbus;
+  m_sched_valid = false;
+  m_adapt.clear();
+  AdaptPrepare();
+  }
+
+// Set the polltime unit [ms] and switch to deadline scheduling (0 = ticker scheduling).
+void OvmsPoller::StandardPollSeries::PollSetIntervalUnit(uint16_t unit_ms)
+  {
+  if (unit_ms == m_interval_unit)
+    return;
+  m_interval_unit = unit_ms;
+  m_sched_valid = false;
+  m_sched.clear();
+  m_sched_stats.clear();
+  }
+
+// Set the max adaptive interval factor (0 = adaptive mode off).
+void OvmsPoller::StandardPollSeries::PollSetAdaptive(uint8_t max_factor)
+  {
+  if (max_factor == m_adapt_max)
+    return;
+  m_adapt_max = max_factor;
+  m_adapt.clear();
+  AdaptPrepare();
+  m_sched_valid = false;
+  }
+
+void OvmsPoller::StandardPollSeries::AdaptPrepare()
+  {
+  if (!m_adapt_max || !m_poll_plist)
+    return;
+  uint16_t count = 0;
+  for (const poll_pid_t* p = m_poll_plist; p->txmoduleid != 0; ++p)
+    ++count;
+  adapt_t init = {};
+  init.factor = 1;
+  m_adapt.resize(count, init);
+  }
+
+uint8_t OvmsPoller::StandardPollSeries::AdaptFactor(uint16_t index) const
+  {
+  if (!m_adapt_max || index >= m_adapt.size())
+    return 1;
+  return m_adapt[index].factor;
+  }
+
+/**
+ * AdaptFind: get the poll list index of a response
+ *  Responses mostly come in list order, so the search starts after the last one.
+ *  @return index or -1
+ */
+int OvmsPoller::StandardPollSeries::AdaptFind(const OvmsPoller::poll_job_t& job)
+  {
+  const poll_pid_t &je = job.entry;
+  uint16_t count = m_adapt.size();
+  for (uint16_t n = 1; n <= count; ++n)
+    {
+    uint16_t i = (m_adapt_last + n) % count;
+    const poll_pid_t &pe = m_poll_plist[i];
+    if (pe.txmoduleid != je.txmoduleid || pe.rxmoduleid != je.rxmoduleid
+      || pe.type != job.type || pe.pid != job.pid)
+      continue;
+    if (POLL_ENTRY_XARGS(pe))
+      {
+      if (pe.xargs.tag != je.xargs.tag || pe.xargs.datalen != je.xargs.datalen || pe.xargs.data != je.xargs.data)
+        continue;
+      }
+    else if (pe.args.datalen != je.args.datalen || memcmp(pe.args.data, je.args.data, LIMIT_MAX(pe.args.datalen, 6)) != 0)
+      continue;
+    m_adapt_last = i;
+    return i;
+    }
+  return -1;
+  }
+
+/**
+ * AdaptIncoming: track the volatility of the responses
+ *  The fragments of a response are hashed (FNV-1a). A response equal to the
+ *  previous one counts as stable, POLL_ADAPT_STABLE stable responses double the
+ *  interval factor (up to the max), a changed response resets it to 1.
+ */
+void OvmsPoller::StandardPollSeries::AdaptIncoming(const OvmsPoller::poll_job_t& job, const uint8_t* data, uint8_t length)
+  {
+  if (!m_adapt_max || m_adapt.empty())
+    return;
+  if (job.mlframe == 0)
+    m_adapt_hash = 2166136261u;
+  for (uint8_t i = 0; i < length; ++i)
+    m_adapt_hash = (m_adapt_hash ^ data[i]) * 16777619u;
+  if (job.mlremain > 0)
+    return;
+
+  int index = AdaptFind(job);
+  if (index < 0)
+    return;
+  adapt_t &adapt = m_adapt[index];
+  if (adapt.responses++ > 0 && adapt.hash == m_adapt_hash)
+    {
+    if (adapt.factor < m_adapt_max && ++adapt.stable >= POLL_ADAPT_STABLE)
+      {
+      adapt.factor = LIMIT_MAX(adapt.factor * 2, m_adapt_max);
+      adapt.stable = 0;
+      IFTRACE(Poller) ESP_LOGD(TAG, "Standard Poll Series: %03" PRIx32 " %02" PRIx16 "(%" PRIx16 ") stable, interval factor %" PRIu8,
+        job.entry.txmoduleid, job.type, job.pid, adapt.factor);
+      }
+    }
+  else if (adapt.responses > 1)
+    {
+    adapt.changes++;
+    adapt.factor = 1;
+    adapt.stable = 0;
+    }
+  adapt.hash = m_adapt_hash;
+  }
+
+void OvmsPoller::StandardPollSeries::AdaptiveReset(bool stats)
+  {
+  for (auto &adapt : m_adapt)
+    {
+    adapt.factor = 1;
+    adapt.stable = 0;
+    if (stats)
+      {
+      adapt.responses = 0;
+      adapt.changes = 0;
+      }
+    }
+  // Deadline scheduling: restart at the base rates
+  if (m_interval_unit && m_adapt_max)
+    m_sched_valid = false;
+  }
+
+void OvmsPoller::StandardPollSeries::AdaptiveStatus(OvmsWriter* writer, const std::string &name)
+  {
+  if (!m_adapt_max || m_adapt.empty())
+    return;
+  uint32_t unit = m_interval_unit ? m_interval_unit : 1000;
+  writer->printf("  %s: max factor %" PRIu8 ", state %" PRIu8 "\n", name.c_str(), m_adapt_max, m_adapt_state);
+  writer->puts("    TxID  Type  PID   Base[ms]  Factor   Eff[ms]   Resp  Changed");
+  for (size_t i = 0; i < m_adapt.size(); ++i)
+    {
+    const poll_pid_t &pe = m_poll_plist[i];
+    uint32_t base = (uint32_t)pe.polltime[m_adapt_state] * unit;
+    if (!base)
+      continue;
+    const adapt_t &adapt = m_adapt[i];
+    writer->printf("    %4" PRIx32 "  %02" PRIx16 "  %04" PRIx16 " %9" PRIu32 " %7" PRIu8 " %9" PRIu32 " %6" PRIu32 " %8" PRIu32 "\n",
+      pe.txmoduleid, pe.type, pe.pid, base, adapt.factor, base * adapt.factor, adapt.responses, adapt.changes);
+    }
+  }
+
+// Heap order: earliest due time on top
+bool OvmsPoller::StandardPollSeries::SchedDueLater(const sched_slot_t &a, const sched_slot_t &b)
+  {
+  return a.due > b.due;
+  }
+
+/**
+ * CompileSchedule: build the due time heap for the bus & (offset) poll state
+ *  Entries sharing an interval get their first due time spread evenly over
+ *  that interval, so they don't burst out together.
+ */
+void OvmsPoller::StandardPollSeries::CompileSchedule(uint8_t mybus, uint8_t pollstate)
+  {
+  m_sched.clear();
+  m_sched_stats.clear();
+  m_sched_bus = mybus;
+  m_sched_state = pollstate;
+  m_sched_valid = true;
+  if (!m_poll_plist || !m_interval_unit)
+    return;
+
+  uint16_t count = 0;
+  for (const poll_pid_t* p = m_poll_plist; p->txmoduleid != 0; ++p)
+    ++count;
+  m_sched_stats.resize(count, sched_stat_t());
+
+  std::map<uint32_t, std::pair<uint16_t,uint16_t>> groups; // interval → total, assigned
+  for (uint16_t i = 0; i < count; ++i)
+    {
+    const poll_pid_t &pe = m_poll_plist[i];
+    uint8_t bus = pe.pollbus ? pe.pollbus : m_defaultbus;
+    uint32_t interval = (bus == mybus) ? (uint32_t)pe.polltime[pollstate] * m_interval_unit : 0;
+    m_sched_stats[i].interval = interval;
+    if (interval)
+      ++groups[interval].first;
+    }
+
+  int64_t now = esp_timer_get_time();
+  for (uint16_t i = 0; i < count; ++i)
+    {
+    uint32_t interval = m_sched_stats[i].interval;
+    if (!interval)
+      continue;
+    auto &grp = groups[interval];
+    sched_slot_t slot;
+    slot.index = i;
+    slot.due = now + (int64_t)interval * 1000 * grp.second++ / grp.first;
+    m_sched.push_back(slot);
+    }
+  std::make_heap(m_sched.begin(), m_sched.end(), SchedDueLater);
+  IFTRACE(Poller) ESP_LOGD(TAG, "Standard Poll Series: schedule compiled, %u entries", (unsigned)m_sched.size());
+  }
+
+// Pop the next due entry from the heap and schedule its next request.
+OvmsPoller::OvmsNextPollResult OvmsPoller::StandardPollSeries::NextScheduledEntry(poll_pid_t &entry, uint8_t mybus, uint8_t pollstate)
+  {
+  if (!m_sched_valid || m_sched_bus != mybus || m_sched_state != pollstate)
+    CompileSchedule(mybus, pollstate);
+  if (m_sched.empty())
+    return OvmsNextPollResult::StillAtEnd;
+
+  int64_t now = esp_timer_get_time();
+  if (m_sched.front().due > now)
+    return OvmsNextPollResult::StillAtEnd;
+
+  // Take the top entry and schedule its next request:
+  auto take = [this, now]() -> uint16_t
+    {
+    std::pop_heap(m_sched.begin(), m_sched.end(), SchedDueLater);
+    sched_slot_t &slot = m_sched.back();
+    sched_stat_t &stat = m_sched_stats[slot.index];
+    uint32_t late = (now - slot.due) / 1000;
+    if (late > stat.late_max)
+      stat.late_max = late;
+    if (stat.sent++ == 0)
+      stat.first = now;
+    stat.last = now;
+
+    // Keep the phase: skip due times missed completely
+    int64_t interval = (int64_t)stat.interval * 1000 * AdaptFactor(slot.index);
+    slot.due += interval;
+    if (slot.due <= now)
+      {
+      int64_t missed = (now - slot.due) / interval + 1;
+      stat.skipped += missed;
+      slot.due += missed * interval;
+      }
+    uint16_t index = slot.index;
+    std::push_heap(m_sched.begin(), m_sched.end(), SchedDueLater);
+    return index;
+    };
+
+  entry = m_poll_plist[take()];
+  if (BatchStart(entry))
+    {
+    // Add the next due entries for the same ECU:
+    while (m_sched.front().due <= now && BatchAdd(entry, m_poll_plist[m_sched.front().index]))
+      take();
+    }
+  IFTRACE(Poller) ESP_LOGD(TAG, "Found Poll Entry for Scheduled Poll");
+  return OvmsNextPollResult::FoundEntry;
+  }
+
+/**
+ * BatchStart: can the entry start a batched ReadDataByIdentifier request?
+ *  This needs a batching capability for the ECU (see OvmsPollers::PollSetBatch())
+ *  and a known response length for the DID.
+ */
+bool OvmsPoller::StandardPollSeries::BatchStart(const poll_pid_t &entry)
+  {
+  m_batch_cnt = 0;
+  if (entry.type != VEHICLE_POLL_TYPE_READDATA || entry.args.datalen != 0
+    || entry.protocol == VWTP_20 || entry.rxmoduleid == 0)
+    return false;
+  if (!MyPollers.GetBatch(entry.txmoduleid, entry.rxmoduleid, m_batch)
+    || m_batch.disabled || m_batch.max_dids < 2
+    || OvmsPollers::BatchLength(m_batch, entry.pid) < 0)
+    return false;
+  m_batch_cnt = 1;
+  m_batch_open = true;
+  return true;
+  }
+
+/**
+ * BatchAdd: add the DID of the next due entry to the batched request
+ *  Only the last DID of a request may have an unknown response length.
+ *  @return false if the entry doesn't match or fit
+ */
+bool OvmsPoller::StandardPollSeries::BatchAdd(poll_pid_t &entry, const poll_pid_t &next)
+  {
+  if (m_batch_cnt == 0 || !m_batch_open || m_batch_cnt >= m_batch.max_dids || m_batch_cnt >= POLL_BATCH_MAXDIDS)
+    return false;
+  if (next.txmoduleid != entry.txmoduleid || next.rxmoduleid != entry.rxmoduleid
+    || next.protocol != entry.protocol || next.type != entry.type
+    || next.args.datalen != 0 || next.pid == entry.pid)
+    return false;
+  // Responses are assigned by DID, so DIDs need to be unique:
+  for (int i = 0; i < m_batch_cnt-1; ++i)
+    {
+    if ((m_batch_data[2*i] << 8 | m_batch_data[2*i+1]) == next.pid)
+      return false;
+    }
+  m_batch_data[2*(m_batch_cnt-1)] = next.pid >> 8;
+  m_batch_data[2*(m_batch_cnt-1)+1] = next.pid & 0xff;
+  m_batch_cnt++;
+  m_batch_open = (OvmsPollers::BatchLength(m_batch, next.pid) >= 0);
+  entry.xargs.tag = POLL_TXBATCH;
+  entry.xargs.datalen = 2*(m_batch_cnt-1);
+  entry.xargs.data = m_batch_data;
+  return true;
+  }
+
+int64_t OvmsPoller::StandardPollSeries::NextDueTime() const
+  {
+  if (!m_interval_unit || !m_sched_valid || m_sched.empty())
+    return 0;
+  return m_sched.front().due;
+  }
+
+void OvmsPoller::StandardPollSeries::ScheduleStatus(OvmsWriter* writer, const std::string &name, bool reset)
+  {
+  if (!m_interval_unit)
+    return;
+  if (reset)
+    {
+    for (auto &stat : m_sched_stats)
+      {
+      uint32_t interval = stat.interval;
+      stat = sched_stat_t();
+      stat.interval = interval;
+      }
+    return;
+    }
+  writer->printf("  %s: unit %" PRIu16 " ms, %u entries scheduled\n", name.c_str(), m_interval_unit, (unsigned)m_sched.size());
+  if (m_sched.empty())
+    return;
+  writer->puts("    TxID  Type  PID    Req[ms]  Act[ms]   Sent  Skip  Late[ms]");
+  for (size_t i = 0; i < m_sched_stats.size(); ++i)
+    {
+    const sched_stat_t &stat = m_sched_stats[i];
+    if (!stat.interval)
+      continue;
+    const poll_pid_t &pe = m_poll_plist[i];
+    float achieved = (stat.sent > 1) ? (float)(stat.last - stat.first) / 1000 / (stat.sent - 1) : 0;
+    writer->printf("    %4" PRIx32 "  %02" PRIx16 "  %04" PRIx16 " %9" PRIu32 " %8.1f %6" PRIu32 " %5" PRIu32 " %9" PRIu32 "\n",
+      pe.txmoduleid, pe.type, pe.pid, stat.interval, achieved, stat.sent, stat.skipped, stat.late_max);
+    }
   }
 
 void OvmsPoller::StandardPollSeries::ResetList(OvmsPoller::ResetMode mode)
@@ -2707,6 +5318,16 @@ OvmsPoller::OvmsNextPollResult OvmsPoller::StandardPollSeries::NextPollEntry(pol
   if (pollstate >= VEHICLE_POLL_NSTATES)
     return OvmsNextPollResult::StillAtEnd;
 
+  // Adaptive rates: restart at the base rates on a state change
+  if (m_adapt_max && pollstate != m_adapt_state)
+    {
+    m_adapt_state = pollstate;
+    AdaptiveReset(false);
+    }
+
+  if (m_interval_unit)
+    return NextScheduledEntry(entry, mybus, pollstate);
+
   // Restart poll list cursor:
   if (m_poll_plcur == NULL)
     m_poll_plcur = m_poll_plist;
@@ -2722,10 +5343,24 @@ OvmsPoller::OvmsNextPollResult OvmsPoller::StandardPollSeries::NextPollEntry(pol
       bus = m_defaultbus;
     if (mybus == bus)
       {
-      uint16_t polltime = m_poll_plcur->polltime[pollstate];
+      uint32_t polltime = m_poll_plcur->polltime[pollstate] * AdaptFactor(m_poll_plcur - m_poll_plist);
       if (( polltime > 0) && ((pollticker % polltime) == 0))
         {
         entry = *m_poll_plcur;
+        if (BatchStart(entry))
+          {
+          // Add the next due entries for the same ECU:
+          for (const poll_pid_t* next = m_poll_plcur+1; next->txmoduleid != 0; ++next)
+            {
+            uint8_t nextbus = next->pollbus ? next->pollbus : m_defaultbus;
+            uint32_t nexttime = next->polltime[pollstate] * AdaptFactor(next - m_poll_plist);
+            if (nextbus != mybus || nexttime == 0 || (pollticker % nexttime) != 0)
+              continue;
+            if (!BatchAdd(entry, *next))
+              break;
+            m_poll_plcur = next;
+            }
+          }
         IFTRACE(Poller) ESP_LOGD(TAG, "Found Poll Entry for Standard Poll");
         return OvmsNextPollResult::FoundEntry;
         }
@@ -2776,17 +5411,52 @@ OvmsPoller::StandardVehiclePollSeries::StandardVehiclePollSeries(OvmsPoller *pol
 // Process an incoming packet.
 void OvmsPoller::StandardVehiclePollSeries::IncomingPacket(const OvmsPoller::poll_job_t& job, uint8_t* data, uint8_t length)
  {
- if (m_signal)
+ AdaptIncoming(job, data, length);
+ if (!m_signal)
+   return;
+ if (!m_signal->PollReassemble())
+   {
    m_signal->IncomingPollReply(job, data, length);
+   return;
+   }
+
+ // Deliver complete responses, single frames without a copy:
+ if (job.mlframe == 0)
+   {
+   if (job.mlremain == 0)
+     {
+     m_rxbuf.Release();
+     m_signal->IncomingPollResponse(job, data, length);
+     return;
+     }
+   m_rxbuf.Start(length + job.mlremain);
+   }
+ m_rxbuf.Append(data, length);
+ if (job.mlremain == 0)
+   {
+   if (m_rxbuf.Data())
+     m_signal->IncomingPollResponse(job, m_rxbuf.Data(), m_rxbuf.Length());
+   else
+     ESP_LOGE(TAG, "[%" PRIu8 "]Poller: no buffer for response (%" PRIu16 " bytes) TYPE:%x PID:%03x",
+       job.bus_no, (uint16_t)(job.mloffset + length), job.type, job.pid);
+   m_rxbuf.Release();
+   }
  }
 
 // Process An Error. 
 void OvmsPoller::StandardVehiclePollSeries::IncomingError(const OvmsPoller::poll_job_t& job, uint16_t code)
  {
+ m_rxbuf.Release();
  if (m_signal)
    m_signal->IncomingPollError(job, code);
  }
 
+// Release a partial response (timeout / abort), don't hold a pool buffer until the next response
+void OvmsPoller::StandardVehiclePollSeries::IncomingAbandoned(const OvmsPoller::poll_job_t& job)
+ {
+ m_rxbuf.Release();
+ }
+
 // Return true if this series is ok to run.
 bool OvmsPoller::StandardVehiclePollSeries::Ready() const
   {
@@ -2800,6 +5470,53 @@ void OvmsPoller::StandardVehiclePollSeries::IncomingTxReply(const OvmsPoller::po
     m_signal->IncomingPollTxCallback(job, success);
   }
 
+// ResponseBuffer
+
+/**
+ * Start: get a buffer for a response of the given total length
+ *  (a previous buffer is released)
+ */
+bool OvmsPoller::ResponseBuffer::Start(uint16_t size)
+  {
+  Release();
+  canpool* pool = (size <= POLLER_RXPOOL_SMALL) ? &s_rxpool_small : &s_rxpool_large;
+  m_data = (uint8_t*) pool->Alloc(size);
+  if (!m_data)
+    return false;
+  m_size = size;
+  return true;
+  }
+
+/**
+ * Append: add a response fragment
+ *  Fragments exceeding the announced length (protocol errors) are truncated.
+ */
+bool OvmsPoller::ResponseBuffer::Append(const uint8_t* data, uint16_t length)
+  {
+  if (!m_data)
+    return false;
+  if (length > m_size - m_length)
+    length = m_size - m_length;
+  memcpy(m_data + m_length, data, length);
+  m_length += length;
+  return true;
+  }
+
+void OvmsPoller::ResponseBuffer::Release()
+  {
+  if (m_data)
+    {
+    // Release() checks the pool address range and falls back to free():
+    if (s_rxpool_small.Owns(m_data))
+      s_rxpool_small.Release(m_data);
+    else
+      s_rxpool_large.Release(m_data);
+    m_data = nullptr;
+    }
+  m_size = 0;
+  m_length = 0;
+  }
+
 // StandardPacketPollSeries
 
 OvmsPoller::StandardPacketPollSeries::StandardPacketPollSeries( OvmsPoller *poller, int repeat_max, poll_success_func success, poll_fail_func fail, bool pack_raw_data)
@@ -2882,18 +5599,29 @@ bool OvmsPoller::StandardPacketPollSeries::HasRepeat() const
 
 OvmsPoller::OnceOffPollBase::OnceOffPollBase( const poll_pid_t &pollentry, std::string *rxbuf, int *rxerr, uint8_t retry_fail)
    : m_sent(status_t::Init), m_poll(pollentry), m_poll_rxbuf(rxbuf), m_poll_rxerr(rxerr),
-    m_retry_fail(retry_fail), m_format(CAN_frame_std)
+    m_retry_fail(retry_fail), m_format(CAN_frame_std), m_poller(nullptr), m_max_age(0)
   {
   }
 void OvmsPoller::OnceOffPollBase::SetParentPoller(OvmsPoller *poller)
   {
+  m_poller = poller;
+  }
+
+/**
+ * SetMaxAge: accept a cached response to the request up to max_age_ms old
+ *  (read only request types only, see POLL_TYPE_IS_CACHEABLE). The callbacks are
+ *  then called from the poller task without sending the request.
+ */
+void OvmsPoller::OnceOffPollBase::SetMaxAge(uint32_t max_age_ms)
+  {
+  m_max_age = max_age_ms;
   }
 
 OvmsPoller::OnceOffPollBase::OnceOffPollBase(std::string *rxbuf, int *rxerr, uint8_t retry_fail)
    : m_sent(status_t::Init),
     m_poll({ 0, 0, 0, 0, { 1, 1, 1, 1 }, 0, 0 }),
     m_poll_rxbuf(rxbuf), m_poll_rxerr(rxerr),
-    m_retry_fail(retry_fail), m_format(CAN_frame_std)
+    m_retry_fail(retry_fail), m_format(CAN_frame_std), m_poller(nullptr), m_max_age(0)
   {
   }
 
@@ -2971,6 +5699,27 @@ OvmsPoller::OvmsNextPollResult OvmsPoller::OnceOffPollBase::NextPollEntry(poll_p
     {
     case status_t::Init:
       {
+      if (m_max_age && m_poller && m_poll_rxbuf && POLL_TYPE_IS_CACHEABLE(m_poll.type))
+        {
+        bool found;
+          {
+          OvmsMutexLock lock(&m_poller->m_cache_mutex);
+          found = m_poller->PollCacheFind(m_poll.txmoduleid, m_poll.rxmoduleid, m_poll.protocol,
+            PollRequestData(m_poll), esp_timer_get_time() - (int64_t)m_max_age * 1000,
+            *m_poll_rxbuf, &m_format);
+          if (found)
+            ++m_poller->m_cache_hits;
+          }
+        if (found)
+          {
+          IFTRACE(Poller) ESP_LOGD(TAG, "Once Off Poll: Response from cache");
+          if (m_poll_rxerr)
+            *m_poll_rxerr = 0;
+          m_sent = status_t::Stopped;
+          Done(true);
+          return OvmsPoller::OvmsNextPollResult::ReachedEnd;
+          }
+        }
       entry = m_poll;
       m_sent = status_t::Sent;
       return OvmsNextPollResult::FoundEntry;
@@ -3022,6 +5771,8 @@ void OvmsPoller::OnceOffPollBase::IncomingPacket(const OvmsPoller::poll_job_t& j
     {
     if (m_poll_rxerr)
       *m_poll_rxerr = 0;
+    if (m_poller && m_poll_rxbuf)
+      m_poller->PollCacheStore(m_poll, m_format, *m_poll_rxbuf);
 
     m_sent = status_t::Stopping;
     Done(true);
@@ -3068,6 +5819,11 @@ bool OvmsPoller::OnceOffPollBase::HasRepeat() const
   return false; // Don't retry in same tick.
   }
 
+bool OvmsPoller::OnceOffPollBase::Interactive() const
+  {
+  return true;
+  }
+
 // OvmsPoller::BlockingOnceOffPoll class
 OvmsPoller::BlockingOnceOffPoll::BlockingOnceOffPoll(const poll_pid_t &pollentry, std::string *rxbuf, int *rxerr, OvmsSemaphore *rxdone )
    : OvmsPoller::OnceOffPollBase(pollentry, rxbuf, rxerr),  m_poll_rxdone(rxdone)
@@ -25,9 +25,12 @@
 #define __VEHICLE_POLLER_H__
 
 #include "vehicle_common.h"
+#include "ovms_mutex.h"
+#include "ovms_semaphore.h"
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 // PollSingleRequest specific result codes:
 #define POLLSINGLE_OK                   0
@@ -39,6 +42,36 @@
 // Number of polling states supported
 #define VEHICLE_POLL_NSTATES            4
 
+// Pipelined ISO-TP requests (see PollSetConcurrency()):
+#define POLLER_MAXSLOTS                 8     // Max concurrent requests per bus
+#define POLLER_SLOT_TIMEOUT             2000  // Response timeout [ms]
+
+// ReadDataByIdentifier batching (see PollSetBatch()):
+#define POLL_BATCH_MAXDIDS              8     // Max DIDs per request
+
+// Adaptive poll rates (see PollSetAdaptive()):
+#define POLL_ADAPT_STABLE               3     // Unchanged responses to double the interval
+
+// Response latency statistics (see "poller latency"):
+#define POLL_LATENCY_BUCKETS            23    // Histogram buckets, see latency_bounds[]
+
+// ISO-TP flow control (see PollSetFlowControlAdaptive()):
+#define POLL_FC_CLEAN                   4     // Clean responses to lower the separation time
+#define POLL_FC_PROBE                   32    // Clean responses to retry a level below a loss
+#define POLL_FC_BLOCKSIZE               8     // Block size used after losses at the max separation time
+#define POLL_FC_TXWAIT                  100   // Max wait [ms] for TX queue space per consecutive frame
+
+// VWTP_20 channel pool (see PollSetChannelPool()):
+#define POLL_VWTP_MAXPOOL               4     // Max idle channels kept open besides the active one
+#define POLL_VWTP_TESTMISS              3     // Unanswered channel tests to drop a pooled channel
+
+// Fair poll series scheduling (see PollSetFairScheduling()):
+#define POLL_FAIR_INTERACTIVE           2     // Entries per round for once-off (interactive) series
+
+// Once-off response cache (see PollSingleRequest()):
+#define POLL_CACHE_SIZE                 16    // Cached responses per bus
+#define POLL_CACHE_MAXDATA              512   // Max response size cached [bytes]
+
 // A note on "PID" and their sizes here:
 //  By "PID" for the service types we mean the part of the request parameters
 //  after the service type that is reflected in _every_ valid response to the request.
@@ -66,6 +99,21 @@
    (type) == VEHICLE_POLL_TYPE_OBDII_18)
 #define POLL_TYPE_HAS_8BIT_PID(type) \
   (!POLL_TYPE_HAS_NO_PID(type) && !POLL_TYPE_HAS_16BIT_PID(type))
+// Read only services, responses may be shared by identical requests:
+#define POLL_TYPE_IS_CACHEABLE(type) \
+  ((type) == VEHICLE_POLL_TYPE_OBDIICURRENT || \
+   (type) == VEHICLE_POLL_TYPE_OBDIIFREEZE || \
+   (type) == VEHICLE_POLL_TYPE_READ_ERDTC || \
+   (type) == VEHICLE_POLL_TYPE_READOBMTEST || \
+   (type) == VEHICLE_POLL_TYPE_READ_DCERDTC || \
+   (type) == VEHICLE_POLL_TYPE_OBDIIVEHICLE || \
+   (type) == VEHICLE_POLL_TYPE_READ_PERMDTC || \
+   (type) == VEHICLE_POLL_TYPE_READDTC || \
+   (type) == VEHICLE_POLL_TYPE_OBDII_1A || \
+   (type) == VEHICLE_POLL_TYPE_OBDIIGROUP || \
+   (type) == VEHICLE_POLL_TYPE_READDATA || \
+   (type) == VEHICLE_POLL_TYPE_READMEMORY || \
+   (type) == VEHICLE_POLL_TYPE_READSCALING)
 
 // OBD/UDS Negative Response Code
 #define UDS_RESP_TYPE_NRC               0x7F  // see ISO 14229 Annex A.1
@@ -75,6 +123,10 @@
 #define POLL_PID_DATA(pid, datastring) \
   {.xargs={ (pid), POLL_TXDATA, sizeof(datastring)-1, reinterpret_cast<const uint8_t*>(datastring) }}
 
+// Poll entry payload is in xargs:
+#define POLL_ENTRY_XARGS(entry) \
+  ((entry).xargs.tag == POLL_TXDATA || (entry).xargs.tag == POLL_TXBATCH)
+
 
 // VWTP_20 channel states:
 typedef enum
@@ -108,6 +160,7 @@ typedef struct
   } vwtp_channel_t;
 
 class OvmsPollers;
+class canpool;
 
 class OvmsPoller : public InternalRamAllocated {
   public:
@@ -133,7 +186,7 @@ class OvmsPoller : public InternalRamAllocated {
           const uint8_t* data;                  // pointer to payload data (single/multi frame request)
           } xargs;
         };
-      uint16_t polltime[VEHICLE_POLL_NSTATES];  // poll intervals in seconds for used poll states
+      uint16_t polltime[VEHICLE_POLL_NSTATES];  // poll intervals in seconds (or PollSetIntervalUnit() units) for used poll states
       uint8_t  pollbus;                         // 0 = default CAN bus from PollSetPidList(), 1…4 = specific
       uint8_t  protocol;                        // ISOTP_STD / ISOTP_EXTADR / ISOTP_EXTFRAME / VWTP_20
       } poll_pid_t;
@@ -164,11 +217,66 @@ class OvmsPoller : public InternalRamAllocated {
     const uint32_t max_ticker = 3600;
     const uint32_t init_ticker = 9999;
 
-    typedef enum : uint8_t { Primary, Secondary, Successful, OnceOff } poller_source_t;
+    typedef enum : uint8_t { Primary, Secondary, Successful, OnceOff, Scheduled, TxPace } poller_source_t;
 
 // Macro for poll_pid_t termination
 #define POLL_LIST_END                   { 0, 0, 0x00, 0x00, { 0, 0, 0 }, 0, 0 }
 
+    // ReadDataByIdentifier batching: response data length per DID
+    typedef struct
+      {
+      uint16_t did;
+      uint16_t length;        // response data length (bytes, without the DID)
+      } poll_did_length_t;
+#define POLL_DID_LENGTH_END             { 0, 0 }
+
+    // ReadDataByIdentifier batching: ECU capability
+    typedef struct
+      {
+      uint32_t txid;
+      uint32_t rxid;
+      uint8_t  max_dids;      // DIDs per request allowed by the ECU
+      bool     disabled;      // ECU rejected a batched request
+      const poll_did_length_t* lengths;
+      uint32_t requests;      // batched requests done
+      uint32_t dids;          // DIDs read by these
+      uint32_t failures;      // failed batched requests
+      } poll_batch_t;
+
+    // Response latency tracking state of a request
+    typedef struct
+      {
+      int64_t  sent;          // esp_timer time of the request, 0 = not tracked
+      bool     first;         // first response frame received
+      } poll_latency_t;
+
+    // ISO-TP flow control parameters and statistics per ECU
+    typedef struct
+      {
+      uint32_t txid;
+      uint8_t  level;         // separation time level (index into isotp_stmin_levels)
+      uint8_t  floor;         // lowest level to use, raised by losses
+      uint8_t  blocksize;     // frames per flow control, 0 = unlimited
+      uint8_t  clean;         // responses without loss since the last change
+      uint32_t responses;     // complete multi frame responses
+      uint32_t losses;        // multi frame responses lost (sequence errors, timeouts)
+      uint32_t frames;        // consecutive frames received
+      uint32_t bytes;         // response bytes received
+      uint64_t time;          // flow control to last frame time [us]
+      } poll_fc_t;
+
+    // ISO-TP flow control state of a multi frame response
+    typedef struct
+      {
+      int64_t  start;         // esp_timer time of the first flow control frame, 0 = none
+      uint32_t txid;          // ECU request ID
+      uint8_t  septime;       // separation time sent
+      uint8_t  blocksize;     // block size sent
+      } poll_fc_rx_t;
+
+    typedef std::function<void(const poll_job_t &job, uint8_t* data, uint8_t length)> batch_packet_fn;
+    typedef std::function<void(const poll_job_t &job, uint16_t code)> batch_error_fn;
+
     // Interface for polls generated from the Vehicle class.
     class VehicleSignal
       {
@@ -179,6 +287,34 @@ class OvmsPoller : public InternalRamAllocated {
         virtual void IncomingPollError(const OvmsPoller::poll_job_t &job, uint16_t code);
         virtual void IncomingPollTxCallback(const OvmsPoller::poll_job_t &job, bool success);
         virtual bool Ready() const = 0;
+
+        // Optional: complete responses, reassembled by the poller (see ResponseBuffer)
+        virtual bool PollReassemble() const { return false; }
+        virtual void IncomingPollResponse(const OvmsPoller::poll_job_t &job, const uint8_t* data, uint16_t length) { }
+      };
+
+    /** Reassembly buffer for complete ISO-TP/VW-TP responses.
+     *  The buffer is taken from a pool by the total response length announced
+     *  in the first frame, so a response is assembled without reallocation.
+     *  Single frame responses are passed through without a copy.
+     */
+    class ResponseBuffer
+      {
+      public:
+        ResponseBuffer() : m_data(nullptr), m_size(0), m_length(0) { }
+        ~ResponseBuffer() { Release(); }
+
+      public:
+        bool Start(uint16_t size);
+        bool Append(const uint8_t* data, uint16_t length);
+        void Release();
+        const uint8_t* Data() const { return m_data; }
+        uint16_t Length() const { return m_length; }
+
+      protected:
+        uint8_t*  m_data;
+        uint16_t  m_size;
+        uint16_t  m_length;
       };
     enum class OvmsNextPollResult
       {
@@ -223,6 +359,9 @@ class OvmsPoller : public InternalRamAllocated {
         /// Send on an imcoming TX reply
         virtual void IncomingTxReply(const OvmsPoller::poll_job_t& job, bool success);
 
+        /// The poller gave up on the response (timeout / abort), drop partial response data.
+        virtual void IncomingAbandoned(const OvmsPoller::poll_job_t& job);
+
         /// Called when run is finished to determine what happens next.
         virtual SeriesStatus FinishRun() = 0;
 
@@ -240,6 +379,25 @@ class OvmsPoller : public InternalRamAllocated {
         /** Return true if this series is ok to run.
          */
         virtual bool Ready() const;
+
+        /** Return the esp_timer time [us] the next deadline scheduled entry is due,
+          or 0 if the series is not deadline scheduled.
+         */
+        virtual int64_t NextDueTime() const;
+
+        /// Output deadline schedule statistics (if any) titled by the series name, optionally reset them.
+        virtual void ScheduleStatus(OvmsWriter* writer, const std::string &name, bool reset);
+
+        /// Return adaptive poll intervals to their base rate, optionally reset the statistics.
+        virtual void AdaptiveReset(bool stats);
+
+        /// Output adaptive poll rates (if any) titled by the series name.
+        virtual void AdaptiveStatus(OvmsWriter* writer, const std::string &name);
+
+        /** Return true if this series serves once-off (interactive) requests.
+          Fair scheduling serves these within the latency target.
+         */
+        virtual bool Interactive() const;
       };
 
     /// Named element in the series double-linked list.
@@ -250,6 +408,15 @@ class OvmsPoller : public InternalRamAllocated {
 
       bool is_blocking;
 
+      // Fair scheduling (see PollSetFairScheduling()):
+      bool interactive;     // Once-off series, served in the interactive turn
+      uint8_t weight;       // Entries per turn
+      bool run_started;     // Got an entry in this run
+      bool run_done;        // Has no more entries in this run
+      int64_t queued;       // Time the interactive series was added [us], 0 = served
+      uint32_t served;      // Entries polled
+      uint32_t starved;     // Primary ticks passed waiting for the first entry of a run
+
       struct poll_series_st *prev, *next;
       } poll_series_t;
 
@@ -264,11 +431,33 @@ class OvmsPoller : public InternalRamAllocated {
         poll_series_t *m_first, *m_last;
         // Current poll entry.
         poll_series_t *m_iter;
+        // Iteration has been resumed at a due deadline series.
+        bool m_resumed;
+
+        // Fair scheduling:
+        int64_t m_fair_latency;       // Latency target for interactive series [us], 0 = insertion order
+        poll_series_t *m_turn;        // Series having the current turn (null = interactive turn / round start)
+        bool m_turn_interactive;      // The interactive turn of this round has been given
+        uint8_t m_turn_left;          // Entries left in the current turn
+        bool m_preempted;             // Last entry was a late interactive one, next goes to the turn
+        bool m_interactive_only;      // Resumed for interactive series after the run finished
+
+        // Interactive series queue wait statistics:
+        uint32_t m_int_served, m_int_late;
+        uint64_t m_int_wait_sum;      // [us]
+        uint32_t m_int_wait_max;      // [us]
 
         // Remove an item out of the linked list.
         void Remove( poll_series_t *iter);
         // Insert an item into the linked list (before == null means the end)
         void InsertBefore( poll_series_t *iter, poll_series_t *before);
+
+        // Account an entry found in the series.
+        void Served( poll_series_t *iter, int64_t now);
+        // Select the series to get the next entry from (fair scheduling).
+        poll_series_t *FairSelect(int64_t now, bool &turn);
+        // Get the next poll entry (fair scheduling).
+        OvmsPoller::OvmsNextPollResult NextFairEntry(poll_pid_t &entry, uint8_t mybus, uint32_t pollticker, uint8_t pollstate);
       public:
         PollSeriesList();
         ~PollSeriesList();
@@ -299,6 +488,9 @@ class OvmsPoller : public InternalRamAllocated {
         /// Send on an imcoming TX reply
         void IncomingTxReply(const OvmsPoller::poll_job_t& job, bool success);
 
+        /// Pass on an abandoned response
+        void IncomingAbandoned(const OvmsPoller::poll_job_t& job);
+
         /// Reset the list to beging processing
         void RestartPoll(ResetMode mode);
 
@@ -308,6 +500,15 @@ class OvmsPoller : public InternalRamAllocated {
         /// Are there any lists that have active entries?
         bool HasPollList() const;
 
+        /// The series of the current entry (may be null).
+        std::shared_ptr<PollSeriesEntry> CurrentSeries() const
+          {
+          return (m_iter != nullptr) ? m_iter->series : nullptr;
+          }
+
+        /// Is the series (still) in the list?
+        bool HasSeries(const PollSeriesEntry* series) const;
+
         /** Return true if the current item is marked as blocking.
         */
         bool PollIsBlocking()
@@ -321,10 +522,60 @@ class OvmsPoller : public InternalRamAllocated {
          */
         bool HasRepeat() const;
 
+        /// Earliest due time of all deadline scheduled series [us], 0 = none.
+        int64_t NextDueTime() const;
+
+        /** Resume the finished iteration at the first deadline series with a due entry.
+          Iteration stops again when that series has no more due entries.
+          @return false if nothing is due.
+         */
+        bool ResumeDue(int64_t now);
+
+        /// Output deadline schedule statistics of all series.
+        void ScheduleStatus(OvmsWriter* writer, bool reset);
+
+        /// Return all adaptive poll intervals to their base rate.
+        void AdaptiveReset(bool stats);
+
+        /// Output adaptive poll rates of all series.
+        void AdaptiveStatus(OvmsWriter* writer);
+
+        /** Enable weighted fair scheduling across the series.
+         * @param latency_ms Latency target for interactive series, 0 = insertion order (default)
+         */
+        void SetFairLatency(uint16_t latency_ms);
+
+        /// Set the entries per turn for the named series, false if not found.
+        bool SetWeight(const std::string &name, uint8_t weight);
+
+        /** Resume the finished iteration for interactive series added since (fair scheduling).
+          Iteration stops again when these are through.
+          @return false if there are none.
+         */
+        bool ResumeInteractive();
+
+        /// Count series still waiting for their first entry of the run at a primary tick.
+        void CountStarved();
+
+        /// Output scheduling statistics of all series.
+        void FairStatus(OvmsWriter* writer);
+
+        /// Reset scheduling statistics.
+        void FairReset();
       };
 
     /** Standard series.
       * The main functionality of processing an array of poll_pid_t based on the pollstate and ticker.
+      *
+      * With an interval unit set (see PollSetIntervalUnit()), the list is instead compiled
+      * into a min-heap of due times (deadline scheduling): polltime values are interpreted
+      * in units of that many milliseconds, entries sharing an interval are spread evenly
+      * over it, and only due entries are looked at. The poller wakes up for the next due
+      * entry independent of the poll ticker.
+      *
+      * In adaptive mode (see PollSetAdaptive()), the intervals of entries with unchanged
+      * responses are stretched up to a max factor, and return to their base rate
+      * on the first change or when the poll state changes.
       */
     class StandardPollSeries : public PollSeriesEntry
       {
@@ -337,6 +588,64 @@ class OvmsPoller : public InternalRamAllocated {
         const poll_pid_t* m_poll_plist; // Head of poll list
         const poll_pid_t* m_poll_plcur; // Poll list loop cursor
 
+        // Deadline scheduling:
+        typedef struct
+          {
+          int64_t   due;          // esp_timer time of next request
+          uint16_t  index;        // poll list index
+          } sched_slot_t;
+        typedef struct
+          {
+          uint32_t  interval;     // requested interval [ms], 0 = not scheduled
+          uint32_t  sent;         // requests sent
+          uint32_t  skipped;      // due times skipped (late by more than an interval)
+          uint32_t  late_max;     // max delay of a request after its due time [ms]
+          int64_t   first;        // esp_timer time of first request
+          int64_t   last;         // esp_timer time of last request
+          } sched_stat_t;
+
+        uint16_t m_interval_unit;   // polltime unit [ms], 0 = ticker scheduling
+        bool m_sched_valid;         // heap compiled for bus & state
+        uint8_t m_sched_bus;
+        uint8_t m_sched_state;
+        std::vector<sched_slot_t> m_sched;        // min-heap by due time
+        std::vector<sched_stat_t> m_sched_stats;  // by poll list index
+
+        static bool SchedDueLater(const sched_slot_t &a, const sched_slot_t &b);
+
+        // ReadDataByIdentifier batching:
+        uint8_t m_batch_data[2*(POLL_BATCH_MAXDIDS-1)]; // Additional DIDs of the current request
+        poll_batch_t m_batch;
+        uint8_t m_batch_cnt;
+        bool m_batch_open;          // Last DID has a known length, more may follow
+
+        bool BatchStart(const poll_pid_t &entry);
+        bool BatchAdd(poll_pid_t &entry, const poll_pid_t &next);
+
+        // Adaptive poll rates:
+        typedef struct
+          {
+          uint32_t  hash;         // hash of the last response
+          uint8_t   factor;       // interval factor, 1 = base rate
+          uint8_t   stable;       // unchanged responses at this factor
+          uint32_t  responses;    // responses received
+          uint32_t  changes;      // responses that differed from the previous one
+          } adapt_t;
+
+        uint8_t m_adapt_max;        // max interval factor, 0 = adaptive mode off
+        uint8_t m_adapt_state;      // poll state the factors apply to
+        uint16_t m_adapt_last;      // poll list index of the last response
+        uint32_t m_adapt_hash;      // hash of the response being received
+        std::vector<adapt_t> m_adapt; // by poll list index
+
+        void AdaptPrepare();
+        uint8_t AdaptFactor(uint16_t index) const;
+        int AdaptFind(const OvmsPoller::poll_job_t& job);
+        void AdaptIncoming(const OvmsPoller::poll_job_t& job, const uint8_t* data, uint8_t length);
+
+        void CompileSchedule(uint8_t mybus, uint8_t pollstate);
+        OvmsPoller::OvmsNextPollResult NextScheduledEntry(poll_pid_t &entry, uint8_t mybus, uint8_t pollstate);
+
       public:
         StandardPollSeries(OvmsPoller *poller, uint16_t stateoffset = 0);
 
@@ -345,6 +654,16 @@ class OvmsPoller : public InternalRamAllocated {
         /// Set the PID list and default bus.
         void PollSetPidList(uint8_t defaultbus, const poll_pid_t* plist);
 
+        /** Set the polltime unit in milliseconds and switch to deadline scheduling,
+          0 = ticker scheduling (default).
+         */
+        void PollSetIntervalUnit(uint16_t unit_ms);
+
+        /** Set the max factor adaptive mode may stretch polltime intervals by,
+          0 = adaptive mode off (default).
+         */
+        void PollSetAdaptive(uint8_t max_factor);
+
         // Move list to start.
         void ResetList(ResetMode mode) override;
 
@@ -365,6 +684,14 @@ class OvmsPoller : public InternalRamAllocated {
         bool HasPollList() const override;
 
         bool HasRepeat() const override;
+
+        int64_t NextDueTime() const override;
+
+        void ScheduleStatus(OvmsWriter* writer, const std::string &name, bool reset) override;
+
+        void AdaptiveReset(bool stats) override;
+
+        void AdaptiveStatus(OvmsWriter* writer, const std::string &name) override;
       };
 
     // Standard Vehicle Poll series passing through various responses.
@@ -372,6 +699,7 @@ class OvmsPoller : public InternalRamAllocated {
       {
       private:
         VehicleSignal *m_signal;
+        ResponseBuffer m_rxbuf;
       public:
         StandardVehiclePollSeries(OvmsPoller *poller, VehicleSignal *signal, uint16_t stateoffset = 0);
 
@@ -384,6 +712,9 @@ class OvmsPoller : public InternalRamAllocated {
         // Send on an imcoming TX reply
         void IncomingTxReply(const OvmsPoller::poll_job_t& job, bool success) override;
 
+        // Release a partial response
+        void IncomingAbandoned(const OvmsPoller::poll_job_t& job) override;
+
         // Return true if this series is ok to run.
         bool Ready() const override;
       };
@@ -439,6 +770,8 @@ class OvmsPoller : public InternalRamAllocated {
         int         *m_poll_rxerr;    // … response error code (NRC) / TX failure code
         uint8_t     m_retry_fail;
         CAN_frame_format_t m_format;
+        OvmsPoller  *m_poller;
+        uint32_t    m_max_age;        // … accept a cached response up to this age [ms], 0 = never
 
         // Called when the one-off is finished (for semaphore etc).
         // Called with NULL bus when on Removing
@@ -455,6 +788,9 @@ class OvmsPoller : public InternalRamAllocated {
 
         void SetParentPoller(OvmsPoller *poller) override;
 
+        // Satisfy the request from the response cache if possible.
+        void SetMaxAge(uint32_t max_age_ms);
+
         // Find the next poll entry.
         OvmsPoller::OvmsNextPollResult NextPollEntry(poll_pid_t &entry,  uint8_t mybus, uint32_t pollticker, uint8_t pollstate) override;
 
@@ -467,6 +803,8 @@ class OvmsPoller : public InternalRamAllocated {
         bool HasPollList() const override;
 
         bool HasRepeat() const override;
+
+        bool Interactive() const override;
       };
 
   private:
@@ -492,6 +830,12 @@ class OvmsPoller : public InternalRamAllocated {
 
         void Removing() override;
       };
+
+    // Pool for the BlockingOnceOffPoll jobs (incl. shared_ptr control block):
+    static canpool s_jobpool;
+  public:
+    // Pools for the response reassembly buffers:
+    static canpool s_rxpool_small, s_rxpool_large;
   public:
    /** Once off poll entry with buffer and asynchronous result call-backs.
     */
@@ -530,6 +874,11 @@ class OvmsPoller : public InternalRamAllocated {
 
     const int         max_poll_repeat = 5; // Maximum # of poll-repeats.
     uint32_t          m_poll_sent_last;
+    uint16_t          m_poll_interval_unit;   // Deadline scheduling polltime unit [ms] for PollSetPidList(), 0 = off
+    uint8_t           m_poll_adaptive;        // Adaptive max interval factor for PollSetPidList(), 0 = off
+    poll_latency_t    m_poll_latency;         // Latency tracking of the m_poll request
+    esp_timer_handle_t m_sched_timer;         // Wakeup for deadline scheduled entries
+    poll_fc_rx_t      m_poll_fc_rx;           // Flow control state of the m_poll response
 
   protected:
     poll_job_t        m_poll;
@@ -537,6 +886,13 @@ class OvmsPoller : public InternalRamAllocated {
     uint16_t          m_poll_tx_remain;       // Payload bytes remaining for multi frame request
     uint16_t          m_poll_tx_offset;       // Payload offset of multi frame request
     uint16_t          m_poll_tx_frame;        // Frame number for multi frame request
+    uint32_t          m_poll_tx_txid;         // Request ID for consecutive frames
+    uint8_t           m_poll_tx_blockcnt;     // Frames remaining in the block, 0 = unlimited
+    uint32_t          m_poll_tx_septime;      // Separation time [us] between consecutive frames
+    int64_t           m_poll_tx_due;          // esp_timer time the next consecutive frame is due
+    bool              m_poll_tx_paced;        // Next consecutive frame is sent by m_tx_timer
+    uint32_t          m_poll_tx_aborts;       // Multi frame requests aborted on TX failure
+    esp_timer_handle_t m_tx_timer;            // Consecutive frame pacing
     uint8_t           m_poll_wait;            // Wait counter for a reply from a sent poll or bytes remaining.
                                               // Gets set = 2 when a poll is sent OR when bytes are remaining after receiving.
                                               // Gets set = 0 when a poll is received.
@@ -555,6 +911,8 @@ class OvmsPoller : public InternalRamAllocated {
     uint8_t           m_poll_sequence_max;    // Polls allowed to be sent in sequence per time tick (second), default 1, 0 = no limit
     uint8_t           m_poll_sequence_cnt;    // Polls already sent in the current time tick (second)
     uint8_t           m_poll_fc_septime;      // Flow control separation time for multi frame responses
+    bool              m_poll_fc_adaptive;     // Learn flow control parameters per ECU
+    std::vector<poll_fc_t> m_fc;              // Flow control per ECU, under m_poll_mutex
     uint16_t          m_poll_ch_keepalive;    // Seconds to keep an inactive channel (e.g. VWTP) alive (default: 60)
     uint16_t          m_poll_between_success;
     bool              m_poll_ticked;
@@ -563,9 +921,95 @@ class OvmsPoller : public InternalRamAllocated {
   private:
     mutable OvmsRecMutex m_poll_single_mutex;    // PollSingleRequest() concurrency protection
 
+    // Once-off response cache & request coalescing:
+    typedef struct
+      {
+      uint32_t          txid;
+      uint32_t          rxid;
+      uint8_t           protocol;
+      CAN_frame_format_t format;
+      int64_t           time;                 // esp_timer time of the response
+      std::string       request;              // Type + PID + payload
+      std::string       response;
+      } poll_cache_t;
+    typedef struct
+      {
+      uint32_t          txid;
+      uint32_t          rxid;
+      uint8_t           protocol;
+      std::string       request;
+      std::string       response;
+      int               result;
+      OvmsSemaphore     rxdone;               // Given when done, passed on by every waiter
+      } poll_inflight_t;
+    OvmsMutex         m_cache_mutex;          // Protects the following, never held while taking m_poll_mutex
+    std::vector<poll_cache_t> m_cache;        // Most recent responses, max POLL_CACHE_SIZE
+    std::vector<std::shared_ptr<poll_inflight_t>> m_inflight; // PollSingleRequest() calls in progress
+    uint32_t          m_cache_hits;           // Statistics…
+    uint32_t          m_cache_coalesced;
+    uint32_t          m_cache_misses;
+
+    int PollSingleTransfer(uint32_t txid, uint32_t rxid, const std::string &request,
+                      std::string& response, int timeout_ms, uint8_t protocol);
+    static std::string PollRequestData(const poll_pid_t &entry);
+    bool PollCacheFind(uint32_t txid, uint32_t rxid, uint8_t protocol, const std::string &request,
+                      int64_t since, std::string &response, CAN_frame_format_t *format = nullptr);
+    void PollCacheStore(const poll_pid_t &entry, CAN_frame_format_t format, const std::string &response);
+    void PollCacheInvalidate(uint32_t txid, uint32_t rxid);
+
   protected:
     vwtp_channel_t    m_poll_vwtp;            // VWTP channel state
 
+    // VWTP channel pool: idle channels to other modules kept open
+    typedef struct
+      {
+      vwtp_channel_t    channel;
+      uint8_t           testmiss;             // Channel tests sent without response
+      } vwtp_pooled_t;
+    vwtp_pooled_t     m_vwtp_pool[POLL_VWTP_MAXPOOL]; // under m_poll_mutex
+    uint8_t           m_vwtp_pool_size;       // Configured pool size, 0 = single channel (default)
+    uint8_t           m_vwtp_pool_limit;      // Pool size accepted by the gateway
+    uint32_t          m_vwtp_pool_tested;     // monotonictime of the last channel tests
+    int64_t           m_vwtp_setup_start;     // esp_timer time of the current channel setup
+    int64_t           m_vwtp_setup_time;      // Statistics…
+    uint32_t          m_vwtp_setups;
+    uint32_t          m_vwtp_switches;
+    uint32_t          m_vwtp_reuses;
+    uint32_t          m_vwtp_evictions;
+    uint32_t          m_vwtp_lost;
+    uint32_t          m_vwtp_refused;
+
+    // Pipelined ISO-TP requests: one slot per ECU in flight
+    typedef struct
+      {
+      bool              busy;
+      poll_job_t        job;                  // Request job state (copy of m_poll on start)
+      std::shared_ptr<PollSeriesEntry> series; // Series the request was taken from
+      uint32_t          txmsgid;              // Request frame MsgID
+      int64_t           deadline;             // esp_timer response timeout
+      ResponseBuffer    frames;               // Raw multi frame response, 8 bytes per frame
+      uint8_t           batch[2*(POLL_BATCH_MAXDIDS-1)]; // Additional DIDs of a batched request
+      poll_latency_t    latency;
+      poll_fc_rx_t      fc;                   // Flow control state of the response
+      } poll_slot_t;
+    typedef struct
+      {
+      poll_pid_t        entry;
+      std::shared_ptr<PollSeriesEntry> series;
+      bool              legacy;               // Needs the non-pipelined request path
+      uint8_t           batch[2*(POLL_BATCH_MAXDIDS-1)]; // Additional DIDs of a batched request
+      } poll_parked_t;
+
+    poll_slot_t       m_slots[POLLER_MAXSLOTS];
+    poll_parked_t     m_parked[POLLER_MAXSLOTS]; // Entries waiting for their ECU to become free
+    uint8_t           m_parked_cnt;
+    uint8_t           m_slots_busy;
+    uint8_t           m_poll_concurrency;     // Max concurrent requests, 1 = no pipelining (default)
+    uint8_t           m_slots_peak;           // Statistics…
+    uint32_t          m_slots_started;
+    uint32_t          m_slots_parked;
+    uint32_t          m_slots_timeouts;
+
   protected:
 
     // Signals for vehicle
@@ -583,15 +1027,57 @@ class OvmsPoller : public InternalRamAllocated {
 
     void PollerISOTPStart(bool fromTicker);
     bool PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid);
+    uint16_t PollerISOTPRequestFrame(poll_job_t &job, CAN_frame_t &txframe);
+
+    bool PollerSlotEligible(const poll_pid_t &entry) const;
+    int  PollerSlotFind(uint32_t txid, uint32_t rxid) const;
+    bool PollerSlotStart(const poll_pid_t &entry, const std::shared_ptr<PollSeriesEntry> &series);
+    void PollerSlotRelease(poll_slot_t &slot);
+    void PollerSlotExpire();
+    bool PollerSlotRunParked();
+    void PollerParkedRemove(int index);
+    void PollerSlotsClear();
+    bool PollerSlotIncoming(CAN_frame_t &frame);
+    bool PollerSlotOutgoing(const CAN_frame_t &frame, bool success);
+    bool PollerISOTPSlotReceive(poll_slot_t &slot, CAN_frame_t* frame, uint32_t msgid);
+    void PollerISOTPSlotDeliver(poll_slot_t &slot, uint8_t* data, uint16_t length);
+    void PollerISOTPSlotReplay(poll_slot_t &slot);
+
+    // ISO-TP flow control:
+    static uint32_t ISOTPSepTime(uint8_t septime);
+    poll_fc_t &PollerFlowControlFind(uint32_t txid);
+    void PollerISOTPFlowControl(const poll_job_t &job, uint32_t txid, poll_fc_rx_t &fc);
+    void PollerISOTPFlowResult(poll_fc_rx_t &fc, bool loss, uint16_t frames = 0, uint16_t bytes = 0);
+    void PollerISOTPTxBlock();
+    static void TxTimerCallback(void* arg);
+
+    // ReadDataByIdentifier batching:
+    uint8_t           m_poll_batch[2*(POLL_BATCH_MAXDIDS-1)]; // Additional DIDs of a batched m_poll request
+    ResponseBuffer    m_batch_rx;             // Batched response collection
+    static void PollerBatchKeep(poll_pid_t &entry, uint8_t* buffer);
+    void PollerBatchIncoming(const poll_job_t &job, uint8_t* data, uint16_t length, const batch_packet_fn &packet);
+    bool PollerBatchSplit(const poll_job_t &job, const uint8_t* data, uint16_t length, const batch_packet_fn &packet);
+    void PollerBatchError(const poll_job_t &job, uint16_t code, const batch_error_fn &error);
 
     void PollerVWTPStart(bool fromTicker);
     bool PollerVWTPReceive(CAN_frame_t* frame, uint32_t msgid);
     void PollerVWTPEnter(vwtp_channelstate_t state);
     void PollerVWTPTicker();
     void PollerVWTPTxCallback(const CAN_frame_t* frame, bool success);
+    uint16_t PollerVWTPOfferID();
+    void PollerVWTPPoolPark();
+    bool PollerVWTPPoolFetch();
+    bool PollerVWTPPoolReceive(CAN_frame_t &frame);
+    void PollerVWTPPoolClose(vwtp_pooled_t &slot);
+    void PollerVWTPPoolCloseAll();
+    void PollerVWTPPoolRefused();
+    void PollerVWTPPoolTicker();
 
     static void DoPollerSendSuccess( void * pvParameter1, uint32_t ulParameter2 );
 
+    void PollerScheduleWake();
+    static void SchedTimerCallback(void* arg);
+
   public:
     bool HasBus(canbus* bus) const { return bus == m_poll.bus;}
     uint8_t CanBusNo() const { return m_poll.bus_no;}
@@ -628,7 +1114,14 @@ class OvmsPoller : public InternalRamAllocated {
       Keepalive,
       SuccessSep,
       Shutdown,
-      ResetTimer
+      ResetTimer,
+      IntervalUnit,
+      Concurrency,
+      Adaptive,
+      AdaptiveReset,
+      FlowControl,
+      ChannelPool,
+      FairSchedule
       };
     typedef struct {
         CAN_frame_t frame;
@@ -680,16 +1173,35 @@ class OvmsPoller : public InternalRamAllocated {
     void PollSetResponseSeparationTime(uint8_t septime);
     void PollSetChannelKeepalive(uint16_t keepalive_seconds);
     void PollSetTimeBetweenSuccess(uint16_t time_between_ms);
+    void PollSetIntervalUnit(uint16_t unit_ms);
+    void PollSetConcurrency(uint8_t max_requests);
+    void PollSetAdaptive(uint8_t max_factor);
+    void PollSetFlowControlAdaptive(bool adaptive);
+    void PollSetChannelPool(uint8_t channels);
+    void PollSetFairScheduling(uint16_t latency_ms);
+    bool PollSetSeriesWeight(const std::string &name, uint8_t weight);
+
+    void ScheduleStatus(OvmsWriter* writer, bool reset);
+    void AdaptiveReset(bool stats);
+    void AdaptiveStatus(OvmsWriter* writer);
+    void FlowControlStatus(OvmsWriter* writer);
+    void FlowControlReset();
+    void ChannelPoolStatus(OvmsWriter* writer);
+    void ChannelPoolReset();
+    void FairStatus(OvmsWriter* writer);
+    void FairReset();
 
     // TODO - Work out how to make sure these are protected. Reduce/eliminate mutex time.
     void PollSetPidList(uint8_t defaultbus, const poll_pid_t* plist, VehicleSignal *signal);
 
     int PollSingleRequest(uint32_t txid, uint32_t rxid,
                       std::string request, std::string& response,
-                      int timeout_ms=3000, uint8_t protocol=ISOTP_STD);
+                      int timeout_ms=3000, uint8_t protocol=ISOTP_STD, int max_age_ms=0);
     int PollSingleRequest(uint32_t txid, uint32_t rxid,
                       uint8_t polltype, uint16_t pid, std::string& response,
-                      int timeout_ms=3000, uint8_t protocol=ISOTP_STD);
+                      int timeout_ms=3000, uint8_t protocol=ISOTP_STD, int max_age_ms=0);
+    void PollCacheStatus(OvmsWriter* writer);
+    void PollCacheClear(bool stats);
 
     bool PollRequest(const std::string &name, const std::shared_ptr<PollSeriesEntry> &series, int timeout_ms = 5000);
     void RemovePollRequest(const std::string &name);
@@ -719,6 +1231,12 @@ class OvmsPollers : public InternalRamAllocated {
     uint8_t           m_poll_fc_septime;      // Flow control separation time for multi frame responses
     uint16_t          m_poll_ch_keepalive;    // Seconds to keep an inactive channel (e.g. VWTP) alive (default: 60)
     uint16_t          m_poll_between_success;
+    uint16_t          m_poll_interval_unit;   // Deadline scheduling polltime unit [ms], 0 = off
+    uint8_t           m_poll_concurrency;     // Max concurrent ISO-TP requests per bus
+    uint8_t           m_poll_adaptive;        // Adaptive max interval factor, 0 = off
+    bool              m_poll_fc_adaptive;     // Learn ISO-TP flow control per ECU
+    uint8_t           m_poll_ch_pool;         // VWTP channels kept open per bus besides the active one
+    uint16_t          m_poll_fair_latency;    // Fair series scheduling latency target [ms], 0 = off
     uint32_t          m_poll_last;
 
     _Alignas(32 / CHAR_BIT)
@@ -735,7 +1253,7 @@ class OvmsPollers : public InternalRamAllocated {
     bool              m_ready;
     bool              m_paused;
     bool              m_user_paused;
-    typedef enum {trace_Off = 0x00, trace_Poller = 0x1, trace_TXRX = 0x2, trace_Times = 0x4, trace_All= 0x3} tracetype_t;
+    typedef enum {trace_Off = 0x00, trace_Poller = 0x1, trace_TXRX = 0x2, trace_Times = 0x4, trace_Latency = 0x8, trace_All= 0x3} tracetype_t;
     uint8_t           m_trace;                // Current Trace flags.
     uint32_t          m_overflow_count[2];    // Keep track of overflows.
                                               //
@@ -743,6 +1261,19 @@ class OvmsPollers : public InternalRamAllocated {
     canfilter         m_filter;
     bool              m_filtered;
 
+  public:
+    // RX frame pipeline stages (see PollerTask):
+    typedef enum {pipe_Poller = 0, pipe_Listeners, pipe_Vehicle, pipe_Count} pipeline_stage_t;
+    typedef std::function<void(CAN_frame_t*)> FrameStage;
+  private:
+    typedef struct {
+      uint32_t frames;
+      uint32_t time_max;                      // [us]
+      uint64_t time_sum;
+    } pipeline_stats_t;
+    FrameStage        m_framestage;           // Vehicle stage, called in place
+    pipeline_stats_t  m_pipeline[pipe_Count];
+
     void PollerTxCallback(const CAN_frame_t* frame, bool success);
     void PollerRxCallback(const CAN_frame_t* frame, bool success);
 
@@ -757,6 +1288,17 @@ class OvmsPollers : public InternalRamAllocated {
     static void vehicle_pause_off(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
     static void vehicle_poller_trace(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
     static void poller_times(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void poller_pipeline(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void poller_schedule(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void poller_batch(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void poller_adaptive(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void poller_latency(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void poller_isotp(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void poller_isotp_bench(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void poller_cache(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void poller_cache_test(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void poller_vwtp(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
+    static void poller_series(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv);
 
 #ifdef CONFIG_OVMS_SC_JAVASCRIPT_DUKTAPE
     // OvmsPoller Object
@@ -803,6 +1345,7 @@ class OvmsPollers : public InternalRamAllocated {
   public:
     bool PollerTimesTrace( OvmsWriter* writer);
     bool IsTracingTimes() const { return (m_trace & trace_Times) != 0; }
+    bool IsTracingLatency() const { return (m_trace & trace_Latency) != 0; }
     typedef std::function<void(canbus*, void *)> PollCallback;
     typedef std::function<void(const CAN_frame_t &)> FrameCallback;
 
@@ -875,6 +1418,17 @@ class OvmsPollers : public InternalRamAllocated {
       CheckStartPollTask(true);
     }
     void DeregisterFrameRx(const std::string &name) { m_framerx_callback.Deregister(name);}
+
+    // Single vehicle stage of the RX pipeline, gets the poller queue frame in place:
+    void SetFrameStage(FrameStage fn) {
+      m_framestage = fn;
+      if (fn)
+        CheckStartPollTask(true);
+    }
+    bool HasFrameStage() const { return (bool)m_framestage; }
+    void AddPipelineTime(pipeline_stage_t stage, uint32_t time_us);
+    void PipelineStatus(OvmsWriter* writer);
+    void PipelineReset();
   private:
     void PollRunFinished(canbus *bus)
       {
@@ -892,16 +1446,17 @@ class OvmsPollers : public InternalRamAllocated {
           cb(bus, nullptr);
           });
       }
-    void PollerFrameRx(CAN_frame_t &frame)
+    void PollerFrameRx(const CAN_frame_t &frame)
       {
       m_framerx_callback.Call(
-        [frame](const std::string &name, FrameCallback cb)
+        [&frame](const std::string &name, const FrameCallback &cb)
           {
           cb(frame);
           });
       }
 
     void Ticker1(std::string event, void* data);
+    void Ticker10(std::string event, void* data);
     void Ticker1_Shutdown(std::string event, void* data);
     void EventSystemShuttingDown(std::string event, void* data);
     void ConfigChanged(std::string event, void* data);
@@ -934,6 +1489,8 @@ class OvmsPollers : public InternalRamAllocated {
 
     void PollRemove(canbus* defbus, const std::string &name);
 
+    void PollSetSeriesWeight(canbus* defbus, const std::string &name, uint8_t weight);
+
     bool HasPollList(canbus* bus = nullptr);
 
     void CheckStartPollTask( bool force = false);
@@ -954,6 +1511,86 @@ class OvmsPollers : public InternalRamAllocated {
       {
       Queue_Command(OvmsPoller::OvmsPollCommand::SuccessSep, time_between_ms);
       }
+    void PollSetIntervalUnit(uint16_t unit_ms)
+      {
+      Queue_Command(OvmsPoller::OvmsPollCommand::IntervalUnit, unit_ms);
+      }
+    void PollSetConcurrency(uint8_t max_requests)
+      {
+      Queue_Command(OvmsPoller::OvmsPollCommand::Concurrency, max_requests);
+      }
+    void PollSetAdaptive(uint8_t max_factor)
+      {
+      Queue_Command(OvmsPoller::OvmsPollCommand::Adaptive, max_factor);
+      }
+    void PollSetFlowControlAdaptive(bool adaptive)
+      {
+      Queue_Command(OvmsPoller::OvmsPollCommand::FlowControl, adaptive);
+      }
+    void PollSetChannelPool(uint8_t channels)
+      {
+      Queue_Command(OvmsPoller::OvmsPollCommand::ChannelPool, channels);
+      }
+    void PollSetFairScheduling(uint16_t latency_ms)
+      {
+      Queue_Command(OvmsPoller::OvmsPollCommand::FairSchedule, latency_ms);
+      }
+
+    // ReadDataByIdentifier batching:
+  private:
+    std::vector<OvmsPoller::poll_batch_t> m_batch;
+    mutable OvmsMutex m_batch_mutex;
+  public:
+    void PollSetBatch(uint32_t txid, uint32_t rxid, uint8_t max_dids, const OvmsPoller::poll_did_length_t* lengths);
+    bool GetBatch(uint32_t txid, uint32_t rxid, OvmsPoller::poll_batch_t &batch) const;
+    void BatchResult(uint32_t txid, uint32_t rxid, uint8_t dids, bool failed);
+    static int BatchLength(const OvmsPoller::poll_batch_t &batch, uint16_t did);
+    void BatchStatus(OvmsWriter* writer);
+    void BatchReset();
+
+    // Response latency statistics per bus, ECU, type & PID:
+  private:
+    typedef struct
+      {
+      uint32_t requests;
+      uint32_t responses;     // complete positive responses
+      uint32_t errors;        // negative responses
+      uint32_t timeouts;
+      uint8_t  nrc_last;      // last negative response code
+      uint32_t bytes_tx;      // request payload bytes
+      uint32_t bytes_rx;      // response payload bytes
+      uint32_t max_first;     // max request to first frame time [us]
+      uint32_t max_done;      // max request to complete response time [us]
+      uint32_t first[POLL_LATENCY_BUCKETS]; // request to first frame histogram
+      uint32_t done[POLL_LATENCY_BUCKETS];  // request to complete response histogram
+      } latency_stat_t;
+    typedef struct
+      {
+      OvmsMetricFloat* p50;
+      OvmsMetricFloat* p95;
+      OvmsMetricFloat* p99;
+      OvmsMetricInt*   timeouts;
+      OvmsMetricInt*   errors;
+      } latency_metrics_t;
+    static const uint32_t latency_bounds[POLL_LATENCY_BUCKETS-1];
+    std::map<uint64_t, latency_stat_t> m_latency;   // by LatencyKey()
+    OvmsMutex m_latency_mutex;
+    latency_metrics_t m_latency_metrics[VEHICLE_MAXBUSSES];
+
+    static uint64_t LatencyKey(const OvmsPoller::poll_job_t &job);
+    static uint8_t LatencyBucket(uint32_t time_us);
+    static float LatencyPercentile(const uint32_t* hist, uint32_t max_us, float p);
+    latency_stat_t &LatencyStat(const OvmsPoller::poll_job_t &job);
+    void LatencyMetrics();
+  public:
+    void LatencyStart(const OvmsPoller::poll_job_t &job, OvmsPoller::poll_latency_t &lat, uint16_t bytes);
+    void LatencyFirst(const OvmsPoller::poll_job_t &job, OvmsPoller::poll_latency_t &lat);
+    void LatencyDone(const OvmsPoller::poll_job_t &job, OvmsPoller::poll_latency_t &lat, uint16_t bytes);
+    void LatencyError(const OvmsPoller::poll_job_t &job, OvmsPoller::poll_latency_t &lat, uint8_t code);
+    void LatencyTimeout(const OvmsPoller::poll_job_t &job, OvmsPoller::poll_latency_t &lat);
+    void LatencyStatus(OvmsWriter* writer, bool json);
+    void LatencyReset();
+
     // signal poller
     void PollerResetThrottle();
 
@@ -38,30 +38,62 @@ static const char *TAG = "vehicle-isotp";
 
 
 /**
- * PollerISOTPStart: start ISO-TP request
+ * ISOTPResponseHeader: split the TP data of a single/first response frame
+ *  into the OBD/UDS response type & PID (or error type & code) and the payload
  */
-void OvmsPoller::PollerISOTPStart(bool fromTicker)
+static void ISOTPResponseHeader(uint8_t* tp_data, uint8_t tp_datalen, uint16_t request_pid,
+  uint8_t &response_type, uint16_t &response_pid, uint8_t* &response_data, uint16_t &response_datalen,
+  uint8_t &error_type, uint8_t &error_code)
   {
-  if (m_poll.entry.rxmoduleid != 0)
+  response_type = tp_data[0];
+  if (response_type == UDS_RESP_TYPE_NRC)
+    {
+    error_type = tp_data[1];
+    error_code = tp_data[2];
+    }
+  else if (POLL_TYPE_HAS_16BIT_PID(response_type-0x40))
+    {
+    response_pid = tp_data[1] << 8 | tp_data[2];
+    response_data = &tp_data[3];
+    response_datalen = tp_datalen - 3;
+    }
+  else if (POLL_TYPE_HAS_8BIT_PID(response_type-0x40))
+    {
+    response_pid = tp_data[1];
+    response_data = &tp_data[2];
+    response_datalen = tp_datalen - 2;
+    }
+  else
+    {
+    response_pid = request_pid;
+    response_data = &tp_data[1];
+    response_datalen = tp_datalen - 1;
+    }
+  }
+
+
+/**
+ * PollerISOTPRequestFrame: set up the job's module IDs and assemble the
+ *  ISO-TP single/first frame of its request
+ *  @return payload bytes sent with this frame
+ */
+uint16_t OvmsPoller::PollerISOTPRequestFrame(poll_job_t &job, CAN_frame_t &txframe)
+  {
+  if (job.entry.rxmoduleid != 0)
     {
     // send to <moduleid>, listen to response from <rmoduleid>:
-    m_poll.moduleid_sent = m_poll.entry.txmoduleid;
-    m_poll.moduleid_low = m_poll.entry.rxmoduleid;
-    m_poll.moduleid_high = m_poll.entry.rxmoduleid;
+    job.moduleid_sent = job.entry.txmoduleid;
+    job.moduleid_low = job.entry.rxmoduleid;
+    job.moduleid_high = job.entry.rxmoduleid;
     }
   else
     {
     // broadcast: send to 0x7df, listen to all responses:
-    m_poll.moduleid_sent = 0x7df;
-    m_poll.moduleid_low = 0x7e8;
-    m_poll.moduleid_high = 0x7ef;
+    job.moduleid_sent = 0x7df;
+    job.moduleid_low = 0x7e8;
+    job.moduleid_high = 0x7ef;
     }
 
-  ESP_LOGD(TAG, "[%" PRIu8 "]PollerISOTPStart(%s): send [bus=%" PRIu8 ", type=%02" PRIX16 ", pid=%X], expecting %03" PRIx32 "/%03" PRIx32 "-%03" PRIx32 "",
-           m_poll.bus_no, fromTicker ? "Yes" : "No",
-           m_poll.entry.pollbus, m_poll.type, m_poll.pid, m_poll.moduleid_sent,
-           m_poll.moduleid_low, m_poll.moduleid_high);
-
   //
   // Assemble ISO-TP single/first frame
   //
@@ -76,46 +108,46 @@ void OvmsPoller::PollerISOTPStart(bool fromTicker)
   uint16_t tx_datalen;            // Payload data length
   uint16_t tx_datasent;           // Payload data length sent with this frame
 
-  if (m_poll.entry.xargs.tag == POLL_TXDATA)
+  if (POLL_ENTRY_XARGS(job.entry))
     {
-    tx_data = m_poll.entry.xargs.data;
-    tx_datalen = m_poll.entry.xargs.datalen;
+    tx_data = job.entry.xargs.data;
+    tx_datalen = job.entry.xargs.datalen;
     }
   else
     {
-    tx_data = m_poll.entry.args.data;
-    tx_datalen = m_poll.entry.args.datalen;
+    tx_data = job.entry.args.data;
+    tx_datalen = job.entry.args.datalen;
     }
 
-  CAN_frame_t txframe = {};
-  txframe.origin = m_poll.bus;
+  txframe = {};
+  txframe.origin = job.bus;
   txframe.callback = &m_poll_txcallback;
   txframe.FIR.B.DLC = 8;
   std::fill_n(txframe.data.u8, sizeof_array(txframe.data.u8), 0x55);
 
-  if (m_poll.protocol == ISOTP_EXTFRAME)
+  if (job.protocol == ISOTP_EXTFRAME)
     txframe.FIR.B.FF = CAN_frame_ext;
   else
     txframe.FIR.B.FF = CAN_frame_std;
 
-  if (m_poll.protocol == ISOTP_EXTADR)
+  if (job.protocol == ISOTP_EXTADR)
     {
-    txframe.MsgID = m_poll.moduleid_sent >> 8;
-    txframe.data.u8[0] = m_poll.moduleid_sent & 0xff;
+    txframe.MsgID = job.moduleid_sent >> 8;
+    txframe.data.u8[0] = job.moduleid_sent & 0xff;
     fr_data = &txframe.data.u8[1];
     fr_maxlen = 7;
     }
   else
     {
-    txframe.MsgID = m_poll.moduleid_sent;
+    txframe.MsgID = job.moduleid_sent;
     fr_data = &txframe.data.u8[0];
     fr_maxlen = 8;
     }
 
   // Do we need to split this request into multiple frames?
-  if (POLL_TYPE_HAS_16BIT_PID(m_poll.entry.type))
+  if (POLL_TYPE_HAS_16BIT_PID(job.entry.type))
     tp_len = 3 + tx_datalen;
-  else if (POLL_TYPE_HAS_8BIT_PID(m_poll.entry.type))
+  else if (POLL_TYPE_HAS_8BIT_PID(job.entry.type))
     tp_len = 2 + tx_datalen;
   else
     tp_len = 1 + tx_datalen;
@@ -135,39 +167,67 @@ void OvmsPoller::PollerISOTPStart(bool fromTicker)
     }
 
   // Add TP data:
-  if (POLL_TYPE_HAS_16BIT_PID(m_poll.entry.type))
+  if (POLL_TYPE_HAS_16BIT_PID(job.entry.type))
     {
-    tp_data[0] = m_poll.type;
-    tp_data[1] = m_poll.pid >> 8;
-    tp_data[2] = m_poll.pid & 0xff;
+    tp_data[0] = job.type;
+    tp_data[1] = job.pid >> 8;
+    tp_data[2] = job.pid & 0xff;
     tx_datasent = LIMIT_MAX(tx_datalen, tp_datalen - 3);
     memcpy(&tp_data[3], tx_data, tx_datasent);
     }
-  else if (POLL_TYPE_HAS_8BIT_PID(m_poll.entry.type))
+  else if (POLL_TYPE_HAS_8BIT_PID(job.entry.type))
     {
-    tp_data[0] = m_poll.type;
-    tp_data[1] = m_poll.pid;
+    tp_data[0] = job.type;
+    tp_data[1] = job.pid;
     tx_datasent = LIMIT_MAX(tx_datalen, tp_datalen - 2);
     memcpy(&tp_data[2], tx_data, tx_datasent);
     }
   else
     {
-    tp_data[0] = m_poll.type;
+    tp_data[0] = job.type;
     tx_datasent = LIMIT_MAX(tx_datalen, tp_datalen - 1);
     memcpy(&tp_data[1], tx_data, tx_datasent);
     }
 
+  return tx_datasent;
+  }
+
+
+/**
+ * PollerISOTPStart: start ISO-TP request
+ */
+void OvmsPoller::PollerISOTPStart(bool fromTicker)
+  {
+  CAN_frame_t txframe;
+  uint16_t tx_datasent = PollerISOTPRequestFrame(m_poll, txframe);
+
+  ESP_LOGD(TAG, "[%" PRIu8 "]PollerISOTPStart(%s): send [bus=%" PRIu8 ", type=%02" PRIX16 ", pid=%X], expecting %03" PRIx32 "/%03" PRIx32 "-%03" PRIx32 "",
+           m_poll.bus_no, fromTicker ? "Yes" : "No",
+           m_poll.entry.pollbus, m_poll.type, m_poll.pid, m_poll.moduleid_sent,
+           m_poll.moduleid_low, m_poll.moduleid_high);
+
   m_poll_txmsgid = txframe.MsgID;
   m_poll_tx_frame = 0;
-  m_poll_tx_data = tx_data;
+  m_poll_tx_paced = false;
+  m_poll_fc_rx.start = 0;
+  if (POLL_ENTRY_XARGS(m_poll.entry))
+    {
+    m_poll_tx_data = m_poll.entry.xargs.data;
+    m_poll_tx_remain = m_poll.entry.xargs.datalen - tx_datasent;
+    }
+  else
+    {
+    m_poll_tx_data = m_poll.entry.args.data;
+    m_poll_tx_remain = m_poll.entry.args.datalen - tx_datasent;
+    }
   m_poll_tx_offset = tx_datasent;
-  m_poll_tx_remain = tx_datalen - tx_datasent;
   m_poll.mlframe = 0;
   m_poll.mloffset = 0;
   m_poll.mlremain = 0;
   m_poll_wait = 2;
+  MyPollers.LatencyStart(m_poll, m_poll_latency, m_poll_tx_offset + m_poll_tx_remain);
 
-  m_poll.bus->Write(&txframe);
+  m_poll.bus->WritePriority(&txframe, CAN_TXPRIO_POLLER);
   }
 
 
@@ -283,74 +343,21 @@ bool OvmsPoller::PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid)
     else
       {
       // continue TX:
-      CAN_frame_t tx_frame = {};
-      uint8_t* tx_data;
-      uint8_t tx_datalen;
-      uint8_t tx_datasent;
-      uint32_t txid;
-      tx_frame.origin = frame->origin;
-      tx_frame.FIR.B.DLC = 8;
-
-      if (m_poll.protocol == ISOTP_EXTFRAME)
-        tx_frame.FIR.B.FF = CAN_frame_ext;
-      else
-        tx_frame.FIR.B.FF = CAN_frame_std;
-
       if (m_poll.moduleid_sent == 0x7df)
         {
         // broadcast request: derive module ID from response ID:
         // (Note: this only works for the SAE standard ID scheme)
-        txid = frame->MsgID - 8;
+        m_poll_tx_txid = frame->MsgID - 8;
         }
       else
         {
         // use known module ID:
-        txid = m_poll.moduleid_sent;
-        }
-
-      if (m_poll.protocol == ISOTP_EXTADR)
-        {
-        tx_frame.MsgID = txid >> 8;
-        tx_frame.data.u8[0] = txid & 0xff;
-        tx_data = &tx_frame.data.u8[1];
-        tx_datalen = 6;
+        m_poll_tx_txid = m_poll.moduleid_sent;
         }
-      else
-        {
-        tx_frame.MsgID = txid;
-        tx_data = &tx_frame.data.u8[0];
-        tx_datalen = 7;
-        }
-
-      // Send next chunk of frames:
-      while (m_poll_tx_remain > 0)
-        {
-        ++m_poll_tx_frame;
-        tx_data[0] = (ISOTP_FT_CONSECUTIVE << 4) + (m_poll_tx_frame & 0x0f);
-        tx_datasent = LIMIT_MAX(m_poll_tx_remain, tx_datalen);
-        memcpy(&tx_data[1], m_poll_tx_data+m_poll_tx_offset, tx_datasent);
-        if (tx_datasent < tx_datalen)
-          memset(&tx_data[1+tx_datasent], 0x55, tx_datalen-tx_datasent);
-        tx_frame.Write();
-        m_poll_tx_offset += tx_datasent;
-        m_poll_tx_remain -= tx_datasent;
-
-        if (m_poll_tx_remain == 0)
-          break;
-        if (tp_fc_framecnt > 0 && --tp_fc_framecnt == 0)
-          break;
-
-        if (tp_fc_septime > 0)
-          {
-          if (tp_fc_septime <= 127)
-            usleep(tp_fc_septime * 1000);
-          else if (tp_fc_septime > 240)
-            usleep((tp_fc_septime - 240) * 100);
-          }
-        }
-
-      if (m_poll_tx_remain > 0)
-        m_poll_wait = 2;
+      m_poll_tx_blockcnt = tp_fc_framecnt;
+      m_poll_tx_septime = ISOTPSepTime(tp_fc_septime);
+      m_poll_tx_due = 0;
+      PollerISOTPTxBlock();
       }
 
     return true;
@@ -369,6 +376,7 @@ bool OvmsPoller::PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid)
               msgid, tp_frameindex, m_poll.mlframe & 0x0f, m_poll.type, m_poll.pid,
               hexdump ? hexdump : "-");
       if (hexdump) free(hexdump);
+      PollerISOTPFlowResult(m_poll_fc_rx, true);
       m_poll.moduleid_low = m_poll.moduleid_high = 0; // ignore further frames
       m_poll_wait = 2; // give the bus time to let remaining frames pass
       return true;
@@ -396,30 +404,8 @@ bool OvmsPoller::PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid)
     }
   else // ISOTP_FT_FIRST || ISOTP_FT_SINGLE
     {
-    response_type = tp_data[0];
-    if (response_type == UDS_RESP_TYPE_NRC)
-      {
-      error_type = tp_data[1];
-      error_code = tp_data[2];
-      }
-    else if (POLL_TYPE_HAS_16BIT_PID(response_type-0x40))
-      {
-      response_pid = tp_data[1] << 8 | tp_data[2];
-      response_data = &tp_data[3];
-      response_datalen = tp_datalen - 3;
-      }
-    else if (POLL_TYPE_HAS_8BIT_PID(response_type-0x40))
-      {
-      response_pid = tp_data[1];
-      response_data = &tp_data[2];
-      response_datalen = tp_datalen - 2;
-      }
-    else
-      {
-      response_pid = m_poll.pid;
-      response_data = &tp_data[1];
-      response_datalen = tp_datalen - 1;
-      }
+    ISOTPResponseHeader(tp_data, tp_datalen, m_poll.pid, response_type, response_pid,
+      response_data, response_datalen, error_type, error_code);
     }
 
 
@@ -435,6 +421,7 @@ bool OvmsPoller::PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid)
       // Info: requestCorrectlyReceived-ResponsePending (server busy processing the request)
       ESP_LOGD(TAG, "[%" PRIu8 "]PollerISOTPReceive[%03" PRIX32 "]: got OBD/UDS info %02X(%X) code=%02X (pending)",
                m_poll.bus_no, msgid, m_poll.type, m_poll.pid, error_code);
+      MyPollers.LatencyFirst(m_poll, m_poll_latency);
       // add some wait time:
       m_poll_wait++;
       return true;
@@ -444,6 +431,7 @@ bool OvmsPoller::PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid)
       // Error: forward to application:
       ESP_LOGD(TAG, "[%" PRIu8 "]PollerISOTPReceive[%03" PRIX32 "]: process OBD/UDS error %02X(%X) code=%02X",
                m_poll.bus_no, msgid, m_poll.type, m_poll.pid, error_code);
+      MyPollers.LatencyError(m_poll, m_poll_latency, error_code);
       // Running single poll?
       {
       OvmsRecMutexLock lock(&m_poll_mutex);
@@ -451,7 +439,13 @@ bool OvmsPoller::PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid)
       m_poll.mlframe = 0;
       m_poll.mloffset = 0;
       m_poll.mlremain = 0;
-      IncomingPollError(m_poll, error_code);
+      if (m_poll.entry.xargs.tag == POLL_TXBATCH)
+        PollerBatchError(m_poll, error_code, [this](const poll_job_t &job, uint16_t code)
+          {
+          IncomingPollError(job, code);
+          });
+      else
+        IncomingPollError(m_poll, error_code);
       }
       // abort:
       m_poll.mlremain = 0;
@@ -461,6 +455,7 @@ bool OvmsPoller::PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid)
     {
     // Normal matching poll response, forward to application:
     m_poll.mlremain = tp_len - tp_datalen;
+    MyPollers.LatencyFirst(m_poll, m_poll_latency);
     ESP_LOGD(TAG, "PollerISOTPReceive[%03" PRIX32 "]: process OBD/UDS response %02" PRIX16 "(%" PRIX16 ") frm=%u len=%u off=%u rem=%u",
              msgid, m_poll.type, m_poll.pid,
              m_poll.mlframe, response_datalen, m_poll.mloffset, m_poll.mlremain);
@@ -468,7 +463,13 @@ bool OvmsPoller::PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid)
       {
       OvmsRecMutexLock lock(&m_poll_mutex);
       m_poll.moduleid_rec = msgid;
-      m_polls.IncomingPacket(m_poll, response_data, response_datalen);
+      if (m_poll.entry.xargs.tag == POLL_TXBATCH)
+        PollerBatchIncoming(m_poll, response_data, response_datalen, [this](const poll_job_t &job, uint8_t* data, uint8_t length)
+          {
+          m_polls.IncomingPacket(job, data, length);
+          });
+      else
+        m_polls.IncomingPacket(m_poll, response_data, response_datalen);
       }
     }
   else
@@ -488,18 +489,7 @@ bool OvmsPoller::PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid)
     if (tp_frametype == ISOTP_FT_FIRST)
       {
       // First frame; send flow control frame:
-      CAN_frame_t txframe;
-      uint8_t* txdata;
       uint32_t txid;
-      memset(&txframe,0,sizeof(txframe));
-      txframe.origin = frame->origin;
-      txframe.FIR.B.DLC = 8;
-
-      if (m_poll.protocol == ISOTP_EXTFRAME)
-        txframe.FIR.B.FF = CAN_frame_ext;
-      else
-        txframe.FIR.B.FF = CAN_frame_std;
-
       if (m_poll.moduleid_sent == 0x7df)
         {
         // broadcast request: derive module ID from response ID:
@@ -511,28 +501,16 @@ bool OvmsPoller::PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid)
         // use known module ID:
         txid = m_poll.moduleid_sent;
         }
-
-      if (m_poll.protocol == ISOTP_EXTADR)
-        {
-        txframe.MsgID = txid >> 8;
-        txframe.data.u8[0] = txid & 0xff;
-        txdata = &txframe.data.u8[1];
-        }
-      else
-        {
-        txframe.MsgID = txid;
-        txdata = &txframe.data.u8[0];
-        }
-
-      txdata[0] = 0x30;                // flow control frame type
-      txdata[1] = 0x00;                // request all frames available
-      txdata[2] = m_poll_fc_septime;   // with configured separation timing (default 25 ms)
-      txframe.Write();
+      m_poll_fc_rx.start = 0;
+      PollerISOTPFlowControl(m_poll, txid, m_poll_fc_rx);
       m_poll.mlframe = 1;
       }
     else
       {
       m_poll.mlframe++;
+      // End of block: send next flow control frame
+      if (m_poll_fc_rx.blocksize && (m_poll.mlframe - 1) % m_poll_fc_rx.blocksize == 0)
+        PollerISOTPFlowControl(m_poll, m_poll_fc_rx.txid, m_poll_fc_rx);
       }
 
     m_poll.mloffset += response_datalen; // next frame application payload offset
@@ -542,6 +520,8 @@ bool OvmsPoller::PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid)
     {
     // Request response complete:
     m_poll_wait = 0;
+    MyPollers.LatencyDone(m_poll, m_poll_latency, m_poll.mloffset + response_datalen);
+    PollerISOTPFlowResult(m_poll_fc_rx, false, m_poll.mlframe, m_poll.mloffset + response_datalen);
     }
 
   //  If there are no more packets and
@@ -555,3 +535,653 @@ bool OvmsPoller::PollerISOTPReceive(CAN_frame_t* frame, uint32_t msgid)
 
   return true;
   }
+
+
+/**
+ * PollerISOTPSlotReceive: process a response frame for a pipelined request
+ *  Pipelined requests are single frame requests to a specific ECU, so there
+ *  is no TX flow control. Multi frame responses are collected in the slot and
+ *  passed on complete by PollerISOTPSlotReplay(), so responses from
+ *  different ECUs don't interleave at the application.
+ */
+bool OvmsPoller::PollerISOTPSlotReceive(poll_slot_t &slot, CAN_frame_t* frame, uint32_t msgid)
+  {
+  poll_job_t &job = slot.job;
+  char *hexdump = NULL;
+
+  uint8_t* fr_data;               // Frame data address
+  uint8_t  fr_maxlen;             // Frame data max length
+  if (job.protocol == ISOTP_EXTADR)
+    {
+    fr_data = &frame->data.u8[1];
+    fr_maxlen = 7;
+    }
+  else
+    {
+    fr_data = &frame->data.u8[0];
+    fr_maxlen = 8;
+    }
+
+  uint8_t tp_frametype = fr_data[0] >> 4;
+
+  if (tp_frametype == ISOTP_FT_CONSECUTIVE)
+    {
+    // Note: we tolerate an index less than the expected one, as some devices
+    //  begin counting at the first consecutive frame
+    uint8_t tp_frameindex = fr_data[0] & 0x0f;
+    if (job.mlremain == 0 || tp_frameindex > (job.mlframe & 0x0f))
+      {
+      ESP_LOGW(TAG, "[%" PRIu8 "]PollerISOTPSlotReceive[%03" PRIX32 "]: unexpected/out of sequence ISO TP frame (%d vs %d), aborting poll %02X(%X)",
+               job.bus_no, msgid, tp_frameindex, job.mlframe & 0x0f, job.type, job.pid);
+      PollerISOTPFlowResult(slot.fc, true);
+      PollerSlotRelease(slot);
+      return true;
+      }
+    uint8_t tp_datalen = LIMIT_MAX(job.mlremain, fr_maxlen-1);
+    slot.frames.Append(frame->data.u8, 8);
+    job.mlremain -= tp_datalen;
+    job.mlframe++;
+    if (job.mlremain > 0)
+      {
+      slot.deadline = esp_timer_get_time() + POLLER_SLOT_TIMEOUT * 1000;
+      // End of block: send next flow control frame
+      if (slot.fc.blocksize && (job.mlframe - 1) % slot.fc.blocksize == 0)
+        PollerISOTPFlowControl(job, slot.fc.txid, slot.fc);
+      return true;
+      }
+    // Response complete:
+    job.moduleid_rec = msgid;
+    PollerISOTPSlotReplay(slot);
+    MyPollers.LatencyDone(job, slot.latency, job.mloffset);
+    PollerISOTPFlowResult(slot.fc, false, job.mlframe, job.mloffset);
+    PollerSlotRelease(slot);
+    if (CanPoll())
+      Queue_PollerSendSuccess();
+    return true;
+    }
+
+  if (tp_frametype != ISOTP_FT_SINGLE && tp_frametype != ISOTP_FT_FIRST)
+    {
+    FormatHexDump(&hexdump, (const char*)frame->data.u8, 8, 8);
+    ESP_LOGW(TAG, "PollerISOTPSlotReceive[%03" PRIX32 "]: ignoring unexpected/invalid ISO TP frame: %s",
+             msgid, hexdump ? hexdump : "-");
+    if (hexdump) free(hexdump);
+    return false;
+    }
+
+  uint16_t tp_len;                // TP payload length (0…4095)
+  uint8_t* tp_data;               // TP frame data section address
+  uint8_t  tp_datalen;            // TP frame data section length (0…7)
+  if (tp_frametype == ISOTP_FT_SINGLE)
+    {
+    tp_len = fr_data[0] & 0x0f;
+    tp_data = &fr_data[1];
+    tp_datalen = tp_len;
+    }
+  else
+    {
+    tp_len = (fr_data[0] & 0x0f) << 8 | fr_data[1];
+    tp_data = &fr_data[2];
+    tp_datalen = (tp_len > fr_maxlen-2) ? fr_maxlen-2 : tp_len;
+    }
+
+  uint8_t  response_type = 0, error_type = 0, error_code = 0;
+  uint16_t response_pid = 0, response_datalen = 0;
+  uint8_t* response_data = NULL;
+  ISOTPResponseHeader(tp_data, tp_datalen, job.pid, response_type, response_pid,
+    response_data, response_datalen, error_type, error_code);
+
+  if (response_type == UDS_RESP_TYPE_NRC && error_type == job.type)
+    {
+    if (error_code == UDS_RESP_NRC_RCRRP)
+      {
+      // Server busy processing the request, give it some more time:
+      MyPollers.LatencyFirst(job, slot.latency);
+      slot.deadline = esp_timer_get_time() + POLLER_SLOT_TIMEOUT * 1000;
+      return true;
+      }
+    ESP_LOGD(TAG, "[%" PRIu8 "]PollerISOTPSlotReceive[%03" PRIX32 "]: process OBD/UDS error %02X(%X) code=%02X",
+             job.bus_no, msgid, job.type, job.pid, error_code);
+    MyPollers.LatencyError(job, slot.latency, error_code);
+    job.moduleid_rec = msgid;
+    job.mlframe = 0;
+    job.mloffset = 0;
+    job.mlremain = 0;
+      {
+      OvmsRecMutexLock lock(&m_poll_mutex);
+      if (job.entry.xargs.tag == POLL_TXBATCH)
+        PollerBatchError(job, error_code, [this, &slot](const poll_job_t &job, uint16_t code)
+          {
+          if (m_polls.HasSeries(slot.series.get()))
+            slot.series->IncomingError(job, code);
+          });
+      else if (m_polls.HasSeries(slot.series.get()))
+        slot.series->IncomingError(job, error_code);
+      }
+    PollerSlotRelease(slot);
+    if (CanPoll())
+      Queue_PollerSendSuccess();
+    return true;
+    }
+
+  if (response_type != 0x40+job.type || response_pid != job.pid)
+    {
+    FormatHexDump(&hexdump, (const char*)frame->data.u8, 8, 8);
+    ESP_LOGW(TAG, "PollerISOTPSlotReceive[%03" PRIX32 "]: OBD/UDS response type/PID mismatch, got %02X(%X) vs %02X(%X) => ignoring: %s",
+             msgid, response_type, response_pid, 0x40+job.type, job.pid, hexdump ? hexdump : "-");
+    if (hexdump) free(hexdump);
+    return false;
+    }
+
+  if (tp_frametype == ISOTP_FT_SINGLE)
+    {
+    // Complete response, pass on directly:
+    job.moduleid_rec = msgid;
+    job.mlframe = 0;
+    job.mloffset = 0;
+    job.mlremain = 0;
+    job.raw_data = frame->data.u8;
+    job.raw_data_len = 8;
+    MyPollers.LatencyDone(job, slot.latency, response_datalen);
+    PollerISOTPSlotDeliver(slot, response_data, response_datalen);
+    PollerSlotRelease(slot);
+    if (CanPoll())
+      Queue_PollerSendSuccess();
+    return true;
+    }
+
+  // First frame: collect the response frames…
+  MyPollers.LatencyFirst(job, slot.latency);
+  uint16_t frames = 1 + (tp_len - tp_datalen + fr_maxlen - 2) / (fr_maxlen - 1);
+  if (!slot.frames.Start(frames * 8))
+    {
+    ESP_LOGE(TAG, "[%" PRIu8 "]PollerISOTPSlotReceive[%03" PRIX32 "]: no buffer for %" PRIu16 " frames, aborting poll %02X(%X)",
+             job.bus_no, msgid, frames, job.type, job.pid);
+    PollerSlotRelease(slot);
+    return true;
+    }
+  slot.frames.Append(frame->data.u8, 8);
+  job.mlremain = tp_len - tp_datalen;
+  job.mlframe = 1;
+  slot.deadline = esp_timer_get_time() + POLLER_SLOT_TIMEOUT * 1000;
+
+  // …and send the flow control frame:
+  slot.fc.start = 0;
+  PollerISOTPFlowControl(job, job.moduleid_sent, slot.fc);
+  return true;
+  }
+
+/**
+ * PollerISOTPSlotDeliver: pass a response fragment to the series of the request
+ */
+void OvmsPoller::PollerISOTPSlotDeliver(poll_slot_t &slot, uint8_t* data, uint16_t length)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  if (slot.job.entry.xargs.tag == POLL_TXBATCH)
+    {
+    PollerBatchIncoming(slot.job, data, length, [this, &slot](const poll_job_t &job, uint8_t* data, uint8_t length)
+      {
+      if (m_polls.HasSeries(slot.series.get()))
+        slot.series->IncomingPacket(job, data, length);
+      });
+    }
+  else if (m_polls.HasSeries(slot.series.get()))
+    slot.series->IncomingPacket(slot.job, data, length);
+  slot.job.raw_data = nullptr;
+  slot.job.raw_data_len = 0;
+  }
+
+/**
+ * PollerISOTPSlotReplay: pass a collected multi frame response on frame by frame
+ *  The job frame counters and raw data are set as for a directly received
+ *  response.
+ */
+void OvmsPoller::PollerISOTPSlotReplay(poll_slot_t &slot)
+  {
+  poll_job_t &job = slot.job;
+  uint8_t* raw = const_cast<uint8_t*>(slot.frames.Data());
+  uint16_t count = slot.frames.Length() / 8;
+  uint8_t  fr_offset = (job.protocol == ISOTP_EXTADR) ? 1 : 0;
+  uint8_t  fr_maxlen = 8 - fr_offset;
+
+  job.mloffset = 0;
+  for (uint16_t i = 0; i < count; ++i)
+    {
+    uint8_t* fr_data = raw + i*8 + fr_offset;
+    uint8_t* response_data = NULL;
+    uint16_t response_datalen = 0;
+    if (i == 0)
+      {
+      uint16_t tp_len = (fr_data[0] & 0x0f) << 8 | fr_data[1];
+      uint8_t tp_datalen = (tp_len > fr_maxlen-2) ? fr_maxlen-2 : tp_len;
+      uint8_t response_type = 0, error_type = 0, error_code = 0;
+      uint16_t response_pid = 0;
+      ISOTPResponseHeader(&fr_data[2], tp_datalen, job.pid, response_type, response_pid,
+        response_data, response_datalen, error_type, error_code);
+      job.mlremain = tp_len - tp_datalen;
+      }
+    else
+      {
+      response_data = &fr_data[1];
+      response_datalen = LIMIT_MAX(job.mlremain, fr_maxlen-1);
+      job.mlremain -= response_datalen;
+      }
+    job.mlframe = i;
+    job.raw_data = raw + i*8;
+    job.raw_data_len = 8;
+    PollerISOTPSlotDeliver(slot, response_data, response_datalen);
+    job.mloffset += response_datalen;
+    }
+  }
+
+
+// Separation time levels for adaptive flow control, fastest first:
+static const uint8_t isotp_stmin_levels[] = { 0x00, 0xf2, 0xf5, 1, 2, 5, 10, 20, 25, 50, 127 };
+#define ISOTP_STMIN_LEVELS ((int)(sizeof(isotp_stmin_levels) / sizeof(isotp_stmin_levels[0])))
+
+/**
+ * ISOTPSepTime: decode an ISO-TP separation time (STmin) to microseconds
+ *  Reserved values are to be treated as the max time of 127 ms (ISO 15765-2).
+ */
+uint32_t OvmsPoller::ISOTPSepTime(uint8_t septime)
+  {
+  if (septime <= 0x7f)
+    return septime * 1000;
+  else if (septime >= 0xf1 && septime <= 0xf9)
+    return (septime - 0xf0) * 100;
+  else
+    return 127000;
+  }
+
+/**
+ * PollerFlowControlFind: get the flow control entry of an ECU, add if new
+ *  New entries start at the level of the configured separation time.
+ *  Must be called under lock of m_poll_mutex.
+ */
+OvmsPoller::poll_fc_t &OvmsPoller::PollerFlowControlFind(uint32_t txid)
+  {
+  for (auto &ecu : m_fc)
+    {
+    if (ecu.txid == txid)
+      return ecu;
+    }
+  poll_fc_t ecu = {};
+  ecu.txid = txid;
+  uint32_t septime = ISOTPSepTime(m_poll_fc_septime);
+  while (ecu.level < ISOTP_STMIN_LEVELS-1 && ISOTPSepTime(isotp_stmin_levels[ecu.level]) < septime)
+    ecu.level++;
+  m_fc.push_back(ecu);
+  return m_fc.back();
+  }
+
+/**
+ * PollerISOTPFlowControl: send a flow control frame for a multi frame response
+ *  On the first frame of a response (fc.start == 0), the block size and
+ *  separation time are taken from the learned values of the ECU in adaptive
+ *  mode, else from PollSetResponseSeparationTime() without a block limit.
+ *  Subsequent calls (end of block) repeat these.
+ */
+void OvmsPoller::PollerISOTPFlowControl(const poll_job_t &job, uint32_t txid, poll_fc_rx_t &fc)
+  {
+  if (!fc.start)
+    {
+    fc.txid = txid;
+    fc.septime = m_poll_fc_septime;
+    fc.blocksize = 0;
+    if (m_poll_fc_adaptive)
+      {
+      OvmsRecMutexLock lock(&m_poll_mutex);
+      poll_fc_t &ecu = PollerFlowControlFind(txid);
+      fc.septime = isotp_stmin_levels[ecu.level];
+      fc.blocksize = ecu.blocksize;
+      }
+    fc.start = esp_timer_get_time();
+    }
+
+  CAN_frame_t txframe = {};
+  uint8_t* txdata;
+  txframe.origin = job.bus;
+  txframe.FIR.B.DLC = 8;
+  if (job.protocol == ISOTP_EXTFRAME)
+    txframe.FIR.B.FF = CAN_frame_ext;
+  else
+    txframe.FIR.B.FF = CAN_frame_std;
+  if (job.protocol == ISOTP_EXTADR)
+    {
+    txframe.MsgID = txid >> 8;
+    txframe.data.u8[0] = txid & 0xff;
+    txdata = &txframe.data.u8[1];
+    }
+  else
+    {
+    txframe.MsgID = txid;
+    txdata = &txframe.data.u8[0];
+    }
+  txdata[0] = 0x30;                // flow control frame type
+  txdata[1] = fc.blocksize;        // frames per block (0 = all frames available)
+  txdata[2] = fc.septime;          // separation time (default 25 ms)
+  txframe.Write(NULL, 0, CAN_TXPRIO_POLLER);
+  }
+
+/**
+ * PollerISOTPFlowResult: account a multi frame response, adapt the ECU flow control
+ *  @param loss
+ *    true = response lost (sequence error or timeout after the first frame)
+ */
+void OvmsPoller::PollerISOTPFlowResult(poll_fc_rx_t &fc, bool loss, uint16_t frames, uint16_t bytes)
+  {
+  if (!fc.start)
+    return;
+  uint32_t time = esp_timer_get_time() - fc.start;
+  fc.start = 0;
+
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  poll_fc_t &ecu = PollerFlowControlFind(fc.txid);
+  if (loss)
+    {
+    ecu.losses++;
+    ecu.clean = 0;
+    if (!m_poll_fc_adaptive)
+      return;
+    if (ecu.level < ISOTP_STMIN_LEVELS-1)
+      {
+      ecu.floor = ecu.level + 1;
+      ecu.level = LIMIT_MAX(ecu.level + 2, ISOTP_STMIN_LEVELS-1);
+      }
+    else
+      {
+      ecu.blocksize = POLL_FC_BLOCKSIZE;
+      }
+    ESP_LOGD(TAG, "[%" PRIu8 "]PollerISOTPFlowResult[%03" PRIX32 "]: response lost, STmin=%02X BS=%" PRIu8,
+             m_poll.bus_no, ecu.txid, isotp_stmin_levels[ecu.level], ecu.blocksize);
+    return;
+    }
+
+  ecu.responses++;
+  ecu.frames += frames;
+  ecu.bytes += bytes;
+  ecu.time += time;
+  if (!m_poll_fc_adaptive || ++ecu.clean < POLL_FC_CLEAN)
+    return;
+  if (ecu.blocksize)
+    {
+    ecu.blocksize = 0;
+    ecu.clean = 0;
+    }
+  else if (ecu.level > ecu.floor)
+    {
+    ecu.level--;
+    ecu.clean = 0;
+    }
+  else if (ecu.floor > 0 && ecu.clean >= POLL_FC_PROBE)
+    {
+    // No losses for a while, retry the level below:
+    ecu.floor--;
+    ecu.clean = 0;
+    }
+  }
+
+/**
+ * PollerISOTPTxBlock: send the consecutive frames of a multi frame request
+ *  Sends up to the end of the block granted by the ECU's flow control frame.
+ *  Without a separation time, the frames are written in one burst. Separation
+ *  times below 1 ms are waited for directly, longer ones by m_tx_timer, so the
+ *  poller task serves other buses meanwhile. The time is taken from the write
+ *  of the previous frame, so the delays of a write don't add up.
+ */
+void OvmsPoller::PollerISOTPTxBlock()
+  {
+  m_poll_tx_paced = false;
+
+  CAN_frame_t tx_frame = {};
+  uint8_t* tx_data;
+  uint8_t tx_datalen;
+  uint8_t tx_datasent;
+  tx_frame.origin = m_poll.bus;
+  tx_frame.FIR.B.DLC = 8;
+  if (m_poll.protocol == ISOTP_EXTFRAME)
+    tx_frame.FIR.B.FF = CAN_frame_ext;
+  else
+    tx_frame.FIR.B.FF = CAN_frame_std;
+  if (m_poll.protocol == ISOTP_EXTADR)
+    {
+    tx_frame.MsgID = m_poll_tx_txid >> 8;
+    tx_frame.data.u8[0] = m_poll_tx_txid & 0xff;
+    tx_data = &tx_frame.data.u8[1];
+    tx_datalen = 6;
+    }
+  else
+    {
+    tx_frame.MsgID = m_poll_tx_txid;
+    tx_data = &tx_frame.data.u8[0];
+    tx_datalen = 7;
+    }
+
+  while (m_poll_tx_remain > 0)
+    {
+    if (m_poll_tx_due)
+      {
+      int64_t wait = m_poll_tx_due - esp_timer_get_time();
+      if (wait >= 1000)
+        {
+        if (!m_tx_timer)
+          {
+          esp_timer_create_args_t args = {};
+          args.callback = TxTimerCallback;
+          args.arg = this;
+          args.name = "poll isotp tx";
+          if (esp_timer_create(&args, &m_tx_timer) != ESP_OK)
+            m_tx_timer = NULL;
+          }
+        if (m_tx_timer && esp_timer_start_once(m_tx_timer, wait) == ESP_OK)
+          {
+          m_poll_tx_paced = true;
+          m_poll_wait = 2;
+          return;
+          }
+        }
+      if (wait > 0)
+        usleep(wait);
+      }
+
+    ++m_poll_tx_frame;
+    tx_data[0] = (ISOTP_FT_CONSECUTIVE << 4) + (m_poll_tx_frame & 0x0f);
+    tx_datasent = LIMIT_MAX(m_poll_tx_remain, tx_datalen);
+    memcpy(&tx_data[1], m_poll_tx_data+m_poll_tx_offset, tx_datasent);
+    if (tx_datasent < tx_datalen)
+      memset(&tx_data[1+tx_datasent], 0x55, tx_datalen-tx_datasent);
+    if (tx_frame.Write(NULL, pdMS_TO_TICKS(POLL_FC_TXWAIT), CAN_TXPRIO_POLLER) == ESP_FAIL)
+      {
+      ESP_LOGW(TAG, "[%" PRIu8 "]PollerISOTPTxBlock[%03" PRIX32 "]: TX queue overflow, aborting request %02X(%X)",
+               m_poll.bus_no, m_poll_tx_txid, m_poll.type, m_poll.pid);
+      m_poll_tx_remain = 0;
+      m_poll_wait = 0;
+      m_poll_tx_aborts++;
+        {
+        OvmsRecMutexLock lock(&m_poll_mutex);
+        m_polls.IncomingError(m_poll, POLLSINGLE_TXFAILURE);
+        }
+      m_poll.moduleid_rec = 0; // Not yet received
+      IncomingPollTxCallback(m_poll, false);
+      return;
+      }
+    m_poll_tx_due = m_poll_tx_septime ? esp_timer_get_time() + m_poll_tx_septime : 0;
+    m_poll_tx_offset += tx_datasent;
+    m_poll_tx_remain -= tx_datasent;
+
+    if (m_poll_tx_blockcnt > 0 && --m_poll_tx_blockcnt == 0)
+      break;
+    }
+
+  if (m_poll_tx_remain > 0)
+    m_poll_wait = 2;
+  }
+
+void OvmsPoller::TxTimerCallback(void* arg)
+  {
+  OvmsPoller* poller = (OvmsPoller*) arg;
+  MyPollers.QueuePollerSend(OvmsPoller::poller_source_t::TxPace, poller->m_poll.bus_no);
+  }
+
+/**
+ * FlowControlStatus: output the flow control parameters & statistics per ECU
+ */
+void OvmsPoller::FlowControlStatus(OvmsWriter* writer)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  if (m_poll_tx_aborts)
+    writer->printf("  Multi frame requests aborted on TX failure: %" PRIu32 "\n", m_poll_tx_aborts);
+  if (m_fc.empty())
+    {
+    writer->puts("  No multi frame responses");
+    return;
+    }
+  writer->puts("  TxID     STmin  BS  Resp  Lost   Frames     Bytes    Bytes/s");
+  for (auto &ecu : m_fc)
+    {
+    uint8_t septime = m_poll_fc_adaptive ? isotp_stmin_levels[ecu.level] : m_poll_fc_septime;
+    uint8_t blocksize = m_poll_fc_adaptive ? ecu.blocksize : 0;
+    writer->printf("  %-8" PRIx32 " %5.1f %3" PRIu8 " %5" PRIu32 " %5" PRIu32 " %8" PRIu32 " %9" PRIu32 " %10.0f\n",
+      ecu.txid, ISOTPSepTime(septime) / 1000.0f, blocksize, ecu.responses, ecu.losses,
+      ecu.frames, ecu.bytes, ecu.time ? ecu.bytes * 1000000.0f / ecu.time : 0.0f);
+    }
+  }
+
+/**
+ * FlowControlReset: forget the learned flow control parameters & statistics
+ */
+void OvmsPoller::FlowControlReset()
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  m_fc.clear();
+  m_poll_tx_aborts = 0;
+  m_poll_fc_rx.start = 0;
+  for (int i = 0; i < POLLER_MAXSLOTS; ++i)
+    m_slots[i].fc.start = 0;
+  }
+
+
+/**
+ * PollerBatchKeep: copy the additional DIDs of a batched request to a buffer
+ *  owned by the request (the series reuses its buffer for the next request)
+ */
+void OvmsPoller::PollerBatchKeep(poll_pid_t &entry, uint8_t* buffer)
+  {
+  if (entry.xargs.tag != POLL_TXBATCH)
+    return;
+  memmove(buffer, entry.xargs.data, entry.xargs.datalen);
+  entry.xargs.data = buffer;
+  }
+
+/**
+ * PollerBatchIncoming: collect the response fragments of a batched
+ *  ReadDataByIdentifier request, split the complete response
+ */
+void OvmsPoller::PollerBatchIncoming(const poll_job_t &job, uint8_t* data, uint16_t length, const batch_packet_fn &packet)
+  {
+  if (job.mlframe == 0 && !m_batch_rx.Start(length + job.mlremain))
+    {
+    ESP_LOGE(TAG, "[%" PRIu8 "]PollerBatchIncoming: no buffer for %u bytes, dropping response %02X(%X)",
+             job.bus_no, length + job.mlremain, job.type, job.pid);
+    return;
+    }
+  m_batch_rx.Append(data, length);
+  if (job.mlremain > 0)
+    return;
+
+  uint8_t dids = 1 + job.entry.xargs.datalen / 2;
+  bool ok = PollerBatchSplit(job, m_batch_rx.Data(), m_batch_rx.Length(), packet);
+  m_batch_rx.Release();
+  MyPollers.BatchResult(job.entry.txmoduleid, job.entry.rxmoduleid, dids, !ok);
+  }
+
+/**
+ * PollerBatchSplit: pass a batched response on as single DID responses
+ *  The response is <data1> { <DID> <data> }, the leading DID has been checked
+ *  already. Each DID response is passed on in the fragments of a single
+ *  ISO-TP response of that length, with the usual mlframe/mloffset/mlremain
+ *  values.
+ *  @return false if the response doesn't match the DID lengths
+ */
+bool OvmsPoller::PollerBatchSplit(const poll_job_t &job, const uint8_t* data, uint16_t length, const batch_packet_fn &packet)
+  {
+  poll_batch_t batch;
+  if (!MyPollers.GetBatch(job.entry.txmoduleid, job.entry.rxmoduleid, batch))
+    return false;
+
+  // Validate the response structure first:
+  struct { uint16_t did, offset, length; } part[POLL_BATCH_MAXDIDS];
+  uint8_t count = 0;
+  uint16_t offset = 0;
+  uint16_t did = job.pid;
+  while (true)
+    {
+    int len = OvmsPollers::BatchLength(batch, did);
+    if (len < 0)
+      len = length - offset;  // unknown length: last DID
+    if (count == POLL_BATCH_MAXDIDS || offset + len > length)
+      {
+      ESP_LOGW(TAG, "[%" PRIu8 "]PollerBatchSplit[%03" PRIX32 "]: response does not match DID %X length, dropping",
+               job.bus_no, job.moduleid_rec, did);
+      return false;
+      }
+    part[count++] = { did, offset, (uint16_t)len };
+    offset += len;
+    if (offset == length)
+      break;
+    if (length - offset < 2)
+      {
+      ESP_LOGW(TAG, "[%" PRIu8 "]PollerBatchSplit[%03" PRIX32 "]: %u trailing bytes after DID %X, dropping",
+               job.bus_no, job.moduleid_rec, length - offset, did);
+      return false;
+      }
+    did = data[offset] << 8 | data[offset+1];
+    offset += 2;
+    }
+
+  // Pass on the DID responses:
+  uint8_t fr_maxlen = (job.protocol == ISOTP_EXTADR) ? 7 : 8;
+  poll_job_t single = job;
+  single.entry.args.datalen = 0;
+  single.raw_data = nullptr;
+  single.raw_data_len = 0;
+  for (uint8_t i = 0; i < count; ++i)
+    {
+    single.pid = single.entry.pid = part[i].did;
+    uint8_t* did_data = const_cast<uint8_t*>(data) + part[i].offset;
+    uint16_t chunk = (part[i].length <= fr_maxlen-4) ? part[i].length : fr_maxlen-5;
+    single.mlframe = 0;
+    single.mloffset = 0;
+    single.mlremain = part[i].length - chunk;
+    while (true)
+      {
+      packet(single, did_data + single.mloffset, chunk);
+      if (single.mlremain == 0)
+        break;
+      single.mloffset += chunk;
+      single.mlframe++;
+      chunk = LIMIT_MAX(single.mlremain, fr_maxlen-1);
+      single.mlremain -= chunk;
+      }
+    }
+  return true;
+  }
+
+/**
+ * PollerBatchError: pass an error response to a batched request on for all DIDs
+ *  Errors indicating the ECU can't handle the batch disable batching for it.
+ */
+void OvmsPoller::PollerBatchError(const poll_job_t &job, uint16_t code, const batch_error_fn &error)
+  {
+  poll_job_t single = job;
+  single.entry.args.datalen = 0;
+  error(single, code);
+  for (uint16_t i = 0; i+1 < job.entry.xargs.datalen; i += 2)
+    {
+    single.pid = single.entry.pid = job.entry.xargs.data[i] << 8 | job.entry.xargs.data[i+1];
+    error(single, code);
+    }
+  // incorrectMessageLengthOrInvalidFormat, responseTooLong, requestOutOfRange:
+  bool failed = (code == 0x13 || code == 0x14 || code == 0x31);
+  MyPollers.BatchResult(job.entry.txmoduleid, job.entry.rxmoduleid, 1 + job.entry.xargs.datalen / 2, failed);
+  }
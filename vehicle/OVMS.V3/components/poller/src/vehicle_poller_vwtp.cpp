@@ -49,6 +49,19 @@ void OvmsPoller::PollerVWTPStart(bool fromTicker)
       m_poll_vwtp.baseid != m_poll.entry.txmoduleid ||
       m_poll_vwtp.moduleid != m_poll.entry.rxmoduleid)
     {
+    if (m_poll.entry.rxmoduleid == 0)
+      {
+      // explicit close request, also close the pooled channels:
+      PollerVWTPPoolCloseAll();
+      }
+    else
+      {
+      m_vwtp_switches++;
+      // keep the idle channel open if possible:
+      if (m_vwtp_pool_limit && m_poll_vwtp.state == VWTP_Idle)
+        PollerVWTPPoolPark();
+      }
+
     // close or reconnect channel:
     if (m_poll_vwtp.state != VWTP_Closed)
       PollerVWTPEnter(VWTP_ChannelClose);
@@ -106,6 +119,12 @@ void OvmsPoller::PollerVWTPEnter(vwtp_channelstate_t state)
         {
         ESP_LOGD(TAG, "[%" PRIu8 "]PollerVWTPEnter/ChannelSetup: m_poll_protocol mismatch, abort", m_poll.bus_no);
         }
+      else if (m_vwtp_pool_size && m_poll_vwtp.state == VWTP_Closed && PollerVWTPPoolFetch())
+        {
+        // Pooled channel to the module is still open, continue with the poll:
+        m_vwtp_reuses++;
+        PollerVWTPEnter(VWTP_StartPoll);
+        }
       else
         {
         m_poll_vwtp.bus = m_poll.bus;
@@ -116,7 +135,7 @@ void OvmsPoller::PollerVWTPEnter(vwtp_channelstate_t state)
         
         // txid & rxid will be changed by the setup response frame, we offer a standard rxid
         // matching observed client behaviour with baseid=0x200 → rxid=0x300:
-        uint16_t offer_rxid = m_poll_vwtp.baseid + 0x100;
+        uint16_t offer_rxid = PollerVWTPOfferID();
 
         ESP_LOGD(TAG, "[%" PRIu8 "]PollerVWTPEnter[%02X]: channel setup request bus=%d txid=%03X rxid=%03X",
           m_poll.bus_no,
@@ -140,7 +159,8 @@ void OvmsPoller::PollerVWTPEnter(vwtp_channelstate_t state)
         m_poll_wait = 2;
         m_poll_vwtp.state = VWTP_ChannelSetup;
         m_poll_vwtp.lastused = monotonictime;
-        m_poll_vwtp.bus->Write(&txframe);
+        m_vwtp_setup_start = esp_timer_get_time();
+        m_poll_vwtp.bus->WritePriority(&txframe, CAN_TXPRIO_POLLER);
         }
       break;
       }
@@ -166,7 +186,7 @@ void OvmsPoller::PollerVWTPEnter(vwtp_channelstate_t state)
       m_poll_wait = 2;
 
       m_poll_vwtp.state = VWTP_ChannelParams;
-      m_poll_vwtp.bus->Write(&txframe);
+      m_poll_vwtp.bus->WritePriority(&txframe, CAN_TXPRIO_POLLER);
       break;
       }
 
@@ -186,7 +206,7 @@ void OvmsPoller::PollerVWTPEnter(vwtp_channelstate_t state)
       m_poll_wait = 2;
 
       m_poll_vwtp.state = VWTP_ChannelClose;
-      m_poll_vwtp.bus->Write(&txframe);
+      m_poll_vwtp.bus->WritePriority(&txframe, CAN_TXPRIO_POLLER);
       break;
       }
 
@@ -293,7 +313,7 @@ void OvmsPoller::PollerVWTPEnter(vwtp_channelstate_t state)
 
         m_poll_vwtp.txseqnr++;
         m_poll_tx_frame++;
-        m_poll_vwtp.bus->Write(&txframe);
+        m_poll_vwtp.bus->WritePriority(&txframe, CAN_TXPRIO_POLLER);
 
         if (m_poll_tx_remain == 0)
           break;
@@ -346,7 +366,7 @@ void OvmsPoller::PollerVWTPEnter(vwtp_channelstate_t state)
       m_poll_vwtp.state = VWTP_Idle;
       m_poll_vwtp.lastused = monotonictime;
       m_poll_wait = 0;
-      m_poll_vwtp.bus->Write(&txframe);
+      m_poll_vwtp.bus->WritePriority(&txframe, CAN_TXPRIO_POLLER);
       break;
       }
 
@@ -410,7 +430,7 @@ bool OvmsPoller::PollerVWTPReceive(CAN_frame_t* frame, uint32_t msgid)
     txframe.data.u8[3] = 0xFF;  // always ff
     txframe.data.u8[4] = 0x0A;  // interval between two packets:  0.1ms x 10 = 1 ms
     txframe.data.u8[5] = 0xFF;  // always ff
-    m_poll_vwtp.bus->Write(&txframe);
+    m_poll_vwtp.bus->WritePriority(&txframe, CAN_TXPRIO_POLLER);
     };
 
   // Send ACK:
@@ -422,7 +442,7 @@ bool OvmsPoller::PollerVWTPReceive(CAN_frame_t* frame, uint32_t msgid)
     txframe.MsgID = m_poll_vwtp.txid;
     txframe.FIR.B.DLC = 1;
     txframe.data.u8[0] = 0xB0 | (m_poll_vwtp.rxseqnr & 0x0f); // ACK, continue
-    m_poll_vwtp.bus->Write(&txframe);
+    m_poll_vwtp.bus->WritePriority(&txframe, CAN_TXPRIO_POLLER);
     };
 
 
@@ -452,6 +472,8 @@ bool OvmsPoller::PollerVWTPReceive(CAN_frame_t* frame, uint32_t msgid)
         m_poll_vwtp.bus = NULL;
         m_poll_vwtp.state = VWTP_Closed;
         m_poll_wait = 0;
+        // The gateway may be out of channels:
+        PollerVWTPPoolRefused();
         }
       else
         {
@@ -479,6 +501,8 @@ bool OvmsPoller::PollerVWTPReceive(CAN_frame_t* frame, uint32_t msgid)
         m_poll_vwtp.septime = (frame->data.u8[4] & 0b00111111) * timeunit[(frame->data.u8[4] & 0b11000000) >> 6];
         ESP_LOGD(TAG, "[%" PRIu8 "]PollerVWTPReceive[%02X]: channel params OK: bs=%d acktime=%" PRIu32 "us septime=%" PRIu32 "us",
           m_poll.bus_no, m_poll_vwtp.moduleid, m_poll_vwtp.blocksize, m_poll_vwtp.acktime, m_poll_vwtp.septime);
+        m_vwtp_setups++;
+        m_vwtp_setup_time += esp_timer_get_time() - m_vwtp_setup_start;
         // …and proceed to data transmission:
         PollerVWTPEnter(VWTP_StartPoll);
         }
@@ -546,7 +570,7 @@ bool OvmsPoller::PollerVWTPReceive(CAN_frame_t* frame, uint32_t msgid)
         txframe.MsgID = m_poll_vwtp.txid;
         txframe.FIR.B.DLC = 1;
         txframe.data.u8[0] = 0x90 | (m_poll_vwtp.rxseqnr & 0x0f); // ACK, abort
-        m_poll_vwtp.bus->Write(&txframe);
+        m_poll_vwtp.bus->WritePriority(&txframe, CAN_TXPRIO_POLLER);
         }
       break;
       }
@@ -820,4 +844,312 @@ void OvmsPoller::PollerVWTPTicker()
       m_poll.bus_no, m_poll_vwtp.moduleid);
     PollerVWTPEnter(VWTP_ChannelClose);
     }
+
+  // Pooled channels:
+  if (m_vwtp_pool_size)
+    PollerVWTPPoolTicker();
+  }
+
+
+/**
+ * PollerVWTPOfferID: get the CAN ID to offer for a new channel (internal)
+ *  The offered ID becomes our rxid (the module's TX ID), so pooled channels
+ *  to the same gateway need distinct IDs, also distinct from the setup ID.
+ */
+uint16_t OvmsPoller::PollerVWTPOfferID()
+  {
+  uint16_t offer = m_poll_vwtp.baseid + 0x100;
+  for (int i = 0; i < POLL_VWTP_MAXPOOL; ++i)
+    {
+    const vwtp_channel_t &ch = m_vwtp_pool[i].channel;
+    if ((ch.state != VWTP_Closed && ch.bus == m_poll_vwtp.bus && ch.rxid == offer)
+        || offer == m_poll_vwtp.rxid)
+      {
+      // taken, start over with the next ID:
+      offer++;
+      i = -1;
+      }
+    }
+  return offer;
+  }
+
+
+/**
+ * PollerVWTPPoolPark: move the idle active channel into the pool (internal)
+ *  Closes the least recently used pooled channel if the pool is full.
+ */
+void OvmsPoller::PollerVWTPPoolPark()
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  vwtp_pooled_t *slot = NULL;
+  for (int i = 0; i < m_vwtp_pool_limit; ++i)
+    {
+    vwtp_pooled_t &it = m_vwtp_pool[i];
+    if (it.channel.state == VWTP_Closed)
+      {
+      slot = &it;
+      break;
+      }
+    if (!slot || it.channel.lastused < slot->channel.lastused)
+      slot = &it;
+    }
+  if (!slot)
+    return;
+  if (slot->channel.state != VWTP_Closed)
+    {
+    m_vwtp_evictions++;
+    PollerVWTPPoolClose(*slot);
+    }
+  ESP_LOGD(TAG, "[%" PRIu8 "]PollerVWTPPoolPark[%02X]: keeping channel txid=%03X rxid=%03X",
+    m_poll.bus_no, m_poll_vwtp.moduleid, m_poll_vwtp.txid, m_poll_vwtp.rxid);
+  slot->channel = m_poll_vwtp;
+  slot->testmiss = 0;
+  m_poll_vwtp = {};
+  m_poll_vwtp.state = VWTP_Closed;
+  }
+
+
+/**
+ * PollerVWTPPoolFetch: make the pooled channel to the current poll module active (internal)
+ *  @return true if a pooled channel was found
+ */
+bool OvmsPoller::PollerVWTPPoolFetch()
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  for (int i = 0; i < POLL_VWTP_MAXPOOL; ++i)
+    {
+    vwtp_pooled_t &slot = m_vwtp_pool[i];
+    if (slot.channel.state == VWTP_Idle && slot.channel.bus == m_poll.bus &&
+        slot.channel.baseid == m_poll.entry.txmoduleid && slot.channel.moduleid == m_poll.entry.rxmoduleid)
+      {
+      ESP_LOGD(TAG, "[%" PRIu8 "]PollerVWTPPoolFetch[%02X]: using pooled channel txid=%03X rxid=%03X",
+        m_poll.bus_no, slot.channel.moduleid, slot.channel.txid, slot.channel.rxid);
+      m_poll_vwtp = slot.channel;
+      m_poll_vwtp.lastused = monotonictime;
+      slot.channel = {};
+      slot.channel.state = VWTP_Closed;
+      return true;
+      }
+    }
+  return false;
+  }
+
+
+/**
+ * PollerVWTPPoolClose: send a close request on a pooled channel (internal)
+ *  The channel is considered closed immediately, the response is not awaited.
+ */
+void OvmsPoller::PollerVWTPPoolClose(vwtp_pooled_t &slot)
+  {
+  vwtp_channel_t &ch = slot.channel;
+  if (ch.state == VWTP_Closed)
+    return;
+  ESP_LOGD(TAG, "[%" PRIu8 "]PollerVWTPPoolClose[%02X]: close channel txid=%03X rxid=%03X",
+    m_poll.bus_no, ch.moduleid, ch.txid, ch.rxid);
+  if (ch.bus)
+    {
+    CAN_frame_t txframe = {};
+    txframe.callback = &m_poll_txcallback;
+    txframe.FIR.B.FF = CAN_frame_std;
+    txframe.MsgID = ch.txid;
+    txframe.FIR.B.DLC = 1;
+    txframe.data.u8[0] = 0xA8;  // close request
+    ch.bus->WritePriority(&txframe, CAN_TXPRIO_POLLER);
+    }
+  ch = {};
+  ch.state = VWTP_Closed;
+  }
+
+
+/**
+ * PollerVWTPPoolCloseAll: close all pooled channels (internal)
+ */
+void OvmsPoller::PollerVWTPPoolCloseAll()
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  for (int i = 0; i < POLL_VWTP_MAXPOOL; ++i)
+    PollerVWTPPoolClose(m_vwtp_pool[i]);
+  }
+
+
+/**
+ * PollerVWTPPoolRefused: channel setup refused, reduce the pool size (internal)
+ *  With pooled channels open, the gateway probably has no channel left. The pool
+ *  limit is set to one less than the channels open, the oldest one is closed.
+ */
+void OvmsPoller::PollerVWTPPoolRefused()
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  int open = 0;
+  vwtp_pooled_t *oldest = NULL;
+  for (int i = 0; i < POLL_VWTP_MAXPOOL; ++i)
+    {
+    vwtp_pooled_t &slot = m_vwtp_pool[i];
+    if (slot.channel.state == VWTP_Closed)
+      continue;
+    open++;
+    if (!oldest || slot.channel.lastused < oldest->channel.lastused)
+      oldest = &slot;
+    }
+  if (!oldest)
+    return;
+  m_vwtp_refused++;
+  m_vwtp_pool_limit = open - 1;
+  ESP_LOGI(TAG, "[%" PRIu8 "]PollerVWTPPoolRefused: gateway refused channel with %d pooled, pool size now %" PRIu8,
+    m_poll.bus_no, open, m_vwtp_pool_limit);
+  PollerVWTPPoolClose(*oldest);
+
+  // Keep the remaining channels within the limit:
+  std::stable_partition(m_vwtp_pool, m_vwtp_pool + POLL_VWTP_MAXPOOL,
+    [](const vwtp_pooled_t &slot) { return slot.channel.state != VWTP_Closed; });
+  }
+
+
+/**
+ * PollerVWTPPoolReceive: process frames of pooled channels (internal)
+ *  @return true if the frame belongs to a pooled channel
+ */
+bool OvmsPoller::PollerVWTPPoolReceive(CAN_frame_t &frame)
+  {
+  for (int i = 0; i < POLL_VWTP_MAXPOOL; ++i)
+    {
+    vwtp_pooled_t &slot = m_vwtp_pool[i];
+    vwtp_channel_t &ch = slot.channel;
+    if (ch.state == VWTP_Closed || ch.bus != frame.origin || ch.rxid != frame.MsgID)
+      continue;
+
+    OvmsRecMutexLock lock(&m_poll_mutex);
+    CAN_frame_t txframe = {};
+    txframe.callback = &m_poll_txcallback;
+    txframe.FIR.B.FF = CAN_frame_std;
+    txframe.MsgID = ch.txid;
+    uint8_t opcode = (frame.FIR.B.DLC > 0) ? frame.data.u8[0] : 0;
+    if (opcode == 0xA1)
+      {
+      // Channel test response:
+      slot.testmiss = 0;
+      }
+    else if (opcode == 0xA3)
+      {
+      // Channel test from the module, send params response:
+      txframe.FIR.B.DLC = 6;
+      txframe.data.u8[0] = 0xA1;  // params response
+      txframe.data.u8[1] = 0x0F;  // block size: 15 frames
+      txframe.data.u8[2] = 0x8A;  // time to wait for ACK: 10ms x 10 = 100 ms
+      txframe.data.u8[3] = 0xFF;  // always ff
+      txframe.data.u8[4] = 0x0A;  // interval between two packets:  0.1ms x 10 = 1 ms
+      txframe.data.u8[5] = 0xFF;  // always ff
+      ch.bus->WritePriority(&txframe, CAN_TXPRIO_POLLER);
+      slot.testmiss = 0;
+      }
+    else if (opcode == 0xA8)
+      {
+      // Channel closed by the module, send ACK:
+      ESP_LOGD(TAG, "[%" PRIu8 "]PollerVWTPPoolReceive[%02X]: channel closed by module",
+        m_poll.bus_no, ch.moduleid);
+      m_vwtp_lost++;
+      PollerVWTPPoolClose(slot);
+      }
+    else if ((opcode & 0xf0) <= 0x30)
+      {
+      // Out of band data frame, send ACK/abort:
+      ch.rxseqnr++;
+      txframe.FIR.B.DLC = 1;
+      txframe.data.u8[0] = 0x90 | (ch.rxseqnr & 0x0f); // ACK, abort
+      ch.bus->WritePriority(&txframe, CAN_TXPRIO_POLLER);
+      }
+    return true;
+    }
+  return false;
+  }
+
+
+/**
+ * PollerVWTPPoolTicker: per second pooled channel maintenance (internal)
+ *  Sends channel tests to keep the pooled channels open, closes channels
+ *  unused for the keepalive time and drops channels not responding.
+ */
+void OvmsPoller::PollerVWTPPoolTicker()
+  {
+  if (m_vwtp_pool_tested == monotonictime)
+    return;
+  m_vwtp_pool_tested = monotonictime;
+
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  for (int i = 0; i < POLL_VWTP_MAXPOOL; ++i)
+    {
+    vwtp_pooled_t &slot = m_vwtp_pool[i];
+    vwtp_channel_t &ch = slot.channel;
+    if (ch.state == VWTP_Closed)
+      continue;
+    if (m_poll_ch_keepalive > 0 && ch.lastused + m_poll_ch_keepalive < monotonictime)
+      {
+      ESP_LOGD(TAG, "[%" PRIu8 "]PollerVWTPPoolTicker[%02X]: channel inactivity timeout",
+        m_poll.bus_no, ch.moduleid);
+      PollerVWTPPoolClose(slot);
+      }
+    else if (slot.testmiss >= POLL_VWTP_TESTMISS)
+      {
+      ESP_LOGD(TAG, "[%" PRIu8 "]PollerVWTPPoolTicker[%02X]: channel lost",
+        m_poll.bus_no, ch.moduleid);
+      m_vwtp_lost++;
+      ch = {};
+      ch.state = VWTP_Closed;
+      }
+    else
+      {
+      CAN_frame_t txframe = {};
+      txframe.callback = &m_poll_txcallback;
+      txframe.FIR.B.FF = CAN_frame_std;
+      txframe.MsgID = ch.txid;
+      txframe.FIR.B.DLC = 1;
+      txframe.data.u8[0] = 0xA3;  // channel test
+      ch.bus->WritePriority(&txframe, CAN_TXPRIO_POLLER);
+      slot.testmiss++;
+      }
+    }
+  }
+
+
+/**
+ * ChannelPoolStatus: output the open VWTP channels & statistics
+ */
+void OvmsPoller::ChannelPoolStatus(OvmsWriter* writer)
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  writer->printf("  Pool size: %" PRIu8 " (limit %" PRIu8 ")  Module switches: %" PRIu32 "  From pool: %" PRIu32 "\n",
+    m_vwtp_pool_size, m_vwtp_pool_limit, m_vwtp_switches, m_vwtp_reuses);
+  writer->printf("  Setups: %" PRIu32 " (avg %.1f ms)  Evicted: %" PRIu32 "  Lost: %" PRIu32 "  Refused: %" PRIu32 "\n",
+    m_vwtp_setups, m_vwtp_setups ? m_vwtp_setup_time / 1000.0f / m_vwtp_setups : 0.0f,
+    m_vwtp_evictions, m_vwtp_lost, m_vwtp_refused);
+  auto print = [writer](const char* type, const vwtp_channel_t &ch)
+    {
+    writer->printf("  %-7s %02X      %03X  %03X  %5" PRIu32 "\n",
+      type, ch.moduleid, ch.txid, ch.rxid, monotonictime - ch.lastused);
+    };
+  writer->puts("  Channel Module  TxID RxID  Idle [s]");
+  if (m_poll_vwtp.state != VWTP_Closed)
+    print("active", m_poll_vwtp);
+  for (int i = 0; i < POLL_VWTP_MAXPOOL; ++i)
+    {
+    if (m_vwtp_pool[i].channel.state != VWTP_Closed)
+      print("pooled", m_vwtp_pool[i].channel);
+    }
+  }
+
+
+/**
+ * ChannelPoolReset: reset the statistics, retry the configured pool size
+ */
+void OvmsPoller::ChannelPoolReset()
+  {
+  OvmsRecMutexLock lock(&m_poll_mutex);
+  m_vwtp_pool_limit = m_vwtp_pool_size;
+  m_vwtp_setup_time = 0;
+  m_vwtp_setups = 0;
+  m_vwtp_switches = 0;
+  m_vwtp_reuses = 0;
+  m_vwtp_evictions = 0;
+  m_vwtp_lost = 0;
+  m_vwtp_refused = 0;
   }
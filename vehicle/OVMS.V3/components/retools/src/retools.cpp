@@ -32,6 +32,8 @@
 static const char *TAG = "re";
 
 #include <string.h>
+#include <algorithm>
+#include <esp_timer.h>
 #include "retools.h"
 #include "dbc_app.h"
 #include "ovms.h"
@@ -128,10 +130,13 @@ void re::Task()
               }
             else
               {
+              int64_t started = esp_timer_get_time();
               DoAnalyse(&message.frame);
+              m_proctime += esp_timer_get_time() - started;
               }
             break;
           }
+        m_processed++;
         m_finished = monotonictime;
         }
       }
@@ -143,13 +148,18 @@ void re::DoAnalyse(CAN_frame_t* frame)
   char vbuf[256];
 
   OvmsRecMutexLock lock(&m_mutex);
-  std::string key = GetKey(frame);
+  if (frame->origin != NULL && GetBusIndex(frame->origin) == 0)
+    {
+    // No room for another bus in the record key:
+    m_rejected++;
+    return;
+    }
+  re_key_t key = GetKey(frame);
   auto k = m_rmap.find(key);
   re_record_t* r;
   if (m_rmap.size() == 0) m_started = monotonictime;
   if (k == m_rmap.end())
     {
-    r = k->second;
     r = new re_record_t;
     memset(r,0,sizeof(re_record_t));
     r->attr.b.Changed = 1; // Mark the whole ID as changed
@@ -163,7 +173,7 @@ void re::DoAnalyse(CAN_frame_t* frame)
         r->attr.dd = 0xff;
         HighlightDump(vbuf, (const char*)frame->data.u8, frame->FIR.B.DLC, r->attr.dc, r->attr.dd);
         ESP_LOGV(TAG, "Discovered new %s%s%s %s",
-          re_green[0][0], key.c_str(), re_green[0][1], vbuf);
+          re_green[0][0], GetKeyName(key).c_str(), re_green[0][1], vbuf);
         break;
       }
     m_rmap[key] = r;
@@ -197,31 +207,104 @@ void re::DoAnalyse(CAN_frame_t* frame)
         if (found)
           {
           HighlightDump(vbuf, (const char*)frame->data.u8, frame->FIR.B.DLC, r->attr.dc, r->attr.dd);
-          ESP_LOGV(TAG, "Discovered change %s %s", k->first.c_str(), vbuf);
+          ESP_LOGV(TAG, "Discovered change %s %s", GetKeyName(k->first).c_str(), vbuf);
           }
         break;
         }
       }
     }
+  if (m_bits_enabled)
+    DoBitsAnalysis(r, frame);
   memcpy(&r->last,frame,sizeof(CAN_frame_t));
   r->rxcount++;
   }
 
-std::string re::GetKey(CAN_frame_t* frame)
+void re::DoBitsAnalysis(re_record_t* r, CAN_frame_t* frame)
   {
-  std::string key;
-  if (frame->origin != NULL)
-    key = std::string(frame->origin->GetName());
-  else
-    key = std::string("can?");
-  key.append("/");
+  if (r->bits == NULL)
+    {
+    if (m_bits_count >= m_bits_max) return;
+    r->bits = new re_bitstats();
+    m_bits_count++;
+    return;
+    }
+  if (r->rxcount == 0) return;
 
-  char id[9];
-  if (frame->FIR.B.FF == CAN_frame_std)
-    sprintf(id,"%03" PRIx32,frame->MsgID);
-  else
-    sprintf(id,"%08" PRIx32,frame->MsgID);
-  key.append(id);
+  r->bits->Update(&r->last, frame);
+
+  if (m_bits_metric_count > 0)
+    {
+    float mvalues[RE_BITS_METRICS];
+    for (int k=0; k<m_bits_metric_count; k++)
+      {
+      if (!m_bits_metrics[k]->IsDefined()) return;
+      mvalues[k] = m_bits_metrics[k]->AsFloat();
+      }
+    r->bits->UpdateCorrelation(frame, mvalues, m_bits_metric_count);
+    }
+  }
+
+void re::SetBitsAnalysis(bool enabled, uint32_t max)
+  {
+  OvmsRecMutexLock lock(&m_mutex);
+  m_bits_enabled = enabled;
+  if (max > 0) m_bits_max = max;
+  if (!enabled)
+    {
+    for (re_record_map_t::iterator it=m_rmap.begin(); it!=m_rmap.end(); ++it)
+      {
+      if (it->second->bits)
+        {
+        delete it->second->bits;
+        it->second->bits = NULL;
+        }
+      }
+    m_bits_count = 0;
+    }
+  }
+
+void re::SetBitsMetrics(int count, OvmsMetric** metrics)
+  {
+  OvmsRecMutexLock lock(&m_mutex);
+  if (count > RE_BITS_METRICS) count = RE_BITS_METRICS;
+  for (int k=0; k<count; k++)
+    m_bits_metrics[k] = metrics[k];
+  m_bits_metric_count = count;
+  for (re_record_map_t::iterator it=m_rmap.begin(); it!=m_rmap.end(); ++it)
+    {
+    if (it->second->bits)
+      it->second->bits->ClearCorrelation();
+    }
+  }
+
+/**
+ * GetBusIndex: key number of a bus (1…RE_MAXBUSES), assigned on its first frame
+ *  independent of the bus name. Returns 0 if there is no room for the bus.
+ *  The caller needs to hold m_mutex.
+ */
+int re::GetBusIndex(canbus* bus)
+  {
+  for (int k = 0; k < RE_MAXBUSES; k++)
+    {
+    if (m_buses[k] == bus)
+      return k+1;
+    if (m_buses[k] == NULL)
+      {
+      m_buses[k] = bus;
+      m_busnames[k] = bus->GetName();
+      return k+1;
+      }
+    }
+  return 0;
+  }
+
+re_key_t re::GetKey(CAN_frame_t* frame)
+  {
+  re_key_t key = frame->MsgID & RE_KEY_ID_MASK;
+  if (frame->FIR.B.FF == CAN_frame_ext)
+    key |= RE_KEY_EXT;
+  if (frame->origin != NULL)
+    key |= ((re_key_t)GetBusIndex(frame->origin) & RE_KEY_BUS_MASK) << RE_KEY_BUS_SHIFT;
 
   if (((m_obdii_std_min>0) &&
        (frame->FIR.B.FF == CAN_frame_std) &&
@@ -239,25 +322,14 @@ std::string re::GetKey(CAN_frame_t* frame)
       // Probably just a continuation frame. Ignore it.
       return key;
       }
-    uint8_t mode = frame->data.u8[1];
-    char req[16];
-    if (mode > 0x4a)
-      {
-      sprintf(req,":O2Pm%d:%d",mode-0x40,((int)frame->data.u8[2]<<8)+frame->data.u8[3]);
-      }
-    else if (mode > 0x40)
-      {
-      sprintf(req,":O2Pm%d:%d",mode-0x40,(int)frame->data.u8[2]);
-      }
-    else if (mode > 0x0a)
-      {
-      sprintf(req,":O2Qm%d:%d",mode,((int)frame->data.u8[2]<<8)+frame->data.u8[3]);
-      }
+    uint32_t mode = frame->data.u8[1];
+    uint32_t pid;
+    if ((mode > 0x4a) || ((mode > 0x0a) && (mode <= 0x40)))
+      pid = ((uint32_t)frame->data.u8[2]<<8) + frame->data.u8[3];
     else
-      {
-      sprintf(req,":O2Qm%d:%d",mode,(int)frame->data.u8[2]);
-      }
-    key.append(req);
+      pid = frame->data.u8[2];
+    key |= ((re_key_t)RE_KEY_TYPE_OBDII << RE_KEY_TYPE_SHIFT) |
+           ((re_key_t)((mode<<16) | pid) << RE_KEY_SUB_SHIFT);
     return key;
     }
 
@@ -274,9 +346,8 @@ std::string re::GetKey(CAN_frame_t* frame)
         dbcSignal* s = m->GetMultiplexorSignal();
         dbcNumber muxn = s->Decode(frame->data.u8, 8);
         uint32_t mux = muxn.GetUnsignedInteger();
-        char b[8];
-        sprintf(b,":%04" PRIx32,mux);
-        key.append(b);
+        key |= ((re_key_t)RE_KEY_TYPE_MUX << RE_KEY_TYPE_SHIFT) |
+               (((re_key_t)mux & RE_KEY_SUB_MASK) << RE_KEY_SUB_SHIFT);
         }
       }
     }
@@ -284,6 +355,100 @@ std::string re::GetKey(CAN_frame_t* frame)
   return key;
   }
 
+std::string re::GetKeyName(re_key_t key)
+  {
+  char buf[40];
+  char *p = buf;
+
+  int bus = (key >> RE_KEY_BUS_SHIFT) & RE_KEY_BUS_MASK;
+  if (bus > 0)
+    p += sprintf(p, "%.8s/", m_busnames[bus-1].c_str());
+  else
+    p += sprintf(p, "can?/");
+
+  uint32_t id = key & RE_KEY_ID_MASK;
+  if (key & RE_KEY_EXT)
+    p += sprintf(p, "%08" PRIx32, id);
+  else
+    p += sprintf(p, "%03" PRIx32, id);
+
+  uint32_t sub = (key >> RE_KEY_SUB_SHIFT) & RE_KEY_SUB_MASK;
+  switch ((key >> RE_KEY_TYPE_SHIFT) & RE_KEY_TYPE_MASK)
+    {
+    case RE_KEY_TYPE_OBDII:
+      {
+      int mode = sub >> 16;
+      int pid = sub & 0xffff;
+      if (mode > 0x40)
+        sprintf(p, ":O2Pm%d:%d", mode-0x40, pid);
+      else
+        sprintf(p, ":O2Qm%d:%d", mode, pid);
+      break;
+      }
+    case RE_KEY_TYPE_MUX:
+      sprintf(p, ":%04" PRIx32, sub);
+      break;
+    default:
+      break;
+    }
+
+  return std::string(buf);
+  }
+
+/**
+ * GetRecordList: render the record keys and collect the matching records,
+ *  sorted by key name. The caller needs to hold m_mutex.
+ */
+void re::GetRecordList(re_record_list_t& list, const char* filter)
+  {
+  list.reserve(m_rmap.size());
+  for (re_record_map_t::iterator it=m_rmap.begin(); it!=m_rmap.end(); ++it)
+    {
+    std::string name = GetKeyName(it->first);
+    if ((filter==NULL)||(strstr(name.c_str(),filter)))
+      list.push_back(std::make_pair(name, it->second));
+    }
+  std::sort(list.begin(), list.end(),
+    [](const re_record_list_t::value_type& a, const re_record_list_t::value_type& b)
+      { return a.first < b.first; });
+  }
+
+/**
+ * CountFrame: CAN callback counting all frames offered to our listener queue,
+ *  so we can tell how many frames got lost due to a full queue.
+ */
+void re::CountFrame(const CAN_frame_t* frame, bool success)
+  {
+  if (success) m_offered++;
+  }
+
+/**
+ * GetDropped: number of frames lost due to the listener queue being full
+ */
+uint32_t re::GetDropped()
+  {
+  uint32_t offered = m_offered;
+  uint32_t done = m_processed + uxQueueMessagesWaiting(m_rxqueue);
+  return (offered > done) ? (offered - done) : 0;
+  }
+
+/**
+ * UpdateRates: calculate offered & processed frame rates (called once per second)
+ */
+void re::UpdateRates()
+  {
+  uint32_t now = monotonictime;
+  uint32_t elapsed = now - m_rate_time;
+  if (elapsed == 0) return;
+  uint32_t offered = m_offered;
+  uint32_t processed = m_processed;
+  m_offered_fps = (offered - m_rate_offered) / elapsed;
+  m_processed_fps = (processed - m_rate_processed) / elapsed;
+  m_rate_offered = offered;
+  m_rate_processed = processed;
+  m_rate_time = now;
+  }
+
 re::re(const char* name, canfilter* filter)
   : pcp(name)
   {
@@ -294,9 +459,28 @@ re::re(const char* name, canfilter* filter)
   m_obdii_ext_max = 0;
   m_started = monotonictime;
   m_finished = monotonictime;
+  for (int k = 0; k < RE_MAXBUSES; k++) m_buses[k] = NULL;
+  m_rejected = 0;
   m_mode = Analyse;
-  m_rxqueue = xQueueCreate(20,sizeof(CAN_frame_t));
+  m_offered = 0;
+  m_processed = 0;
+  m_proctime = 0;
+  m_rate_time = monotonictime;
+  m_rate_offered = 0;
+  m_rate_processed = 0;
+  m_offered_fps = 0;
+  m_processed_fps = 0;
+  m_bits_enabled = false;
+  m_bits_max = 64;
+  m_bits_count = 0;
+  m_bits_metric_count = 0;
+  m_rmap.reserve(256);
+  m_rxqueue = xQueueCreate(CONFIG_OVMS_HW_CAN_RX_QUEUE_SIZE,sizeof(CAN_frame_t));
   xTaskCreatePinnedToCore(RE_task, "OVMS RE", 4096, (void*)this, 5, &m_task, CORE(1));
+  using std::placeholders::_1;
+  using std::placeholders::_2;
+  MyCan.RegisterCallback(TAG, std::bind(&re::CountFrame, this, _1, _2), false);
+  MyCan.RegisterCallback(TAG, std::bind(&re::CountFrame, this, _1, _2), true);
   MyCan.RegisterListener(m_rxqueue, true);
   }
 
@@ -304,6 +488,7 @@ re::~re()
   {
   OvmsRecMutexLock lock(&m_mutex);
   MyCan.DeregisterListener(m_rxqueue);
+  MyCan.DeregisterCallback(TAG);
 
   Clear();
   vQueueDelete(m_rxqueue);
@@ -337,11 +522,24 @@ void re::Clear()
   {
   for (re_record_map_t::iterator it=m_rmap.begin(); it!=m_rmap.end(); ++it)
     {
+    if (it->second->bits) delete it->second->bits;
     delete it->second;
     }
   m_rmap.clear();
+  for (int k = 0; k < RE_MAXBUSES; k++)
+    {
+    m_buses[k] = NULL;
+    m_busnames[k].clear();
+    }
+  m_rejected = 0;
+  m_bits_count = 0;
   m_started = monotonictime;
   m_finished = monotonictime;
+  m_offered = 0;
+  m_processed = 0;
+  m_proctime = 0;
+  m_rate_offered = 0;
+  m_rate_processed = 0;
   }
 
 void re_start(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
@@ -422,16 +620,15 @@ void re_list(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, cons
 
   OvmsRecMutexLock lock(&MyRE->m_mutex);
   writer->printf("%-20.20s %10s %6s %s\n","key","records","ms","last");
-  for (re_record_map_t::iterator it=MyRE->m_rmap.begin(); it!=MyRE->m_rmap.end(); ++it)
+  re_record_list_t list;
+  MyRE->GetRecordList(list, (argc>0) ? argv[0] : NULL);
+  for (re_record_list_t::iterator it=list.begin(); it!=list.end(); ++it)
     {
-    if ((argc==0)||(strstr(it->first.c_str(),argv[0])))
-      {
-      char vbuf[48];
-      char *s = vbuf;
-      FormatHexDump(&s, (const char*)it->second->last.data.u8, it->second->last.FIR.B.DLC, 8);
-      writer->printf("%-20s %10" PRId32 " %6" PRId32 " %s\n",
-        it->first.c_str(),it->second->rxcount,(tdiff/it->second->rxcount),vbuf);
-      }
+    char vbuf[48];
+    char *s = vbuf;
+    FormatHexDump(&s, (const char*)it->second->last.data.u8, it->second->last.FIR.B.DLC, 8);
+    writer->printf("%-20s %10" PRId32 " %6" PRId32 " %s\n",
+      it->first.c_str(),it->second->rxcount,(tdiff/it->second->rxcount),vbuf);
     }
   }
 
@@ -451,19 +648,18 @@ void re_stream_list(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int arg
   writer->printf("[");
   int cnt = 0;
   char *ascii = NULL;
-  for (re_record_map_t::iterator it=MyRE->m_rmap.begin(); it!=MyRE->m_rmap.end(); ++it)
+  re_record_list_t list;
+  MyRE->GetRecordList(list, (argc>0) ? argv[0] : NULL);
+  for (re_record_list_t::iterator it=list.begin(); it!=list.end(); ++it)
     {
-    if (argc == 0 || strstr(it->first.c_str(),argv[0]) != NULL)
-      {
-      HighlightDump(vbuf, (const char*)it->second->last.data.u8,
-        it->second->last.FIR.B.DLC, it->second->attr.dc, it->second->attr.dd, 1, &ascii);
-      writer->printf("%s[\"%s\",%" PRId32 ",%" PRId32 ",\"%s\",\"%s\"]\n",
-        cnt ? "," : "",
-        json_encode(it->first).c_str(), it->second->rxcount, (tdiff/it->second->rxcount),
-        json_encode(std::string(vbuf)).c_str(),
-        json_encode(std::string(ascii)).c_str());
-      cnt++;
-      }
+    HighlightDump(vbuf, (const char*)it->second->last.data.u8,
+      it->second->last.FIR.B.DLC, it->second->attr.dc, it->second->attr.dd, 1, &ascii);
+    writer->printf("%s[\"%s\",%" PRId32 ",%" PRId32 ",\"%s\",\"%s\"]\n",
+      cnt ? "," : "",
+      json_encode(it->first).c_str(), it->second->rxcount, (tdiff/it->second->rxcount),
+      json_encode(std::string(vbuf)).c_str(),
+      json_encode(std::string(ascii)).c_str());
+    cnt++;
     }
   writer->puts("]");
   }
@@ -481,27 +677,26 @@ void re_dbc_list(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc,
 
   OvmsRecMutexLock lock(&MyRE->m_mutex);
   writer->printf("%-20.20s %10s %6s %s\n","key","records","ms","last");
-  for (re_record_map_t::iterator it=MyRE->m_rmap.begin(); it!=MyRE->m_rmap.end(); ++it)
+  re_record_list_t list;
+  MyRE->GetRecordList(list, (argc>0) ? argv[0] : NULL);
+  for (re_record_list_t::iterator it=list.begin(); it!=list.end(); ++it)
     {
-    if ((argc==0)||(strstr(it->first.c_str(),argv[0])))
+    char vbuf[48];
+    char *s = vbuf;
+    FormatHexDump(&s, (const char*)it->second->last.data.u8, it->second->last.FIR.B.DLC, 8);
+    writer->printf("%-20s %10" PRId32 " %6" PRId32 " %s\n",
+      it->first.c_str(),it->second->rxcount,(tdiff/it->second->rxcount),vbuf);
+    re_record_t *re_record = it->second;
+    if (re_record->last.origin)
       {
-      char vbuf[48];
-      char *s = vbuf;
-      FormatHexDump(&s, (const char*)it->second->last.data.u8, it->second->last.FIR.B.DLC, 8);
-      writer->printf("%-20s %10" PRId32 " %6" PRId32 " %s\n",
-        it->first.c_str(),it->second->rxcount,(tdiff/it->second->rxcount),vbuf);
-      re_record_t *re_record = it->second;
-      if (re_record->last.origin)
+      dbcfile* dbc = re_record->last.origin->GetDBC();
+      if (dbc)
         {
-        dbcfile* dbc = re_record->last.origin->GetDBC();
-        if (dbc)
-          {
-          // We have a DBC attached.
-          dbc->DecodeSignal(
-              re_record->last.FIR.B.FF, re_record->last.MsgID,
-              re_record->last.data.u8, 8,
-              writer);
-          }
+        // We have a DBC attached.
+        dbc->DecodeSignal(
+            re_record->last.FIR.B.FF, re_record->last.MsgID,
+            re_record->last.data.u8, 8,
+            writer);
         }
       }
     }
@@ -530,6 +725,28 @@ void re_status(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, co
     writer->printf("Filter:  %s\n", MyRE->m_filter->Info().c_str());
     }
 
+  uint32_t processed = MyRE->m_processed;
+  writer->printf("Frames:  %" PRIu32 " offered, %" PRIu32 " processed, %" PRIu32 " dropped\n",
+    MyRE->m_offered, processed, MyRE->GetDropped());
+  writer->printf("Rate:    %" PRIu32 " frames/s offered, %" PRIu32 " frames/s processed\n",
+    MyRE->m_offered_fps, MyRE->m_processed_fps);
+  if (MyRE->m_rejected > 0)
+    writer->printf("Buses:   %" PRIu32 " frames rejected (max %d buses)\n", MyRE->m_rejected, RE_MAXBUSES);
+  if (processed > 0)
+    {
+    uint32_t us = MyRE->m_proctime / processed;
+    writer->printf("Cost:    %" PRIu32 " us/frame, capacity ~%" PRIu32 " frames/s\n",
+      us, (us > 0) ? (1000000 / us) : 1000000);
+    }
+
+  if (MyRE->m_bits_enabled)
+    {
+    writer->printf("Bits:    analysing %" PRIu32 " of max %" PRIu32 " records\n",
+      MyRE->m_bits_count, MyRE->m_bits_max);
+    for (int k=0; k<MyRE->m_bits_metric_count; k++)
+      writer->printf("         correlating %s\n", MyRE->m_bits_metrics[k]->m_name);
+    }
+
   OvmsRecMutexLock lock(&MyRE->m_mutex);
   writer->printf("Key Map: %d entries\n",MyRE->m_rmap.size());
   if (MyRE->m_rmap.size() > 0)
@@ -687,17 +904,16 @@ void re_list_changed(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int ar
 
   OvmsRecMutexLock lock(&MyRE->m_mutex);
   writer->printf("%-20.20s %10s %6s %s\n","key","records","ms","last");
-  for (re_record_map_t::iterator it=MyRE->m_rmap.begin(); it!=MyRE->m_rmap.end(); ++it)
+  re_record_list_t list;
+  MyRE->GetRecordList(list, (argc>0) ? argv[0] : NULL);
+  for (re_record_list_t::iterator it=list.begin(); it!=list.end(); ++it)
     {
     if ((it->second->attr.b.Changed)||(it->second->attr.dc))
       {
       HighlightDump(vbuf, (const char*)it->second->last.data.u8,
         it->second->last.FIR.B.DLC, it->second->attr.dc, it->second->attr.dd);
-      if ((argc==0)||(strstr(it->first.c_str(),argv[0])))
-        {
-        writer->printf("%-20s %10" PRId32 " %6" PRId32 " %s\n",
-          it->first.c_str(),it->second->rxcount,(tdiff/it->second->rxcount),vbuf);
-        }
+      writer->printf("%-20s %10" PRId32 " %6" PRId32 " %s\n",
+        it->first.c_str(),it->second->rxcount,(tdiff/it->second->rxcount),vbuf);
       }
     }
   }
@@ -718,10 +934,11 @@ void re_stream_changed(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int
   writer->printf("[");
   int cnt = 0;
   char *ascii = NULL;
-  for (re_record_map_t::iterator it=MyRE->m_rmap.begin(); it!=MyRE->m_rmap.end(); ++it)
+  re_record_list_t list;
+  MyRE->GetRecordList(list, (argc>0) ? argv[0] : NULL);
+  for (re_record_list_t::iterator it=list.begin(); it!=list.end(); ++it)
     {
-    if ((it->second->attr.b.Changed || it->second->attr.dc) &&
-        (argc == 0 || strstr(it->first.c_str(),argv[0]) != NULL))
+    if (it->second->attr.b.Changed || it->second->attr.dc)
       {
       HighlightDump(vbuf, (const char*)it->second->last.data.u8,
         it->second->last.FIR.B.DLC, it->second->attr.dc, it->second->attr.dd, 1, &ascii);
@@ -750,17 +967,16 @@ void re_list_discovered(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int
 
   OvmsRecMutexLock lock(&MyRE->m_mutex);
   writer->printf("%-20.20s %10s %6s %s\n","key","records","ms","last");
-  for (re_record_map_t::iterator it=MyRE->m_rmap.begin(); it!=MyRE->m_rmap.end(); ++it)
+  re_record_list_t list;
+  MyRE->GetRecordList(list, (argc>0) ? argv[0] : NULL);
+  for (re_record_list_t::iterator it=list.begin(); it!=list.end(); ++it)
     {
     if ((it->second->attr.b.Discovered)||(it->second->attr.dd))
       {
       HighlightDump(vbuf, (const char*)it->second->last.data.u8,
         it->second->last.FIR.B.DLC, it->second->attr.dc, it->second->attr.dd);
-      if ((argc==0)||(strstr(it->first.c_str(),argv[0])))
-        {
-        writer->printf("%-20s %10" PRId32 " %6" PRId32 " %s\n",
-          it->first.c_str(),it->second->rxcount,(tdiff/it->second->rxcount),vbuf);
-        }
+      writer->printf("%-20s %10" PRId32 " %6" PRId32 " %s\n",
+        it->first.c_str(),it->second->rxcount,(tdiff/it->second->rxcount),vbuf);
       }
     }
   }
@@ -774,6 +990,7 @@ class REInit
 
 void REInit::Ticker1(std::string event, void* data)
   {
+  if (MyRE) MyRE->UpdateRates();
   if (MyRE && MyNotify.HasReader("stream", "retools.status"))
     {
     StringWriter buf;
@@ -36,6 +36,8 @@
 #include "freertos/queue.h"
 #include <string>
 #include <map>
+#include <unordered_map>
+#include <vector>
 #include "can.h"
 #include "canformat.h"
 #include "dbc.h"
@@ -43,6 +45,8 @@
 #include "ovms.h"
 #include "ovms_mutex.h"
 #include "ovms_netmanager.h"
+#include "ovms_metrics.h"
+#include "retools_bits.h"
 
 typedef struct
   {
@@ -64,9 +68,30 @@ typedef struct
     uint8_t dd;             // Data bytes discovered
     uint8_t spare;
     } attr;
+  re_bitstats* bits;        // Bit level statistics (if enabled)
   } re_record_t;
 
-typedef std::map<std::string, re_record_t*> re_record_map_t;
+// Record key: bus, frame format, ID and OBDII request / DBC multiplexor value
+// packed into 64 bits, so the per-frame lookup needs no string formatting.
+// The string representation is only rendered for listings (see GetKeyName()).
+typedef uint64_t re_key_t;
+
+#define RE_KEY_ID_MASK        0x1fffffffULL // 29 bit CAN ID
+#define RE_KEY_EXT            (1ULL<<29)    // Extended frame format
+#define RE_KEY_BUS_SHIFT      30            // 3 bits: bus index + 1 (0 = unknown, see GetBusIndex())
+#define RE_KEY_BUS_MASK       0x7ULL
+#define RE_MAXBUSES           7             // buses fitting into the key
+#define RE_KEY_TYPE_SHIFT     33            // 2 bits: key type (see below)
+#define RE_KEY_TYPE_MASK      0x3ULL
+#define RE_KEY_SUB_SHIFT      35            // 29 bits: OBDII mode+PID / mux value
+#define RE_KEY_SUB_MASK       0x1fffffffULL
+
+#define RE_KEY_TYPE_PLAIN     0
+#define RE_KEY_TYPE_MUX       1
+#define RE_KEY_TYPE_OBDII     2
+
+typedef std::unordered_map<re_key_t, re_record_t*> re_record_map_t;
+typedef std::vector< std::pair<std::string, re_record_t*> > re_record_list_t;
 
 enum REMode { Analyse, Discover };
 
@@ -82,7 +107,18 @@ class re : public pcp, public ExternalRamAllocated
   public:
     void Task();
     void Clear();
-    std::string GetKey(CAN_frame_t* frame);
+    int GetBusIndex(canbus* bus);
+    re_key_t GetKey(CAN_frame_t* frame);
+    std::string GetKeyName(re_key_t key);
+    void GetRecordList(re_record_list_t& list, const char* filter=NULL);
+    void CountFrame(const CAN_frame_t* frame, bool success);
+    void UpdateRates();
+    uint32_t GetDropped();
+    void SetBitsAnalysis(bool enabled, uint32_t max=0);
+    void SetBitsMetrics(int count, OvmsMetric** metrics);
+
+  protected:
+    void DoBitsAnalysis(re_record_t* r, CAN_frame_t* frame);
 
   protected:
     void DoAnalyse(CAN_frame_t* frame);
@@ -102,6 +138,26 @@ class re : public pcp, public ExternalRamAllocated
     uint32_t m_obdii_ext_max;
     uint32_t m_started;
     uint32_t m_finished;
+    canbus* m_buses[RE_MAXBUSES];   // buses seen, in order of their first frame
+    std::string m_busnames[RE_MAXBUSES];
+    uint32_t m_rejected;            // frames of buses not fitting into the key
+
+  public:
+    volatile uint32_t m_offered;    // Frames seen by the CAN framework
+    uint32_t m_processed;           // Frames taken from the queue
+    int64_t m_proctime;             // Total processing time [us]
+    uint32_t m_rate_time;           // monotonictime of last rate update
+    uint32_t m_rate_offered;        // offered count at last rate update
+    uint32_t m_rate_processed;      // processed count at last rate update
+    uint32_t m_offered_fps;         // Frames/s seen by the CAN framework
+    uint32_t m_processed_fps;       // Frames/s processed
+
+  public:
+    bool m_bits_enabled;            // Bit level analysis enabled
+    uint32_t m_bits_max;            // Max number of records to analyse
+    uint32_t m_bits_count;          // Number of records analysed
+    int m_bits_metric_count;        // Number of metrics to correlate
+    OvmsMetric* m_bits_metrics[RE_BITS_METRICS];
   };
 
 #endif //#ifndef __RETOOLS_H__
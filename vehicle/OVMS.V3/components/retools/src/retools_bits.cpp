@@ -0,0 +1,544 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Date:          14th March 2017
+;
+;    Changes:
+;    1.0  Initial release
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011        Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+#include "ovms_log.h"
+static const char *TAG = "re-bits";
+
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+#include "retools.h"
+#include "retools_bits.h"
+#include "ovms_command.h"
+#include "ovms_metrics.h"
+
+extern re *MyRE;
+
+static uint8_t re_crc8_j1850(const uint8_t* data, int len, int skip)
+  {
+  uint8_t crc = 0xff;
+  for (int k=0; k<len; k++)
+    {
+    if (k == skip) continue;
+    crc ^= data[k];
+    for (int b=0; b<8; b++)
+      crc = (crc & 0x80) ? ((crc << 1) ^ 0x1d) : (crc << 1);
+    }
+  return crc ^ 0xff;
+  }
+
+re_bitstats::re_bitstats()
+  {
+  Clear();
+  }
+
+re_bitstats::~re_bitstats()
+  {
+  }
+
+void re_bitstats::Clear()
+  {
+  m_samples = 0;
+  m_dlc = 0;
+  memset(m_flips, 0, sizeof(m_flips));
+  memset(m_cnt_delta, 0, sizeof(m_cnt_delta));
+  memset(m_cnt_hits, 0, sizeof(m_cnt_hits));
+  memset(m_xor_hits, 0, sizeof(m_xor_hits));
+  memset(m_sum_hits, 0, sizeof(m_sum_hits));
+  memset(m_crc_hits, 0, sizeof(m_crc_hits));
+  ClearCorrelation();
+  }
+
+void re_bitstats::ClearCorrelation()
+  {
+  m_corr_n = 0;
+  memset(m_xmean, 0, sizeof(m_xmean));
+  memset(m_xm2, 0, sizeof(m_xm2));
+  memset(m_ymean, 0, sizeof(m_ymean));
+  memset(m_ym2, 0, sizeof(m_ym2));
+  memset(m_cxy, 0, sizeof(m_cxy));
+  }
+
+/**
+ * Update: account the changes from the last to the current frame
+ */
+void re_bitstats::Update(const CAN_frame_t* last, const CAN_frame_t* frame)
+  {
+  int dlc = frame->FIR.B.DLC;
+  if (dlc > 8) dlc = 8;
+  if (dlc > m_dlc) m_dlc = dlc;
+  m_samples++;
+
+  const uint8_t* cur = frame->data.u8;
+  const uint8_t* prev = last->data.u8;
+  uint8_t xsum = 0, asum = 0;
+
+  for (int b=0; b<dlc; b++)
+    {
+    // Bit flips, in Motorola bit order:
+    uint8_t diff = cur[b] ^ prev[b];
+    for (int bit=7; diff && bit>=0; bit--)
+      {
+      if (diff & (1<<bit))
+        {
+        m_flips[b*8 + (7-bit)]++;
+        diff &= ~(1<<bit);
+        }
+      }
+
+    // Counter candidates (byte, high nibble, low nibble):
+    uint8_t delta[3] = {
+      (uint8_t)(cur[b] - prev[b]),
+      (uint8_t)(((cur[b] >> 4) - (prev[b] >> 4)) & 0x0f),
+      (uint8_t)((cur[b] - prev[b]) & 0x0f) };
+    for (int k=0; k<3; k++)
+      {
+      int idx = k*8 + b;
+      if ((delta[k] != 0) && (delta[k] == m_cnt_delta[idx]))
+        m_cnt_hits[idx]++;
+      m_cnt_delta[idx] = delta[k];
+      }
+
+    xsum ^= cur[b];
+    asum += cur[b];
+    }
+
+  // Checksum candidates:
+  if (dlc >= 2)
+    {
+    for (int b=0; b<dlc; b++)
+      {
+      if ((xsum ^ cur[b]) == cur[b]) m_xor_hits[b]++;
+      if ((uint8_t)(asum - cur[b]) == cur[b]) m_sum_hits[b]++;
+      if (re_crc8_j1850(cur, dlc, b) == cur[b]) m_crc_hits[b]++;
+      }
+    }
+  }
+
+uint32_t re_bitstats::GetCandidateValue(const CAN_frame_t* frame, int candidate)
+  {
+  const uint8_t* d = frame->data.u8;
+  if (candidate < 8)
+    return d[candidate];
+  else if (candidate < 15)
+    return ((uint32_t)d[candidate-8] << 8) | d[candidate-7];     // big endian
+  else
+    return ((uint32_t)d[candidate-14] << 8) | d[candidate-15];   // little endian
+  }
+
+/**
+ * UpdateCorrelation: add a sample for the candidate fields vs. the metric values
+ *  (Welford's online co-moment algorithm)
+ */
+void re_bitstats::UpdateCorrelation(const CAN_frame_t* frame, const float* mvalues, int mcount)
+  {
+  float dx[RE_BITS_CANDIDATES];
+  float dy[RE_BITS_METRICS];
+
+  m_corr_n++;
+  float n = m_corr_n;
+
+  for (int c=0; c<RE_BITS_CANDIDATES; c++)
+    {
+    float x = GetCandidateValue(frame, c);
+    dx[c] = x - m_xmean[c];
+    m_xmean[c] += dx[c] / n;
+    m_xm2[c] += dx[c] * (x - m_xmean[c]);
+    }
+  for (int m=0; m<mcount; m++)
+    {
+    float y = mvalues[m];
+    float d = y - m_ymean[m];
+    m_ymean[m] += d / n;
+    dy[m] = y - m_ymean[m];
+    m_ym2[m] += d * dy[m];
+    }
+  for (int c=0; c<RE_BITS_CANDIDATES; c++)
+    {
+    for (int m=0; m<mcount; m++)
+      m_cxy[c][m] += dx[c] * dy[m];
+    }
+  }
+
+float re_bitstats::GetCorrelation(int candidate, int metric)
+  {
+  if ((m_corr_n < RE_BITS_MINSAMPLES) ||
+      (m_xm2[candidate] <= 0) || (m_ym2[metric] <= 0))
+    return 0;
+  return m_cxy[candidate][metric] / sqrtf(m_xm2[candidate] * m_ym2[metric]);
+  }
+
+/**
+ * GetCandidateName: DBC style signal position of a correlation candidate
+ */
+const char* re_bitstats::GetCandidateName(int candidate, char* buffer)
+  {
+  if (candidate < 8)
+    sprintf(buffer, "%d|8@1+", candidate*8);
+  else if (candidate < 15)
+    sprintf(buffer, "%d|16@0+", (candidate-8)*8 + 7);
+  else
+    sprintf(buffer, "%d|16@1+", (candidate-15)*8);
+  return buffer;
+  }
+
+const char* re_bitstats::GetFieldTypeName(re_field_type_t type)
+  {
+  switch (type)
+    {
+    case RE_FIELD_Counter:      return "counter";
+    case RE_FIELD_ChecksumXor:  return "checksum-xor";
+    case RE_FIELD_ChecksumSum:  return "checksum-sum";
+    case RE_FIELD_ChecksumCrc8: return "checksum-crc8";
+    default:                    return "signal";
+    }
+  }
+
+/**
+ * GetMagnitude: decimal magnitude of the flip rate of a bit position,
+ *  i.e. floor(log10(flips/samples)): 0 = every frame, -1 = 10%+, ...
+ */
+int re_bitstats::GetMagnitude(int pos)
+  {
+  uint64_t v = m_flips[pos];
+  int mag = 0;
+  if (v == 0) return INT32_MIN;
+  while (v < m_samples)
+    {
+    v *= 10;
+    mag--;
+    }
+  return mag;
+  }
+
+re_field_type_t re_bitstats::GetByteType(int byte)
+  {
+  if (m_samples < RE_BITS_MINSAMPLES)
+    return RE_FIELD_Signal;
+
+  uint32_t changes = 0;
+  for (int k=0; k<8; k++) changes += m_flips[byte*8+k];
+  if (changes == 0)
+    return RE_FIELD_Signal;
+
+  uint32_t limit = m_samples - m_samples/20;
+  if (m_crc_hits[byte] >= limit)
+    return RE_FIELD_ChecksumCrc8;
+  if (m_xor_hits[byte] >= limit)
+    return RE_FIELD_ChecksumXor;
+  if (m_sum_hits[byte] >= limit)
+    return RE_FIELD_ChecksumSum;
+
+  limit = m_samples - m_samples/10;
+  if (m_cnt_hits[byte] >= limit)
+    return RE_FIELD_Counter;
+
+  return RE_FIELD_Signal;
+  }
+
+/**
+ * GetFields: derive candidate signal fields from the statistics
+ *
+ * Checksum and counter bytes & nibbles are reported as such, remaining
+ * changing bits are split into fields where the flip rate magnitude drops
+ * (walking from MSB to LSB in Motorola order).
+ */
+int re_bitstats::GetFields(re_field_t* fields, int max)
+  {
+  int cnt = 0;
+  int bits = m_dlc * 8;
+  uint32_t nlimit = m_samples - m_samples/10;
+
+  // Classify bytes & nibbles:
+  re_field_type_t special[16];
+  for (int b=0; b<8; b++)
+    {
+    re_field_type_t t = (b < m_dlc) ? GetByteType(b) : RE_FIELD_Signal;
+    special[b*2] = t;
+    special[b*2+1] = t;
+    if ((t == RE_FIELD_Signal) && (m_samples >= RE_BITS_MINSAMPLES))
+      {
+      if (m_cnt_hits[8+b] >= nlimit) special[b*2] = RE_FIELD_Counter;
+      if (m_cnt_hits[16+b] >= nlimit) special[b*2+1] = RE_FIELD_Counter;
+      }
+    }
+
+  int pos = 0;
+  while ((pos < bits) && (cnt < max))
+    {
+    re_field_type_t t = special[pos/4];
+    if (t != RE_FIELD_Signal)
+      {
+      // Whole byte or nibble:
+      int len = ((pos%8)==0 && special[pos/4+1] == t && (t != RE_FIELD_Counter || m_cnt_hits[pos/8] >= nlimit)) ? 8 : 4;
+      fields[cnt].start = pos;
+      fields[cnt].length = len;
+      fields[cnt].type = t;
+      cnt++;
+      pos += len;
+      continue;
+      }
+    if (m_flips[pos] == 0)
+      {
+      pos++;
+      continue;
+      }
+    int start = pos;
+    int mag = GetMagnitude(pos++);
+    while ((pos < bits) && (m_flips[pos] > 0))
+      {
+      if (((pos%4)==0) && (special[pos/4] != RE_FIELD_Signal)) break;
+      int m = GetMagnitude(pos);
+      if (m < mag) break; // Flip rate drops towards the LSB => new field
+      mag = m;
+      pos++;
+      }
+    fields[cnt].start = start;
+    fields[cnt].length = pos - start;
+    fields[cnt].type = RE_FIELD_Signal;
+    cnt++;
+    }
+
+  return cnt;
+  }
+
+/**
+ * GetFlipMap: one char per bit (Motorola order, bytes separated by spaces):
+ *  '.' = never changed, '0'..'9' = flip rate in tenths
+ *  buffer needs 72 bytes
+ */
+void re_bitstats::GetFlipMap(char* buffer)
+  {
+  char* p = buffer;
+  for (int pos=0; pos<64; pos++)
+    {
+    if ((pos > 0) && ((pos%8) == 0)) *p++ = ' ';
+    if (m_flips[pos] == 0)
+      *p++ = '.';
+    else
+      {
+      uint32_t d = (uint64_t)m_flips[pos] * 10 / m_samples;
+      *p++ = '0' + ((d > 9) ? 9 : d);
+      }
+    }
+  *p = 0;
+  }
+
+////////////////////////////////////////////////////////////////////////
+// Commands
+////////////////////////////////////////////////////////////////////////
+
+void re_bits_on(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (!MyRE)
+    {
+    writer->puts("Error: RE tools not running");
+    return;
+    }
+
+  int max = (argc > 0) ? atoi(argv[0]) : 0;
+  if (max < 0)
+    {
+    writer->puts("Error: invalid maximum number of records");
+    return;
+    }
+  MyRE->SetBitsAnalysis(true, max);
+  writer->printf("Bit analysis enabled for max %" PRIu32 " records (%u bytes each)\n",
+    MyRE->m_bits_max, sizeof(re_bitstats));
+  }
+
+void re_bits_off(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (!MyRE)
+    {
+    writer->puts("Error: RE tools not running");
+    return;
+    }
+
+  MyRE->SetBitsAnalysis(false);
+  writer->puts("Bit analysis disabled");
+  }
+
+void re_bits_metrics(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (!MyRE)
+    {
+    writer->puts("Error: RE tools not running");
+    return;
+    }
+
+  OvmsMetric* metrics[RE_BITS_METRICS];
+  for (int k=0; k<argc; k++)
+    {
+    metrics[k] = MyMetrics.Find(argv[k]);
+    if (metrics[k] == NULL)
+      {
+      writer->printf("Error: metric '%s' not found\n", argv[k]);
+      return;
+      }
+    }
+  MyRE->SetBitsMetrics(argc, metrics);
+  if (argc == 0)
+    writer->puts("Cleared correlation metrics");
+  else
+    writer->printf("Correlating %d metric(s)\n", argc);
+  }
+
+void re_bits_list(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (!MyRE)
+    {
+    writer->puts("Error: RE tools not running");
+    return;
+    }
+
+  OvmsRecMutexLock lock(&MyRE->m_mutex);
+  re_record_list_t list;
+  MyRE->GetRecordList(list, (argc>0) ? argv[0] : NULL);
+  for (re_record_list_t::iterator it=list.begin(); it!=list.end(); ++it)
+    {
+    re_bitstats* bs = it->second->bits;
+    if (bs == NULL || bs->m_samples == 0) continue;
+
+    char map[72];
+    bs->GetFlipMap(map);
+    writer->printf("%-20s %10" PRIu32 " %s\n", it->first.c_str(), bs->m_samples, map);
+
+    re_field_t fields[32];
+    int cnt = bs->GetFields(fields, 32);
+    for (int k=0; k<cnt; k++)
+      {
+      int start = (fields[k].start/8)*8 + 7 - (fields[k].start%8);
+      writer->printf("  %2d|%-2d@0+ %s\n", start, fields[k].length,
+        re_bitstats::GetFieldTypeName(fields[k].type));
+      }
+
+    for (int m=0; m<MyRE->m_bits_metric_count; m++)
+      {
+      int best = -1;
+      float bestr = 0;
+      for (int c=0; c<RE_BITS_CANDIDATES; c++)
+        {
+        float r = bs->GetCorrelation(c, m);
+        if (fabsf(r) > fabsf(bestr))
+          {
+          best = c;
+          bestr = r;
+          }
+        }
+      if (best >= 0)
+        {
+        char name[16];
+        writer->printf("  %-10s r=%+.3f %s\n", re_bitstats::GetCandidateName(best, name),
+          bestr, MyRE->m_bits_metrics[m]->m_name);
+        }
+      }
+    }
+  }
+
+void re_bits_correlation(int verbosity, OvmsWriter* writer, OvmsCommand* cmd, int argc, const char* const* argv)
+  {
+  if (!MyRE)
+    {
+    writer->puts("Error: RE tools not running");
+    return;
+    }
+
+  OvmsRecMutexLock lock(&MyRE->m_mutex);
+  if (MyRE->m_bits_metric_count == 0)
+    {
+    writer->puts("Error: no correlation metrics set");
+    return;
+    }
+
+  int top = (argc > 0) ? atoi(argv[0]) : 20;
+  float minr = (argc > 1) ? atof(argv[1]) : 0.5;
+
+  struct corr_t { float r; int c; int m; std::string key; };
+  std::vector<corr_t> results;
+  re_record_list_t list;
+  MyRE->GetRecordList(list);
+  for (re_record_list_t::iterator it=list.begin(); it!=list.end(); ++it)
+    {
+    re_bitstats* bs = it->second->bits;
+    if (bs == NULL) continue;
+    for (int m=0; m<MyRE->m_bits_metric_count; m++)
+      {
+      for (int c=0; c<RE_BITS_CANDIDATES; c++)
+        {
+        float r = bs->GetCorrelation(c, m);
+        if (fabsf(r) >= minr)
+          results.push_back({ r, c, m, it->first });
+        }
+      }
+    }
+
+  std::sort(results.begin(), results.end(),
+    [](const corr_t& a, const corr_t& b) { return fabsf(a.r) > fabsf(b.r); });
+
+  writer->printf("%-20.20s %-10s %7s %s\n", "key", "field", "r", "metric");
+  char name[16];
+  for (int k=0; k<(int)results.size() && k<top; k++)
+    {
+    writer->printf("%-20s %-10s %+7.3f %s\n", results[k].key.c_str(),
+      re_bitstats::GetCandidateName(results[k].c, name), results[k].r,
+      MyRE->m_bits_metrics[results[k].m]->m_name);
+    }
+  if (results.size() == 0)
+    writer->puts("No correlations found (yet)");
+  }
+
+class REBitsInit
+  {
+  public: REBitsInit();
+} REBitsInit  __attribute__ ((init_priority (8810)));
+
+REBitsInit::REBitsInit()
+  {
+  ESP_LOGI(TAG, "Initialising RE Tools bit analysis (8810)");
+
+  OvmsCommand* cmd_re = MyCommandApp.FindCommand("re");
+  if (cmd_re == NULL)
+    {
+    ESP_LOGE(TAG,"Cannot find RE command - aborting bits command registration");
+    return;
+    }
+
+  OvmsCommand* cmd_bits = cmd_re->RegisterCommand("bits","RE bit level analysis framework");
+  cmd_bits->RegisterCommand("on","Enable bit level analysis",re_bits_on,"[<max_records>]", 0, 1);
+  cmd_bits->RegisterCommand("off","Disable bit level analysis",re_bits_off);
+  cmd_bits->RegisterCommand("metrics","Set metrics to correlate",re_bits_metrics,
+    "[<metric1>] ... [<metric4>]\n"
+    "Example: v.p.speed v.b.soc v.b.current", 0, RE_BITS_METRICS);
+  cmd_bits->RegisterCommand("list","List bit statistics & candidate fields",re_bits_list, "[<filter>]", 0, 1);
+  cmd_bits->RegisterCommand("correlation","List top field/metric correlations",re_bits_correlation,
+    "[<top>] [<min_r>]", 0, 2);
+  }
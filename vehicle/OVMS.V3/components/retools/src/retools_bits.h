@@ -0,0 +1,118 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Date:          14th March 2017
+;
+;    Changes:
+;    1.0  Initial release
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011        Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+#ifndef __RETOOLS_BITS_H__
+#define __RETOOLS_BITS_H__
+
+#include <stdint.h>
+#include "can.h"
+#include "ovms.h"
+
+/**
+ * re_bitstats: bit level change statistics for one RE record
+ *
+ * Collected incrementally by the RE task for each (ID, mux) record while the
+ * bit analysis is enabled ("re bits on"). Memory per record is fixed, the
+ * number of records analysed is limited by the configured maximum.
+ *
+ * Bit positions are counted in Motorola (big endian) order, position 0 being
+ * the MSB of byte 0 and position 63 the LSB of byte 7. Candidate signal
+ * boundaries are derived from the flip rate magnitudes along that order (a
+ * numeric signal flips more often towards its LSB).
+ *
+ * Correlation of fixed candidate fields (all bytes and aligned 16 bit words
+ * in both byte orders) against up to RE_BITS_METRICS metrics is done online
+ * using Welford's algorithm.
+ */
+
+#define RE_BITS_METRICS       4       // Max number of metrics to correlate
+#define RE_BITS_CANDIDATES    22      // u8 x 8, u16 big endian x 7, u16 little endian x 7
+#define RE_BITS_MINSAMPLES    16      // Minimum number of samples for a classification
+
+typedef enum
+  {
+  RE_FIELD_Signal = 0,                // Plain changing bits
+  RE_FIELD_Counter,                   // Monotonic (wrapping) counter
+  RE_FIELD_ChecksumXor,               // XOR of all other bytes
+  RE_FIELD_ChecksumSum,               // Sum of all other bytes
+  RE_FIELD_ChecksumCrc8               // CRC8 SAE J1850 over all other bytes
+  } re_field_type_t;
+
+typedef struct
+  {
+  uint8_t start;                      // Motorola bit position of the MSB
+  uint8_t length;                     // Field length in bits
+  re_field_type_t type;
+  } re_field_t;
+
+class re_bitstats : public ExternalRamAllocated
+  {
+  public:
+    re_bitstats();
+    ~re_bitstats();
+
+  public:
+    void Clear();
+    void ClearCorrelation();
+    void Update(const CAN_frame_t* last, const CAN_frame_t* frame);
+    void UpdateCorrelation(const CAN_frame_t* frame, const float* mvalues, int mcount);
+
+  public:
+    int GetFields(re_field_t* fields, int max);
+    void GetFlipMap(char* buffer);
+    float GetCorrelation(int candidate, int metric);
+    static const char* GetCandidateName(int candidate, char* buffer);
+    static const char* GetFieldTypeName(re_field_type_t type);
+
+  protected:
+    int GetMagnitude(int pos);
+    re_field_type_t GetByteType(int byte);
+    static uint32_t GetCandidateValue(const CAN_frame_t* frame, int candidate);
+
+  public:
+    uint32_t m_samples;               // Number of frame pairs compared
+    uint8_t m_dlc;                    // Max DLC seen
+    uint32_t m_flips[64];             // Flip counts per bit position
+    uint8_t m_cnt_delta[24];          // Last counter delta: bytes 0-7, high nibbles, low nibbles
+    uint32_t m_cnt_hits[24];          // Frames matching the counter delta
+    uint32_t m_xor_hits[8];           // Frames matching the XOR checksum per byte
+    uint32_t m_sum_hits[8];           // Frames matching the sum checksum per byte
+    uint32_t m_crc_hits[8];           // Frames matching the CRC8 checksum per byte
+
+  public:
+    uint32_t m_corr_n;                // Number of correlation samples
+    float m_xmean[RE_BITS_CANDIDATES];
+    float m_xm2[RE_BITS_CANDIDATES];
+    float m_ymean[RE_BITS_METRICS];
+    float m_ym2[RE_BITS_METRICS];
+    float m_cxy[RE_BITS_CANDIDATES][RE_BITS_METRICS];
+  };
+
+#endif //#ifndef __RETOOLS_BITS_H__
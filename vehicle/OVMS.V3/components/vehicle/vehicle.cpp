@@ -121,24 +121,24 @@ OvmsVehicleFactory::OvmsVehicleFactory()
       "request", "Send OBD2/UDS request, output response");
     cmd_obdreq->RegisterCommand(
       "device", "Send OBD2/ISOTP request to a device", obdii_request,
-      "[-e|-E|-v] [-t<timeout_ms>] <txid> <rxid> <request>\n"
+      "[-e|-E|-v] [-t<timeout_ms>] [-a<max_age_ms>] <txid> <rxid> <request>\n"
       "Give <txid> and <rxid> as hexadecimal CAN IDs,"
       " add -e to use ISO-TP extended addressing (19 bit IDs via standard frames)\n"
       " or -E to use ISO-TP via extended frames (29 bit IDs)\n"
       " or -v to use VW-TP 2.0 (VW/VAG specific transport protocol, txid=200, rxid=ECUID).\n"
       "<request> is the hex string of the request type + arguments,"
       " e.g. '223a4b' = read data from PID 0x3a4b.\n"
-      "Default timeout is 3000 ms.",
-      3, 5);
+      "Default timeout is 3000 ms. Add -a to accept a cached response up to <max_age_ms> old.",
+      3, 6);
     cmd_obdreq->RegisterCommand(
       "broadcast", "Send OBD2/UDS request as broadcast", obdii_request,
-      "[-t<timeout_ms>] <request>\n"
+      "[-t<timeout_ms>] [-a<max_age_ms>] <request>\n"
       "Sends the request to broadcast ID 7df, listens on IDs 7e8-7ef.\n"
       "Note: only the first response will be shown, enable CAN log to check for more.\n"
       "<request> is the hex string of the request type + arguments,"
       " e.g. '223a4b' = read data from PID 0x3a4b.\n"
-      "Default timeout is 3000 ms.",
-      1, 2);
+      "Default timeout is 3000 ms. Add -a to accept a cached response up to <max_age_ms> old.",
+      1, 3);
     }
 
 
@@ -360,6 +360,7 @@ OvmsVehicle::OvmsVehicle()
 #ifdef CONFIG_OVMS_COMP_POLLER
   m_poll_state = 0;
   m_pollsignal = nullptr;
+  m_poll_reassemble = false;
 
   // Poll parameters.
   PollSetThrottling(1);
@@ -446,30 +447,43 @@ OvmsVehicle::OvmsVehicle()
 
   MyMetrics.RegisterListener(TAG, "*", std::bind(&OvmsVehicle::MetricModified, this, _1));
 
+  m_vqueue = nullptr;
+  m_vtask = nullptr;
 #ifdef CONFIG_OVMS_COMP_POLLER
-
-  MyPollers.RegisterFrameRx(TAG, std::bind(&OvmsVehicle::IncomingRxFrame, this, _1));
+  // Frames are passed to the IncomingFrameCanN() handlers by the poller task
+  // (single RX pipeline). The separate vehicle task with its own listener
+  // queue is kept as a compatibility option.
+  bool separate = (MyConfig.GetParamValue("vehicle", "can.pipeline", "unified") == "separate");
+  if (separate)
+    ESP_LOGI(TAG, "CAN RX pipeline: separate vehicle task");
+  else
+    MyPollers.SetFrameStage(std::bind(&OvmsVehicle::IncomingFrameStage, this, _1));
 #else
-
-  m_vqueue = xQueueCreate(CONFIG_OVMS_VEHICLE_CAN_RX_QUEUE_SIZE,sizeof(CAN_frame_t));
-  xTaskCreatePinnedToCore(OvmsVehicleTask, "OVMS Vehicle Poll",
-      CONFIG_OVMS_VEHICLE_RXTASK_STACK, (void*)this, 10, &m_vtask, CORE(1));
-  MyCan.RegisterListener(m_vqueue);
+  bool separate = true;
   for (int idx = 0; idx < VEHICLE_MAXBUSSES; ++idx)
     m_autopoweroff[idx] = false;
 #endif
+
+  if (separate)
+    {
+    m_vqueue = xQueueCreate(CONFIG_OVMS_VEHICLE_CAN_RX_QUEUE_SIZE,sizeof(CAN_frame_t));
+    xTaskCreatePinnedToCore(OvmsVehicleTask, "OVMS Vehicle Poll",
+        CONFIG_OVMS_VEHICLE_RXTASK_STACK, (void*)this, 10, &m_vtask, CORE(1));
+    MyCan.RegisterListener(m_vqueue);
+    }
   }
 
 OvmsVehicle::~OvmsVehicle()
   {
-#ifndef CONFIG_OVMS_COMP_POLLER
   auto vtask = Atomic_GetAndNull(m_vtask);
   if (vtask)
     vTaskDelete(vtask);
 
-  vQueueDelete(m_vqueue);
-  m_vqueue = nullptr;
-#endif
+  if (m_vqueue)
+    {
+    vQueueDelete(m_vqueue);
+    m_vqueue = nullptr;
+    }
 
   if (m_bms_voltages != NULL)
     {
@@ -542,18 +556,21 @@ void OvmsVehicle::ShuttingDown()
   MyPollers.ShuttingDownVehicle();
   MyPollers.DeregisterRunFinished(TAG);
   MyPollers.DeregisterPollStateTicker(TAG);
-  MyPollers.DeregisterFrameRx(TAG);
+  MyPollers.SetFrameStage(nullptr);
 
   if (m_pollsignal)
     delete m_pollsignal;
-#else
-  MyCan.DeregisterListener(m_vqueue);
-  CAN_frame_t entry;
-  entry.origin = nullptr;
-  entry.callback = nullptr;
-  entry.MsgID = 0;
-  xQueueSendToFront(m_vqueue, &entry, 0);
-
+#endif
+  if (m_vqueue)
+    {
+    MyCan.DeregisterListener(m_vqueue);
+    CAN_frame_t entry;
+    entry.origin = nullptr;
+    entry.callback = nullptr;
+    entry.MsgID = 0;
+    xQueueSendToFront(m_vqueue, &entry, 0);
+    }
+#ifndef CONFIG_OVMS_COMP_POLLER
   if (MyConfig.GetParamValueBool("vehicle", "can.autooff", true))
     {
     if (m_can1 && m_autopoweroff[0]) m_can1->SetPowerMode(Off);
@@ -574,6 +591,10 @@ bool OvmsVehicle::IsShutdown()
   if (Atomic_Get(m_vqueue) != nullptr) {
     return false;
   }
+#else
+  if (Atomic_Get(m_vtask) != nullptr) {
+    return false;
+  }
 #endif
   return true;
   }
@@ -640,6 +661,17 @@ void OvmsVehicle::OvmsVehicleSignal::IncomingPollTxCallback(const OvmsPoller::po
     m_parent->IncomingPollTxCallback(job, success);
   }
 
+bool OvmsVehicle::OvmsVehicleSignal::PollReassemble() const
+  {
+  return m_parent->m_poll_reassemble;
+  }
+
+void OvmsVehicle::OvmsVehicleSignal::IncomingPollResponse(const OvmsPoller::poll_job_t &job, const uint8_t* data, uint16_t length)
+  {
+  if (Ready())
+    m_parent->IncomingPollResponse(job, data, length);
+  }
+
 bool OvmsVehicle::OvmsVehicleSignal::Ready() const
   {
   return m_parent->m_ready;
@@ -2526,7 +2558,7 @@ void OvmsVehicle::PollSetState(uint8_t state, canbus* bus)
 #ifdef CONFIG_OVMS_COMP_POLLER
 int OvmsVehicle::PollSingleRequest(canbus* bus, uint32_t txid, uint32_t rxid,
                 std::string request, std::string& response,
-                int timeout_ms, uint8_t protocol)
+                int timeout_ms, uint8_t protocol, int max_age_ms)
   {
 
   if (!m_ready)
@@ -2534,19 +2566,19 @@ int OvmsVehicle::PollSingleRequest(canbus* bus, uint32_t txid, uint32_t rxid,
   auto poller = MyPollers.GetPoller(bus, true);
   if (!poller)
     return POLLSINGLE_TXFAILURE;
-  return poller->PollSingleRequest(txid, rxid, request, response, timeout_ms, protocol);
+  return poller->PollSingleRequest(txid, rxid, request, response, timeout_ms, protocol, max_age_ms);
   }
 
 int OvmsVehicle::PollSingleRequest(canbus* bus, uint32_t txid, uint32_t rxid,
                 uint8_t polltype, uint16_t pid, std::string& response,
-                int timeout_ms, uint8_t protocol)
+                int timeout_ms, uint8_t protocol, int max_age_ms)
   {
   if (!m_ready)
     return POLLSINGLE_TXFAILURE;
   auto poller = MyPollers.GetPoller(bus, true);
   if (!poller)
     return POLLSINGLE_TXFAILURE;
-  return poller->PollSingleRequest(txid, rxid, polltype, pid, response, timeout_ms, protocol);
+  return poller->PollSingleRequest(txid, rxid, polltype, pid, response, timeout_ms, protocol, max_age_ms);
   }
 
 /** Set the 'tick' interval for the poller.
@@ -2572,6 +2604,10 @@ void OvmsVehicle::PollSetTimeBetweenSuccess(uint16_t time_between_ms)
   {
   MyPollers.PollSetTimeBetweenSuccess(time_between_ms);
   }
+void OvmsVehicle::PollSetResponseReassembly(bool enable)
+  {
+  m_poll_reassemble = enable;
+  }
 
 /**
  * IncomingPollReply: poll response handler (stub, override with vehicle implementation)
@@ -2590,6 +2626,24 @@ void OvmsVehicle::IncomingPollReply(const OvmsPoller::poll_job_t &job, uint8_t*
   {
   }
 
+/**
+ * IncomingPollResponse: complete poll response handler (stub, override with vehicle implementation)
+ *  This is called instead of IncomingPollReply() after PollSetResponseReassembly(true),
+ *  once per response with the complete payload. Multi frame responses are collected
+ *  by the poller in a pooled buffer sized by the first frame, single frame responses
+ *  are passed without a copy. The data is only valid during the call.
+ *
+ *  @param job
+ *    Status of the current Poll job (as of the last frame)
+ *  @param data
+ *    Complete payload
+ *  @param length
+ *    Payload size
+ */
+void OvmsVehicle::IncomingPollResponse(const OvmsPoller::poll_job_t &job, const uint8_t* data, uint16_t length)
+  {
+  }
+
 /**
  * IncomingPollError: Calls Vehicle poll response error handler
  *  This is called by PollerReceive() on reception of an OBD/UDS Negative Response Code (NRC),
@@ -2624,12 +2678,6 @@ void OvmsVehicle::IncomingPollTxCallback(const OvmsPoller::poll_job_t &job, bool
 
 #endif
 
-#ifdef CONFIG_OVMS_COMP_POLLER
-void OvmsVehicle::IncomingRxFrame(const CAN_frame_t &frame)
-  {
-  SendIncomingFrame(&frame);
-  }
-#else
 void OvmsVehicle::OvmsVehicleTask(void *pvParameters)
   {
   OvmsVehicle *me = (OvmsVehicle*)pvParameters;
@@ -2645,28 +2693,43 @@ void OvmsVehicle::VehicleTask()
     if (xQueueReceive(m_vqueue, &entry, (portTickType)portMAX_DELAY)!=pdTRUE)
       continue;
     if (entry.origin != nullptr )
+      {
+#ifdef CONFIG_OVMS_COMP_POLLER
+      int64_t start = esp_timer_get_time();
+      SendIncomingFrame(&entry);
+      MyPollers.AddPipelineTime(OvmsPollers::pipe_Vehicle, esp_timer_get_time() - start);
+#else
       SendIncomingFrame(&entry);
+#endif
+      }
     }
   auto vtask = Atomic_GetAndNull(m_vtask);
   if (vtask)
     vTaskDelete(vtask);
   vTaskSuspend(nullptr);
   }
-#endif
 
 void OvmsVehicle::SendIncomingFrame(const CAN_frame_t *frame)
+  {
+  // Pass a copy to the standard handlers:
+  CAN_frame_t tmp_frame = *frame;
+  IncomingFrameStage(&tmp_frame);
+  }
+
+/**
+ * IncomingFrameStage: pass frame to the standard handlers
+ *  Called in place by the poller task for the single RX pipeline.
+ */
+void OvmsVehicle::IncomingFrameStage(CAN_frame_t *frame)
   {
   if (!m_ready)
     return;
 
   auto bus = frame->origin;
-
-  // Pass frame to standard handlers:
-  CAN_frame_t tmp_frame = *frame;
-  if (m_can1 == bus) IncomingFrameCan1(&tmp_frame);
-  else if (m_can2 == bus) IncomingFrameCan2(&tmp_frame);
-  else if (m_can3 == bus) IncomingFrameCan3(&tmp_frame);
-  else if (m_can4 == bus) IncomingFrameCan4(&tmp_frame);
+  if (m_can1 == bus) IncomingFrameCan1(frame);
+  else if (m_can2 == bus) IncomingFrameCan2(frame);
+  else if (m_can3 == bus) IncomingFrameCan3(frame);
+  else if (m_can4 == bus) IncomingFrameCan4(frame);
   }
 
 #ifdef CONFIG_OVMS_COMP_POLLER
@@ -93,10 +93,11 @@ struct DashboardConfig;
 //   { 0x200, 0x1f,  0x10,   0x89,  {…times…},    0,  VWTP_20 }
 //   { 0x200, 0x1f,  0x22, 0x04a1,  {…times…},    0 , VWTP_20 }
 // 
-// VW gateways currently do not support multiple open channels. To minimize connection
-// overhead for successive polls to an ECU, the VWTP_20 engine keeps an idle connection open
-// until the keepalive timeout occurs. So you should try to arrange your polls in interval
-// blocks/sequences to the same devices if possible.
+// By default, only one channel is open at a time. To minimize connection overhead for
+// successive polls to an ECU, the VWTP_20 engine keeps an idle connection open until the
+// keepalive timeout occurs. So you should try to arrange your polls in interval
+// blocks/sequences to the same devices if possible. If the gateway supports multiple
+// channels, PollSetChannelPool() keeps the channels to other modules open as well.
 // 
 // To explicitly close a VWTP_20 channel, send a poll (any type) to RXID 0, that just
 // closes the channel (ECU ID 0 is an invalid destination):
@@ -274,10 +275,10 @@ class OvmsVehicle : public InternalRamAllocated
 
     int PollSingleRequest(canbus* bus, uint32_t txid, uint32_t rxid,
                       std::string request, std::string& response,
-                      int timeout_ms=3000, uint8_t protocol=ISOTP_STD);
+                      int timeout_ms=3000, uint8_t protocol=ISOTP_STD, int max_age_ms=0);
     int PollSingleRequest(canbus* bus, uint32_t txid, uint32_t rxid,
                       uint8_t polltype, uint16_t pid, std::string& response,
-                      int timeout_ms=3000, uint8_t protocol=ISOTP_STD);
+                      int timeout_ms=3000, uint8_t protocol=ISOTP_STD, int max_age_ms=0);
 
     // Poller configuration
 
@@ -286,10 +287,43 @@ class OvmsVehicle : public InternalRamAllocated
       MyPollers.PollSetThrottling(sequence_max);
       }
     void PollSetTicker(uint16_t tick_time_ms, uint8_t secondary_ticks = 0);
+    void PollSetIntervalUnit(uint16_t unit_ms)
+      {
+      MyPollers.PollSetIntervalUnit(unit_ms);
+      }
+    void PollSetConcurrency(uint8_t max_requests)
+      {
+      MyPollers.PollSetConcurrency(max_requests);
+      }
+    void PollSetBatch(uint32_t txid, uint32_t rxid, uint8_t max_dids, const OvmsPoller::poll_did_length_t* lengths)
+      {
+      MyPollers.PollSetBatch(txid, rxid, max_dids, lengths);
+      }
+    void PollSetAdaptive(uint8_t max_factor)
+      {
+      MyPollers.PollSetAdaptive(max_factor);
+      }
+    void PollSetFlowControlAdaptive(bool adaptive)
+      {
+      MyPollers.PollSetFlowControlAdaptive(adaptive);
+      }
+    void PollSetChannelPool(uint8_t channels)
+      {
+      MyPollers.PollSetChannelPool(channels);
+      }
+    void PollSetFairScheduling(uint16_t latency_ms)
+      {
+      MyPollers.PollSetFairScheduling(latency_ms);
+      }
+    void PollSetSeriesWeight(canbus* bus, const std::string &name, uint8_t weight)
+      {
+      MyPollers.PollSetSeriesWeight(bus, name, weight);
+      }
 
     void PollSetResponseSeparationTime(uint8_t septime);
     void PollSetChannelKeepalive(uint16_t keepalive_seconds);
     void PollSetTimeBetweenSuccess(uint16_t tick_between_ms);
+    void PollSetResponseReassembly(bool enable);
 #endif
 
     uint8_t GetBusNo(canbus* bus);
@@ -547,6 +581,9 @@ class OvmsVehicle : public InternalRamAllocated
       void IncomingPollError(const OvmsPoller::poll_job_t &job, uint16_t code) override;
       void IncomingPollTxCallback(const OvmsPoller::poll_job_t &job, bool success) override;
 
+      bool PollReassemble() const override;
+      void IncomingPollResponse(const OvmsPoller::poll_job_t &job, const uint8_t* data, uint16_t length) override;
+
       bool Ready() const override;
     };
 #endif
@@ -561,6 +598,9 @@ class OvmsVehicle : public InternalRamAllocated
     virtual void IncomingPollReply(const OvmsPoller::poll_job_t &job, uint8_t* data, uint8_t length);
     virtual void IncomingPollError(const OvmsPoller::poll_job_t &job, uint16_t code);
     virtual void IncomingPollTxCallback(const OvmsPoller::poll_job_t &job, bool success);
+    virtual void IncomingPollResponse(const OvmsPoller::poll_job_t &job, const uint8_t* data, uint16_t length);
+
+    bool              m_poll_reassemble;      // Deliver complete responses to IncomingPollResponse()
 #endif
 
   protected:
@@ -569,17 +609,18 @@ class OvmsVehicle : public InternalRamAllocated
     uint8_t           m_poll_state;           // Current poll state
     void PollRequest(canbus* bus, const std::string &name, const std::shared_ptr<OvmsPoller::PollSeriesEntry> &series);
     void RemovePollRequest(canbus* bus, const std::string &name);
-    void IncomingRxFrame(const CAN_frame_t &frame);
 #else
-    // These are required in lieu of using the OvmsPoller queue.
+    bool m_autopoweroff[VEHICLE_MAXBUSSES];
+#endif
+    // These are required in lieu of using the OvmsPoller queue
+    // (no poller, or config vehicle can.pipeline=separate):
     static void OvmsVehicleTask(void *pvParameters);
     void VehicleTask();
     QueueHandle_t m_vqueue;
     TaskHandle_t  m_vtask;
 
-    bool m_autopoweroff[VEHICLE_MAXBUSSES];
-#endif
     void SendIncomingFrame(const CAN_frame_t *frame);
+    void IncomingFrameStage(CAN_frame_t *frame);
 
   // BMS helpers
   protected:
@@ -390,6 +390,7 @@ duk_ret_t OvmsVehicleFactory::DukOvmsVehicleStopCooldown(duk_context *ctx)
  *      [bus: <string>,]                  // default: "can1"
  *      [timeout: <int>,]                 // in ms, default: 3000
  *      [protocol: <int>,]                // default: 0 = ISOTP_STD, see vehicle.h
+ *      [maxage: <int>,]                  // in ms, accept a cached response up to this age, default: 0
  *    });
  * 
  *    obdResult = {
@@ -409,6 +410,7 @@ duk_ret_t OvmsVehicleFactory::DukOvmsVehicleObdRequest(duk_context *ctx)
   uint32_t txid = 0, rxid = 0;
   std::string request, response;
   int timeout = 3000;
+  int maxage = 0;
 #ifdef CONFIG_OVMS_COMP_POLLER
   uint8_t protocol = ISOTP_STD;
 #endif
@@ -432,6 +434,9 @@ duk_ret_t OvmsVehicleFactory::DukOvmsVehicleObdRequest(duk_context *ctx)
     if (duk_get_prop_string(ctx, 0, "timeout"))
       timeout = duk_to_int(ctx, -1);
     duk_pop(ctx);
+    if (duk_get_prop_string(ctx, 0, "maxage"))
+      maxage = duk_to_int(ctx, -1);
+    duk_pop(ctx);
 #ifdef CONFIG_OVMS_COMP_POLLER
     if (duk_get_prop_string(ctx, 0, "protocol"))
       protocol = duk_to_int(ctx, -1);
@@ -470,7 +475,7 @@ duk_ret_t OvmsVehicleFactory::DukOvmsVehicleObdRequest(duk_context *ctx)
       errordesc = "Missing mandatory argument";
       }
     else if (device == NULL || (txid <= 0 || (txid != 0x7df && rxid <= 0) ||
-        request.size() == 0) || timeout <= 0)
+        request.size() == 0) || timeout <= 0 || maxage < 0)
       {
       error = -1003;
       errordesc = "Invalid argument";
@@ -481,7 +486,7 @@ duk_ret_t OvmsVehicleFactory::DukOvmsVehicleObdRequest(duk_context *ctx)
       {
 #ifdef CONFIG_OVMS_COMP_POLLER
       error = MyVehicleFactory.m_currentvehicle->PollSingleRequest(
-        device, txid, rxid, request, response, timeout, protocol);
+        device, txid, rxid, request, response, timeout, protocol, maxage);
 
       if (error == POLLSINGLE_TXFAILURE)
         errordesc = "Transmission failure (CAN bus error)";
@@ -594,6 +594,7 @@ void OvmsVehicleFactory::obdii_request(int verbosity, OvmsWriter* writer, OvmsCo
   uint32_t txid = 0, rxid = 0;
   uint8_t protocol = ISOTP_STD;
   int timeout_ms = 3000;
+  int max_age_ms = 0;
   std::string request;
   std::string response;
 
@@ -601,7 +602,7 @@ void OvmsVehicleFactory::obdii_request(int verbosity, OvmsWriter* writer, OvmsCo
   const char* target = cmd->GetName();
   if (strcmp(target, "device") == 0)
     {
-    // device: [-e|-E|-v] [-t<timeout_ms>] txid rxid request
+    // device: [-e|-E|-v] [-t<timeout_ms>] [-a<max_age_ms>] txid rxid request
     int argpos = 0;
     for (int i = 0; i < argc; i++)
       {
@@ -621,6 +622,9 @@ void OvmsVehicleFactory::obdii_request(int verbosity, OvmsWriter* writer, OvmsCo
           case 't':
             timeout_ms = atoi(argv[i]+2);
             break;
+          case 'a':
+            max_age_ms = atoi(argv[i]+2);
+            break;
           default:
             writer->printf("ERROR: unknown option '%s'\n", argv[i]);
             return;
@@ -653,7 +657,7 @@ void OvmsVehicleFactory::obdii_request(int verbosity, OvmsWriter* writer, OvmsCo
     }
   else
     {
-    // broadcast: [-t<timeout_ms>] request
+    // broadcast: [-t<timeout_ms>] [-a<max_age_ms>] request
     int argpos = 0;
     for (int i = 0; i < argc; i++)
       {
@@ -664,6 +668,9 @@ void OvmsVehicleFactory::obdii_request(int verbosity, OvmsWriter* writer, OvmsCo
           case 't':
             timeout_ms = atoi(argv[i]+2);
             break;
+          case 'a':
+            max_age_ms = atoi(argv[i]+2);
+            break;
           default:
             writer->printf("ERROR: unknown option '%s'\n", argv[i]);
             return;
@@ -715,7 +722,7 @@ void OvmsVehicleFactory::obdii_request(int verbosity, OvmsWriter* writer, OvmsCo
 
   // execute request:
   int err = MyVehicleFactory.m_currentvehicle->PollSingleRequest(bus, txid, rxid,
-    request, response, timeout_ms, protocol);
+    request, response, timeout_ms, protocol, max_age_ms);
 
   writer->printf("%" PRIx32 "[%" PRIx32 "] %s: ", txid, rxid, hexencode(request).c_str());
   if (err == POLLSINGLE_TXFAILURE)
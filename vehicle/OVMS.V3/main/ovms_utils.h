@@ -715,7 +715,7 @@ class ovms_callback_register_t
       {
       Register(nametag, nullptr);
       }
-    typedef std::function<void (const std::string &nametag, FN callback)> visit_fn_t;
+    typedef std::function<void (const std::string &nametag, const FN &callback)> visit_fn_t;
     void Call(visit_fn_t visit)
       {
       for (auto it = m_list.begin(); it != m_list.end(); ++it)
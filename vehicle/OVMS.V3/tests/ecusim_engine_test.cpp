@@ -0,0 +1,391 @@
+/*
+;    Project:       Open Vehicle Monitor System
+;    Module:        ECU simulator engine host test
+;    Date:          18th October 2026
+;
+;    (C) 2011       Michael Stegen / Stegen Electronics
+;    (C) 2011-2017  Mark Webb-Johnson
+;    (C) 2011        Sonny Chen @ EPRO/DX
+;
+; Permission is hereby granted, free of charge, to any person obtaining a copy
+; of this software and associated documentation files (the "Software"), to deal
+; in the Software without restriction, including without limitation the rights
+; to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+; copies of the Software, and to permit persons to whom the Software is
+; furnished to do so, subject to the following conditions:
+;
+; The above copyright notice and this permission notice shall be included in
+; all copies or substantial portions of the Software.
+;
+; THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+; IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+; FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+; AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+; LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+; OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+; THE SOFTWARE.
+*/
+
+/**
+ * Host test of the EcuSimEngine protocol logic, build & run from this directory:
+ *
+ *  g++ -std=gnu++11 -Wall -Wextra -I../components/ecusim/src -I../components/vehicle \
+ *    ../components/ecusim/src/ecusim_engine.cpp ecusim_engine_test.cpp -o ecusim_engine_test
+ *  ./ecusim_engine_test
+ *
+ * Exits with status 1 if a check fails.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "ecusim_engine.h"
+
+static int checks = 0;
+static int failures = 0;
+
+#define CHECK(cond) \
+  do { \
+    checks++; \
+    if (!(cond)) \
+      { \
+      failures++; \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+      } \
+  } while (0)
+
+static ecusim_frame_t Frame(uint32_t id, std::vector<uint8_t> data, bool ext=false)
+  {
+  ecusim_frame_t frame = {};
+  frame.id = id;
+  frame.ext = ext;
+  frame.dlc = data.size();
+  memcpy(frame.data, data.data(), data.size());
+  return frame;
+  }
+
+static bool Match(const ecusim_output_t& output, uint32_t id, std::vector<uint8_t> data)
+  {
+  return output.frame.id == id
+    && output.frame.dlc == data.size()
+    && memcmp(output.frame.data, data.data(), data.size()) == 0;
+  }
+
+static bool Load(EcuSimEngine& engine, const char* script)
+  {
+  std::string error;
+  if (!engine.Load(script, error))
+    {
+    printf("script error: %s\n", error.c_str());
+    return false;
+    }
+  return true;
+  }
+
+static void TestSingleFrame()
+  {
+  EcuSimEngine engine;
+  CHECK(Load(engine,
+    "ecu bms 79b 7bb\n"
+    "delay 3\n"
+    "req 2101 610102\n"));
+  ecusim_outputs_t out;
+
+  // Frames of other IDs are not handled:
+  CHECK(!engine.Receive(Frame(0x7e0, { 0x02, 0x21, 0x01, 0, 0, 0, 0, 0 }), 0, out));
+  CHECK(out.empty());
+
+  CHECK(engine.Receive(Frame(0x79b, { 0x02, 0x21, 0x01, 0, 0, 0, 0, 0 }), 1000, out));
+  CHECK(out.size() == 1);
+  if (out.size() == 1)
+    {
+    CHECK(out[0].due == 1000 + 3000);
+    CHECK(Match(out[0], 0x7bb, { 0x03, 0x61, 0x01, 0x02, 0x55, 0x55, 0x55, 0x55 }));
+    }
+  CHECK(engine.m_ecus[0].requests == 1);
+  CHECK(engine.m_ecus[0].responses == 1);
+  CHECK(engine.m_ecus[0].rules[0].hits == 1);
+  }
+
+static void TestMultiFrameResponse()
+  {
+  EcuSimEngine engine;
+  CHECK(Load(engine,
+    "ecu bms 79b 7bb\n"
+    "req 2102 6102+20\n"));
+  ecusim_outputs_t out;
+  EcuSimEngine::ecu_t& ecu = engine.m_ecus[0];
+
+  // 22 bytes: first frame + 3 consecutive frames
+  engine.Receive(Frame(0x79b, { 0x02, 0x21, 0x02, 0, 0, 0, 0, 0 }), 0, out);
+  CHECK(out.size() == 1);
+  if (out.size() == 1)
+    CHECK(Match(out[0], 0x7bb, { 0x10, 0x16, 0x61, 0x02, 0x00, 0x01, 0x02, 0x03 }));
+  CHECK(ecu.txwait);
+
+  // Flow control BS=2 STmin=5 ms: two frames, 5 ms apart, then wait:
+  out.clear();
+  engine.Receive(Frame(0x79b, { 0x30, 0x02, 0x05, 0, 0, 0, 0, 0 }), 10000, out);
+  CHECK(out.size() == 2);
+  if (out.size() == 2)
+    {
+    CHECK(out[0].frame.data[0] == 0x21);
+    CHECK(out[1].frame.data[0] == 0x22);
+    CHECK(out[0].due == 10000);
+    CHECK(out[1].due == 15000);
+    }
+  CHECK(ecu.txwait);
+
+  // Flow control STmin=f5 (500 us), BS=0: the rest
+  out.clear();
+  engine.Receive(Frame(0x79b, { 0x30, 0x00, 0xf5, 0, 0, 0, 0, 0 }), 20000, out);
+  CHECK(out.size() == 1);
+  if (out.size() == 1)
+    CHECK(Match(out[0], 0x7bb, { 0x23, 0x12, 0x13, 0x55, 0x55, 0x55, 0x55, 0x55 }));
+  CHECK(!ecu.txwait);
+  CHECK(ecu.txbuf.empty());
+
+  // Flow control without a transfer in progress is ignored:
+  out.clear();
+  engine.Receive(Frame(0x79b, { 0x30, 0x00, 0x00, 0, 0, 0, 0, 0 }), 30000, out);
+  CHECK(out.empty());
+
+  // Overflow flow control aborts the transfer:
+  engine.Receive(Frame(0x79b, { 0x02, 0x21, 0x02, 0, 0, 0, 0, 0 }), 40000, out);
+  out.clear();
+  engine.Receive(Frame(0x79b, { 0x32, 0x00, 0x00, 0, 0, 0, 0, 0 }), 50000, out);
+  CHECK(out.empty());
+  CHECK(ecu.aborted == 1);
+  CHECK(!ecu.txwait);
+  }
+
+static void TestMultiFrameRequest()
+  {
+  EcuSimEngine engine;
+  CHECK(Load(engine,
+    "ecu inv 18da10f1 18daf110 ext\n"
+    "flow 1000 2\n"
+    "req 2e0101 6e0101\n"));
+  ecusim_outputs_t out;
+
+  // 25 bytes: first frame (6) + 3 consecutive frames (7+7+5)
+  std::vector<uint8_t> ff = { 0x10, 0x19, 0x2e, 0x01, 0x01, 0x03, 0x04, 0x05 };
+  engine.Receive(Frame(0x18da10f1, ff, true), 0, out);
+  CHECK(out.size() == 1);
+  if (out.size() == 1)
+    {
+    CHECK(out[0].frame.ext);
+    CHECK(Match(out[0], 0x18daf110, { 0x30, 0x02, 0x01, 0x55, 0x55, 0x55, 0x55, 0x55 }));
+    }
+
+  // Block size 2: next flow control after the second frame
+  out.clear();
+  engine.Receive(Frame(0x18da10f1, { 0x21, 1, 2, 3, 4, 5, 6, 7 }, true), 1000, out);
+  CHECK(out.empty());
+  engine.Receive(Frame(0x18da10f1, { 0x22, 1, 2, 3, 4, 5, 6, 7 }, true), 2000, out);
+  CHECK(out.size() == 1);
+  if (out.size() == 1)
+    CHECK(out[0].frame.data[0] == 0x30);
+
+  out.clear();
+  engine.Receive(Frame(0x18da10f1, { 0x23, 1, 2, 3, 4, 5, 0, 0 }, true), 3000, out);
+  CHECK(out.size() == 1);
+  if (out.size() == 1)
+    CHECK(Match(out[0], 0x18daf110, { 0x03, 0x6e, 0x01, 0x01, 0x55, 0x55, 0x55, 0x55 }));
+
+  // Sequence error drops the request:
+  out.clear();
+  engine.Receive(Frame(0x18da10f1, ff, true), 4000, out);
+  engine.Receive(Frame(0x18da10f1, { 0x22, 1, 2, 3, 4, 5, 6, 7 }, true), 5000, out);
+  CHECK(engine.m_ecus[0].aborted == 1);
+  CHECK(engine.m_ecus[0].requests == 1);
+  }
+
+static void TestNegativeResponses()
+  {
+  EcuSimEngine engine;
+  CHECK(Load(engine,
+    "ecu bms 79b 7bb\n"
+    "delay 10\n"
+    "req 2103 nrc:22\n"
+    "req 2104 pending=2 610401\n"));
+  ecusim_outputs_t out;
+  EcuSimEngine::ecu_t& ecu = engine.m_ecus[0];
+
+  // Unknown request: requestOutOfRange
+  engine.Receive(Frame(0x79b, { 0x02, 0x21, 0x09, 0, 0, 0, 0, 0 }), 0, out);
+  CHECK(out.size() == 1);
+  if (out.size() == 1)
+    CHECK(Match(out[0], 0x7bb, { 0x03, 0x7f, 0x21, 0x31, 0x55, 0x55, 0x55, 0x55 }));
+  CHECK(ecu.unknown == 1);
+  CHECK(ecu.errors == 1);
+
+  // Scripted NRC:
+  out.clear();
+  engine.Receive(Frame(0x79b, { 0x02, 0x21, 0x03, 0, 0, 0, 0, 0 }), 0, out);
+  CHECK(out.size() == 1);
+  if (out.size() == 1)
+    CHECK(Match(out[0], 0x7bb, { 0x03, 0x7f, 0x21, 0x22, 0x55, 0x55, 0x55, 0x55 }));
+  CHECK(ecu.errors == 2);
+
+  // Two "response pending", each after the response delay, then the response:
+  out.clear();
+  engine.Receive(Frame(0x79b, { 0x02, 0x21, 0x04, 0, 0, 0, 0, 0 }), 0, out);
+  CHECK(out.size() == 3);
+  if (out.size() == 3)
+    {
+    CHECK(Match(out[0], 0x7bb, { 0x03, 0x7f, 0x21, 0x78, 0x55, 0x55, 0x55, 0x55 }));
+    CHECK(Match(out[1], 0x7bb, { 0x03, 0x7f, 0x21, 0x78, 0x55, 0x55, 0x55, 0x55 }));
+    CHECK(Match(out[2], 0x7bb, { 0x03, 0x61, 0x04, 0x01, 0x55, 0x55, 0x55, 0x55 }));
+    CHECK(out[0].due == 10000);
+    CHECK(out[1].due == 20000);
+    CHECK(out[2].due == 30000);
+    }
+  CHECK(ecu.errors == 2);
+  CHECK(ecu.responses == 3);
+
+  // TesterPresent is answered without a rule, unless suppressed:
+  out.clear();
+  engine.Receive(Frame(0x79b, { 0x02, 0x3e, 0x00, 0, 0, 0, 0, 0 }), 0, out);
+  CHECK(out.size() == 1);
+  if (out.size() == 1)
+    CHECK(Match(out[0], 0x7bb, { 0x02, 0x7e, 0x00, 0x55, 0x55, 0x55, 0x55, 0x55 }));
+  out.clear();
+  engine.Receive(Frame(0x79b, { 0x02, 0x3e, 0x80, 0, 0, 0, 0, 0 }), 0, out);
+  CHECK(out.empty());
+  }
+
+static void TestDrop()
+  {
+  EcuSimEngine engine;
+  CHECK(Load(engine,
+    "ecu bms 79b 7bb\n"
+    "drop 100\n"
+    "req 2101 610102\n"));
+  ecusim_outputs_t out;
+  for (int k = 0; k < 10; k++)
+    engine.Receive(Frame(0x79b, { 0x02, 0x21, 0x01, 0, 0, 0, 0, 0 }), k * 1000, out);
+  CHECK(out.empty());
+  CHECK(engine.m_ecus[0].dropped == 10);
+  CHECK(engine.m_ecus[0].frames_tx == 0);
+  CHECK(engine.m_ecus[0].requests == 10);
+
+  // Partial drops are reproducible from the seed:
+  const char* script =
+    "seed 1234\n"
+    "ecu bms 79b 7bb\n"
+    "drop 50\n"
+    "req 2101 610102\n";
+  EcuSimEngine a, b;
+  CHECK(Load(a, script));
+  CHECK(Load(b, script));
+  ecusim_outputs_t out_a, out_b;
+  for (int k = 0; k < 100; k++)
+    {
+    a.Receive(Frame(0x79b, { 0x02, 0x21, 0x01, 0, 0, 0, 0, 0 }), k * 1000, out_a);
+    b.Receive(Frame(0x79b, { 0x02, 0x21, 0x01, 0, 0, 0, 0, 0 }), k * 1000, out_b);
+    }
+  CHECK(a.m_ecus[0].dropped > 0 && a.m_ecus[0].dropped < 100);
+  CHECK(a.m_ecus[0].dropped == b.m_ecus[0].dropped);
+  CHECK(out_a.size() == out_b.size());
+  for (size_t i = 0; i < out_a.size() && i < out_b.size(); i++)
+    CHECK(out_a[i].due == out_b[i].due);
+  }
+
+static void TestVwtp()
+  {
+  EcuSimEngine engine;
+  CHECK(Load(engine,
+    "ecu gw 200 1f vwtp\n"
+    "req 22f190 62f190+17\n"));
+  ecusim_outputs_t out;
+  EcuSimEngine::ecu_t& ecu = engine.m_ecus[0];
+
+  // Channel setup: the tester offers 0x300 as its receive ID
+  CHECK(engine.Receive(Frame(0x200, { 0x1f, 0xc0, 0x00, 0x10, 0x00, 0x03, 0x01 }), 0, out));
+  CHECK(out.size() == 1);
+  if (out.size() == 1)
+    CHECK(Match(out[0], 0x21f, { 0x00, 0xd0, 0x00, 0x03, 0x5f, 0x07, 0x01 }));
+  CHECK(ecu.vwtp_open);
+  CHECK(ecu.vwtp_txid == 0x75f);
+  CHECK(ecu.vwtp_rxid == 0x300);
+
+  // Channel parameters: block size 15, separation 5 ms (0x32 = 50 x 100 us)
+  out.clear();
+  CHECK(engine.Receive(Frame(0x75f, { 0xa0, 0x0f, 0x8a, 0xff, 0x32, 0xff }), 1000, out));
+  CHECK(out.size() == 1);
+  if (out.size() == 1)
+    CHECK(Match(out[0], 0x300, { 0xa1, 0x0f, 0x8a, 0xff, 0x00, 0xff }));
+  CHECK(ecu.vwtp_bs == 15);
+  CHECK(ecu.vwtp_septime == 5000);
+
+  // Request in a single last frame: ACK, then 2 length + 20 payload bytes in 4 frames
+  out.clear();
+  engine.Receive(Frame(0x75f, { 0x10, 0x00, 0x03, 0x22, 0xf1, 0x90 }), 2000, out);
+  CHECK(out.size() == 5);
+  if (out.size() == 5)
+    {
+    CHECK(Match(out[0], 0x300, { 0xb1 }));
+    CHECK(Match(out[1], 0x300, { 0x20, 0x00, 0x14, 0x62, 0xf1, 0x90, 0x00, 0x01 }));
+    CHECK(out[2].frame.data[0] == 0x21);
+    CHECK(out[3].frame.data[0] == 0x22);
+    CHECK(out[4].frame.data[0] == 0x13);
+    CHECK(out[4].frame.dlc == 2);
+    CHECK(out[2].due == out[1].due + 5000);
+    CHECK(out[4].due == out[3].due + 5000);
+    }
+  CHECK(!ecu.txwait);
+
+  // Block size 2: the second frame ends the block and waits for the ACK
+  out.clear();
+  engine.Receive(Frame(0x75f, { 0xa0, 0x02, 0x8a, 0xff, 0x00, 0xff }), 3000, out);
+  out.clear();
+  engine.Receive(Frame(0x75f, { 0x11, 0x00, 0x03, 0x22, 0xf1, 0x90 }), 4000, out);
+  CHECK(out.size() == 3);
+  if (out.size() == 3)
+    {
+    CHECK(Match(out[0], 0x300, { 0xb2 }));
+    CHECK(out[1].frame.data[0] == 0x24);
+    CHECK(out[2].frame.data[0] == 0x05);
+    }
+  CHECK(ecu.txwait);
+  out.clear();
+  engine.Receive(Frame(0x75f, { 0xb6 }), 5000, out);
+  CHECK(out.size() == 2);
+  if (out.size() == 2)
+    {
+    CHECK(out[0].frame.data[0] == 0x26);
+    CHECK(out[1].frame.data[0] == 0x17);
+    }
+  CHECK(!ecu.txwait);
+
+  // ACK with abort during a block:
+  out.clear();
+  engine.Receive(Frame(0x75f, { 0x12, 0x00, 0x03, 0x22, 0xf1, 0x90 }), 6000, out);
+  CHECK(ecu.txwait);
+  engine.Receive(Frame(0x75f, { 0x9a }), 7000, out);
+  CHECK(ecu.aborted == 1);
+  CHECK(!ecu.txwait);
+
+  // Channel close:
+  out.clear();
+  engine.Receive(Frame(0x75f, { 0xa8 }), 8000, out);
+  CHECK(out.size() == 1);
+  if (out.size() == 1)
+    CHECK(Match(out[0], 0x300, { 0xa8 }));
+  CHECK(!ecu.vwtp_open);
+  CHECK(!engine.Receive(Frame(0x75f, { 0xa3 }), 9000, out));
+  }
+
+int main()
+  {
+  TestSingleFrame();
+  TestMultiFrameResponse();
+  TestMultiFrameRequest();
+  TestNegativeResponses();
+  TestDrop();
+  TestVwtp();
+  printf("%d checks, %d failed\n", checks, failures);
+  return failures ? 1 : 0;
+  }